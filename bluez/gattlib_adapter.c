@@ -22,10 +22,14 @@
  */
 
 #include "gattlib_internal.h"
+#include "gattlib_scan_throttle.h"
 
+#include <errno.h>
 #include <poll.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <sys/socket.h>
 
 #include <bluetooth/bluetooth.h>
 #include <bluetooth/hci.h>
@@ -40,13 +44,43 @@
 #define DISCOV_LE_SCAN_WIN              0x12
 #define DISCOV_LE_SCAN_INT              0x12
 
-#define BLE_EVENT_TYPE     0x05
-#define BLE_SCAN_RESPONSE  0x04
-
+#define EIR_UUID16_SOME    0x02  /* 16-bit UUID, more available */
+#define EIR_UUID16_ALL     0x03  /* 16-bit UUID, all listed */
+#define EIR_UUID32_SOME    0x04  /* 32-bit UUID, more available */
+#define EIR_UUID32_ALL     0x05  /* 32-bit UUID, all listed */
+#define EIR_UUID128_SOME   0x06  /* 128-bit UUID, more available */
+#define EIR_UUID128_ALL    0x07  /* 128-bit UUID, all listed */
 #define EIR_NAME_SHORT     0x08  /* shortened local name */
 #define EIR_NAME_COMPLETE  0x09  /* complete local name */
-
-int gattlib_adapter_open(const char* adapter_name, void** adapter) {
+#define EIR_SERVICE_DATA16  0x16 /* service data with 16-bit UUID */
+#define EIR_SERVICE_DATA32  0x20 /* service data with 32-bit UUID */
+#define EIR_SERVICE_DATA128 0x21 /* service data with 128-bit UUID */
+#define EIR_MANUFACTURER_DATA 0xFF /* manufacturer specific data */
+
+/* HCI commands of the LE extended scanning (Bluetooth 5.0) */
+#define OCF_LE_SET_EXT_SCAN_PARAMETERS  0x0041
+#define OCF_LE_SET_EXT_SCAN_ENABLE      0x0042
+
+#define LE_SCAN_PHY_1M                  0x01
+
+/* Maximum number of HCI events read at once from the HCI socket */
+#define HCI_EVENT_BATCH_SIZE            16
+
+struct scan_discovered_device {
+	gattlib_discovered_device_t discovered_device_cb;
+	void* user_data;
+};
+
+struct scan_discovered_device_with_data {
+	uuid_t **uuid_list;
+	int16_t rssi_threshold;
+	uint32_t enabled_filters;
+	gattlib_discovered_device_with_data_t discovered_device_cb;
+	void* user_data;
+};
+
+int gattlib_adapter_open(const char* adapter_name, gattlib_adapter_t** adapter) {
+	gattlib_adapter_t* gattlib_adapter;
 	int dev_id;
 
 	if (adapter == NULL) {
@@ -64,175 +98,504 @@ int gattlib_adapter_open(const char* adapter_name, void** adapter) {
 		return GATTLIB_NOT_FOUND;
 	}
 
-	int* device_desc = malloc(sizeof(int));
-	if (device_desc == NULL) {
+	gattlib_adapter = calloc(sizeof(gattlib_adapter_t), 1);
+	if (gattlib_adapter == NULL) {
 		return GATTLIB_OUT_OF_MEMORY;
-	} else {
-		*adapter = device_desc;
 	}
+	g_mutex_init(&gattlib_adapter->mutex);
 
-	*device_desc = hci_open_dev(dev_id);
-	if (*device_desc < 0) {
+	gattlib_adapter->device_desc = hci_open_dev(dev_id);
+	if (gattlib_adapter->device_desc < 0) {
 		fprintf(stderr, "ERROR: Could not open device.\n");
+		g_mutex_clear(&gattlib_adapter->mutex);
+		free(gattlib_adapter);
 		return GATTLIB_DEVICE_ERROR;
 	}
 
+	*adapter = gattlib_adapter;
 	return GATTLIB_SUCCESS;
 }
 
-static char* parse_name(uint8_t* data, size_t size) {
-	size_t offset = 0;
+static char* get_name(const gattlib_advertising_report_t* report) {
+	size_t i;
 
-	while (offset < size) {
-		uint8_t field_len = data[0];
-		size_t name_len;
-
-		if (field_len == 0 || offset + field_len > size)
-			return NULL;
-
-		switch (data[1]) {
+	for (i = 0; i < report->ad_count; i++) {
+		switch (report->ad[i].type) {
 		case EIR_NAME_SHORT:
 		case EIR_NAME_COMPLETE:
-			name_len = field_len - 1;
-			if (name_len > size)
-				return NULL;
-
-			return strndup((const char*)(data + 2), name_len);
+			return strndup((const char*)report->ad[i].data, report->ad[i].data_length);
 		}
-
-		offset += field_len + 1;
-		data += field_len + 1;
 	}
 
 	return NULL;
 }
 
-static int ble_scan(gattlib_adapter_t* adapter, int device_desc, gattlib_discovered_device_t discovered_device_cb, int timeout, void *user_data) {
-	struct hci_filter old_options;
-	socklen_t slen = sizeof(old_options);
-	struct hci_filter new_options;
-	unsigned char buffer[HCI_MAX_EVENT_SIZE];
-	evt_le_meta_event* meta = (evt_le_meta_event*)(buffer + HCI_EVENT_HDR_SIZE + 1);
-	le_advertising_info* info;
+static void on_report_discovered_device(gattlib_adapter_t* adapter, const gattlib_advertising_report_t* report, void *user_data) {
+	struct scan_discovered_device* scan = user_data;
+	bdaddr_t bdaddr;
 	char addr[18];
-	int len;
-#if BLUEZ_VERSION_MAJOR == 4
-	struct timeval wait;
-	fd_set read_set;
-#endif
 
-	if (getsockopt(device_desc, SOL_HCI, HCI_FILTER, &old_options, &slen) < 0) {
-		fprintf(stderr, "ERROR: Could not get socket options.\n");
-		return 1;
+	memcpy(&bdaddr, report->address, sizeof(bdaddr));
+	ba2str(&bdaddr, addr);
+
+	char* name = get_name(report);
+	scan->discovered_device_cb(adapter, addr, name, scan->user_data);
+	if (name) {
+		free(name);
 	}
+}
 
-	hci_filter_clear(&new_options);
-	hci_filter_set_ptype(HCI_EVENT_PKT, &new_options);
-	hci_filter_set_event(EVT_LE_META_EVENT, &new_options);
+/**
+ * Read a little-endian UUID of an AD structure
+ *
+ * @return the number of bytes of the UUID. 0 if the UUID is truncated.
+ */
+static size_t get_ad_uuid(const uint8_t* data, size_t data_length, size_t uuid_length, uuid_t* uuid) {
+	size_t i;
 
-	if (setsockopt(device_desc, SOL_HCI, HCI_FILTER,
-				   &new_options, sizeof(new_options)) < 0) {
-		fprintf(stderr, "ERROR: Could not set socket options.\n");
-		return 1;
+	if (data_length < uuid_length) {
+		return 0;
 	}
 
-#if BLUEZ_VERSION_MAJOR == 4
-	wait.tv_sec = timeout;
-	int ts = time(NULL);
+	memset(uuid, 0, sizeof(uuid_t));
+	if (uuid_length == 2) {
+		uuid->type = SDP_UUID16;
+		uuid->value.uuid16 = data[0] | (data[1] << 8);
+	} else if (uuid_length == 4) {
+		uuid->type = SDP_UUID32;
+		uuid->value.uuid32 = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+	} else {
+		uuid->type = SDP_UUID128;
+		for (i = 0; i < 16; i++) {
+			uuid->value.uuid128.data[i] = data[15 - i];
+		}
+	}
+	return uuid_length;
+}
 
-	while(1) {
-		FD_ZERO(&read_set);
-		FD_SET(device_desc, &read_set);
+// Return the length of the UUID of a service data AD structure. 0 if the AD structure is not a service data.
+static size_t get_service_data_uuid_length(uint8_t ad_type) {
+	switch (ad_type) {
+	case EIR_SERVICE_DATA16:
+		return 2;
+	case EIR_SERVICE_DATA32:
+		return 4;
+	case EIR_SERVICE_DATA128:
+		return 16;
+	default:
+		return 0;
+	}
+}
 
-		int err = select(FD_SETSIZE, &read_set, NULL, NULL, &wait);
-		if (err <= 0) {
-			break;
+static bool is_uuid_in_list(uuid_t **uuid_list, const uuid_t* uuid) {
+	for (; *uuid_list != NULL; uuid_list++) {
+		if (gattlib_uuid_cmp(*uuid_list, uuid) == 0) {
+			return true;
 		}
+	}
+	return false;
+}
 
-		len = read(device_desc, buffer, sizeof(buffer));
-		if (len < 0) {
-			fprintf(stderr, "Read error\n");
-			break;
+// Return true if the report advertises one of the UUIDs of the list in its service UUIDs or its service data
+static bool is_report_matching_uuids(const gattlib_advertising_report_t* report, uuid_t **uuid_list) {
+	size_t i, offset, uuid_length;
+	uuid_t uuid;
+
+	for (i = 0; i < report->ad_count; i++) {
+		const gattlib_ad_structure_t* ad = &report->ad[i];
+
+		uuid_length = get_service_data_uuid_length(ad->type);
+		if (uuid_length > 0) {
+			if ((get_ad_uuid(ad->data, ad->data_length, uuid_length, &uuid) > 0) && is_uuid_in_list(uuid_list, &uuid)) {
+				return true;
+			}
+			continue;
 		}
 
-		if (meta->subevent != 0x02 || (uint8_t)buffer[BLE_EVENT_TYPE] != BLE_SCAN_RESPONSE)
+		switch (ad->type) {
+		case EIR_UUID16_SOME:
+		case EIR_UUID16_ALL:
+			uuid_length = 2;
+			break;
+		case EIR_UUID32_SOME:
+		case EIR_UUID32_ALL:
+			uuid_length = 4;
+			break;
+		case EIR_UUID128_SOME:
+		case EIR_UUID128_ALL:
+			uuid_length = 16;
+			break;
+		default:
 			continue;
+		}
 
-		info = (le_advertising_info*) (meta->data + 1);
-		ba2str(&info->bdaddr, addr);
+		for (offset = 0; offset + uuid_length <= ad->data_length; offset += uuid_length) {
+			get_ad_uuid(&ad->data[offset], ad->data_length - offset, uuid_length, &uuid);
+			if (is_uuid_in_list(uuid_list, &uuid)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
 
-		char* name = parse_name(info->data, info->length);
-		discovered_device_cb(adapter, addr, name, user_data);
-		if (name) {
-			free(name);
+static void on_report_discovered_device_with_data(gattlib_adapter_t* adapter, const gattlib_advertising_report_t* report, void *user_data) {
+	struct scan_discovered_device_with_data* scan = user_data;
+	gattlib_advertisement_data_t* advertisement_data = NULL;
+	size_t advertisement_data_count = 0;
+	gattlib_manufacturer_data_t* manufacturer_data = NULL;
+	size_t manufacturer_data_count = 0;
+	bdaddr_t bdaddr;
+	char addr[18];
+	size_t i;
+
+	if ((scan->enabled_filters & GATTLIB_DISCOVER_FILTER_USE_RSSI) &&
+	    ((report->rssi == GATTLIB_ADVERTISING_REPORT_RSSI_UNKNOWN) || (report->rssi < scan->rssi_threshold))) {
+		return;
+	}
+
+	if ((scan->enabled_filters & GATTLIB_DISCOVER_FILTER_USE_UUID) && (scan->uuid_list != NULL) &&
+	    !is_report_matching_uuids(report, scan->uuid_list)) {
+		return;
+	}
+
+	if (report->ad_count > 0) {
+		advertisement_data = calloc(report->ad_count, sizeof(gattlib_advertisement_data_t));
+		manufacturer_data = calloc(report->ad_count, sizeof(gattlib_manufacturer_data_t));
+		if ((advertisement_data == NULL) || (manufacturer_data == NULL)) {
+			fprintf(stderr, "ERROR: Could not allocate the advertisement data.\n");
+			goto EXIT;
 		}
+	}
 
-		int elapsed = time(NULL) - ts;
-		if (elapsed >= timeout) {
-			fprintf(stderr, "Timeout error\n");
-			break;
+	// The data point to the report. They are only valid during the callback.
+	for (i = 0; i < report->ad_count; i++) {
+		const gattlib_ad_structure_t* ad = &report->ad[i];
+		size_t uuid_length = get_service_data_uuid_length(ad->type);
+
+		if (uuid_length > 0) {
+			if (get_ad_uuid(ad->data, ad->data_length, uuid_length, &advertisement_data[advertisement_data_count].uuid) > 0) {
+				advertisement_data[advertisement_data_count].data = (uint8_t*)&ad->data[uuid_length];
+				advertisement_data[advertisement_data_count].data_length = ad->data_length - uuid_length;
+				advertisement_data_count++;
+			}
+		} else if ((ad->type == EIR_MANUFACTURER_DATA) && (ad->data_length >= 2)) {
+			manufacturer_data[manufacturer_data_count].manufacturer_id = ad->data[0] | (ad->data[1] << 8);
+			manufacturer_data[manufacturer_data_count].data = (uint8_t*)&ad->data[2];
+			manufacturer_data[manufacturer_data_count].data_size = ad->data_length - 2;
+			manufacturer_data_count++;
 		}
+	}
+
+	memcpy(&bdaddr, report->address, sizeof(bdaddr));
+	ba2str(&bdaddr, addr);
+
+	char* name = get_name(report);
+	scan->discovered_device_cb(adapter, addr, name,
+			advertisement_data, advertisement_data_count,
+			manufacturer_data, manufacturer_data_count,
+			scan->user_data);
+	if (name) {
+		free(name);
+	}
+
+EXIT:
+	free(advertisement_data);
+	free(manufacturer_data);
+}
+
+// Throttling of the reports of a scan
+struct scan_throttle_context {
+	// Copy of the throttling of the adapter. It might be changed while scanning.
+	bool has_throttle;
+	gattlib_scan_throttle_t throttle;
+	// Last-seen cache of the devices. Allocated on first use.
+	struct gattlib_scan_throttle_cache* cache;
+
+	gattlib_advertising_report_cb_t report_cb;
+	void *user_data;
+};
+
+static void on_throttled_report(gattlib_adapter_t* adapter, const gattlib_advertising_report_t* report, void *user_data) {
+	struct scan_throttle_context* context = user_data;
+
+	if (context->has_throttle) {
+		uint64_t address = gattlib_address48_from_bytes(report->address);
+		unsigned int payload_index = (report->properties & GATTLIB_ADVERTISING_REPORT_SCAN_RESPONSE) ?
+				GATTLIB_SCAN_THROTTLE_PAYLOAD_SCAN_RESPONSE : GATTLIB_SCAN_THROTTLE_PAYLOAD_ADVERTISING;
+		uint64_t payload_hash = gattlib_scan_throttle_hash(GATTLIB_SCAN_THROTTLE_HASH_INIT, report->data, report->data_length);
+
+		if (context->cache == NULL) {
+			context->cache = gattlib_scan_throttle_cache_new();
+		}
+		if ((context->cache != NULL) &&
+		    !gattlib_scan_throttle_cache_update(context->cache, &context->throttle, address, report->rssi,
+				payload_index, payload_hash, (uint64_t)g_get_monotonic_time() * 1000)) {
+			return;
+		}
+	}
+
+	context->report_cb(adapter, report, context->user_data);
+}
+
+/**
+ * Read the HCI events available on the HCI socket without blocking.
+ *
+ * @return Number of events read. -1 on error.
+ */
+static int read_hci_events(int device_desc, uint8_t buffers[][HCI_MAX_EVENT_SIZE], int* lengths) {
+#if BLUEZ_VERSION_MAJOR == 5
+	struct mmsghdr messages[HCI_EVENT_BATCH_SIZE];
+	struct iovec iovecs[HCI_EVENT_BATCH_SIZE];
+	int count, i;
+
+	memset(messages, 0, sizeof(messages));
+	for (i = 0; i < HCI_EVENT_BATCH_SIZE; i++) {
+		iovecs[i].iov_base = buffers[i];
+		iovecs[i].iov_len = HCI_MAX_EVENT_SIZE;
+		messages[i].msg_hdr.msg_iov = &iovecs[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	count = recvmmsg(device_desc, messages, HCI_EVENT_BATCH_SIZE, MSG_DONTWAIT, NULL);
+	if (count < 0) {
+		return ((errno == EAGAIN) || (errno == EINTR)) ? 0 : -1;
+	}
 
-		wait.tv_sec = timeout - elapsed;
+	for (i = 0; i < count; i++) {
+		lengths[i] = messages[i].msg_len;
 	}
+	return count;
 #else
+	int count;
+
+	for (count = 0; count < HCI_EVENT_BATCH_SIZE; count++) {
+		lengths[count] = recv(device_desc, buffers[count], HCI_MAX_EVENT_SIZE, MSG_DONTWAIT);
+		if (lengths[count] < 0) {
+			if ((count == 0) && (errno != EAGAIN) && (errno != EINTR)) {
+				return -1;
+			}
+			break;
+		}
+	}
+	return count;
+#endif
+}
+
+static int ble_scan(gattlib_adapter_t* adapter, int device_desc, gattlib_advertising_report_cb_t report_cb, int timeout, void *user_data) {
+	struct hci_filter old_options;
+	socklen_t slen = sizeof(old_options);
+	struct hci_filter new_options;
+	gattlib_advertising_parser_t* parser;
+	gattlib_advertising_filter_t* filter = NULL;
+	gattlib_address_set_t* allowlist = NULL;
+	gattlib_address_set_t* denylist = NULL;
+	struct scan_throttle_context throttle_context = {
+		.report_cb = report_cb,
+		.user_data = user_data,
+	};
+	uint8_t buffers[HCI_EVENT_BATCH_SIZE][HCI_MAX_EVENT_SIZE];
+	int lengths[HCI_EVENT_BATCH_SIZE];
+	gint64 end_time = g_get_monotonic_time() + (gint64)timeout * G_USEC_PER_SEC;
+	int count, i;
+	int ret;
+
+	ret = gattlib_advertising_parser_new(&parser);
+	if (ret != GATTLIB_SUCCESS) {
+		return ret;
+	}
+
+	if (getsockopt(device_desc, SOL_HCI, HCI_FILTER, &old_options, &slen) < 0) {
+		fprintf(stderr, "ERROR: Could not get socket options.\n");
+		gattlib_advertising_parser_free(parser);
+		return 1;
+	}
+
+	hci_filter_clear(&new_options);
+	hci_filter_set_ptype(HCI_EVENT_PKT, &new_options);
+	hci_filter_set_event(EVT_LE_META_EVENT, &new_options);
+
+	if (setsockopt(device_desc, SOL_HCI, HCI_FILTER,
+				   &new_options, sizeof(new_options)) < 0) {
+		fprintf(stderr, "ERROR: Could not set socket options.\n");
+		gattlib_advertising_parser_free(parser);
+		return 1;
+	}
+
 	while (1) {
 		struct pollfd fds;
+		int poll_timeout = -1;
+
+		if (timeout > 0) {
+			gint64 remaining = end_time - g_get_monotonic_time();
+			if (remaining <= 0) {
+				break;
+			}
+			poll_timeout = (int)((remaining + 999) / 1000);
+		}
+
 		fds.fd     = device_desc;
 		fds.events = POLLIN;
 
-		int err = poll(&fds, 1, timeout * 1000);
-		if (err <= 0) {
+		int err = poll(&fds, 1, poll_timeout);
+		if (err < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		} else if (err == 0) {
 			break;
 		} else if ((fds.revents & POLLIN) == 0) {
 			continue;
 		}
 
-		len = read(device_desc, buffer, sizeof(buffer));
-		if (len < 0) {
+		// The filter and the address lists of the adapter might have been changed while scanning.
+		// The content of the address sets is updated in place.
+		g_mutex_lock(&adapter->mutex);
+		if (adapter->advertising_filter != filter) {
+			filter = adapter->advertising_filter;
+			gattlib_advertising_parser_set_filter(parser, filter);
+		}
+		if ((adapter->address_allowlist != allowlist) || (adapter->address_denylist != denylist)) {
+			allowlist = adapter->address_allowlist;
+			denylist = adapter->address_denylist;
+			gattlib_advertising_parser_set_address_lists(parser, allowlist, denylist);
+		}
+		throttle_context.has_throttle = adapter->has_scan_throttle;
+		throttle_context.throttle = adapter->scan_throttle;
+		g_mutex_unlock(&adapter->mutex);
+
+		// Several events might have been queued while waiting. Read them with a single call.
+		count = read_hci_events(device_desc, buffers, lengths);
+		if (count < 0) {
 			fprintf(stderr, "Read error\n");
 			break;
 		}
 
-		if (meta->subevent != 0x02 || (uint8_t)buffer[BLE_EVENT_TYPE] != BLE_SCAN_RESPONSE)
-			continue;
-
-		info = (le_advertising_info*) (meta->data + 1);
-		ba2str(&info->bdaddr, addr);
+		for (i = 0; i < count; i++) {
+			if ((lengths[i] < 1) || (buffers[i][0] != HCI_EVENT_PKT)) {
+				continue;
+			}
 
-		char* name = parse_name(info->data, info->length);
-		discovered_device_cb(adapter, addr, name, user_data);
-		if (name) {
-			free(name);
+			ret = gattlib_advertising_parser_parse_hci_event(parser, adapter, &buffers[i][1], lengths[i] - 1,
+					on_throttled_report, &throttle_context);
+			if (ret == GATTLIB_INVALID_PARAMETER) {
+				fprintf(stderr, "Malformed advertising report event\n");
+			}
 		}
 	}
-#endif
 
 	setsockopt(device_desc, SOL_HCI, HCI_FILTER, &old_options, sizeof(old_options));
+	gattlib_scan_throttle_cache_free(throttle_context.cache);
+	gattlib_advertising_parser_free(parser);
 	return GATTLIB_SUCCESS;
 }
 
-int gattlib_adapter_scan_enable(gattlib_adapter_t* adapter, gattlib_discovered_device_t discovered_device_cb, size_t timeout, void *user_data) {
-	int device_desc = *(int*)adapter;
+static int le_send_command(int device_desc, uint16_t ocf, void* cparam, int clen) {
+	struct hci_request rq;
+	uint8_t status;
+
+	memset(&rq, 0, sizeof(rq));
+	rq.ogf = OGF_LE_CTL;
+	rq.ocf = ocf;
+	rq.cparam = cparam;
+	rq.clen = clen;
+	rq.rparam = &status;
+	rq.rlen = 1;
+
+	if (hci_send_req(device_desc, &rq, 10000) < 0) {
+		return -1;
+	}
+
+	if (status) {
+		errno = EIO;
+		return -1;
+	}
+
+	return 0;
+}
 
-	uint16_t interval = htobs(DISCOV_LE_SCAN_INT);
-	uint16_t window = htobs(DISCOV_LE_SCAN_WIN);
+/**
+ * @param interval Scan interval in host byte order
+ * @param window   Scan window in host byte order
+ */
+static int le_set_extended_scan_parameters(int device_desc, uint8_t type, uint16_t interval, uint16_t window,
+		uint8_t own_address_type, uint8_t filter_policy)
+{
+	uint8_t cparam[8];
+
+	// The HCI parameters are little-endian
+
+	cparam[0] = own_address_type;
+	cparam[1] = filter_policy;
+	cparam[2] = LE_SCAN_PHY_1M;
+	cparam[3] = type;
+	cparam[4] = interval & 0xFF;
+	cparam[5] = interval >> 8;
+	cparam[6] = window & 0xFF;
+	cparam[7] = window >> 8;
+
+	return le_send_command(device_desc, OCF_LE_SET_EXT_SCAN_PARAMETERS, cparam, sizeof(cparam));
+}
+
+static int le_set_extended_scan_enable(int device_desc, uint8_t enable, uint8_t filter_dup) {
+	// Enable, filter duplicates, duration and period (scan until disabled)
+	uint8_t cparam[6] = { enable, filter_dup, 0, 0, 0, 0 };
+
+	return le_send_command(device_desc, OCF_LE_SET_EXT_SCAN_ENABLE, cparam, sizeof(cparam));
+}
+
+static int scan_start(int device_desc, uint8_t filter_dup) {
+	uint16_t interval = DISCOV_LE_SCAN_INT;
+	uint16_t window = DISCOV_LE_SCAN_WIN;
 	uint8_t own_address_type = 0x00;
 	uint8_t filter_policy = 0x00;
 
-	int ret = hci_le_set_scan_parameters(device_desc, LE_SCAN_ACTIVE, interval, window, own_address_type, filter_policy, 10000);
+	// Prefer the extended scanning to also receive the extended advertising reports.
+	// Controllers older than Bluetooth 5.0 reject these commands.
+	if ((le_set_extended_scan_parameters(device_desc, LE_SCAN_ACTIVE, interval, window, own_address_type, filter_policy) == 0) &&
+	    (le_set_extended_scan_enable(device_desc, 0x01, filter_dup) == 0)) {
+		return GATTLIB_SUCCESS;
+	}
+
+	// hci_le_set_scan_parameters() copies the values as they are in its command
+	int ret = hci_le_set_scan_parameters(device_desc, LE_SCAN_ACTIVE, htobs(interval), htobs(window),
+			own_address_type, filter_policy, 10000);
 	if (ret < 0) {
 		fprintf(stderr, "ERROR: Set scan parameters failed (are you root?).\n");
 		return 1;
 	}
 
-	ret = hci_le_set_scan_enable(device_desc, 0x01, 1, 10000);
+	ret = hci_le_set_scan_enable(device_desc, 0x01, filter_dup, 10000);
 	if (ret < 0) {
 		fprintf(stderr, "ERROR: Enable scan failed.\n");
 		return 1;
 	}
 
-	ret = ble_scan(adapter, device_desc, discovered_device_cb, timeout, user_data);
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_adapter_scan_enable_with_reports(gattlib_adapter_t* adapter, gattlib_advertising_report_cb_t report_cb,
+		size_t timeout, void *user_data)
+{
+	int device_desc = adapter->device_desc;
+
+	if (report_cb == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	// The throttling needs all the advertisements. The controller must not filter the duplicates.
+	g_mutex_lock(&adapter->mutex);
+	uint8_t filter_dup = adapter->has_scan_throttle ? 0x00 : 0x01;
+	g_mutex_unlock(&adapter->mutex);
+
+	int ret = scan_start(device_desc, filter_dup);
+	if (ret != GATTLIB_SUCCESS) {
+		return ret;
+	}
+
+	ret = ble_scan(adapter, device_desc, report_cb, timeout, user_data);
 	if (ret != 0) {
 		fprintf(stderr, "ERROR: Advertisement fail.\n");
 		return 1;
@@ -241,14 +604,41 @@ int gattlib_adapter_scan_enable(gattlib_adapter_t* adapter, gattlib_discovered_d
 	return GATTLIB_SUCCESS;
 }
 
+int gattlib_adapter_scan_enable(gattlib_adapter_t* adapter, gattlib_discovered_device_t discovered_device_cb, size_t timeout, void *user_data) {
+	struct scan_discovered_device scan = {
+		.discovered_device_cb = discovered_device_cb,
+		.user_data = user_data,
+	};
+
+	return gattlib_adapter_scan_enable_with_reports(adapter, on_report_discovered_device, timeout, &scan);
+}
+
 int gattlib_adapter_scan_enable_with_filter(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
 		gattlib_discovered_device_t discovered_device_cb, size_t timeout, void *user_data)
 {
 	return GATTLIB_NOT_SUPPORTED;
 }
 
+int gattlib_adapter_scan_enable_with_data(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
+		gattlib_discovered_device_with_data_t discovered_device_cb, size_t timeout, void *user_data)
+{
+	struct scan_discovered_device_with_data scan = {
+		.uuid_list = uuid_list,
+		.rssi_threshold = rssi_threshold,
+		.enabled_filters = enabled_filters,
+		.discovered_device_cb = discovered_device_cb,
+		.user_data = user_data,
+	};
+
+	if (discovered_device_cb == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	return gattlib_adapter_scan_enable_with_reports(adapter, on_report_discovered_device_with_data, timeout, &scan);
+}
+
 int gattlib_adapter_scan_disable(gattlib_adapter_t* adapter) {
-	int device_desc = *(int*)adapter;
+	int device_desc = adapter->device_desc;
 
 	if (device_desc == -1) {
 		fprintf(stderr, "ERROR: Could not disable scan, not enabled yet.\n");
@@ -256,14 +646,81 @@ int gattlib_adapter_scan_disable(gattlib_adapter_t* adapter) {
 	}
 
 	int result = hci_le_set_scan_enable(device_desc, 0x00, 1, 10000);
+	if (result < 0) {
+		// The scan might have been started with the extended scanning commands
+		result = le_set_extended_scan_enable(device_desc, 0x00, 1);
+	}
 	if (result < 0) {
 		fprintf(stderr, "ERROR: Disable scan failed.\n");
 	}
 	return result;
 }
 
+int gattlib_adapter_set_advertising_filter(gattlib_adapter_t* adapter, gattlib_advertising_filter_t* filter) {
+	if (adapter == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	gattlib_advertising_filter_ref(filter);
+
+	g_mutex_lock(&adapter->mutex);
+	gattlib_advertising_filter_t* previous_filter = adapter->advertising_filter;
+	adapter->advertising_filter = filter;
+	g_mutex_unlock(&adapter->mutex);
+
+	gattlib_advertising_filter_unref(previous_filter);
+	return GATTLIB_SUCCESS;
+}
+
+static int set_address_list(gattlib_adapter_t* adapter, gattlib_address_set_t** list, gattlib_address_set_t* set) {
+	gattlib_address_set_ref(set);
+
+	g_mutex_lock(&adapter->mutex);
+	gattlib_address_set_t* previous_set = *list;
+	*list = set;
+	g_mutex_unlock(&adapter->mutex);
+
+	gattlib_address_set_unref(previous_set);
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_adapter_set_address_allowlist(gattlib_adapter_t* adapter, gattlib_address_set_t* allowlist) {
+	if (adapter == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+	return set_address_list(adapter, &adapter->address_allowlist, allowlist);
+}
+
+int gattlib_adapter_set_address_denylist(gattlib_adapter_t* adapter, gattlib_address_set_t* denylist) {
+	if (adapter == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+	return set_address_list(adapter, &adapter->address_denylist, denylist);
+}
+
+int gattlib_adapter_set_scan_throttle(gattlib_adapter_t* adapter, const gattlib_scan_throttle_t* throttle) {
+	if (adapter == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_mutex_lock(&adapter->mutex);
+	if (throttle != NULL) {
+		adapter->scan_throttle = *throttle;
+		adapter->has_scan_throttle = true;
+	} else {
+		adapter->has_scan_throttle = false;
+	}
+	g_mutex_unlock(&adapter->mutex);
+
+	return GATTLIB_SUCCESS;
+}
+
 int gattlib_adapter_close(gattlib_adapter_t* adapter) {
-	hci_close_dev(*(int*)adapter);
+	hci_close_dev(adapter->device_desc);
+	gattlib_advertising_filter_unref(adapter->advertising_filter);
+	gattlib_address_set_unref(adapter->address_allowlist);
+	gattlib_address_set_unref(adapter->address_denylist);
+	g_mutex_clear(&adapter->mutex);
 	free(adapter);
 	return GATTLIB_SUCCESS;
 }
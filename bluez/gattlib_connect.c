@@ -22,9 +22,11 @@
  */
 
 #include <assert.h>
+#include <errno.h>
 #include <pthread.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <sys/socket.h>
 
 #include <bluetooth/bluetooth.h>
 
@@ -32,13 +34,33 @@
 
 #include "att.h"
 #include "btio.h"
+#include "gatt.h"
 #include "gattrib.h"
 #include "hci.h"
 #include "hci_lib.h"
 
+#if BLUEZ_VERSION_MAJOR == 5
+  #include "src/shared/gatt-db.h"
+  #include "src/shared/gatt-client.h"
+#endif
+
 #define CONNECTION_TIMEOUT    2
 
-struct gattlib_thread_t g_gattlib_thread = { 0 };
+// Largest ATT MTU the legacy backend requests to the remote device
+#if BLUEZ_VERSION_MAJOR == 4
+  #define GATTLIB_LEGACY_MAX_MTU    ATT_MAX_MTU
+#else
+  #define GATTLIB_LEGACY_MAX_MTU    BT_ATT_MAX_LE_MTU
+#endif
+
+// Loop threads of the legacy backend. There is one loop thread per adapter.
+static GMutex m_loop_threads_mutex;
+static GSList* m_loop_threads = NULL;
+// Loop thread serving each connection socket: file descriptor -> loop thread.
+// Protected by 'm_loop_threads_mutex'.
+static GHashTable* m_loop_thread_sockets = NULL;
+// Loop thread the current thread is running or is connecting through
+static GPrivate m_current_loop_thread;
 
 typedef struct {
 	gattlib_connection_t* conn;
@@ -46,14 +68,56 @@ typedef struct {
 	int                connected;
 	int                timeout;
 	GError*            error;
+	// GATTLIB_* error code when the link has been established but the connection could not be set up.
+	// The link has then been closed.
+	int                setup_error;
 	void*              user_data;
+	// ATT MTU requested to the remote device
+	uint16_t           mtu;
 } io_connect_arg_t;
 
+static void _gattlib_disconnect_link(gattlib_connection_t* connection);
+static void _gattlib_connection_free(gattlib_connection_t* connection);
+
+/**
+ * Replace the list of characteristics used for the correspondence handle/UUID
+ */
+static void set_characteristics(gattlib_connection_t* conn, gattlib_characteristic_t* characteristics, int characteristic_count) {
+	gattlib_context_t* conn_context = conn->context;
+	gattlib_characteristic_t* previous_characteristics;
+
+	g_mutex_lock(&conn_context->characteristics_mutex);
+	previous_characteristics = conn_context->characteristics;
+	conn_context->characteristics = characteristics;
+	conn_context->characteristic_count = characteristic_count;
+	g_mutex_unlock(&conn_context->characteristics_mutex);
+
+	free(previous_characteristics);
+}
+
+#if BLUEZ_VERSION_MAJOR == 4
+struct gattlib_mtu_exchange {
+	int      completed;
+	uint16_t requested_mtu;
+	uint16_t mtu;
+};
+#else
+struct gattlib_gatt_client_ready {
+	int     completed;
+	bool    success;
+	uint8_t att_ecode;
+};
+#endif
+
 static void events_handler(const uint8_t *pdu, uint16_t len, gpointer user_data) {
 	gattlib_connection_t *conn = user_data;
-	uint8_t opdu[ATT_MAX_MTU];
+	gattlib_context_t* conn_context = conn->context;
+	uint8_t *opdu;
+	size_t opdu_len;
 	uint16_t handle, olen = 0;
 	uuid_t uuid = {};
+	// Reception time of the event in the CLOCK_MONOTONIC time base
+	uint64_t timestamp_ns = (uint64_t)g_get_monotonic_time() * 1000;
 
 #if BLUEZ_VERSION_MAJOR == 4
 	handle = att_get_u16(&pdu[1]);
@@ -69,12 +133,12 @@ static void events_handler(const uint8_t *pdu, uint16_t len, gpointer user_data)
 	switch (pdu[0]) {
 	case ATT_OP_HANDLE_NOTIFY:
 		if (gattlib_has_valid_handler(&conn->notification)) {
-			gattlib_on_gatt_notification(&conn, &uuid, &pdu[3], len - 3);
+			gattlib_on_gatt_notification(conn, &uuid, &pdu[3], len - 3, timestamp_ns);
 		}
 		break;
 	case ATT_OP_HANDLE_IND:
 		if (gattlib_has_valid_handler(&conn->indication)) {
-			gattlib_on_gatt_notification(&conn, &uuid, &pdu[3], len - 3);
+			gattlib_on_gatt_indication(conn, &uuid, &pdu[3], len - 3, timestamp_ns);
 		}
 		break;
 	default:
@@ -85,10 +149,17 @@ static void events_handler(const uint8_t *pdu, uint16_t len, gpointer user_data)
 	if (pdu[0] == ATT_OP_HANDLE_NOTIFY)
 		return;
 
-	olen = enc_confirmation(opdu, sizeof(opdu));
+#if BLUEZ_VERSION_MAJOR == 5
+	// The GATT client engine confirms the indications received on the ATT transport
+	if (conn_context->client != NULL)
+		return;
+#endif
+
+	// The buffer of the transport is sized from the negotiated MTU
+	opdu = g_attrib_get_buffer(conn_context->attrib, &opdu_len);
+	olen = enc_confirmation(opdu, opdu_len);
 
 	if (olen > 0) {
-		gattlib_context_t* conn_context = conn->context;
 		g_attrib_send(conn_context->attrib, 0,
 #if BLUEZ_VERSION_MAJOR == 4
 				opdu[0],
@@ -115,6 +186,186 @@ static gboolean io_listen_cb(gpointer user_data) {
 	return FALSE;
 }
 
+#if BLUEZ_VERSION_MAJOR == 4
+static void exchange_mtu_cb(guint8 status, const guint8 *pdu, guint16 plen, gpointer user_data) {
+	struct gattlib_mtu_exchange* exchange = user_data;
+	uint16_t server_mtu;
+
+	if (status != 0) {
+		fprintf(stderr, "Exchange MTU failed: %s\n", att_ecode2str(status));
+	} else if (!dec_mtu_resp(pdu, plen, &server_mtu)) {
+		fprintf(stderr, "Exchange MTU: Protocol error\n");
+	} else {
+		// The ATT MTU of the connection is the smallest of the client and server MTUs
+		exchange->mtu = MIN(exchange->requested_mtu, server_mtu);
+		if (exchange->mtu < ATT_DEFAULT_LE_MTU) {
+			exchange->mtu = ATT_DEFAULT_LE_MTU;
+		}
+	}
+
+	exchange->completed = TRUE;
+}
+
+/**
+ * @brief Negotiate the ATT MTU of a LE connection (ATT Exchange MTU)
+ *
+ * @note: It must be called from the GattLib thread before any other ATT request.
+ *
+ * @param conn          Connection to negotiate the MTU
+ * @param requested_mtu MTU requested to the remote device
+ *
+ * @return The ATT MTU of the connection
+ */
+static uint16_t gattlib_exchange_mtu(gattlib_connection_t* conn, uint16_t requested_mtu) {
+	gattlib_context_t* conn_context = conn->context;
+	struct gattlib_mtu_exchange exchange = {
+		.completed = FALSE,
+		.requested_mtu = requested_mtu,
+		.mtu = ATT_DEFAULT_LE_MTU
+	};
+
+	if (requested_mtu <= ATT_DEFAULT_LE_MTU) {
+		return ATT_DEFAULT_LE_MTU;
+	}
+
+	if (gatt_exchange_mtu(conn_context->attrib, requested_mtu, exchange_mtu_cb, &exchange) == 0) {
+		fprintf(stderr, "Fail to send Exchange MTU request.\n");
+		return ATT_DEFAULT_LE_MTU;
+	}
+
+	// Wait for completion of the exchange. The ATT transaction timeout guarantees the completion.
+	while (exchange.completed == FALSE) {
+		g_main_context_iteration(conn_context->loop_thread->loop_context, FALSE);
+	}
+
+	if (exchange.mtu == ATT_DEFAULT_LE_MTU) {
+		return ATT_DEFAULT_LE_MTU;
+	}
+
+	// Resize the buffers of the transport to the negotiated MTU
+	if (!g_attrib_set_mtu(conn_context->attrib, exchange.mtu)) {
+		fprintf(stderr, "Fail to set the MTU of the connection to %u.\n", exchange.mtu);
+		return ATT_DEFAULT_LE_MTU;
+	}
+
+	return exchange.mtu;
+}
+#else
+static void gatt_client_ready_cb(bool success, uint8_t att_ecode, void *user_data) {
+	struct gattlib_gatt_client_ready* ready = user_data;
+
+	ready->success = success;
+	ready->att_ecode = att_ecode;
+	ready->completed = TRUE;
+}
+
+static void gatt_client_service_changed_cb(uint16_t start_handle, uint16_t end_handle, void *user_data) {
+	gattlib_connection_t* conn = user_data;
+	gattlib_characteristic_t* characteristics;
+	int characteristic_count;
+	int ret;
+
+	// The GATT client engine has already rediscovered the range. Rebuild the correspondence handle/UUID.
+	ret = gattlib_discover_char(conn, &characteristics, &characteristic_count);
+	if (ret != GATTLIB_SUCCESS) {
+		fprintf(stderr, "Fail to update the characteristics after 'Service Changed' (0x%04x-0x%04x).\n",
+				start_handle, end_handle);
+		return;
+	}
+
+	// The application threads might be looking up a handle at the same time
+	set_characteristics(conn, characteristics, characteristic_count);
+}
+
+/**
+ * @brief Start the GATT client engine on the ATT transport of the connection
+ *
+ * The engine negotiates the ATT MTU and discovers all the attributes of the remote device into its
+ * database. The function returns once the engine is ready.
+ *
+ * @note: It must be called from the GattLib thread before any other ATT request.
+ *
+ * @param conn          Connection to start the GATT client on
+ * @param requested_mtu MTU requested to the remote device
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+static int gattlib_gatt_client_init(gattlib_connection_t* conn, uint16_t requested_mtu) {
+	gattlib_context_t* conn_context = conn->context;
+	struct gattlib_gatt_client_ready ready = {
+		.completed = FALSE,
+		.success = false,
+		.att_ecode = 0
+	};
+
+	conn_context->db = gatt_db_new();
+	if (conn_context->db == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	conn_context->client = bt_gatt_client_new(conn_context->db, g_attrib_get_att(conn_context->attrib), requested_mtu);
+	if (conn_context->client == NULL) {
+		fprintf(stderr, "Fail to create the GATT client.\n");
+		gatt_db_unref(conn_context->db);
+		conn_context->db = NULL;
+		return GATTLIB_ERROR_INTERNAL;
+	}
+
+	bt_gatt_client_set_ready_handler(conn_context->client, gatt_client_ready_cb, &ready, NULL);
+
+	// Wait for the MTU exchange and the discovery. The ATT transaction timeout guarantees the completion.
+	while (ready.completed == FALSE) {
+		g_main_context_iteration(conn_context->loop_thread->loop_context, FALSE);
+	}
+
+	// 'ready' is on the stack
+	bt_gatt_client_set_ready_handler(conn_context->client, NULL, NULL, NULL);
+
+	if (!ready.success) {
+		fprintf(stderr, "GATT client initialization failed: %s\n", att_ecode2str(ready.att_ecode));
+		bt_gatt_client_unref(conn_context->client);
+		conn_context->client = NULL;
+		gatt_db_unref(conn_context->db);
+		conn_context->db = NULL;
+		return GATTLIB_ERROR_BLUEZ_WITH_ERROR(ready.att_ecode);
+	}
+
+	bt_gatt_client_set_service_changed(conn_context->client, gatt_client_service_changed_cb, conn, NULL);
+
+	// The GAttrib based requests share the transport. Resize its buffers to the negotiated MTU.
+	conn_context->mtu = bt_gatt_client_get_mtu(conn_context->client);
+	if (!g_attrib_set_mtu(conn_context->attrib, conn_context->mtu)) {
+		fprintf(stderr, "Fail to set the MTU of the connection to %u.\n", conn_context->mtu);
+	}
+
+	return GATTLIB_SUCCESS;
+}
+#endif
+
+/**
+ * @brief Size the Write Command credits of a connection from the send buffer of its socket
+ *
+ * A credit is taken by each queued Write Command. Sizing the credits from the socket send buffer
+ * keeps the writer close to the rate the socket accepts data, without queueing more than it can hold.
+ */
+static gint get_write_cmd_credits(GIOChannel *io, uint16_t mtu) {
+	int sndbuf = 0;
+	socklen_t sndbuf_len = sizeof(sndbuf);
+	gint credits;
+
+	if (getsockopt(g_io_channel_unix_get_fd(io), SOL_SOCKET, SO_SNDBUF, &sndbuf, &sndbuf_len) < 0) {
+		return 1;
+	}
+
+	credits = sndbuf / mtu;
+	if (credits < 1) {
+		credits = 1;
+	} else if (credits > GATTLIB_WRITE_CMD_MAX_CREDITS) {
+		credits = GATTLIB_WRITE_CMD_MAX_CREDITS;
+	}
+	return credits;
+}
+
 static void io_connect_cb(GIOChannel *io, GError *err, gpointer user_data) {
 	io_connect_arg_t* io_connect_arg = user_data;
 
@@ -127,13 +378,65 @@ static void io_connect_cb(GIOChannel *io, GError *err, gpointer user_data) {
 		}
 	} else {
 		gattlib_context_t* conn_context = io_connect_arg->conn->context;
+		gattlib_characteristic_t* characteristics = NULL;
+		int characteristic_count = 0;
+		GError *gerr = NULL;
+		uint16_t imtu, cid;
+#if BLUEZ_VERSION_MAJOR == 5
+		int ret;
+#endif
+
+		// Over BR/EDR, the ATT MTU is the L2CAP MTU. Over LE, the ATT MTU must be exchanged.
+		if (!bt_io_get(io,
+#if BLUEZ_VERSION_MAJOR == 4
+				BT_IO_L2CAP,
+#endif
+				&gerr, BT_IO_OPT_IMTU, &imtu, BT_IO_OPT_CID, &cid, BT_IO_OPT_INVALID)) {
+			fprintf(stderr, "Can't detect MTU, using default: %s\n", gerr->message);
+			g_error_free(gerr);
+			imtu = ATT_DEFAULT_LE_MTU;
+			cid = ATT_CID;
+		}
+
+		if (cid == ATT_CID) {
+			conn_context->mtu = ATT_DEFAULT_LE_MTU;
+		} else {
+			conn_context->mtu = imtu;
+		}
 
 #if BLUEZ_VERSION_MAJOR == 4
 		conn_context->attrib = g_attrib_new(io);
 #else
-		conn_context->attrib = g_attrib_new(io, BT_ATT_DEFAULT_LE_MTU, false);
+		conn_context->attrib = g_attrib_new(io, conn_context->mtu, false);
 #endif
 
+#if BLUEZ_VERSION_MAJOR == 4
+		if (cid == ATT_CID) {
+			conn_context->mtu = gattlib_exchange_mtu(io_connect_arg->conn, io_connect_arg->mtu);
+		}
+#else
+		// The GATT client engine exchanges the MTU (LE only) and fills its database
+		ret = gattlib_gatt_client_init(io_connect_arg->conn, io_connect_arg->mtu);
+		if (ret != GATTLIB_SUCCESS) {
+			fprintf(stderr, "Fail to initialize the GATT client. Attributes cannot be accessed.\n");
+
+			// Do not report a connection whose attributes cannot be accessed. Close its link.
+			_gattlib_disconnect_link(io_connect_arg->conn);
+			io_connect_arg->setup_error = ret;
+
+			if (io_connect_arg->connect_cb) {
+				io_connect_arg->connect_cb(NULL, io_connect_arg->user_data);
+
+				// The connection has not been reported to the application. Nobody else refers to it.
+				_gattlib_connection_free(io_connect_arg->conn);
+				free(io_connect_arg);
+			}
+			return;
+		}
+#endif
+
+		g_atomic_int_set(&conn_context->write_cmd_credits, get_write_cmd_credits(io, conn_context->mtu));
+
 		//
 		// Register the listener callback
 		//
@@ -143,14 +446,16 @@ static void io_connect_cb(GIOChannel *io, GError *err, gpointer user_data) {
 		g_source_set_callback(source, io_listen_cb, io_connect_arg->conn, NULL);
 
 		// Attaches the listener to the main loop context
-		guint id = g_source_attach(source, g_gattlib_thread.loop_context);
+		guint id = g_source_attach(source, conn_context->loop_thread->loop_context);
 		g_source_unref (source);
 		assert(id != 0);
 
 		//
 		// Save list of characteristics to do the correspondence handle/UUID
+		// (with BlueZ v5, they come from the database of the GATT client)
 		//
-		gattlib_discover_char(io_connect_arg->conn, &conn_context->characteristics, &conn_context->characteristic_count);
+		gattlib_discover_char(io_connect_arg->conn, &characteristics, &characteristic_count);
+		set_characteristics(io_connect_arg->conn, characteristics, characteristic_count);
 
 		//
 		// Call callback if defined
@@ -166,48 +471,225 @@ static void io_connect_cb(GIOChannel *io, GError *err, gpointer user_data) {
 	}
 }
 
+static void loop_thread_free(struct gattlib_thread_t* loop_thread) {
+	g_main_loop_unref(loop_thread->loop);
+	g_main_context_unref(loop_thread->loop_context);
+	g_cond_clear(&loop_thread->condition);
+	g_mutex_clear(&loop_thread->mutex);
+	g_free(loop_thread->adapter_id);
+	free(loop_thread);
+}
+
+static gboolean loop_thread_started_cb(gpointer user_data) {
+	struct gattlib_thread_t* loop_thread = user_data;
+
+	g_mutex_lock(&loop_thread->mutex);
+	loop_thread->is_running = true;
+	g_cond_broadcast(&loop_thread->condition);
+	g_mutex_unlock(&loop_thread->mutex);
+
+	return FALSE;
+}
+
 static void *connection_thread(void* arg) {
 	struct gattlib_thread_t* loop_thread = arg;
+	bool is_detached;
 
-	loop_thread->loop_context = g_main_context_new();
-	loop_thread->loop = g_main_loop_new(loop_thread->loop_context, TRUE);
+	g_private_set(&m_current_loop_thread, loop_thread);
+
+	// The first event dispatched by the loop signals its readiness
+	GSource *source = g_idle_source_new();
+	assert(source != NULL);
+	g_source_set_callback(source, loop_thread_started_cb, loop_thread, NULL);
+	g_source_attach(source, loop_thread->loop_context);
+	g_source_unref(source);
 
 	g_main_loop_run(loop_thread->loop);
-	g_main_loop_unref(loop_thread->loop);
-	assert(0);
+
+	g_mutex_lock(&loop_thread->mutex);
+	is_detached = loop_thread->is_detached;
+	g_mutex_unlock(&loop_thread->mutex);
+
+	if (is_detached) {
+		loop_thread_free(loop_thread);
+	}
 	return NULL;
 }
 
-static gattlib_connection_t *initialize_gattlib_connection(const gchar *src, const gchar *dst,
-		uint8_t dest_type, BtIOSecLevel sec_level, int psm, int mtu,
-		gatt_connect_cb_t connect_cb,
-		io_connect_arg_t* io_connect_arg)
-{
-	bdaddr_t sba, dba;
-	GError *err = NULL;
-	int ret;
+/**
+ * @brief Get the loop thread of an adapter. The loop thread is started if needed.
+ *
+ * @param adapter_id Adapter served by the loop thread (NULL for the default adapter)
+ *
+ * @return The loop thread once its loop runs. NULL on error.
+ */
+static struct gattlib_thread_t* gattlib_loop_thread_get(const char* adapter_id) {
+	struct gattlib_thread_t* loop_thread = NULL;
+	int error;
 
-	io_connect_arg->error = NULL;
+	g_mutex_lock(&m_loop_threads_mutex);
 
-	/* Check if the GattLib thread has been started */
-	if (g_gattlib_thread.ref == 0) {
-		/* Start it */
+	for (GSList *l = m_loop_threads; l != NULL; l = l->next) {
+		struct gattlib_thread_t* thread = l->data;
+		if (g_strcmp0(thread->adapter_id, adapter_id) == 0) {
+			loop_thread = thread;
+			break;
+		}
+	}
+
+	if (loop_thread != NULL) {
+		/* Increase the reference to know how many GATT connection use the loop */
+		loop_thread->ref++;
+	} else {
+		loop_thread = calloc(sizeof(struct gattlib_thread_t), 1);
+		if (loop_thread == NULL) {
+			g_mutex_unlock(&m_loop_threads_mutex);
+			return NULL;
+		}
+
+		loop_thread->ref = 1;
+		loop_thread->adapter_id = g_strdup(adapter_id);
+		g_mutex_init(&loop_thread->mutex);
+		g_cond_init(&loop_thread->condition);
+		loop_thread->loop_context = g_main_context_new();
+		loop_thread->loop = g_main_loop_new(loop_thread->loop_context, FALSE);
 
 		/* Create a thread that will handle Bluetooth events */
-		int error = pthread_create(&g_gattlib_thread.thread, NULL, &connection_thread, &g_gattlib_thread);
+		error = pthread_create(&loop_thread->thread, NULL, &connection_thread, loop_thread);
 		if (error != 0) {
 			fprintf(stderr, "Cannot create connection thread: %s", strerror(error));
+			loop_thread_free(loop_thread);
+			g_mutex_unlock(&m_loop_threads_mutex);
 			return NULL;
 		}
 
-		/* Wait for the loop to be started */
-		while (!g_gattlib_thread.loop || !g_main_loop_is_running (g_gattlib_thread.loop)) {
-			usleep(1000);
-		}
+		m_loop_threads = g_slist_prepend(m_loop_threads, loop_thread);
+	}
+
+	g_mutex_unlock(&m_loop_threads_mutex);
+
+	/* Wait for the loop to be started */
+	g_mutex_lock(&loop_thread->mutex);
+	while (!loop_thread->is_running) {
+		g_cond_wait(&loop_thread->condition, &loop_thread->mutex);
+	}
+	g_mutex_unlock(&loop_thread->mutex);
+
+	return loop_thread;
+}
+
+/**
+ * @brief Release a loop thread. The loop thread is stopped with its last connection.
+ */
+static void gattlib_loop_thread_put(struct gattlib_thread_t* loop_thread) {
+	bool is_last;
+
+	g_mutex_lock(&m_loop_threads_mutex);
+	loop_thread->ref--;
+	is_last = (loop_thread->ref == 0);
+	if (is_last) {
+		m_loop_threads = g_slist_remove(m_loop_threads, loop_thread);
+	}
+	g_mutex_unlock(&m_loop_threads_mutex);
+
+	if (!is_last) {
+		return;
+	}
+
+	if (pthread_equal(pthread_self(), loop_thread->thread)) {
+		// Called from an event of the loop. The loop thread cannot be joined. It frees itself on exit.
+		g_mutex_lock(&loop_thread->mutex);
+		loop_thread->is_detached = true;
+		g_mutex_unlock(&loop_thread->mutex);
+
+		pthread_detach(loop_thread->thread);
+		g_main_loop_quit(loop_thread->loop);
 	} else {
-		/* Increase the reference to know how many GATT connection use the loop */
-		g_gattlib_thread.ref++;
+		g_main_loop_quit(loop_thread->loop);
+		pthread_join(loop_thread->thread, NULL);
+		loop_thread_free(loop_thread);
+	}
+}
+
+static void gattlib_loop_thread_add_socket(struct gattlib_thread_t* loop_thread, GIOChannel* io) {
+	g_mutex_lock(&m_loop_threads_mutex);
+	if (m_loop_thread_sockets == NULL) {
+		m_loop_thread_sockets = g_hash_table_new(g_direct_hash, g_direct_equal);
+	}
+	g_hash_table_insert(m_loop_thread_sockets, GINT_TO_POINTER(g_io_channel_unix_get_fd(io)), loop_thread);
+	g_mutex_unlock(&m_loop_threads_mutex);
+}
+
+static void gattlib_loop_thread_remove_socket(GIOChannel* io) {
+	g_mutex_lock(&m_loop_threads_mutex);
+	if (m_loop_thread_sockets != NULL) {
+		g_hash_table_remove(m_loop_thread_sockets, GINT_TO_POINTER(g_io_channel_unix_get_fd(io)));
+	}
+	g_mutex_unlock(&m_loop_threads_mutex);
+}
+
+/**
+ * @brief Return a reference to the main loop context that must dispatch the events of a socket
+ *
+ * The sources of the BlueZ helpers are created either from the loop thread of the connection or from
+ * the thread of the caller. The context is found from the socket. The loop thread of the current thread
+ * is used for sockets not registered yet (ie: while connecting).
+ */
+static GMainContext* gattlib_loop_context_ref(GIOChannel* io) {
+	struct gattlib_thread_t* loop_thread = NULL;
+	GMainContext* context = NULL;
+
+	g_mutex_lock(&m_loop_threads_mutex);
+
+	if ((io != NULL) && (m_loop_thread_sockets != NULL)) {
+		loop_thread = g_hash_table_lookup(m_loop_thread_sockets, GINT_TO_POINTER(g_io_channel_unix_get_fd(io)));
 	}
+	if (loop_thread == NULL) {
+		loop_thread = g_private_get(&m_current_loop_thread);
+	}
+	if ((loop_thread == NULL) && (m_loop_threads != NULL)) {
+		// Fallback for sources without socket created outside of a loop thread
+		loop_thread = m_loop_threads->data;
+	}
+	if (loop_thread != NULL) {
+		context = g_main_context_ref(loop_thread->loop_context);
+	}
+
+	g_mutex_unlock(&m_loop_threads_mutex);
+
+	return context;
+}
+
+GMainContext* gattlib_connection_loop_context(gattlib_connection_t* connection) {
+	gattlib_context_t* conn_context = connection->context;
+
+	return conn_context->loop_thread->loop_context;
+}
+
+static GSource* loop_thread_timeout_add_seconds(GMainContext* context, guint interval, GSourceFunc function, gpointer data) {
+	GSource *source = g_timeout_source_new_seconds(interval);
+	assert(source != NULL);
+
+	g_source_set_callback(source, function, data, NULL);
+
+	// Attaches it to the main loop context
+	guint id = g_source_attach(source, context);
+	g_source_unref (source);
+	assert(id != 0);
+
+	return source;
+}
+
+static gattlib_connection_t *initialize_gattlib_connection(const gchar *src, const gchar *dst,
+		uint8_t dest_type, BtIOSecLevel sec_level, int psm, int mtu,
+		gatt_connect_cb_t connect_cb,
+		io_connect_arg_t* io_connect_arg)
+{
+	bdaddr_t sba, dba;
+	GError *err = NULL;
+	int ret;
+
+	io_connect_arg->error = NULL;
 
 	/* Remote device */
 	if (dst == NULL) {
@@ -258,12 +740,32 @@ static gattlib_connection_t *initialize_gattlib_connection(const gchar *src, con
 
 	conn->context = conn_context;
 
+	/* Events of the connection are dispatched by the loop thread of its adapter */
+	conn_context->loop_thread = gattlib_loop_thread_get(src);
+	if (conn_context->loop_thread == NULL) {
+		free(conn_context);
+		free(conn);
+		return NULL;
+	}
+
+	g_mutex_init(&conn_context->characteristics_mutex);
+
 	/* Intialize bt_io_connect argument */
-	io_connect_arg->conn       = conn;
-	io_connect_arg->connect_cb = connect_cb;
-	io_connect_arg->connected  = FALSE;
-	io_connect_arg->timeout    = FALSE;
-	io_connect_arg->error      = NULL;
+	io_connect_arg->conn        = conn;
+	io_connect_arg->connect_cb  = connect_cb;
+	io_connect_arg->connected   = FALSE;
+	io_connect_arg->timeout     = FALSE;
+	io_connect_arg->error       = NULL;
+	io_connect_arg->setup_error = GATTLIB_SUCCESS;
+	if ((mtu <= 0) || (mtu > GATTLIB_LEGACY_MAX_MTU)) {
+		io_connect_arg->mtu    = GATTLIB_LEGACY_MAX_MTU;
+	} else {
+		io_connect_arg->mtu    = mtu;
+	}
+
+	// The sources created while connecting belong to the loop thread of the connection
+	struct gattlib_thread_t* previous_loop_thread = g_private_get(&m_current_loop_thread);
+	g_private_set(&m_current_loop_thread, conn_context->loop_thread);
 
 	if (psm == 0) {
 		conn_context->io = bt_io_connect(
@@ -293,23 +795,45 @@ static gattlib_connection_t *initialize_gattlib_connection(const gchar *src, con
 #endif
 				BT_IO_OPT_DEST_BDADDR, &dba,
 				BT_IO_OPT_PSM, psm,
-				BT_IO_OPT_IMTU, mtu,
+				BT_IO_OPT_IMTU, io_connect_arg->mtu,
 				BT_IO_OPT_SEC_LEVEL, sec_level,
 				BT_IO_OPT_TIMEOUT, CONNECTION_TIMEOUT,
 				BT_IO_OPT_INVALID);
 	}
 
+	g_private_set(&m_current_loop_thread, previous_loop_thread);
+
 	if (err) {
 		fprintf(stderr, "%s\n", err->message);
 		g_error_free(err);
+		gattlib_loop_thread_put(conn_context->loop_thread);
+		g_mutex_clear(&conn_context->characteristics_mutex);
 		free(conn_context);
 		free(conn);
 		return NULL;
 	} else {
+		gattlib_loop_thread_add_socket(conn_context->loop_thread, conn_context->io);
 		return conn;
 	}
 }
 
+/**
+ * @brief Get the identifier ('hciN') of the adapter opened by gattlib_adapter_open()
+ */
+static int get_adapter_id(gattlib_adapter_t* adapter, char* adapter_id, size_t adapter_id_len) {
+	struct sockaddr_hci addr;
+	socklen_t addr_len = sizeof(addr);
+
+	memset(&addr, 0, sizeof(addr));
+	if (getsockname(adapter->device_desc, (struct sockaddr*)&addr, &addr_len) < 0) {
+		fprintf(stderr, "Cannot get the adapter of the HCI socket: %s\n", strerror(errno));
+		return GATTLIB_DEVICE_ERROR;
+	}
+
+	snprintf(adapter_id, adapter_id_len, "hci%u", addr.hci_dev);
+	return GATTLIB_SUCCESS;
+}
+
 static void get_connection_options(unsigned long options, BtIOSecLevel *bt_io_sec_level, int *psm, int *mtu) {
 	if (options & GATTLIB_CONNECTION_OPTIONS_LEGACY_BT_SEC_LOW) {
 		*bt_io_sec_level = BT_IO_SEC_LOW;
@@ -331,14 +855,16 @@ int gattlib_connect(gattlib_adapter_t* adapter, const char *dst,
 		void* user_data)
 {
 	const char *adapter_mac_address;
+	char adapter_id[16];
 	gattlib_connection_t *conn;
 	BtIOSecLevel bt_io_sec_level;
 	int psm, mtu;
 
 	if (adapter != NULL) {
-		fprintf(stderr, "Missing support");
-		assert(0); // Need to add support
-		return NULL;
+		if (get_adapter_id(adapter, adapter_id, sizeof(adapter_id)) != GATTLIB_SUCCESS) {
+			return NULL;
+		}
+		adapter_mac_address = adapter_id;
 	} else {
 		adapter_mac_address = NULL;
 	}
@@ -413,20 +939,29 @@ static gattlib_connection_t *gattlib_connect_with_options(const char *src, const
 	}
 
 	// Timeout of 'CONNECTION_TIMEOUT+4' seconds
-	timeout = gattlib_timeout_add_seconds(CONNECTION_TIMEOUT + 4, connection_timeout, &io_connect_arg);
+	timeout = loop_thread_timeout_add_seconds(gattlib_connection_loop_context(conn), CONNECTION_TIMEOUT + 4,
+			connection_timeout, &io_connect_arg);
 
 	// Wait for the connection to be done
-	while ((io_connect_arg.connected == FALSE) && (io_connect_arg.timeout == FALSE)) {
-		g_main_context_iteration(g_gattlib_thread.loop_context, FALSE);
+	while ((io_connect_arg.connected == FALSE) && (io_connect_arg.timeout == FALSE) &&
+	       (io_connect_arg.setup_error == GATTLIB_SUCCESS)) {
+		g_main_context_iteration(gattlib_connection_loop_context(conn), FALSE);
 	}
 
-	// Disconnect the timeout source if connection success
-	if (io_connect_arg.connected) g_source_destroy(timeout);
+	// Disconnect the timeout source if it has not fired. It refers to 'io_connect_arg' on the stack.
+	if (!io_connect_arg.timeout) g_source_destroy(timeout);
 
 	if (io_connect_arg.timeout) {
 		return NULL;
 	}
 
+	if (io_connect_arg.setup_error != GATTLIB_SUCCESS) {
+		fprintf(stderr, "gattlib_connect - connection setup error:%d\n", io_connect_arg.setup_error);
+		// The link has already been closed
+		_gattlib_connection_free(conn);
+		return NULL;
+	}
+
 	if (io_connect_arg.error) {
 		fprintf(stderr, "gattlib_connect - connection error:%s\n", io_connect_arg.error->message);
 		g_error_free(io_connect_arg.error);
@@ -447,14 +982,16 @@ static gattlib_connection_t *gattlib_connect_with_options(const char *src, const
 gattlib_connection_t *gattlib_connect(gattlib_adapter_t* adapter, const char *dst, unsigned long options)
 {
 	const char* adapter_mac_address;
+	char adapter_id[16];
 	gattlib_connection_t *conn;
 	BtIOSecLevel bt_io_sec_level;
 	int psm, mtu;
 
 	if (adapter != NULL) {
-		fprintf(stderr, "Missing support");
-		assert(0); // Need to add support
-		return NULL;
+		if (get_adapter_id(adapter, adapter_id, sizeof(adapter_id)) != GATTLIB_SUCCESS) {
+			return NULL;
+		}
+		adapter_mac_address = adapter_id;
 	} else {
 		adapter_mac_address = NULL;
 	}
@@ -483,9 +1020,11 @@ gattlib_connection_t *gattlib_connect(gattlib_adapter_t* adapter, const char *ds
 	return conn;
 }
 
-int gattlib_disconnect(gattlib_connection_t* connection, bool wait_disconnection) {
+static void _gattlib_disconnect_link(gattlib_connection_t* connection) {
 	gattlib_context_t* conn_context = connection->context;
 
+	gattlib_loop_thread_remove_socket(conn_context->io);
+
 #if BLUEZ_VERSION_MAJOR == 4
 	// Stop the I/O Channel
 	GIOStatus status = g_io_channel_shutdown(conn_context->io, FALSE, NULL);
@@ -493,25 +1032,48 @@ int gattlib_disconnect(gattlib_connection_t* connection, bool wait_disconnection
 	g_io_channel_unref(conn_context->io);
 #endif
 
+#if BLUEZ_VERSION_MAJOR == 5
+	if (conn_context->client != NULL) {
+		bt_gatt_client_unref(conn_context->client);
+	}
+	if (conn_context->db != NULL) {
+		gatt_db_unref(conn_context->db);
+	}
+#endif
+
 	g_attrib_unref(conn_context->attrib);
+}
+
+static void _gattlib_connection_free(gattlib_connection_t* connection) {
+	gattlib_context_t* conn_context = connection->context;
+	struct gattlib_thread_t* loop_thread = conn_context->loop_thread;
 
 	free(conn_context->characteristics);
+	g_mutex_clear(&conn_context->characteristics_mutex);
 	free(connection->context);
 	free(connection);
 
-	//TODO: Add a mutex around this code to avoid a race condition
-	/* Decrease the reference counter of the loop */
-	g_gattlib_thread.ref--;
-	/* Check if we are the last one */
-	if (g_gattlib_thread.ref == 0) {
-		g_main_loop_quit(g_gattlib_thread.loop);
-		g_main_loop_unref(g_gattlib_thread.loop);
-		g_main_context_unref(g_gattlib_thread.loop_context);
+	/* Release the loop thread. It is stopped with its last connection */
+	gattlib_loop_thread_put(loop_thread);
+}
+
+int gattlib_disconnect(gattlib_connection_t* connection, bool wait_disconnection) {
+	_gattlib_disconnect_link(connection);
+	_gattlib_connection_free(connection);
+	return GATTLIB_SUCCESS;
+}
 
-		// Detach the thread
-		pthread_detach(g_gattlib_thread.thread);
+int gattlib_disconnect_async(gattlib_connection_t* connection, gattlib_disconnect_cb_t disconnect_cb, void* user_data) {
+	if (connection == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
 	}
 
+	// The disconnection of the legacy backend is synchronous. The connection is freed once the callback has returned.
+	_gattlib_disconnect_link(connection);
+	if (disconnect_cb != NULL) {
+		disconnect_cb(connection, GATTLIB_SUCCESS, user_data);
+	}
+	_gattlib_connection_free(connection);
 	return GATTLIB_SUCCESS;
 }
 
@@ -524,8 +1086,11 @@ GSource* gattlib_watch_connection_full(GIOChannel* io, GIOCondition condition,
 
 	g_source_set_callback (source, (GSourceFunc)func, user_data, notify);
 
-	// Attaches it to the main loop context
-	guint id = g_source_attach(source, g_gattlib_thread.loop_context);
+	// Attaches it to the main loop context of the loop thread serving the socket
+	GMainContext* context = gattlib_loop_context_ref(io);
+	assert(context != NULL);
+	guint id = g_source_attach(source, context);
+	g_main_context_unref(context);
 	g_source_unref (source);
 	assert(id != 0);
 
@@ -533,43 +1098,66 @@ GSource* gattlib_watch_connection_full(GIOChannel* io, GIOCondition condition,
 }
 
 GSource* gattlib_timeout_add_seconds(guint interval, GSourceFunc function, gpointer data) {
-	GSource *source = g_timeout_source_new_seconds(interval);
-	assert(source != NULL);
-
-	g_source_set_callback(source, function, data, NULL);
+	GSource *source;
 
-	// Attaches it to the main loop context
-	guint id = g_source_attach(source, g_gattlib_thread.loop_context);
-	g_source_unref (source);
-	assert(id != 0);
+	// Attaches it to the main loop context of the current loop thread
+	GMainContext* context = gattlib_loop_context_ref(NULL);
+	assert(context != NULL);
+	source = loop_thread_timeout_add_seconds(context, interval, function, data);
+	g_main_context_unref(context);
 
 	return source;
 }
 
 int get_uuid_from_handle(gattlib_connection_t* connection, uint16_t handle, uuid_t* uuid) {
 	gattlib_context_t* conn_context = connection->context;
+	int ret = GATTLIB_NOT_FOUND;
 	int i;
 
+	g_mutex_lock(&conn_context->characteristics_mutex);
 	for (i = 0; i < conn_context->characteristic_count; i++) {
 		if (conn_context->characteristics[i].value_handle == handle) {
 			memcpy(uuid, &conn_context->characteristics[i].uuid, sizeof(uuid_t));
-			return GATTLIB_SUCCESS;
+			ret = GATTLIB_SUCCESS;
+			break;
 		}
 	}
-	return GATTLIB_NOT_FOUND;
+	g_mutex_unlock(&conn_context->characteristics_mutex);
+	return ret;
 }
 
 int get_handle_from_uuid(gattlib_connection_t* connection, const uuid_t* uuid, uint16_t* handle) {
 	gattlib_context_t* conn_context = connection->context;
+	int ret = GATTLIB_NOT_FOUND;
 	int i;
 
+	g_mutex_lock(&conn_context->characteristics_mutex);
 	for (i = 0; i < conn_context->characteristic_count; i++) {
 		if (gattlib_uuid_cmp(&conn_context->characteristics[i].uuid, uuid) == 0) {
 			*handle = conn_context->characteristics[i].value_handle;
-			return GATTLIB_SUCCESS;
+			ret = GATTLIB_SUCCESS;
+			break;
 		}
 	}
-	return GATTLIB_NOT_FOUND;
+	g_mutex_unlock(&conn_context->characteristics_mutex);
+	return ret;
+}
+
+int gattlib_get_mtu(gattlib_connection_t* connection, uint16_t* mtu)
+{
+	gattlib_context_t* conn_context;
+
+	if ((connection == NULL) || (mtu == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	conn_context = connection->context;
+	if ((conn_context == NULL) || (conn_context->attrib == NULL)) {
+		return GATTLIB_DEVICE_DISCONNECTED;
+	}
+
+	*mtu = conn_context->mtu;
+	return GATTLIB_SUCCESS;
 }
 
 #if 0 // Disable until https://github.com/labapart/gattlib/issues/75 is resolved
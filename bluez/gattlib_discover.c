@@ -32,17 +32,224 @@
 #include "gattrib.h"
 #include "gatt.h"
 
+#if BLUEZ_VERSION_MAJOR == 5
+#include "src/shared/gatt-db.h"
+
+//
+// With BlueZ v5, the attributes are read from the database of the GATT client engine. The database
+// is filled when the connection is established and kept up to date on 'Service Changed'. The
+// discovery does not need any ATT request.
+//
+
+struct gattlib_db_services {
+	gattlib_primary_service_t* services;
+	int services_count;
+	int services_max;
+};
+
+static void db_primary_service_cb(struct gatt_db_attribute *attrib, void *user_data) {
+	struct gattlib_db_services* data = user_data;
+	uint16_t start_handle, end_handle;
+	bool primary;
+	bt_uuid_t bt_uuid;
+
+	if (!gatt_db_attribute_get_service_data(attrib, &start_handle, &end_handle, &primary, &bt_uuid)) {
+		return;
+	}
+	if (!primary) {
+		return;
+	}
+
+	if (data->services != NULL) {
+		// Sanity check to avoid buffer overflow
+		if (data->services_count >= data->services_max) {
+			return;
+		}
+
+		data->services[data->services_count].attr_handle_start = start_handle;
+		data->services[data->services_count].attr_handle_end   = end_handle;
+		bt_uuid_to_uuid(&bt_uuid, &data->services[data->services_count].uuid);
+	}
+	data->services_count++;
+}
+
+int gattlib_discover_primary(gattlib_connection_t* connection, gattlib_primary_service_t** services, int* services_count) {
+	gattlib_context_t* conn_context = connection->context;
+	struct gattlib_db_services data;
+
+	if (conn_context->db == NULL) {
+		return GATTLIB_DEVICE_NOT_CONNECTED;
+	}
+
+	// First pass to count the services, second pass to fill the array
+	bzero(&data, sizeof(data));
+	gatt_db_foreach_service(conn_context->db, NULL, db_primary_service_cb, &data);
+
+	data.services_max = data.services_count;
+	data.services_count = 0;
+	data.services = calloc(data.services_max > 0 ? data.services_max : 1, sizeof(gattlib_primary_service_t));
+	if (data.services == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	gatt_db_foreach_service(conn_context->db, NULL, db_primary_service_cb, &data);
+
+	if (services != NULL) {
+		*services = data.services;
+	} else {
+		free(data.services);
+	}
+	if (services_count != NULL) {
+		*services_count = data.services_count;
+	}
+
+	return GATTLIB_SUCCESS;
+}
+
+struct gattlib_db_characteristics {
+	uint16_t start;
+	uint16_t end;
+	gattlib_characteristic_t* characteristics;
+	int characteristics_count;
+	int characteristics_max;
+};
+
+static void db_characteristic_cb(struct gatt_db_attribute *attrib, void *user_data) {
+	struct gattlib_db_characteristics* data = user_data;
+	uint16_t handle, value_handle, ext_prop;
+	uint8_t properties;
+	bt_uuid_t bt_uuid;
+
+	if (!gatt_db_attribute_get_char_data(attrib, &handle, &value_handle, &properties, &ext_prop, &bt_uuid)) {
+		return;
+	}
+	if ((handle < data->start) || (handle > data->end)) {
+		return;
+	}
+
+	if (data->characteristics != NULL) {
+		// Sanity check to avoid buffer overflow
+		if (data->characteristics_count >= data->characteristics_max) {
+			return;
+		}
+
+		data->characteristics[data->characteristics_count].handle       = handle;
+		data->characteristics[data->characteristics_count].properties   = properties;
+		data->characteristics[data->characteristics_count].value_handle = value_handle;
+		bt_uuid_to_uuid(&bt_uuid, &data->characteristics[data->characteristics_count].uuid);
+	}
+	data->characteristics_count++;
+}
+
+static void db_service_characteristics_cb(struct gatt_db_attribute *attrib, void *user_data) {
+	gatt_db_service_foreach_char(attrib, db_characteristic_cb, user_data);
+}
+
+int gattlib_discover_char_range(gattlib_connection_t* connection, uint16_t start, uint16_t end, gattlib_characteristic_t** characteristics, int* characteristics_count) {
+	gattlib_context_t* conn_context = connection->context;
+	struct gattlib_db_characteristics data;
+
+	if (conn_context->db == NULL) {
+		return GATTLIB_DEVICE_NOT_CONNECTED;
+	}
+
+	bzero(&data, sizeof(data));
+	data.start = start;
+	data.end   = end;
+
+	// First pass to count the characteristics, second pass to fill the array
+	gatt_db_foreach_service(conn_context->db, NULL, db_service_characteristics_cb, &data);
+
+	data.characteristics_max = data.characteristics_count;
+	data.characteristics_count = 0;
+	data.characteristics = calloc(data.characteristics_max > 0 ? data.characteristics_max : 1, sizeof(gattlib_characteristic_t));
+	if (data.characteristics == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	gatt_db_foreach_service(conn_context->db, NULL, db_service_characteristics_cb, &data);
+
+	*characteristics       = data.characteristics;
+	*characteristics_count = data.characteristics_count;
+
+	return GATTLIB_SUCCESS;
+}
+
+struct gattlib_db_descriptors {
+	uint16_t start;
+	uint16_t end;
+	gattlib_descriptor_t* descriptors;
+	int descriptors_count;
+	int descriptors_max;
+};
+
+static void db_descriptor_cb(struct gatt_db_attribute *attrib, void *user_data) {
+	struct gattlib_db_descriptors* data = user_data;
+	uint16_t handle = gatt_db_attribute_get_handle(attrib);
+	bt_uuid_t bt_uuid;
+
+	if ((handle < data->start) || (handle > data->end)) {
+		return;
+	}
+
+	if (data->descriptors != NULL) {
+		// Sanity check to avoid buffer overflow
+		if (data->descriptors_count >= data->descriptors_max) {
+			return;
+		}
+
+		memcpy(&bt_uuid, gatt_db_attribute_get_type(attrib), sizeof(bt_uuid));
+
+		data->descriptors[data->descriptors_count].handle = handle;
+		data->descriptors[data->descriptors_count].uuid16 = (bt_uuid.type == BT_UUID16) ? bt_uuid.value.u16 : 0;
+		bt_uuid_to_uuid(&bt_uuid, &data->descriptors[data->descriptors_count].uuid);
+	}
+	data->descriptors_count++;
+}
+
+// gatt_db_service_foreach_desc() expects the declaration of a characteristic, not of a service
+static void db_characteristic_descriptors_cb(struct gatt_db_attribute *attrib, void *user_data) {
+	gatt_db_service_foreach_desc(attrib, db_descriptor_cb, user_data);
+}
+
+static void db_service_descriptors_cb(struct gatt_db_attribute *attrib, void *user_data) {
+	gatt_db_service_foreach_char(attrib, db_characteristic_descriptors_cb, user_data);
+}
+
+int gattlib_discover_desc_range(gattlib_connection_t* connection, int start, int end, gattlib_descriptor_t** descriptors, int* descriptor_count) {
+	gattlib_context_t* conn_context = connection->context;
+	struct gattlib_db_descriptors data;
+
+	if (conn_context->db == NULL) {
+		return GATTLIB_DEVICE_NOT_CONNECTED;
+	}
+
+	bzero(&data, sizeof(data));
+	data.start = start;
+	data.end   = end;
+
+	// First pass to count the descriptors, second pass to fill the array
+	gatt_db_foreach_service(conn_context->db, NULL, db_service_descriptors_cb, &data);
+
+	data.descriptors_max = data.descriptors_count;
+	data.descriptors_count = 0;
+	data.descriptors = calloc(data.descriptors_max > 0 ? data.descriptors_max : 1, sizeof(gattlib_descriptor_t));
+	if (data.descriptors == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	gatt_db_foreach_service(conn_context->db, NULL, db_service_descriptors_cb, &data);
+
+	*descriptors      = data.descriptors;
+	*descriptor_count = data.descriptors_count;
+
+	return GATTLIB_SUCCESS;
+}
+#else
 struct primary_all_cb_t {
 	gattlib_primary_service_t* services;
 	int services_count;
 	int discovered;
 };
 
-#if BLUEZ_VERSION_MAJOR == 4
 static void primary_all_cb(GSList *services, guint8 status, gpointer user_data) {
-#else
-static void primary_all_cb(uint8_t status, GSList *services, void *user_data) {
-#endif
 	struct primary_all_cb_t* data = user_data;
 	GSList *l;
 	int i;
@@ -90,7 +297,7 @@ int gattlib_discover_primary(gattlib_connection_t* connection, gattlib_primary_s
 
 	// Wait for completion
 	while(user_data.discovered == FALSE) {
-		g_main_context_iteration(g_gattlib_thread.loop_context, FALSE);
+		g_main_context_iteration(gattlib_connection_loop_context(connection), FALSE);
 	}
 
 	if (services != NULL) {
@@ -109,11 +316,7 @@ struct characteristic_cb_t {
 	int discovered;
 };
 
-#if BLUEZ_VERSION_MAJOR == 4
 static void characteristic_cb(GSList *characteristics, guint8 status, gpointer user_data) {
-#else
-static void characteristic_cb(uint8_t status, GSList *characteristics, void *user_data) {
-#endif
 	struct characteristic_cb_t* data = user_data;
 	GSList *l;
 	int i;
@@ -162,7 +365,7 @@ int gattlib_discover_char_range(gattlib_connection_t* connection, uint16_t start
 
 	// Wait for completion
 	while(user_data.discovered == FALSE) {
-		g_main_context_iteration(g_gattlib_thread.loop_context, FALSE);
+		g_main_context_iteration(gattlib_connection_loop_context(connection), FALSE);
 	}
 	*characteristics       = user_data.characteristics;
 	*characteristics_count = user_data.characteristics_count;
@@ -170,17 +373,12 @@ int gattlib_discover_char_range(gattlib_connection_t* connection, uint16_t start
 	return GATTLIB_SUCCESS;
 }
 
-int gattlib_discover_char(gattlib_connection_t* connection, gattlib_characteristic_t** characteristics, int* characteristics_count) {
-	return gattlib_discover_char_range(connection, 0x0001, 0xffff, characteristics, characteristics_count);
-}
-
 struct descriptor_cb_t {
 	gattlib_descriptor_t* descriptors;
 	int descriptors_count;
 	int discovered;
 };
 
-#if BLUEZ_VERSION_MAJOR == 4
 static void char_desc_cb(guint8 status, const guint8 *pdu, guint16 plen, gpointer user_data)
 {
 	struct descriptor_cb_t* data = user_data;
@@ -229,40 +427,6 @@ static void char_desc_cb(guint8 status, const guint8 *pdu, guint16 plen, gpointe
 done:
 	data->discovered = TRUE;
 }
-#else
-static void char_desc_cb(uint8_t status, GSList *descriptors, void *user_data)
-{
-	struct descriptor_cb_t* data = user_data;
-	GSList *l;
-	int i;
-
-	if (status) {
-		fprintf(stderr, "Discover all descriptors failed: %s\n", att_ecode2str(status));
-		goto done;
-	}
-
-	// Allocate array
-	data->descriptors_count = g_slist_length(descriptors);
-	data->descriptors = malloc(data->descriptors_count * sizeof(gattlib_descriptor_t));
-	if (data->descriptors == NULL) {
-		fprintf(stderr, "Discover all descriptors failed: OutOfMemory\n");
-		goto done;
-	}
-
-	for (i = 0, l = descriptors; l; l = l->next, i++) {
-		struct gatt_desc *desc = l->data;
-
-		data->descriptors[i].handle = desc->handle;
-		data->descriptors[i].uuid16 = desc->uuid16;
-		gattlib_string_to_uuid(desc->uuid, MAX_LEN_UUID_STR + 1, &data->descriptors[i].uuid);
-
-		assert(i < data->descriptors_count);
-	}
-
-done:
-	data->discovered = TRUE;
-}
-#endif
 
 int gattlib_discover_desc_range(gattlib_connection_t* connection, int start, int end, gattlib_descriptor_t** descriptors, int* descriptor_count) {
 	gattlib_context_t* conn_context = connection->context;
@@ -271,11 +435,7 @@ int gattlib_discover_desc_range(gattlib_connection_t* connection, int start, int
 
 	bzero(&descriptor_data, sizeof(descriptor_data));
 
-#if BLUEZ_VERSION_MAJOR == 4
 	ret = gatt_find_info(conn_context->attrib, start, end, char_desc_cb, &descriptor_data);
-#else
-	ret = gatt_discover_desc(conn_context->attrib, start, end, NULL, char_desc_cb, &descriptor_data);
-#endif
 	if (ret == 0) {
 		fprintf(stderr, "Fail to discover descriptors.\n");
 		return GATTLIB_ERROR_BLUEZ_WITH_ERROR(ret);
@@ -283,7 +443,7 @@ int gattlib_discover_desc_range(gattlib_connection_t* connection, int start, int
 
 	// Wait for completion
 	while(descriptor_data.discovered == FALSE) {
-		g_main_context_iteration(g_gattlib_thread.loop_context, FALSE);
+		g_main_context_iteration(gattlib_connection_loop_context(connection), FALSE);
 	}
 
 	*descriptors      = descriptor_data.descriptors;
@@ -291,6 +451,11 @@ int gattlib_discover_desc_range(gattlib_connection_t* connection, int start, int
 
 	return GATTLIB_SUCCESS;
 }
+#endif
+
+int gattlib_discover_char(gattlib_connection_t* connection, gattlib_characteristic_t** characteristics, int* characteristics_count) {
+	return gattlib_discover_char_range(connection, 0x0001, 0xffff, characteristics, characteristics_count);
+}
 
 int gattlib_discover_desc(gattlib_connection_t* connection, gattlib_descriptor_t** descriptors, int* descriptor_count) {
 	return gattlib_discover_desc_range(connection, 0x0001, 0xffff, descriptors, descriptor_count);
@@ -39,25 +39,87 @@
   #include "src/shared/util.h"
 #endif
 
+// Largest number of Write Commands queued on a connection and not written to its socket yet
+#define GATTLIB_WRITE_CMD_MAX_CREDITS    32
+
 typedef struct _GAttrib GAttrib;
 
+#if BLUEZ_VERSION_MAJOR == 5
+struct gatt_db;
+struct bt_gatt_client;
+#endif
+
+/**
+ * Adapter opened by gattlib_adapter_open()
+ */
+struct _gattlib_adapter {
+	// HCI socket of the adapter
+	int device_desc;
+
+	// Protect 'advertising_filter', the address lists and the scan throttling that can be changed while scanning
+	GMutex mutex;
+	// Advertisements not matching the filter are dropped by the scanner. NULL if none.
+	gattlib_advertising_filter_t* advertising_filter;
+	// Advertisements of the addresses not in the allowlist or in the denylist are dropped by the scanner. NULL if none.
+	gattlib_address_set_t* address_allowlist;
+	gattlib_address_set_t* address_denylist;
+	// Throttling of the devices reported again by a scan. Only used when 'has_scan_throttle' is set.
+	bool has_scan_throttle;
+	gattlib_scan_throttle_t scan_throttle;
+};
+
+/**
+ * Loop thread dispatching the events of the connections of an adapter
+ */
 struct gattlib_thread_t {
+	// Number of connections using the loop thread
 	int           ref;
 	pthread_t     thread;
 	GMainContext* loop_context;
 	GMainLoop*    loop;
+	// Adapter served by the loop thread. NULL for the default adapter.
+	char*         adapter_id;
+
+	// 'condition' is signalled once the loop runs
+	GMutex        mutex;
+	GCond         condition;
+	bool          is_running;
+	// The loop thread frees itself when its loop returns
+	bool          is_detached;
 };
 
 typedef struct {
 	GIOChannel*               io;
 	GAttrib*                  attrib;
+	// Loop thread dispatching the events of the connection
+	struct gattlib_thread_t*  loop_thread;
+	// ATT MTU of the connection
+	uint16_t                  mtu;
+	// Number of Write Commands that can still be queued (see GATTLIB_WRITE_CMD_MAX_CREDITS).
+	// A credit is returned once its Write Command is written to the socket.
+	gint                      write_cmd_credits;
+
+#if BLUEZ_VERSION_MAJOR == 5
+	// GATT client engine sharing the ATT transport of 'attrib'. Its database caches the
+	// attributes of the remote device and is kept up to date on 'Service Changed'.
+	// It is only used for the MTU exchange, the discovery, the reads, the writes with response
+	// and the confirmation of the indications. The notifications, the batched CCCD writes, the chunked
+	// long reads and writes, the Write Commands and the write transactions still go through 'attrib'.
+	struct gatt_db*           db;
+	struct bt_gatt_client*    client;
+#endif
 
 	// We keep a list of characteristics to make the correspondence handle/UUID.
+	// They are replaced from the loop thread on 'Service Changed'. Protected by 'characteristics_mutex'.
+	GMutex                    characteristics_mutex;
 	gattlib_characteristic_t* characteristics;
 	int                       characteristic_count;
 } gattlib_context_t;
 
-extern struct gattlib_thread_t g_gattlib_thread;
+/**
+ * Return the main loop context of the loop thread of the connection
+ */
+GMainContext* gattlib_connection_loop_context(gattlib_connection_t* connection);
 
 /**
  * Watch the GATT connection for conditions
@@ -70,6 +132,16 @@ void uuid_to_bt_uuid(uuid_t* uuid, bt_uuid_t* bt_uuid);
 void bt_uuid_to_uuid(bt_uuid_t* bt_uuid, uuid_t* uuid);
 
 int get_uuid_from_handle(gattlib_connection_t* connection, uint16_t handle, uuid_t* uuid);
+
+/**
+ * Dispatch a notification or an indication received from the loop thread to the handler of the connection
+ *
+ * @param timestamp_ns Reception time of the event in the CLOCK_MONOTONIC time base
+ */
+void gattlib_on_gatt_notification(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns);
+void gattlib_on_gatt_indication(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns);
 int get_handle_from_uuid(gattlib_connection_t* connection, const uuid_t* uuid, uint16_t* handle);
 
 #endif
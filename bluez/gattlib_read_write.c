@@ -24,147 +24,303 @@
 #include <stdlib.h>
 
 #include "gattlib_internal.h"
+#include "gattlib_write_transaction.h"
 
 #include "uuid.h"
 #include "att.h"
 #include "gattrib.h"
 #include "gatt.h"
 
-struct gattlib_result_read_uuid_t {
+#if BLUEZ_VERSION_MAJOR == 5
+#include "src/shared/gatt-client.h"
+#include "src/shared/gatt-db.h"
+#endif
+
+void uuid_to_bt_uuid(uuid_t* uuid, bt_uuid_t* bt_uuid) {
+	memcpy(&bt_uuid->value, &uuid->value, sizeof(bt_uuid->value));
+	if (uuid->type == SDP_UUID16) {
+		bt_uuid->type = BT_UUID16;
+	} else if (uuid->type == SDP_UUID32) {
+		bt_uuid->type = BT_UUID32;
+	} else if (uuid->type == SDP_UUID128) {
+		bt_uuid->type = BT_UUID128;
+	} else {
+		bt_uuid->type = BT_UUID_UNSPEC;
+	}
+}
+
+#if BLUEZ_VERSION_MAJOR == 5
+struct gattlib_gatt_client_read {
 	void**         buffer;
 	size_t*        buffer_len;
 	gatt_read_cb_t callback;
 	int            completed;
+	int            ret;
 };
 
-static void gattlib_result_read_uuid_cb(guint8 status, const guint8 *pdu, guint16 len, gpointer user_data) {
-	struct gattlib_result_read_uuid_t* gattlib_result = user_data;
-	struct att_data_list *list;
-	int i;
+static void gatt_client_read_cb(bool success, uint8_t att_ecode, const uint8_t *value, uint16_t length, void *user_data) {
+	struct gattlib_gatt_client_read* gattlib_result = user_data;
 
-	if (status == ATT_ECODE_ATTR_NOT_FOUND) {
+	if (!success) {
+		fprintf(stderr, "Read characteristic failed: %s\n", att_ecode2str(att_ecode));
+		gattlib_result->ret = GATTLIB_ERROR_BLUEZ_WITH_ERROR(att_ecode);
 		goto done;
 	}
 
-	if (status != 0) {
-		fprintf(stderr, "Read characteristics by UUID failed: %s\n", att_ecode2str(status));
-		goto done;
+	if (gattlib_result->callback) {
+		gattlib_result->callback(value, length);
+	} else {
+		void* buffer = malloc(length > 0 ? length : 1);
+		if (buffer == NULL) {
+			gattlib_result->ret = GATTLIB_OUT_OF_MEMORY;
+			goto done;
+		}
+
+		// Copy value into the buffer
+		memcpy(buffer, value, length);
+
+		*gattlib_result->buffer_len = length;
+		*gattlib_result->buffer     = buffer;
 	}
 
-	list = dec_read_by_type_resp(pdu, len);
-	if (list == NULL) {
-		goto done;
+done:
+	gattlib_result->completed = TRUE;
+}
+
+/**
+ * Read the value of a characteristic with the GATT client engine.
+ * The engine continues with 'Read Blob' requests when the value does not fit in a single PDU.
+ */
+static int gatt_client_read(gattlib_connection_t* connection, uint16_t handle, struct gattlib_gatt_client_read* gattlib_result) {
+	gattlib_context_t* conn_context = connection->context;
+	unsigned int id;
+
+	if (conn_context->client == NULL) {
+		return GATTLIB_DEVICE_NOT_CONNECTED;
 	}
 
-	for (i = 0; i < list->num; i++) {
-		uint8_t *value = list->data[i];
-		size_t buffer_len = list->len - 2;
+	// The result of asynchronous reads is freed once the read completes
+	id = bt_gatt_client_read_long_value(conn_context->client, handle, 0,
+			gatt_client_read_cb, gattlib_result,
+			(gattlib_result->callback != NULL) ? free : NULL);
+	if (id == 0) {
+		return GATTLIB_NOT_FOUND;
+	}
 
-		// Move the value to the beginning of the data
-		value += 2;
+	return GATTLIB_SUCCESS;
+}
 
-		if (gattlib_result->callback) {
-			gattlib_result->callback(value, buffer_len);
-		} else {
-			void* buffer = malloc(buffer_len);
-			if (buffer == NULL) {
-				goto done;
-			}
+int gattlib_read_char_by_handle(gattlib_connection_t* connection, uint16_t handle,
+				void **buffer, size_t* buffer_len)
+{
+	struct gattlib_gatt_client_read gattlib_result = {
+		.buffer     = buffer,
+		.buffer_len = buffer_len,
+		.callback   = NULL,
+		.completed  = FALSE,
+		.ret        = GATTLIB_SUCCESS
+	};
+	int ret;
 
-			// Copy value into the buffer
-			memcpy(buffer, value, buffer_len);
+	ret = gatt_client_read(connection, handle, &gattlib_result);
+	if (ret != GATTLIB_SUCCESS) {
+		return ret;
+	}
 
-			*gattlib_result->buffer_len = buffer_len;
-			*gattlib_result->buffer     = buffer;
-		}
+	// Wait for completion of the event
+	while(gattlib_result.completed == FALSE) {
+		g_main_context_iteration(gattlib_connection_loop_context(connection), FALSE);
 	}
 
-	att_data_list_free(list);
+	return gattlib_result.ret;
+}
 
-done:
-	if (gattlib_result->callback) {
+int gattlib_read_char_by_uuid_async(gattlib_connection_t* connection, uuid_t* uuid,
+				    gatt_read_cb_t gatt_read_cb)
+{
+	struct gattlib_gatt_client_read* gattlib_result;
+	uint16_t handle = 0;
+	int ret;
+
+	ret = get_handle_from_uuid(connection, uuid, &handle);
+	if (ret) {
+		fprintf(stderr, "Fail to find handle for UUID.\n");
+		return ret;
+	}
+
+	gattlib_result = calloc(sizeof(struct gattlib_gatt_client_read), 1);
+	if (gattlib_result == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	gattlib_result->callback = gatt_read_cb;
+
+	ret = gatt_client_read(connection, handle, gattlib_result);
+	if (ret != GATTLIB_SUCCESS) {
 		free(gattlib_result);
-	} else {
-		gattlib_result->completed = TRUE;
 	}
+	return ret;
 }
 
-void uuid_to_bt_uuid(uuid_t* uuid, bt_uuid_t* bt_uuid) {
-	memcpy(&bt_uuid->value, &uuid->value, sizeof(bt_uuid->value));
-	if (uuid->type == SDP_UUID16) {
-		bt_uuid->type = BT_UUID16;
-	} else if (uuid->type == SDP_UUID32) {
-		bt_uuid->type = BT_UUID32;
-	} else if (uuid->type == SDP_UUID128) {
-		bt_uuid->type = BT_UUID128;
-	} else {
-		bt_uuid->type = BT_UUID_UNSPEC;
+struct gattlib_gatt_client_write {
+	int completed;
+	int ret;
+};
+
+static void gatt_client_write_cb(bool success, uint8_t att_ecode, void *user_data) {
+	struct gattlib_gatt_client_write* write = user_data;
+
+	if (!success) {
+		fprintf(stderr, "Write characteristic failed: %s\n", att_ecode2str(att_ecode));
+		write->ret = GATTLIB_ERROR_BLUEZ_WITH_ERROR(att_ecode);
 	}
+	write->completed = TRUE;
 }
 
-int gattlib_read_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid,
-			      void **buffer, size_t* buffer_len)
-{
+static void gatt_client_write_long_cb(bool success, bool reliable_error, uint8_t att_ecode, void *user_data) {
+	gatt_client_write_cb(success, att_ecode, user_data);
+}
+
+int gattlib_write_char_by_handle(gattlib_connection_t* connection, uint16_t handle, const void* buffer, size_t buffer_len) {
 	gattlib_context_t* conn_context = connection->context;
-	struct gattlib_result_read_uuid_t* gattlib_result;
-	bt_uuid_t bt_uuid;
-	const int start = 0x0001;
-	const int end   = 0xffff;
+	struct gattlib_gatt_client_write write = {
+		.completed = FALSE,
+		.ret = GATTLIB_SUCCESS
+	};
+	unsigned int id;
+
+	if (conn_context->client == NULL) {
+		return GATTLIB_DEVICE_NOT_CONNECTED;
+	}
+	if (buffer_len > G_MAXUINT16) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
 
-	gattlib_result = malloc(sizeof(struct gattlib_result_read_uuid_t));
-	if (gattlib_result == NULL) {
-		return GATTLIB_OUT_OF_MEMORY;
+	// A value that does not fit in a 'Write Request' is sent with 'Prepare Write' and 'Execute Write'
+	if (buffer_len + 3 <= bt_gatt_client_get_mtu(conn_context->client)) {
+		id = bt_gatt_client_write_value(conn_context->client, handle, buffer, buffer_len,
+				gatt_client_write_cb, &write, NULL);
+	} else {
+		id = bt_gatt_client_write_long_value(conn_context->client, false, handle, 0, buffer, buffer_len,
+				gatt_client_write_long_cb, &write, NULL);
+	}
+	if (id == 0) {
+		return GATTLIB_ERROR_INTERNAL;
 	}
-	gattlib_result->buffer         = buffer;
-	gattlib_result->buffer_len     = buffer_len;
-	gattlib_result->callback       = NULL;
-	gattlib_result->completed      = FALSE;
 
-	uuid_to_bt_uuid(uuid, &bt_uuid);
+	// Wait for completion of the event
+	while(write.completed == FALSE) {
+		g_main_context_iteration(gattlib_connection_loop_context(connection), FALSE);
+	}
+	return write.ret;
+}
+#else
+struct gattlib_result_read_t {
+	void**         buffer;
+	size_t*        buffer_len;
+	gatt_read_cb_t callback;
+	int            completed;
+	int            ret;
+};
+
+static void gattlib_result_read_cb(guint8 status, const guint8 *pdu, guint16 len, gpointer user_data) {
+	struct gattlib_result_read_t* gattlib_result = user_data;
+	size_t buffer_len;
+
+	if (status != 0) {
+		fprintf(stderr, "Read characteristic failed: %s\n", att_ecode2str(status));
+		gattlib_result->ret = GATTLIB_ERROR_BLUEZ_WITH_ERROR(status);
+		goto done;
+	}
+
+	if ((len < 1) || (pdu[0] != ATT_OP_READ_RESP)) {
+		fprintf(stderr, "Read characteristic failed: Protocol error\n");
+		gattlib_result->ret = GATTLIB_UNEXPECTED;
+		goto done;
+	}
+
+	// The value follows the opcode
+	buffer_len = len - 1;
+
+	if (gattlib_result->callback) {
+		gattlib_result->callback(&pdu[1], buffer_len);
+	} else {
+		void* buffer = malloc(buffer_len > 0 ? buffer_len : 1);
+		if (buffer == NULL) {
+			gattlib_result->ret = GATTLIB_OUT_OF_MEMORY;
+			goto done;
+		}
+
+		// Copy value into the buffer
+		memcpy(buffer, &pdu[1], buffer_len);
+
+		*gattlib_result->buffer_len = buffer_len;
+		*gattlib_result->buffer     = buffer;
+	}
+
+done:
+	if (gattlib_result->callback) {
+		free(gattlib_result);
+	} else {
+		gattlib_result->completed = TRUE;
+	}
+}
 
-	gatt_read_char_by_uuid(conn_context->attrib, start, end, &bt_uuid,
-			       gattlib_result_read_uuid_cb, gattlib_result);
+int gattlib_read_char_by_handle(gattlib_connection_t* connection, uint16_t handle,
+				void **buffer, size_t* buffer_len)
+{
+	gattlib_context_t* conn_context = connection->context;
+	struct gattlib_result_read_t gattlib_result = {
+		.buffer     = buffer,
+		.buffer_len = buffer_len,
+		.callback   = NULL,
+		.completed  = FALSE,
+		.ret        = GATTLIB_SUCCESS
+	};
+	guint id;
+
+	id = gatt_read_char(conn_context->attrib, handle, 0, gattlib_result_read_cb, &gattlib_result);
+	if (id == 0) {
+		return GATTLIB_NOT_FOUND;
+	}
 
 	// Wait for completion of the event
-	while(gattlib_result->completed == FALSE) {
-		g_main_context_iteration(g_gattlib_thread.loop_context, FALSE);
+	while(gattlib_result.completed == FALSE) {
+		g_main_context_iteration(gattlib_connection_loop_context(connection), FALSE);
 	}
 
-	free(gattlib_result);
-	return GATTLIB_SUCCESS;
+	return gattlib_result.ret;
 }
 
 int gattlib_read_char_by_uuid_async(gattlib_connection_t* connection, uuid_t* uuid,
 				    gatt_read_cb_t gatt_read_cb)
 {
 	gattlib_context_t* conn_context = connection->context;
-	struct gattlib_result_read_uuid_t* gattlib_result;
-	const int start = 0x0001;
-	const int end   = 0xffff;
-	bt_uuid_t bt_uuid;
+	struct gattlib_result_read_t* gattlib_result;
+	uint16_t handle = 0;
+	int ret;
 
-	gattlib_result = malloc(sizeof(struct gattlib_result_read_uuid_t));
+	ret = get_handle_from_uuid(connection, uuid, &handle);
+	if (ret) {
+		fprintf(stderr, "Fail to find handle for UUID.\n");
+		return ret;
+	}
+
+	gattlib_result = calloc(sizeof(struct gattlib_result_read_t), 1);
 	if (gattlib_result == NULL) {
 		return GATTLIB_OUT_OF_MEMORY;
 	}
-	gattlib_result->buffer         = NULL;
-	gattlib_result->buffer_len     = 0;
-	gattlib_result->callback       = gatt_read_cb;
-	gattlib_result->completed      = FALSE;
-
-	uuid_to_bt_uuid(uuid, &bt_uuid);
-
-	guint id = gatt_read_char_by_uuid(conn_context->attrib, start, end, &bt_uuid,
-					  gattlib_result_read_uuid_cb, gattlib_result);
+	gattlib_result->callback = gatt_read_cb;
 
+	guint id = gatt_read_char(conn_context->attrib, handle, 0, gattlib_result_read_cb, gattlib_result);
 	if (id) {
 		return GATTLIB_SUCCESS;
 	} else {
+		free(gattlib_result);
 		return GATTLIB_NOT_FOUND;
 	}
 }
 
-void gattlib_write_result_cb(guint8 status, const guint8 *pdu, guint16 len, gpointer user_data) {
+static void gattlib_write_result_cb(guint8 status, const guint8 *pdu, guint16 len, gpointer user_data) {
 	int* write_completed = user_data;
 
 	*write_completed = TRUE;
@@ -182,10 +338,28 @@ int gattlib_write_char_by_handle(gattlib_connection_t* connection, uint16_t hand
 
 	// Wait for completion of the event
 	while(write_completed == FALSE) {
-		g_main_context_iteration(g_gattlib_thread.loop_context, FALSE);
+		g_main_context_iteration(gattlib_connection_loop_context(connection), FALSE);
 	}
 	return 0;
 }
+#endif
+
+int gattlib_read_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid,
+			      void **buffer, size_t* buffer_len)
+{
+	uint16_t handle = 0;
+	int ret;
+
+	// Read the value handle found at discovery time. A 'Read Request' on a single handle is cheaper
+	// than a 'Read By Type Request' that makes the remote device scan its whole attribute table.
+	ret = get_handle_from_uuid(connection, uuid, &handle);
+	if (ret) {
+		fprintf(stderr, "Fail to find handle for UUID.\n");
+		return ret;
+	}
+
+	return gattlib_read_char_by_handle(connection, handle, buffer, buffer_len);
+}
 
 int gattlib_write_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, const void* buffer, size_t buffer_len) {
 	uint16_t handle = 0;
@@ -200,40 +374,566 @@ int gattlib_write_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, c
 	return gattlib_write_char_by_handle(connection, handle, buffer, buffer_len);
 }
 
+static bool gattlib_write_cmd_take_credit(gattlib_context_t* conn_context) {
+	gint credits;
+
+	do {
+		credits = g_atomic_int_get(&conn_context->write_cmd_credits);
+		if (credits <= 0) {
+			return false;
+		}
+	} while (!g_atomic_int_compare_and_exchange(&conn_context->write_cmd_credits, credits, credits - 1));
+
+	return true;
+}
+
+// Called once the Write Command has been written to the socket (or dropped on disconnection)
+static void gattlib_write_cmd_sent_cb(gpointer user_data) {
+	gattlib_context_t* conn_context = user_data;
+
+	g_atomic_int_inc(&conn_context->write_cmd_credits);
+}
+
 int gattlib_write_without_response_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, const void* buffer, size_t buffer_len)
 {
-	// Only supported in the DBUS API (ie: Bluez > v5.40) at the moment
-	return GATTLIB_NOT_SUPPORTED;
+	uint16_t handle = 0;
+	int ret;
+
+	ret = get_handle_from_uuid(connection, uuid, &handle);
+	if (ret) {
+		fprintf(stderr, "Fail to find handle for UUID.\n");
+		return ret;
+	}
+
+	return gattlib_write_without_response_char_by_handle(connection, handle, buffer, buffer_len);
 }
 
 int gattlib_write_without_response_char_by_handle(gattlib_connection_t* connection, uint16_t handle, const void* buffer, size_t buffer_len)
 {
-	// Only supported in the DBUS API (ie: Bluez > v5.40) at the moment
+	gattlib_context_t* conn_context = connection->context;
+	size_t buflen;
+	guint id;
+
+	// A Write Command cannot be split. The value must fit in a single PDU (opcode and handle take 3 bytes).
+	g_attrib_get_buffer(conn_context->attrib, &buflen);
+	if (buffer_len > buflen - 3) {
+		fprintf(stderr, "Value of %zu bytes does not fit in a Write Command (ATT MTU: %zu).\n", buffer_len, buflen);
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	// Wait for a credit. The ATT transport only writes into the socket when its send buffer has room,
+	// so the credits return at the rate the link drains the socket.
+	while (!gattlib_write_cmd_take_credit(conn_context)) {
+		g_main_context_iteration(gattlib_connection_loop_context(connection), FALSE);
+	}
+
+	id = gatt_write_cmd(conn_context->attrib, handle, (uint8_t*)buffer, buffer_len,
+			gattlib_write_cmd_sent_cb, conn_context);
+	if (id == 0) {
+		g_atomic_int_inc(&conn_context->write_cmd_credits);
+		return GATTLIB_ERROR_INTERNAL;
+	}
+
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_write_char_by_uuid_with_priority(gattlib_connection_t* connection, uuid_t* uuid, const void* buffer, size_t buffer_len,
+		gattlib_priority_t priority)
+{
+	// The requests are sent in their submission order by GAttrib. Priority classes are not supported.
+	return gattlib_write_char_by_uuid(connection, uuid, buffer, buffer_len);
+}
+
+int gattlib_write_without_response_char_by_uuid_with_priority(gattlib_connection_t* connection, uuid_t* uuid,
+		const void* buffer, size_t buffer_len, gattlib_priority_t priority)
+{
+	// The requests are sent in their submission order by GAttrib. Priority classes are not supported.
+	return gattlib_write_without_response_char_by_uuid(connection, uuid, buffer, buffer_len);
+}
+
+int gattlib_write_coalescing_enable(gattlib_connection_t* connection, const uuid_t* uuid, bool enable)
+{
+	// Writes without response are sent as ATT Write Commands by this backend but their coalescing is
+	// only implemented by the DBUS backend
 	return GATTLIB_NOT_SUPPORTED;
 }
 
+int gattlib_write_coalescing_get_stats(gattlib_connection_t* connection, const uuid_t* uuid,
+		uint64_t* written, uint64_t* coalesced)
+{
+	return GATTLIB_NOT_SUPPORTED;
+}
+
+#if BLUEZ_VERSION_MAJOR == 5
+struct gattlib_cccd_lookup {
+	bt_uuid_t uuid;
+	uint16_t  handle;
+};
+
+static void gattlib_cccd_lookup_cb(struct gatt_db_attribute *attrib, void *user_data) {
+	struct gattlib_cccd_lookup* lookup = user_data;
+
+	if ((lookup->handle == 0) && (bt_uuid_cmp(&lookup->uuid, gatt_db_attribute_get_type(attrib)) == 0)) {
+		lookup->handle = gatt_db_attribute_get_handle(attrib);
+	}
+}
+#endif
+
+/**
+ * Return the handle of the Client Characteristic Configuration descriptor of the characteristic
+ */
+static int get_cccd_handle_from_uuid(gattlib_connection_t* connection, const uuid_t* uuid, uint16_t* handle) {
+	gattlib_context_t* conn_context = connection->context;
+	int ret = GATTLIB_NOT_FOUND;
+	int i;
+
+	g_mutex_lock(&conn_context->characteristics_mutex);
+	for (i = 0; i < conn_context->characteristic_count; i++) {
+		if (gattlib_uuid_cmp(&conn_context->characteristics[i].uuid, uuid) == 0) {
+			break;
+		}
+	}
+
+	if (i < conn_context->characteristic_count) {
+#if BLUEZ_VERSION_MAJOR == 5
+		struct gatt_db_attribute* char_decl = NULL;
+		struct gattlib_cccd_lookup lookup = { .handle = 0 };
+
+		if (conn_context->db != NULL) {
+			char_decl = gatt_db_get_attribute(conn_context->db, conn_context->characteristics[i].handle);
+		}
+
+		if (char_decl != NULL) {
+			bt_uuid16_create(&lookup.uuid, GATT_CLIENT_CHARAC_CFG_UUID);
+			gatt_db_service_foreach_desc(char_decl, gattlib_cccd_lookup_cb, &lookup);
+			if (lookup.handle != 0) {
+				*handle = lookup.handle;
+				ret = GATTLIB_SUCCESS;
+			}
+		} else
+#endif
+		{
+			// Without the attribute database, assume the descriptor follows the characteristic value
+			*handle = conn_context->characteristics[i].value_handle + 1;
+			ret = GATTLIB_SUCCESS;
+		}
+	}
+	g_mutex_unlock(&conn_context->characteristics_mutex);
+	return ret;
+}
+
 int gattlib_notification_start(gattlib_connection_t* connection, const uuid_t* uuid) {
 	uint16_t handle;
 	uint16_t enable_notification = 0x0001;
 
-	int ret = get_handle_from_uuid(connection, uuid, &handle);
+	int ret = get_cccd_handle_from_uuid(connection, uuid, &handle);
 	if (ret) {
-		return -1;
+		return ret;
 	}
 
 	// Enable Status Notification
-	return gattlib_write_char_by_handle(connection, handle + 1, &enable_notification, sizeof(enable_notification));
+	return gattlib_write_char_by_handle(connection, handle, &enable_notification, sizeof(enable_notification));
 }
 
 int gattlib_notification_stop(gattlib_connection_t* connection, const uuid_t* uuid) {
 	uint16_t handle;
 	uint16_t enable_notification = 0x0000;
 
-	int ret = get_handle_from_uuid(connection, uuid, &handle);
+	int ret = get_cccd_handle_from_uuid(connection, uuid, &handle);
 	if (ret) {
-		return -1;
+		return ret;
 	}
 
-	// Enable Status Notification
-	return gattlib_write_char_by_handle(connection, handle + 1, &enable_notification, sizeof(enable_notification));
+	// Disable Status Notification
+	return gattlib_write_char_by_handle(connection, handle, &enable_notification, sizeof(enable_notification));
+}
+
+struct gattlib_cccd_batch {
+	gint  pending; // Decremented from the connection loop thread
+	gint* results;
+};
+
+struct gattlib_cccd_batch_item {
+	struct gattlib_cccd_batch* batch;
+	size_t index;
+};
+
+static void gattlib_cccd_batch_write_cb(guint8 status, const guint8 *pdu, guint16 len, gpointer user_data) {
+	struct gattlib_cccd_batch_item* item = user_data;
+
+	if (status != 0) {
+		GATTLIB_LOG(GATTLIB_ERROR, "Failed to write Client Characteristic Configuration: %s", att_ecode2str(status));
+		g_atomic_int_set(&item->batch->results[item->index], GATTLIB_ERROR_BLUEZ_WITH_ERROR(status));
+	}
+	g_atomic_int_add(&item->batch->pending, -1);
+}
+
+/**
+ * Write the Client Characteristic Configuration of all the characteristics without waiting for
+ * each response. The ATT requests are queued by GAttrib and sent back to back.
+ */
+static int gattlib_cccd_batch_write(gattlib_connection_t* connection, const uuid_t* uuids, size_t uuids_count,
+		uint16_t value, int* results)
+{
+	gattlib_context_t* conn_context = connection->context;
+	struct gattlib_cccd_batch batch = { 0 };
+	struct gattlib_cccd_batch_item* items;
+	int ret = GATTLIB_SUCCESS;
+	size_t i;
+
+	if ((uuids == NULL) || (uuids_count == 0)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	batch.results = calloc(sizeof(gint), uuids_count);
+	items = calloc(sizeof(struct gattlib_cccd_batch_item), uuids_count);
+	if ((batch.results == NULL) || (items == NULL)) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	for (i = 0; i < uuids_count; i++) {
+		uint16_t handle;
+
+		if (get_cccd_handle_from_uuid(connection, &uuids[i], &handle) != GATTLIB_SUCCESS) {
+			batch.results[i] = GATTLIB_NOT_FOUND;
+			continue;
+		}
+
+		items[i].batch = &batch;
+		items[i].index = i;
+
+		// Count the request before it is queued as its callback runs on the connection loop thread
+		g_atomic_int_inc(&batch.pending);
+		guint id = gatt_write_char(conn_context->attrib, handle, (void*)&value, sizeof(value),
+				gattlib_cccd_batch_write_cb, &items[i]);
+		if (id == 0) {
+			g_atomic_int_set(&batch.results[i], GATTLIB_DEVICE_ERROR);
+			g_atomic_int_add(&batch.pending, -1);
+		}
+	}
+
+	// Wait for completion of all the requests
+	while (g_atomic_int_get(&batch.pending) > 0) {
+		g_main_context_iteration(gattlib_connection_loop_context(connection), FALSE);
+	}
+
+	for (i = 0; i < uuids_count; i++) {
+		int result = g_atomic_int_get(&batch.results[i]);
+
+		if ((ret == GATTLIB_SUCCESS) && (result != GATTLIB_SUCCESS)) {
+			ret = result;
+		}
+		if (results != NULL) {
+			results[i] = result;
+		}
+	}
+
+EXIT:
+	free(items);
+	free(batch.results);
+	return ret;
+}
+
+int gattlib_notifications_start(gattlib_connection_t* connection, const uuid_t* uuids, size_t uuids_count, uint32_t flags, int* results) {
+	const uint16_t enable = (flags & GATTLIB_NOTIFICATIONS_INDICATION) ? 0x0002 : 0x0001;
+
+	return gattlib_cccd_batch_write(connection, uuids, uuids_count, enable, results);
+}
+
+int gattlib_notifications_stop(gattlib_connection_t* connection, const uuid_t* uuids, size_t uuids_count, int* results) {
+	return gattlib_cccd_batch_write(connection, uuids, uuids_count, 0x0000, results);
+}
+
+#if BLUEZ_VERSION_MAJOR == 5
+
+struct gattlib_att_response {
+	int      completed;
+	guint8   status;
+	uint8_t* pdu;
+	guint16  pdu_len;
+};
+
+static void gattlib_att_response_cb(guint8 status, const guint8 *pdu, guint16 len, gpointer user_data) {
+	struct gattlib_att_response* response = user_data;
+
+	response->status = status;
+	if ((status == 0) && (len > 0)) {
+		response->pdu = malloc(len);
+		if (response->pdu != NULL) {
+			memcpy(response->pdu, pdu, len);
+			response->pdu_len = len;
+		}
+	}
+	response->completed = TRUE;
+}
+
+/**
+ * Send an ATT request and wait for its response.
+ * On success, the response PDU must be freed by the caller.
+ */
+static int gattlib_att_request(gattlib_connection_t* connection, const uint8_t* pdu, guint16 len,
+		struct gattlib_att_response* response)
+{
+	gattlib_context_t* conn_context = connection->context;
+	guint id;
+
+	memset(response, 0, sizeof(struct gattlib_att_response));
+
+	id = g_attrib_send(conn_context->attrib, 0, pdu, len, gattlib_att_response_cb, response, NULL);
+	if (id == 0) {
+		return GATTLIB_DEVICE_ERROR;
+	}
+
+	// Wait for completion of the event
+	while (response->completed == FALSE) {
+		g_main_context_iteration(gattlib_connection_loop_context(connection), FALSE);
+	}
+
+	if (response->status != 0) {
+		return GATTLIB_ERROR_BLUEZ_WITH_ERROR(response->status);
+	} else if (response->pdu == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	} else {
+		return GATTLIB_SUCCESS;
+	}
+}
+
+int gattlib_read_char_by_uuid_long(gattlib_connection_t* connection, uuid_t* uuid, gattlib_long_read_cb_t chunk_cb, void* user_data)
+{
+	gattlib_context_t* conn_context = connection->context;
+	struct gattlib_att_response response;
+	size_t offset = 0;
+	uint16_t handle;
+	uint8_t *buf;
+	size_t buflen;
+	guint16 plen;
+	int ret;
+
+	if (chunk_cb == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	ret = get_handle_from_uuid(connection, uuid, &handle);
+	if (ret) {
+		fprintf(stderr, "Fail to find handle for UUID.\n");
+		return ret;
+	}
+
+	// The buffer is sized from the ATT MTU
+	buf = g_attrib_get_buffer(conn_context->attrib, &buflen);
+	plen = enc_read_req(handle, buf, buflen);
+
+	while (true) {
+		ret = gattlib_att_request(connection, buf, plen, &response);
+		if (ret != GATTLIB_SUCCESS) {
+			// The value length was a multiple of the chunk length. There is nothing left to read.
+			if ((offset > 0) && ((response.status == ATT_ECODE_INVALID_OFFSET) || (response.status == ATT_ECODE_ATTR_NOT_LONG))) {
+				ret = GATTLIB_SUCCESS;
+			}
+			break;
+		}
+
+		// Skip the opcode of the Read (Blob) Response
+		if (response.pdu_len > 1) {
+			chunk_cb(response.pdu + 1, response.pdu_len - 1, offset, user_data);
+			offset += response.pdu_len - 1;
+		}
+		free(response.pdu);
+
+		// A response shorter than the MTU is the end of the value
+		if ((response.pdu_len < buflen) || (offset > G_MAXUINT16)) {
+			break;
+		}
+
+		buf = g_attrib_get_buffer(conn_context->attrib, &buflen);
+		plen = enc_read_blob_req(handle, offset, buf, buflen);
+	}
+
+	return ret;
+}
+
+int gattlib_write_char_by_uuid_long(gattlib_connection_t* connection, uuid_t* uuid, gattlib_long_write_cb_t chunk_cb, void* user_data)
+{
+	gattlib_context_t* conn_context = connection->context;
+	struct gattlib_att_response response;
+	size_t chunk_max_length;
+	size_t chunk_length;
+	size_t offset = 0;
+	uint8_t *chunk;
+	uint16_t handle;
+	uint8_t *buf;
+	size_t buflen;
+	guint16 plen;
+	int ret;
+
+	if (chunk_cb == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	ret = get_handle_from_uuid(connection, uuid, &handle);
+	if (ret) {
+		fprintf(stderr, "Fail to find handle for UUID.\n");
+		return ret;
+	}
+
+	// A Prepare Write Request carries up to ATT_MTU - 5 bytes of the value
+	buf = g_attrib_get_buffer(conn_context->attrib, &buflen);
+	chunk_max_length = buflen - 5;
+
+	chunk = malloc(chunk_max_length);
+	if (chunk == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	while ((chunk_length = chunk_cb(chunk, chunk_max_length, offset, user_data)) > 0) {
+		if ((chunk_length > chunk_max_length) || (offset > G_MAXUINT16)) {
+			ret = GATTLIB_INVALID_PARAMETER;
+			goto CANCEL;
+		}
+
+		buf = g_attrib_get_buffer(conn_context->attrib, &buflen);
+		plen = enc_prep_write_req(handle, offset, chunk, chunk_length, buf, buflen);
+		ret = gattlib_att_request(connection, buf, plen, &response);
+		if (ret != GATTLIB_SUCCESS) {
+			goto CANCEL;
+		}
+		free(response.pdu);
+
+		offset += chunk_length;
+	}
+
+	if (offset == 0) {
+		// Empty value. There is nothing to prepare.
+		free(chunk);
+		return gattlib_write_char_by_handle(connection, handle, NULL, 0);
+	}
+
+	// Commit all the prepared chunks
+	buf = g_attrib_get_buffer(conn_context->attrib, &buflen);
+	plen = enc_exec_write_req(ATT_WRITE_ALL_PREP_WRITES, buf, buflen);
+	ret = gattlib_att_request(connection, buf, plen, &response);
+	if (ret == GATTLIB_SUCCESS) {
+		free(response.pdu);
+	}
+
+	free(chunk);
+	return ret;
+
+CANCEL:
+	// Discard the chunks already prepared by the device
+	buf = g_attrib_get_buffer(conn_context->attrib, &buflen);
+	plen = enc_exec_write_req(ATT_CANCEL_ALL_PREP_WRITES, buf, buflen);
+	if (gattlib_att_request(connection, buf, plen, &response) == GATTLIB_SUCCESS) {
+		free(response.pdu);
+	}
+
+	free(chunk);
+	return ret;
+}
+
+#else
+
+int gattlib_read_char_by_uuid_long(gattlib_connection_t* connection, uuid_t* uuid, gattlib_long_read_cb_t chunk_cb, void* user_data)
+{
+	return GATTLIB_NOT_SUPPORTED;
+}
+
+int gattlib_write_char_by_uuid_long(gattlib_connection_t* connection, uuid_t* uuid, gattlib_long_write_cb_t chunk_cb, void* user_data)
+{
+	return GATTLIB_NOT_SUPPORTED;
+}
+
+#endif
+
+#if BLUEZ_VERSION_MAJOR == 5
+
+int gattlib_write_transaction_commit(gattlib_write_transaction_t* transaction) {
+	gattlib_context_t* conn_context;
+	struct gattlib_att_response response;
+	uint16_t* handles = NULL;
+	uint8_t *buf;
+	size_t buflen;
+	guint16 plen;
+	int ret = GATTLIB_SUCCESS;
+	guint i;
+
+	if (transaction == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+	conn_context = transaction->connection->context;
+
+	handles = calloc(sizeof(uint16_t), transaction->items->len + 1);
+	if (handles == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	// Resolve all the handles first to not prepare a transaction that cannot complete
+	for (i = 0; i < transaction->items->len; i++) {
+		struct gattlib_write_transaction_item* item = g_ptr_array_index(transaction->items, i);
+
+		ret = get_handle_from_uuid(transaction->connection, &item->uuid, &handles[i]);
+		if (ret) {
+			fprintf(stderr, "Fail to find handle for UUID.\n");
+			goto EXIT;
+		}
+	}
+
+	// Queue all the values on the device. Values longer than a PDU are split at increasing offsets.
+	for (i = 0; i < transaction->items->len; i++) {
+		struct gattlib_write_transaction_item* item = g_ptr_array_index(transaction->items, i);
+		size_t offset = 0;
+
+		do {
+			size_t chunk_length;
+
+			buf = g_attrib_get_buffer(conn_context->attrib, &buflen);
+			chunk_length = MIN(item->value_length - offset, buflen - 5);
+			if (offset > G_MAXUINT16) {
+				ret = GATTLIB_INVALID_PARAMETER;
+				goto CANCEL;
+			}
+
+			plen = enc_prep_write_req(handles[i], offset, item->value + offset, chunk_length, buf, buflen);
+			ret = gattlib_att_request(transaction->connection, buf, plen, &response);
+			if (ret != GATTLIB_SUCCESS) {
+				goto CANCEL;
+			}
+			free(response.pdu);
+
+			offset += chunk_length;
+		} while (offset < item->value_length);
+	}
+
+	// Apply all the queued values at once
+	buf = g_attrib_get_buffer(conn_context->attrib, &buflen);
+	plen = enc_exec_write_req(ATT_WRITE_ALL_PREP_WRITES, buf, buflen);
+	ret = gattlib_att_request(transaction->connection, buf, plen, &response);
+	if (ret == GATTLIB_SUCCESS) {
+		free(response.pdu);
+	}
+	goto EXIT;
+
+CANCEL:
+	// Discard the values already queued by the device
+	buf = g_attrib_get_buffer(conn_context->attrib, &buflen);
+	plen = enc_exec_write_req(ATT_CANCEL_ALL_PREP_WRITES, buf, buflen);
+	if (gattlib_att_request(transaction->connection, buf, plen, &response) == GATTLIB_SUCCESS) {
+		free(response.pdu);
+	}
+
+EXIT:
+	free(handles);
+	gattlib_write_transaction_abort(transaction);
+	return ret;
 }
+
+#else
+
+int gattlib_write_transaction_commit(gattlib_write_transaction_t* transaction) {
+	gattlib_write_transaction_abort(transaction);
+	return GATTLIB_NOT_SUPPORTED;
+}
+
+#endif
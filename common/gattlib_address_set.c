@@ -0,0 +1,348 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "gattlib_address_set.h"
+
+#define ADDRESS_MAX                     0xFFFFFFFFFFFFULL
+
+// Marker of the free slots. It cannot collide with a 48-bit address.
+#define ADDRESS_SET_EMPTY_SLOT          UINT64_MAX
+
+#define ADDRESS_SET_MIN_CAPACITY        64
+// Largest capacity whose table size in bytes does not overflow a size_t
+#define ADDRESS_SET_MAX_CAPACITY        (((size_t)1) << (sizeof(size_t) * 8 - 4))
+// As the table is kept at most half full
+#define ADDRESS_SET_MAX_COUNT           (ADDRESS_SET_MAX_CAPACITY / 2)
+
+// Size of the Bloom filter in bits per slot of the hash table. As the table is at most half full,
+// there are at least 16 bits per address. With 2 hash functions, it gives less than 2% of false positives.
+#define ADDRESS_SET_BLOOM_BITS_PER_SLOT 8
+
+struct _gattlib_address_set {
+	gint reference_counter;
+
+	// Protect the set that can be updated while a scan is reading it
+	GRWLock lock;
+
+	// Hash table with open addressing and linear probing. Its capacity is a power of two
+	// and it is kept at most half full.
+	uint64_t* slots;
+	size_t capacity;
+	size_t count;
+
+	// Bloom filter in front of the hash table. Most of the addresses seen by a scan are not in the set:
+	// they are rejected by the Bloom filter without probing the (larger) hash table.
+	uint64_t* bloom;
+	size_t bloom_mask;
+	// Addresses removed since the Bloom filter has been built. Their bits are still set.
+	size_t bloom_stale_count;
+};
+
+// 64-bit finalizer of MurmurHash3
+static inline uint64_t hash_address(uint64_t address) {
+	address ^= address >> 33;
+	address *= 0xFF51AFD7ED558CCDULL;
+	address ^= address >> 33;
+	address *= 0xC4CEB9FE1A85EC53ULL;
+	address ^= address >> 33;
+	return address;
+}
+
+static inline size_t bloom_bit1(const gattlib_address_set_t* set, uint64_t hash) {
+	return (hash >> 32) & set->bloom_mask;
+}
+
+static inline size_t bloom_bit2(const gattlib_address_set_t* set, uint64_t hash) {
+	return ((hash * 0x9E3779B97F4A7C15ULL) >> 32) & set->bloom_mask;
+}
+
+static inline void bloom_add(gattlib_address_set_t* set, uint64_t hash) {
+	size_t bit1 = bloom_bit1(set, hash);
+	size_t bit2 = bloom_bit2(set, hash);
+
+	set->bloom[bit1 / 64] |= 1ULL << (bit1 % 64);
+	set->bloom[bit2 / 64] |= 1ULL << (bit2 % 64);
+}
+
+static inline bool bloom_may_contain(const gattlib_address_set_t* set, uint64_t hash) {
+	size_t bit1 = bloom_bit1(set, hash);
+	size_t bit2 = bloom_bit2(set, hash);
+
+	return (set->bloom[bit1 / 64] & (1ULL << (bit1 % 64))) && (set->bloom[bit2 / 64] & (1ULL << (bit2 % 64)));
+}
+
+static void bloom_rebuild(gattlib_address_set_t* set) {
+	size_t i;
+
+	memset(set->bloom, 0, set->capacity * ADDRESS_SET_BLOOM_BITS_PER_SLOT / 8);
+	for (i = 0; i < set->capacity; i++) {
+		if (set->slots[i] != ADDRESS_SET_EMPTY_SLOT) {
+			bloom_add(set, hash_address(set->slots[i]));
+		}
+	}
+	set->bloom_stale_count = 0;
+}
+
+// Return the slot of the address or the free slot where it would be inserted
+static inline size_t find_slot(const gattlib_address_set_t* set, uint64_t address, uint64_t hash) {
+	size_t mask = set->capacity - 1;
+	size_t i = hash & mask;
+
+	while ((set->slots[i] != ADDRESS_SET_EMPTY_SLOT) && (set->slots[i] != address)) {
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+/**
+ * Resize the hash table and rebuild the Bloom filter
+ *
+ * @note Caller must hold the writer lock
+ */
+static int resize(gattlib_address_set_t* set, size_t capacity) {
+	uint64_t* old_slots = set->slots;
+	size_t old_capacity = set->capacity;
+	uint64_t* slots;
+	uint64_t* bloom;
+	size_t i;
+
+	slots = malloc(capacity * sizeof(uint64_t));
+	bloom = malloc(capacity * ADDRESS_SET_BLOOM_BITS_PER_SLOT / 8);
+	if ((slots == NULL) || (bloom == NULL)) {
+		free(slots);
+		free(bloom);
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	// All bytes to 0xFF is ADDRESS_SET_EMPTY_SLOT
+	memset(slots, 0xFF, capacity * sizeof(uint64_t));
+
+	set->slots = slots;
+	set->capacity = capacity;
+	for (i = 0; i < old_capacity; i++) {
+		if (old_slots[i] != ADDRESS_SET_EMPTY_SLOT) {
+			set->slots[find_slot(set, old_slots[i], hash_address(old_slots[i]))] = old_slots[i];
+		}
+	}
+	free(old_slots);
+
+	free(set->bloom);
+	set->bloom = bloom;
+	set->bloom_mask = capacity * ADDRESS_SET_BLOOM_BITS_PER_SLOT - 1;
+	bloom_rebuild(set);
+	return GATTLIB_SUCCESS;
+}
+
+/**
+ * Ensure the hash table can receive 'added_count' more addresses while staying at most half full
+ *
+ * @note Caller must hold the writer lock
+ */
+static int reserve(gattlib_address_set_t* set, size_t added_count) {
+	size_t capacity = set->capacity;
+	size_t count;
+
+	// Reject the counts the table cannot hold before computing its capacity. It would overflow.
+	if (added_count > ADDRESS_SET_MAX_COUNT - set->count) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+	count = set->count + added_count;
+
+	while (capacity < 2 * count) {
+		capacity *= 2;
+	}
+
+	if (capacity == set->capacity) {
+		return GATTLIB_SUCCESS;
+	}
+	return resize(set, capacity);
+}
+
+/**
+ * @note Caller must hold the writer lock
+ */
+static void insert(gattlib_address_set_t* set, uint64_t address) {
+	uint64_t hash = hash_address(address);
+	size_t i = find_slot(set, address, hash);
+
+	if (set->slots[i] == ADDRESS_SET_EMPTY_SLOT) {
+		set->slots[i] = address;
+		set->count++;
+		bloom_add(set, hash);
+	}
+}
+
+int gattlib_address_set_new(gattlib_address_set_t** set) {
+	gattlib_address_set_t* new_set;
+
+	if (set == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	new_set = calloc(1, sizeof(gattlib_address_set_t));
+	if (new_set == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	new_set->reference_counter = 1;
+	g_rw_lock_init(&new_set->lock);
+
+	if (resize(new_set, ADDRESS_SET_MIN_CAPACITY) != GATTLIB_SUCCESS) {
+		g_rw_lock_clear(&new_set->lock);
+		free(new_set);
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	*set = new_set;
+	return GATTLIB_SUCCESS;
+}
+
+gattlib_address_set_t* gattlib_address_set_ref(gattlib_address_set_t* set) {
+	if (set != NULL) {
+		g_atomic_int_inc(&set->reference_counter);
+	}
+	return set;
+}
+
+void gattlib_address_set_unref(gattlib_address_set_t* set) {
+	if ((set == NULL) || !g_atomic_int_dec_and_test(&set->reference_counter)) {
+		return;
+	}
+
+	g_rw_lock_clear(&set->lock);
+	free(set->slots);
+	free(set->bloom);
+	free(set);
+}
+
+int gattlib_address_set_add(gattlib_address_set_t* set, uint64_t address) {
+	return gattlib_address_set_add_list(set, &address, 1);
+}
+
+int gattlib_address_set_add_list(gattlib_address_set_t* set, const uint64_t* addresses, size_t count) {
+	size_t i;
+	int ret;
+
+	if ((set == NULL) || ((addresses == NULL) && (count > 0))) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (addresses[i] > ADDRESS_MAX) {
+			return GATTLIB_INVALID_PARAMETER;
+		}
+	}
+
+	g_rw_lock_writer_lock(&set->lock);
+
+	// Grow the table once for the whole list
+	ret = reserve(set, count);
+	if (ret == GATTLIB_SUCCESS) {
+		for (i = 0; i < count; i++) {
+			insert(set, addresses[i]);
+		}
+	}
+
+	g_rw_lock_writer_unlock(&set->lock);
+	return ret;
+}
+
+int gattlib_address_set_remove(gattlib_address_set_t* set, uint64_t address) {
+	size_t mask, i, j;
+
+	if ((set == NULL) || (address > ADDRESS_MAX)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rw_lock_writer_lock(&set->lock);
+
+	mask = set->capacity - 1;
+	i = find_slot(set, address, hash_address(address));
+	if (set->slots[i] == ADDRESS_SET_EMPTY_SLOT) {
+		g_rw_lock_writer_unlock(&set->lock);
+		return GATTLIB_NOT_FOUND;
+	}
+
+	// Backward shift deletion: move back the following addresses of the cluster whose probe
+	// sequence goes through the freed slot
+	for (j = (i + 1) & mask; set->slots[j] != ADDRESS_SET_EMPTY_SLOT; j = (j + 1) & mask) {
+		size_t home = hash_address(set->slots[j]) & mask;
+
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			set->slots[i] = set->slots[j];
+			i = j;
+		}
+	}
+	set->slots[i] = ADDRESS_SET_EMPTY_SLOT;
+	set->count--;
+
+	// The bits of the removed addresses cannot be cleared. Rebuild the Bloom filter once they
+	// are too many to keep a low rate of false positives.
+	set->bloom_stale_count++;
+	if (set->bloom_stale_count > set->count) {
+		bloom_rebuild(set);
+	}
+
+	g_rw_lock_writer_unlock(&set->lock);
+	return GATTLIB_SUCCESS;
+}
+
+void gattlib_address_set_clear(gattlib_address_set_t* set) {
+	if (set == NULL) {
+		return;
+	}
+
+	g_rw_lock_writer_lock(&set->lock);
+	memset(set->slots, 0xFF, set->capacity * sizeof(uint64_t));
+	memset(set->bloom, 0, set->capacity * ADDRESS_SET_BLOOM_BITS_PER_SLOT / 8);
+	set->count = 0;
+	set->bloom_stale_count = 0;
+	g_rw_lock_writer_unlock(&set->lock);
+}
+
+bool gattlib_address_set_contains(gattlib_address_set_t* set, uint64_t address) {
+	uint64_t hash = hash_address(address);
+	bool is_present = false;
+
+	if (set == NULL) {
+		return false;
+	}
+
+	g_rw_lock_reader_lock(&set->lock);
+	if (bloom_may_contain(set, hash)) {
+		is_present = (set->slots[find_slot(set, address, hash)] == address);
+	}
+	g_rw_lock_reader_unlock(&set->lock);
+
+	return is_present;
+}
+
+size_t gattlib_address_set_size(gattlib_address_set_t* set) {
+	size_t count;
+
+	if (set == NULL) {
+		return 0;
+	}
+
+	g_rw_lock_reader_lock(&set->lock);
+	count = set->count;
+	g_rw_lock_reader_unlock(&set->lock);
+
+	return count;
+}
+
+bool gattlib_address_set_is_reported(gattlib_address_set_t* allowlist, gattlib_address_set_t* denylist,
+		uint64_t address)
+{
+	if ((denylist != NULL) && gattlib_address_set_contains(denylist, address)) {
+		return false;
+	}
+	return (allowlist == NULL) || gattlib_address_set_contains(allowlist, address);
+}
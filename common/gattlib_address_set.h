@@ -0,0 +1,17 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#ifndef __GATTLIB_ADDRESS_SET_H__
+#define __GATTLIB_ADDRESS_SET_H__
+
+#include "gattlib.h"
+
+// Return true if the address is not in the denylist and, when there is an allowlist, is in the allowlist.
+// Both lists can be NULL.
+bool gattlib_address_set_is_reported(gattlib_address_set_t* allowlist, gattlib_address_set_t* denylist,
+		uint64_t address);
+
+#endif
@@ -0,0 +1,447 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "gattlib_advertising_filter.h"
+
+#define AD_TYPE_SHORTENED_LOCAL_NAME    0x08
+#define AD_TYPE_COMPLETE_LOCAL_NAME     0x09
+#define AD_TYPE_SERVICE_DATA_UUID16     0x16
+#define AD_TYPE_SERVICE_DATA_UUID32     0x20
+#define AD_TYPE_SERVICE_DATA_UUID128    0x21
+#define AD_TYPE_MANUFACTURER_DATA       0xFF
+
+// The data of an AD structure is at most 254 bytes long
+#define AD_DATA_MAX_LENGTH              254
+
+#define ADDRESS_MAX                     0xFFFFFFFFFFFFULL
+
+// Masked prefix expected at the start of the data of an AD type
+struct ad_pattern {
+	uint8_t ad_type;
+	// Index of the rule in the bitmask of the AD rules
+	uint8_t rule;
+	uint8_t length;
+	// 'value' is already masked
+	const uint8_t* value;
+	const uint8_t* mask;
+};
+
+struct filter_group {
+	// AD rules that must all match
+	uint64_t ad_rules;
+	bool has_rssi_threshold;
+	int16_t rssi_threshold;
+	// Intersection of the address ranges of the group
+	uint64_t address_first;
+	uint64_t address_last;
+};
+
+struct _gattlib_advertising_filter {
+	gint reference_counter;
+
+	struct filter_group groups[GATTLIB_ADVERTISING_FILTER_MAX_RULES];
+	size_t group_count;
+
+	// Patterns sorted by AD type. The patterns of the AD type 't' are in [pattern_index[t], pattern_index[t+1]).
+	struct ad_pattern* patterns;
+	size_t pattern_count;
+	uint16_t pattern_index[257];
+
+	// Storage of the values and masks of the patterns
+	uint8_t* pool;
+	size_t pool_length;
+};
+
+static const uint8_t m_bluetooth_base_uuid[16] = {
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB
+};
+
+size_t gattlib_advertising_uuid_to_le(const uuid_t* uuid, uint8_t* uuid_le) {
+	uint8_t uuid128[16];
+	int i;
+
+	// Get the 128-bit form of the UUID in network order
+	memcpy(uuid128, m_bluetooth_base_uuid, sizeof(uuid128));
+	if (uuid->type == SDP_UUID16) {
+		uuid128[2] = uuid->value.uuid16 >> 8;
+		uuid128[3] = uuid->value.uuid16 & 0xFF;
+	} else if (uuid->type == SDP_UUID32) {
+		uuid128[0] = uuid->value.uuid32 >> 24;
+		uuid128[1] = (uuid->value.uuid32 >> 16) & 0xFF;
+		uuid128[2] = (uuid->value.uuid32 >> 8) & 0xFF;
+		uuid128[3] = uuid->value.uuid32 & 0xFF;
+	} else if (uuid->type == SDP_UUID128) {
+		memcpy(uuid128, &uuid->value.uuid128, sizeof(uuid128));
+	} else {
+		return 0;
+	}
+
+	// The UUIDs are little-endian in the advertising data
+	for (i = 0; i < 16; i++) {
+		uuid_le[i] = uuid128[15 - i];
+	}
+
+	if (memcmp(&uuid128[4], &m_bluetooth_base_uuid[4], 12) != 0) {
+		return 16;
+	} else if ((uuid128[0] == 0) && (uuid128[1] == 0)) {
+		return 2;
+	} else {
+		return 4;
+	}
+}
+
+// Number of bytes the patterns of a rule need in the pool
+static size_t get_rule_pool_length(const gattlib_advertising_rule_t* rule) {
+	switch (rule->type) {
+	case GATTLIB_ADVERTISING_RULE_MANUFACTURER_ID:
+		return 2 * 2;
+	case GATTLIB_ADVERTISING_RULE_SERVICE_DATA_UUID:
+		return 2 * (2 + 4 + 16);
+	case GATTLIB_ADVERTISING_RULE_AD_PREFIX:
+		return 2 * rule->rule.ad_prefix.length;
+	case GATTLIB_ADVERTISING_RULE_NAME_PREFIX:
+		return (rule->rule.name_prefix != NULL) ? 2 * 2 * strlen(rule->rule.name_prefix) : 0;
+	default:
+		return 0;
+	}
+}
+
+static int add_pattern(gattlib_advertising_filter_t* filter, uint8_t ad_type, uint8_t rule,
+		const uint8_t* value, const uint8_t* mask, size_t length)
+{
+	struct ad_pattern* pattern = &filter->patterns[filter->pattern_count];
+	uint8_t* pattern_value = &filter->pool[filter->pool_length];
+	uint8_t* pattern_mask = &filter->pool[filter->pool_length + length];
+	size_t i;
+
+	if (length > AD_DATA_MAX_LENGTH) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	for (i = 0; i < length; i++) {
+		pattern_mask[i] = (mask != NULL) ? mask[i] : 0xFF;
+		pattern_value[i] = value[i] & pattern_mask[i];
+	}
+
+	pattern->ad_type = ad_type;
+	pattern->rule = rule;
+	pattern->length = length;
+	pattern->value = pattern_value;
+	pattern->mask = pattern_mask;
+
+	filter->pattern_count++;
+	filter->pool_length += 2 * length;
+	return GATTLIB_SUCCESS;
+}
+
+static int add_service_data_patterns(gattlib_advertising_filter_t* filter, uint8_t rule, const uuid_t* uuid) {
+	uint8_t value[16];
+	size_t length;
+	int ret;
+
+	length = gattlib_advertising_uuid_to_le(uuid, value);
+	if (length == 0) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	ret = add_pattern(filter, AD_TYPE_SERVICE_DATA_UUID128, rule, value, NULL, 16);
+	if (ret != GATTLIB_SUCCESS) {
+		return ret;
+	}
+
+	// UUIDs derived from the Bluetooth Base UUID can also be advertised in their short forms
+	if (length <= 4) {
+		ret = add_pattern(filter, AD_TYPE_SERVICE_DATA_UUID32, rule, &value[12], NULL, 4);
+		if ((ret == GATTLIB_SUCCESS) && (length == 2)) {
+			ret = add_pattern(filter, AD_TYPE_SERVICE_DATA_UUID16, rule, &value[12], NULL, 2);
+		}
+	}
+
+	return ret;
+}
+
+static int compile_rule(gattlib_advertising_filter_t* filter, struct filter_group* group, const gattlib_advertising_rule_t* rule,
+		uint8_t* ad_rule_count)
+{
+	uint8_t ad_rule = *ad_rule_count;
+	uint8_t manufacturer_id[2];
+	int ret;
+
+	switch (rule->type) {
+	case GATTLIB_ADVERTISING_RULE_RSSI:
+		if (!group->has_rssi_threshold || (rule->rule.rssi_threshold > group->rssi_threshold)) {
+			group->rssi_threshold = rule->rule.rssi_threshold;
+		}
+		group->has_rssi_threshold = true;
+		return GATTLIB_SUCCESS;
+
+	case GATTLIB_ADVERTISING_RULE_ADDRESS_RANGE:
+		if ((rule->rule.address_range.first > rule->rule.address_range.last) ||
+		    (rule->rule.address_range.last > ADDRESS_MAX)) {
+			return GATTLIB_INVALID_PARAMETER;
+		}
+		if (rule->rule.address_range.first > group->address_first) {
+			group->address_first = rule->rule.address_range.first;
+		}
+		if (rule->rule.address_range.last < group->address_last) {
+			group->address_last = rule->rule.address_range.last;
+		}
+		return GATTLIB_SUCCESS;
+
+	case GATTLIB_ADVERTISING_RULE_MANUFACTURER_ID:
+		manufacturer_id[0] = rule->rule.manufacturer_id & 0xFF;
+		manufacturer_id[1] = rule->rule.manufacturer_id >> 8;
+		ret = add_pattern(filter, AD_TYPE_MANUFACTURER_DATA, ad_rule, manufacturer_id, NULL, sizeof(manufacturer_id));
+		break;
+
+	case GATTLIB_ADVERTISING_RULE_SERVICE_DATA_UUID:
+		ret = add_service_data_patterns(filter, ad_rule, &rule->rule.service_data_uuid);
+		break;
+
+	case GATTLIB_ADVERTISING_RULE_AD_PREFIX:
+		if ((rule->rule.ad_prefix.value == NULL) && (rule->rule.ad_prefix.length > 0)) {
+			return GATTLIB_INVALID_PARAMETER;
+		}
+		ret = add_pattern(filter, rule->rule.ad_prefix.ad_type, ad_rule,
+				rule->rule.ad_prefix.value, rule->rule.ad_prefix.mask, rule->rule.ad_prefix.length);
+		break;
+
+	case GATTLIB_ADVERTISING_RULE_NAME_PREFIX:
+		if (rule->rule.name_prefix == NULL) {
+			return GATTLIB_INVALID_PARAMETER;
+		}
+		ret = add_pattern(filter, AD_TYPE_SHORTENED_LOCAL_NAME, ad_rule,
+				(const uint8_t*)rule->rule.name_prefix, NULL, strlen(rule->rule.name_prefix));
+		if (ret == GATTLIB_SUCCESS) {
+			ret = add_pattern(filter, AD_TYPE_COMPLETE_LOCAL_NAME, ad_rule,
+					(const uint8_t*)rule->rule.name_prefix, NULL, strlen(rule->rule.name_prefix));
+		}
+		break;
+
+	default:
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	if (ret == GATTLIB_SUCCESS) {
+		group->ad_rules |= (1ULL << ad_rule);
+		(*ad_rule_count)++;
+	}
+	return ret;
+}
+
+static int compare_pattern(const void* a, const void* b) {
+	const struct ad_pattern* pattern_a = a;
+	const struct ad_pattern* pattern_b = b;
+
+	if (pattern_a->ad_type != pattern_b->ad_type) {
+		return pattern_a->ad_type - pattern_b->ad_type;
+	}
+	return pattern_a->rule - pattern_b->rule;
+}
+
+int gattlib_advertising_filter_compile(const gattlib_advertising_rule_t* rules, size_t rule_count,
+		gattlib_advertising_filter_t** filter)
+{
+	gattlib_advertising_filter_t* new_filter;
+	unsigned int group_ids[GATTLIB_ADVERTISING_FILTER_MAX_RULES];
+	uint8_t ad_rule_count = 0;
+	size_t pool_length = 0;
+	size_t i, j;
+	int ret;
+
+	if ((filter == NULL) || (rules == NULL) || (rule_count == 0) || (rule_count > GATTLIB_ADVERTISING_FILTER_MAX_RULES)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	new_filter = calloc(sizeof(gattlib_advertising_filter_t), 1);
+	if (new_filter == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	new_filter->reference_counter = 1;
+
+	for (i = 0; i < rule_count; i++) {
+		pool_length += get_rule_pool_length(&rules[i]);
+	}
+
+	// A rule has at most 3 patterns (service data UUID in its 16, 32 and 128-bit forms)
+	new_filter->patterns = malloc(rule_count * 3 * sizeof(struct ad_pattern));
+	new_filter->pool = malloc(pool_length + 1);
+	if ((new_filter->patterns == NULL) || (new_filter->pool == NULL)) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto ON_ERROR;
+	}
+
+	for (i = 0; i < rule_count; i++) {
+		struct filter_group* group = NULL;
+
+		for (j = 0; j < new_filter->group_count; j++) {
+			if (group_ids[j] == rules[i].group) {
+				group = &new_filter->groups[j];
+				break;
+			}
+		}
+		if (group == NULL) {
+			group_ids[new_filter->group_count] = rules[i].group;
+			group = &new_filter->groups[new_filter->group_count++];
+			group->address_first = 0;
+			group->address_last = ADDRESS_MAX;
+		}
+
+		ret = compile_rule(new_filter, group, &rules[i], &ad_rule_count);
+		if (ret != GATTLIB_SUCCESS) {
+			goto ON_ERROR;
+		}
+	}
+
+	// Index the patterns by AD type
+	qsort(new_filter->patterns, new_filter->pattern_count, sizeof(struct ad_pattern), compare_pattern);
+	for (i = 0, j = 0; i < 256; i++) {
+		new_filter->pattern_index[i] = j;
+		while ((j < new_filter->pattern_count) && (new_filter->patterns[j].ad_type == i)) {
+			j++;
+		}
+	}
+	new_filter->pattern_index[256] = j;
+
+	*filter = new_filter;
+	return GATTLIB_SUCCESS;
+
+ON_ERROR:
+	free(new_filter->patterns);
+	free(new_filter->pool);
+	free(new_filter);
+	return ret;
+}
+
+gattlib_advertising_filter_t* gattlib_advertising_filter_ref(gattlib_advertising_filter_t* filter) {
+	if (filter != NULL) {
+		g_atomic_int_inc(&filter->reference_counter);
+	}
+	return filter;
+}
+
+void gattlib_advertising_filter_unref(gattlib_advertising_filter_t* filter) {
+	if ((filter == NULL) || !g_atomic_int_dec_and_test(&filter->reference_counter)) {
+		return;
+	}
+
+	free(filter->patterns);
+	free(filter->pool);
+	free(filter);
+}
+
+bool gattlib_advertising_filter_begin(const gattlib_advertising_filter_t* filter, uint64_t address, int16_t rssi,
+		struct gattlib_advertising_filter_state* state)
+{
+	size_t i;
+
+	state->pending_groups = 0;
+	state->satisfied_rules = 0;
+
+	for (i = 0; i < filter->group_count; i++) {
+		const struct filter_group* group = &filter->groups[i];
+
+		if ((address < group->address_first) || (address > group->address_last)) {
+			continue;
+		}
+		if (group->has_rssi_threshold && ((rssi == GATTLIB_ADVERTISING_REPORT_RSSI_UNKNOWN) || (rssi < group->rssi_threshold))) {
+			continue;
+		}
+		if (group->ad_rules == 0) {
+			return true;
+		}
+		state->pending_groups |= (1ULL << i);
+	}
+
+	return false;
+}
+
+static bool pattern_match(const struct ad_pattern* pattern, const uint8_t* header, size_t header_length,
+		const uint8_t* data, size_t data_length)
+{
+	size_t i;
+
+	if (header_length + data_length < pattern->length) {
+		return false;
+	}
+
+	for (i = 0; i < pattern->length; i++) {
+		uint8_t byte = (i < header_length) ? header[i] : data[i - header_length];
+		if ((byte & pattern->mask[i]) != pattern->value[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool gattlib_advertising_filter_feed(const gattlib_advertising_filter_t* filter, struct gattlib_advertising_filter_state* state,
+		uint8_t ad_type, const uint8_t* header, size_t header_length, const uint8_t* data, size_t data_length)
+{
+	bool has_new_rule = false;
+	size_t i;
+
+	if (state->pending_groups == 0) {
+		return false;
+	}
+
+	for (i = filter->pattern_index[ad_type]; i < filter->pattern_index[ad_type + 1]; i++) {
+		const struct ad_pattern* pattern = &filter->patterns[i];
+		uint64_t rule = 1ULL << pattern->rule;
+
+		if ((state->satisfied_rules & rule) == 0 && pattern_match(pattern, header, header_length, data, data_length)) {
+			state->satisfied_rules |= rule;
+			has_new_rule = true;
+		}
+	}
+
+	if (!has_new_rule) {
+		return false;
+	}
+
+	for (i = 0; i < filter->group_count; i++) {
+		if ((state->pending_groups & (1ULL << i)) &&
+		    ((filter->groups[i].ad_rules & state->satisfied_rules) == filter->groups[i].ad_rules)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool gattlib_advertising_filter_match(const gattlib_advertising_filter_t* filter, uint64_t address, int16_t rssi,
+		const uint8_t* data, size_t data_length)
+{
+	struct gattlib_advertising_filter_state state;
+	size_t offset = 0;
+
+	if (filter == NULL) {
+		return true;
+	}
+
+	if (gattlib_advertising_filter_begin(filter, address, rssi, &state)) {
+		return true;
+	}
+
+	while ((state.pending_groups != 0) && (offset < data_length)) {
+		uint8_t field_length = data[offset];
+
+		if ((field_length == 0) || (offset + 1 + field_length > data_length)) {
+			break;
+		}
+
+		if (gattlib_advertising_filter_feed(filter, &state, data[offset + 1], NULL, 0, &data[offset + 2], field_length - 1)) {
+			return true;
+		}
+
+		offset += 1 + field_length;
+	}
+
+	return false;
+}
@@ -0,0 +1,34 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#ifndef __GATTLIB_ADVERTISING_FILTER_H__
+#define __GATTLIB_ADVERTISING_FILTER_H__
+
+#include "gattlib.h"
+
+// Progress of the evaluation of an advertisement against a filter. It allows the backends
+// to feed the AD structures one by one when they do not have the raw advertising data.
+struct gattlib_advertising_filter_state {
+	// Groups whose rules not depending on the AD structures have matched
+	uint64_t pending_groups;
+	// Rules depending on the AD structures that have matched
+	uint64_t satisfied_rules;
+};
+
+// Return true if the advertisement matches without looking at its AD structures
+bool gattlib_advertising_filter_begin(const gattlib_advertising_filter_t* filter, uint64_t address, int16_t rssi,
+		struct gattlib_advertising_filter_state* state);
+
+// Evaluate an AD structure whose data is the concatenation of 'header' and 'data'.
+// Return true once the advertisement matches.
+bool gattlib_advertising_filter_feed(const gattlib_advertising_filter_t* filter, struct gattlib_advertising_filter_state* state,
+		uint8_t ad_type, const uint8_t* header, size_t header_length, const uint8_t* data, size_t data_length);
+
+// Convert a UUID into its advertising form: 128-bit little-endian in 'uuid_le' (16 bytes).
+// Return the length of its shortest form (2, 4 or 16), found at '&uuid_le[12]' when shorter than 16. 0 if the UUID is invalid.
+size_t gattlib_advertising_uuid_to_le(const uuid_t* uuid, uint8_t* uuid_le);
+
+#endif
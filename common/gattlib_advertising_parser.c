@@ -0,0 +1,459 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gattlib_address_set.h"
+
+#define HCI_EVENT_LE_META                          0x3E
+
+#define HCI_LE_SUBEVENT_ADVERTISING_REPORT         0x02
+#define HCI_LE_SUBEVENT_DIRECTED_ADVERTISING_REPORT 0x0B
+#define HCI_LE_SUBEVENT_EXTENDED_ADVERTISING_REPORT 0x0D
+
+// Size of a report without its data
+#define ADVERTISING_REPORT_HEADER_SIZE             9   // event type, address type, address, data length
+#define DIRECTED_ADVERTISING_REPORT_SIZE           16
+#define EXTENDED_ADVERTISING_REPORT_HEADER_SIZE    24
+
+// Data status of the extended advertising reports
+#define EXTENDED_DATA_STATUS(event_type)           (((event_type) >> 5) & 0x3)
+#define EXTENDED_DATA_STATUS_COMPLETE              0
+#define EXTENDED_DATA_STATUS_INCOMPLETE            1
+#define EXTENDED_DATA_STATUS_TRUNCATED             2
+
+#define AD_TYPE_TX_POWER_LEVEL                     0x0A
+
+// Maximum length of the advertising data of an advertising set
+#define EXTENDED_ADVERTISING_DATA_MAX_LENGTH       1650
+// Number of advertising sets which data can be reassembled at the same time
+#define ADVERTISING_PARSER_FRAGMENT_SLOTS          4
+// Number of AD structures the parser can hold before growing. It covers the data of a single HCI event.
+#define ADVERTISING_PARSER_DEFAULT_AD_CAPACITY     128
+
+// Advertising data of an advertising set received in several extended advertising reports
+struct advertising_fragment {
+	bool     is_used;
+	uint8_t  address[6];
+	uint8_t  address_type;
+	uint8_t  sid;
+	uint64_t sequence;
+	size_t   data_length;
+	uint8_t  data[EXTENDED_ADVERTISING_DATA_MAX_LENGTH];
+};
+
+struct _gattlib_advertising_parser {
+	// AD structures of the report being delivered. Reused from one report to the next.
+	gattlib_ad_structure_t* ad;
+	size_t ad_capacity;
+
+	struct advertising_fragment fragments[ADVERTISING_PARSER_FRAGMENT_SLOTS];
+	uint64_t fragment_sequence;
+
+	// Reports not matching the filter are dropped. NULL if none.
+	gattlib_advertising_filter_t* filter;
+
+	// Reports of the addresses not in the allowlist or in the denylist are dropped. NULL if none.
+	gattlib_address_set_t* allowlist;
+	gattlib_address_set_t* denylist;
+};
+
+// Properties of the legacy advertising PDU types (ADV_IND, ADV_DIRECT_IND, ADV_SCAN_IND, ADV_NONCONN_IND, SCAN_RSP)
+static const uint16_t m_legacy_properties[] = {
+	GATTLIB_ADVERTISING_REPORT_CONNECTABLE | GATTLIB_ADVERTISING_REPORT_SCANNABLE | GATTLIB_ADVERTISING_REPORT_LEGACY,
+	GATTLIB_ADVERTISING_REPORT_CONNECTABLE | GATTLIB_ADVERTISING_REPORT_DIRECTED | GATTLIB_ADVERTISING_REPORT_LEGACY,
+	GATTLIB_ADVERTISING_REPORT_SCANNABLE | GATTLIB_ADVERTISING_REPORT_LEGACY,
+	GATTLIB_ADVERTISING_REPORT_LEGACY,
+	GATTLIB_ADVERTISING_REPORT_SCANNABLE | GATTLIB_ADVERTISING_REPORT_SCAN_RESPONSE | GATTLIB_ADVERTISING_REPORT_LEGACY,
+};
+
+int gattlib_advertising_parser_new(gattlib_advertising_parser_t** parser) {
+	gattlib_advertising_parser_t* new_parser;
+
+	if (parser == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	new_parser = calloc(sizeof(gattlib_advertising_parser_t), 1);
+	if (new_parser == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	new_parser->ad = malloc(ADVERTISING_PARSER_DEFAULT_AD_CAPACITY * sizeof(gattlib_ad_structure_t));
+	if (new_parser->ad == NULL) {
+		free(new_parser);
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	new_parser->ad_capacity = ADVERTISING_PARSER_DEFAULT_AD_CAPACITY;
+
+	*parser = new_parser;
+	return GATTLIB_SUCCESS;
+}
+
+void gattlib_advertising_parser_free(gattlib_advertising_parser_t* parser) {
+	if (parser == NULL) {
+		return;
+	}
+
+	gattlib_advertising_filter_unref(parser->filter);
+	gattlib_address_set_unref(parser->allowlist);
+	gattlib_address_set_unref(parser->denylist);
+	free(parser->ad);
+	free(parser);
+}
+
+int gattlib_advertising_parser_set_filter(gattlib_advertising_parser_t* parser, gattlib_advertising_filter_t* filter) {
+	if (parser == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	gattlib_advertising_filter_ref(filter);
+	gattlib_advertising_filter_unref(parser->filter);
+	parser->filter = filter;
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_advertising_parser_set_address_lists(gattlib_advertising_parser_t* parser,
+		gattlib_address_set_t* allowlist, gattlib_address_set_t* denylist)
+{
+	if (parser == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	gattlib_address_set_ref(allowlist);
+	gattlib_address_set_unref(parser->allowlist);
+	parser->allowlist = allowlist;
+
+	gattlib_address_set_ref(denylist);
+	gattlib_address_set_unref(parser->denylist);
+	parser->denylist = denylist;
+	return GATTLIB_SUCCESS;
+}
+
+/**
+ * Decode the AD structures of the report data into the parser.
+ *
+ * A malformed AD structure ends the decoding. The AD structures decoded before it are kept.
+ */
+static int decode_ad_structures(gattlib_advertising_parser_t* parser, gattlib_advertising_report_t* report) {
+	const uint8_t* data = report->data;
+	size_t offset = 0;
+	size_t count = 0;
+
+	// An AD structure is at least 2 bytes long. Reserve the memory once for the report.
+	size_t max_count = report->data_length / 2 + 1;
+	if (max_count > parser->ad_capacity) {
+		gattlib_ad_structure_t* ad = realloc(parser->ad, max_count * sizeof(gattlib_ad_structure_t));
+		if (ad == NULL) {
+			return GATTLIB_OUT_OF_MEMORY;
+		}
+		parser->ad = ad;
+		parser->ad_capacity = max_count;
+	}
+
+	while (offset < report->data_length) {
+		uint8_t field_length = data[offset];
+
+		// A zero length ends the significant part of the data
+		if (field_length == 0) {
+			break;
+		}
+		if (offset + 1 + field_length > report->data_length) {
+			break;
+		}
+
+		parser->ad[count].type = data[offset + 1];
+		parser->ad[count].data_length = field_length - 1;
+		parser->ad[count].data = &data[offset + 2];
+
+		if ((parser->ad[count].type == AD_TYPE_TX_POWER_LEVEL) && (field_length == 2) &&
+		    (report->tx_power == GATTLIB_ADVERTISING_REPORT_TX_POWER_UNKNOWN)) {
+			report->tx_power = (int8_t)data[offset + 2];
+		}
+
+		count++;
+		offset += 1 + field_length;
+	}
+
+	report->ad = parser->ad;
+	report->ad_count = count;
+	return GATTLIB_SUCCESS;
+}
+
+static int deliver_report(gattlib_advertising_parser_t* parser, gattlib_adapter_t* adapter, gattlib_advertising_report_t* report,
+		gattlib_advertising_report_cb_t report_cb, void *user_data)
+{
+	uint64_t address = gattlib_address48_from_bytes(report->address);
+	int ret;
+
+	// Drop the report before decoding it
+	if (!gattlib_address_set_is_reported(parser->allowlist, parser->denylist, address)) {
+		return GATTLIB_SUCCESS;
+	}
+	if ((parser->filter != NULL) &&
+	    !gattlib_advertising_filter_match(parser->filter, address, report->rssi, report->data, report->data_length)) {
+		return GATTLIB_SUCCESS;
+	}
+
+	ret = decode_ad_structures(parser, report);
+	if (ret != GATTLIB_SUCCESS) {
+		return ret;
+	}
+
+	report_cb(adapter, report, user_data);
+	return GATTLIB_SUCCESS;
+}
+
+static int parse_advertising_reports(gattlib_advertising_parser_t* parser, gattlib_adapter_t* adapter,
+		const uint8_t* params, size_t params_length, gattlib_advertising_report_cb_t report_cb, void *user_data)
+{
+	gattlib_advertising_report_t report;
+	size_t offset = 1;
+	uint8_t i;
+	int ret;
+
+	for (i = 0; i < params[0]; i++) {
+		if (offset + ADVERTISING_REPORT_HEADER_SIZE > params_length) {
+			return GATTLIB_INVALID_PARAMETER;
+		}
+
+		const uint8_t* p = &params[offset];
+		uint8_t data_length = p[8];
+
+		// The data is followed by the RSSI
+		if (offset + ADVERTISING_REPORT_HEADER_SIZE + data_length + 1 > params_length) {
+			return GATTLIB_INVALID_PARAMETER;
+		}
+
+		memset(&report, 0, sizeof(report));
+		if (p[0] < sizeof(m_legacy_properties) / sizeof(m_legacy_properties[0])) {
+			report.properties = m_legacy_properties[p[0]];
+		} else {
+			report.properties = GATTLIB_ADVERTISING_REPORT_LEGACY;
+		}
+		report.address_type = p[1];
+		memcpy(report.address, &p[2], sizeof(report.address));
+		report.data = &p[9];
+		report.data_length = data_length;
+		report.rssi = (int8_t)p[9 + data_length];
+		report.tx_power = GATTLIB_ADVERTISING_REPORT_TX_POWER_UNKNOWN;
+		report.sid = 0xFF;
+
+		ret = deliver_report(parser, adapter, &report, report_cb, user_data);
+		if (ret != GATTLIB_SUCCESS) {
+			return ret;
+		}
+
+		offset += ADVERTISING_REPORT_HEADER_SIZE + data_length + 1;
+	}
+
+	return GATTLIB_SUCCESS;
+}
+
+static int parse_directed_advertising_reports(gattlib_advertising_parser_t* parser, gattlib_adapter_t* adapter,
+		const uint8_t* params, size_t params_length, gattlib_advertising_report_cb_t report_cb, void *user_data)
+{
+	gattlib_advertising_report_t report;
+	size_t offset = 1;
+	uint8_t i;
+	int ret;
+
+	for (i = 0; i < params[0]; i++) {
+		if (offset + DIRECTED_ADVERTISING_REPORT_SIZE > params_length) {
+			return GATTLIB_INVALID_PARAMETER;
+		}
+
+		const uint8_t* p = &params[offset];
+
+		memset(&report, 0, sizeof(report));
+		report.properties = GATTLIB_ADVERTISING_REPORT_CONNECTABLE | GATTLIB_ADVERTISING_REPORT_DIRECTED |
+				GATTLIB_ADVERTISING_REPORT_LEGACY;
+		report.address_type = p[1];
+		memcpy(report.address, &p[2], sizeof(report.address));
+		report.rssi = (int8_t)p[15];
+		report.tx_power = GATTLIB_ADVERTISING_REPORT_TX_POWER_UNKNOWN;
+		report.sid = 0xFF;
+
+		ret = deliver_report(parser, adapter, &report, report_cb, user_data);
+		if (ret != GATTLIB_SUCCESS) {
+			return ret;
+		}
+
+		offset += DIRECTED_ADVERTISING_REPORT_SIZE;
+	}
+
+	return GATTLIB_SUCCESS;
+}
+
+static struct advertising_fragment* fragment_lookup(gattlib_advertising_parser_t* parser, const gattlib_advertising_report_t* report) {
+	int i;
+
+	for (i = 0; i < ADVERTISING_PARSER_FRAGMENT_SLOTS; i++) {
+		struct advertising_fragment* fragment = &parser->fragments[i];
+
+		if (fragment->is_used && (fragment->sid == report->sid) && (fragment->address_type == report->address_type) &&
+		    (memcmp(fragment->address, report->address, sizeof(fragment->address)) == 0)) {
+			return fragment;
+		}
+	}
+	return NULL;
+}
+
+static struct advertising_fragment* fragment_new(gattlib_advertising_parser_t* parser, const gattlib_advertising_report_t* report) {
+	struct advertising_fragment* fragment = NULL;
+	int i;
+
+	// Use a free slot or reuse the slot of the oldest advertising set
+	for (i = 0; i < ADVERTISING_PARSER_FRAGMENT_SLOTS; i++) {
+		if (!parser->fragments[i].is_used) {
+			fragment = &parser->fragments[i];
+			break;
+		} else if ((fragment == NULL) || (parser->fragments[i].sequence < fragment->sequence)) {
+			fragment = &parser->fragments[i];
+		}
+	}
+
+	fragment->is_used = true;
+	memcpy(fragment->address, report->address, sizeof(fragment->address));
+	fragment->address_type = report->address_type;
+	fragment->sid = report->sid;
+	fragment->sequence = parser->fragment_sequence++;
+	fragment->data_length = 0;
+	return fragment;
+}
+
+// Return false if the data does not fit in the fragment
+static bool fragment_append(struct advertising_fragment* fragment, const uint8_t* data, size_t data_length) {
+	if (fragment->data_length + data_length > sizeof(fragment->data)) {
+		data_length = sizeof(fragment->data) - fragment->data_length;
+		memcpy(&fragment->data[fragment->data_length], data, data_length);
+		fragment->data_length += data_length;
+		return false;
+	}
+
+	memcpy(&fragment->data[fragment->data_length], data, data_length);
+	fragment->data_length += data_length;
+	return true;
+}
+
+static int parse_extended_advertising_reports(gattlib_advertising_parser_t* parser, gattlib_adapter_t* adapter,
+		const uint8_t* params, size_t params_length, gattlib_advertising_report_cb_t report_cb, void *user_data)
+{
+	gattlib_advertising_report_t report;
+	struct advertising_fragment* fragment;
+	size_t offset = 1;
+	uint8_t i;
+	int ret;
+
+	for (i = 0; i < params[0]; i++) {
+		if (offset + EXTENDED_ADVERTISING_REPORT_HEADER_SIZE > params_length) {
+			return GATTLIB_INVALID_PARAMETER;
+		}
+
+		const uint8_t* p = &params[offset];
+		uint16_t event_type = p[0] | (p[1] << 8);
+		uint8_t data_length = p[23];
+		uint8_t data_status = EXTENDED_DATA_STATUS(event_type);
+
+		if (offset + EXTENDED_ADVERTISING_REPORT_HEADER_SIZE + data_length > params_length) {
+			return GATTLIB_INVALID_PARAMETER;
+		}
+
+		memset(&report, 0, sizeof(report));
+		report.properties = event_type & (GATTLIB_ADVERTISING_REPORT_CONNECTABLE | GATTLIB_ADVERTISING_REPORT_SCANNABLE |
+				GATTLIB_ADVERTISING_REPORT_DIRECTED | GATTLIB_ADVERTISING_REPORT_SCAN_RESPONSE |
+				GATTLIB_ADVERTISING_REPORT_LEGACY);
+		report.address_type = p[2];
+		memcpy(report.address, &p[3], sizeof(report.address));
+		report.primary_phy = p[9];
+		report.secondary_phy = p[10];
+		report.sid = p[11];
+		report.tx_power = (int8_t)p[12];
+		report.rssi = (int8_t)p[13];
+		report.data = &p[EXTENDED_ADVERTISING_REPORT_HEADER_SIZE];
+		report.data_length = data_length;
+
+		offset += EXTENDED_ADVERTISING_REPORT_HEADER_SIZE + data_length;
+
+		fragment = fragment_lookup(parser, &report);
+
+		if (data_status == EXTENDED_DATA_STATUS_INCOMPLETE) {
+			// Keep the data until the last report of the advertising set
+			if (fragment == NULL) {
+				fragment = fragment_new(parser, &report);
+			}
+			fragment_append(fragment, report.data, report.data_length);
+			continue;
+		}
+
+		if (data_status != EXTENDED_DATA_STATUS_COMPLETE) {
+			report.properties |= GATTLIB_ADVERTISING_REPORT_TRUNCATED;
+		}
+
+		if (fragment != NULL) {
+			if (!fragment_append(fragment, report.data, report.data_length)) {
+				report.properties |= GATTLIB_ADVERTISING_REPORT_TRUNCATED;
+			}
+			report.data = fragment->data;
+			report.data_length = fragment->data_length;
+		}
+
+		ret = deliver_report(parser, adapter, &report, report_cb, user_data);
+
+		if (fragment != NULL) {
+			fragment->is_used = false;
+		}
+		if (ret != GATTLIB_SUCCESS) {
+			return ret;
+		}
+	}
+
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_advertising_parser_parse_hci_event(gattlib_advertising_parser_t* parser, gattlib_adapter_t* adapter,
+		const uint8_t* event, size_t event_length, gattlib_advertising_report_cb_t report_cb, void *user_data)
+{
+	const uint8_t* params;
+	size_t params_length;
+
+	if ((parser == NULL) || (event == NULL) || (report_cb == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	// Event code and parameter length
+	if (event_length < 2) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+	if (event[0] != HCI_EVENT_LE_META) {
+		return GATTLIB_SUCCESS;
+	}
+
+	params_length = event[1];
+	if (params_length + 2 > event_length) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	// Subevent code and number of reports
+	if (params_length < 2) {
+		return GATTLIB_SUCCESS;
+	}
+
+	params = &event[3];
+	params_length -= 1;
+
+	switch (event[2]) {
+	case HCI_LE_SUBEVENT_ADVERTISING_REPORT:
+		return parse_advertising_reports(parser, adapter, params, params_length, report_cb, user_data);
+	case HCI_LE_SUBEVENT_DIRECTED_ADVERTISING_REPORT:
+		return parse_directed_advertising_reports(parser, adapter, params, params_length, report_cb, user_data);
+	case HCI_LE_SUBEVENT_EXTENDED_ADVERTISING_REPORT:
+		return parse_extended_advertising_reports(parser, adapter, params, params_length, report_cb, user_data);
+	default:
+		return GATTLIB_SUCCESS;
+	}
+}
@@ -46,44 +46,65 @@ ON_ERROR:
 }
 #endif
 
-static gpointer _gattlib_connected_device_thread(gpointer data) {
-	gattlib_connection_t* connection = data;
-	const gchar *device_mac_address = org_bluez_device1_get_address(connection->backend.device);
-
-	// Mutex to ensure the handler is valid
+struct gattlib_connected_device_task_args {
+	gattlib_connection_t* connection;
+	gatt_connect_cb_t connection_handler;
+	void* user_data;
+	// Only used to report a connection failure
+	char* dst;
+	int error;
+};
+
+static void _gattlib_connected_device_task(void* data) {
+	struct gattlib_connected_device_task_args* args = data;
+	gattlib_connection_t* connection = args->connection;
+	char* device_mac_address = NULL;
+
+	// Mutex to ensure the connection is still valid
 	g_rec_mutex_lock(&m_gattlib_mutex);
 
 	if (!gattlib_connection_is_connected(connection)) {
-		GATTLIB_LOG(GATTLIB_ERROR, "_gattlib_connected_device_thread: Device is not connected (state:%s)",
+		GATTLIB_LOG(GATTLIB_ERROR, "_gattlib_connected_device_task: Device is not connected (state:%s)",
 			device_state_str[connection->device->state]);
 		g_rec_mutex_unlock(&m_gattlib_mutex);
-		return NULL;
+		goto EXIT;
 	}
 
-	if (!gattlib_has_valid_handler(&connection->on_connection)) {
-		GATTLIB_LOG(GATTLIB_ERROR, "_gattlib_connected_device_thread: Handler is not valid");
-		g_rec_mutex_unlock(&m_gattlib_mutex);
-		return NULL;
-	}
-
-	// Ensure we increment device reference counter to prevent the device/connection is freed during the execution
-	gattlib_device_ref(connection->device);
+	device_mac_address = g_strdup(org_bluez_device1_get_address(connection->backend.device));
 
 	// We need to release the lock here to ensure the connection callback that is actually
 	// doing the application sepcific work is not locking the BLE state.
 	g_rec_mutex_unlock(&m_gattlib_mutex);
 
-	connection->on_connection.callback.connection_handler(
+	args->connection_handler(
 		connection->device->adapter, device_mac_address, connection, 0 /* no error */,
-		connection->on_connection.user_data);
+		args->user_data);
 
+	g_free(device_mac_address);
+
+EXIT:
+	// Release the reference taken when the task has been queued
 	gattlib_device_unref(connection->device);
-	return NULL;
+	free(args);
+}
+
+static struct gattlib_connected_device_task_args* _connected_device_task_args_new(gattlib_connection_t* connection) {
+	struct gattlib_connected_device_task_args* task_args = calloc(sizeof(struct gattlib_connected_device_task_args), 1);
+	if (task_args == NULL) {
+		return NULL;
+	}
+	task_args->connection = connection;
+	task_args->connection_handler = connection->on_connection.callback.connection_handler;
+	task_args->user_data = connection->on_connection.user_data;
+
+	// Ensure we increment device reference counter to prevent the device/connection is freed before the task is executed
+	gattlib_device_ref(connection->device);
+	return task_args;
 }
 
-static void* _connected_device_thread_args_allocator(va_list args) {
+static void* _connected_device_task_args_allocator(va_list args) {
 	gattlib_connection_t* connection = va_arg(args, gattlib_connection_t*);
-	return connection;
+	return _connected_device_task_args_new(connection);
 }
 
 void gattlib_on_connected_device(gattlib_connection_t* connection) {
@@ -92,15 +113,64 @@ void gattlib_on_connected_device(gattlib_connection_t* connection) {
 		return;
 	}
 
-	gattlib_handler_dispatch_to_thread(
+	gattlib_handler_dispatch_to_executor(
+		connection->serial_queue,
 		&connection->on_connection,
 #if defined(WITH_PYTHON)
 		gattlib_connected_device_python_callback /* python_callback */,
 #else
 		NULL, // No Python support. So we do not need to check the callback against Python callback
 #endif
-		_gattlib_connected_device_thread /* thread_func */,
-		"gattlib_connected_device" /* thread_name */,
-		_connected_device_thread_args_allocator /* thread_args_allocator */,
+		_gattlib_connected_device_task /* task_func */,
+		// The application commonly runs its logic from the connection callback. It must not prevent
+		// the notifications of the connection to be delivered. They might run concurrently with it
+		// (see gattlib_executor_set_max_threads()).
+		GATTLIB_TASK_DETACHED /* task_flags */,
+		_connected_device_task_args_allocator /* task_args_allocator */,
 		connection);
 }
+
+static void _gattlib_connection_failure_task(void* data) {
+	struct gattlib_connected_device_task_args* args = data;
+
+	args->connection_handler(args->connection->device->adapter, args->dst, NULL, args->error, args->user_data);
+
+	// Release the reference taken when the task has been queued
+	gattlib_device_unref(args->connection->device);
+	free(args->dst);
+	free(args);
+}
+
+static void* _connection_failure_task_args_allocator(va_list args) {
+	gattlib_connection_t* connection = va_arg(args, gattlib_connection_t*);
+	const char* dst = va_arg(args, const char*);
+	int error = va_arg(args, int);
+
+	struct gattlib_connected_device_task_args* task_args = _connected_device_task_args_new(connection);
+	if (task_args == NULL) {
+		return NULL;
+	}
+	task_args->dst = strdup(dst);
+	task_args->error = error;
+	return task_args;
+}
+
+void gattlib_on_connection_failure(gattlib_connection_t* connection, const char* dst, int error) {
+	if (!gattlib_connection_is_valid(connection)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_on_connection_failure: Device is not valid");
+		return;
+	}
+
+	gattlib_handler_dispatch_to_executor(
+		connection->serial_queue,
+		&connection->on_connection,
+#if defined(WITH_PYTHON)
+		gattlib_connected_device_python_callback /* python_callback */,
+#else
+		NULL, // No Python support. So we do not need to check the callback against Python callback
+#endif
+		_gattlib_connection_failure_task /* task_func */,
+		0 /* task_flags */,
+		_connection_failure_task_args_allocator /* task_args_allocator */,
+		connection, dst, error);
+}
@@ -30,6 +30,53 @@ void gattlib_disconnected_device_python_callback(gattlib_connection_t* connectio
 }
 #endif
 
+struct gattlib_disconnected_device_task_args {
+	gattlib_connection_t* connection;
+	// Copy of the handlers at the time of the disconnection
+	struct gattlib_handler on_disconnection;
+	struct gattlib_handler on_disconnect_complete;
+};
+
+static void _gattlib_disconnected_device_task(void* data) {
+	struct gattlib_disconnected_device_task_args* args = data;
+	gattlib_connection_t* connection = args->connection;
+
+	if (gattlib_has_valid_handler(&args->on_disconnection)) {
+		args->on_disconnection.callback.disconnection_handler(connection, args->on_disconnection.user_data);
+	}
+
+	if (gattlib_has_valid_handler(&args->on_disconnect_complete)) {
+		args->on_disconnect_complete.callback.disconnect_handler(connection, GATTLIB_SUCCESS,
+			args->on_disconnect_complete.user_data);
+	}
+
+	// Release the reference taken when the task has been queued
+	gattlib_device_unref(connection->device);
+	free(args);
+}
+
+static struct gattlib_disconnected_device_task_args* _disconnected_device_task_args_new(gattlib_connection_t* connection) {
+	struct gattlib_disconnected_device_task_args* task_args = calloc(sizeof(struct gattlib_disconnected_device_task_args), 1);
+	if (task_args == NULL) {
+		return NULL;
+	}
+	task_args->connection = connection;
+	task_args->on_disconnection = connection->on_disconnection;
+	task_args->on_disconnect_complete = connection->on_disconnect_complete;
+
+	// The disconnect callback is a one-off callback
+	connection->on_disconnect_complete.callback.callback = NULL;
+
+	// Ensure we increment device reference counter to prevent the device/connection is freed before the task is executed
+	gattlib_device_ref(connection->device);
+	return task_args;
+}
+
+static void* _disconnected_device_task_args_allocator(va_list args) {
+	gattlib_connection_t* connection = va_arg(args, gattlib_connection_t*);
+	return _disconnected_device_task_args_new(connection);
+}
+
 void gattlib_on_disconnected_device(gattlib_connection_t* connection) {
 	g_rec_mutex_lock(&m_gattlib_mutex);
 
@@ -39,27 +86,47 @@ void gattlib_on_disconnected_device(gattlib_connection_t* connection) {
 		return;
 	}
 
+	// Wake up the threads waiting for this disconnection before the callbacks are queued. A thread might be
+	// waiting from a callback running on the serial queue of this connection, ahead of the disconnection task.
+	gattlib_completion_complete(&connection->disconnection, GATTLIB_SUCCESS);
+
+	// The disconnection callbacks are queued behind the pending notifications of the connection
 	if (gattlib_has_valid_handler(&connection->on_disconnection)) {
+		gattlib_handler_dispatch_to_executor(
+			connection->serial_queue,
+			&connection->on_disconnection,
 #if defined(WITH_PYTHON)
-		// Check if we are using the Python callback, in case of Python argument we keep track of the argument to free them
-		// once we are done with the handler.
-		if ((gattlib_disconnection_handler_t)connection->on_disconnection.callback.callback == gattlib_disconnected_device_python_callback) {
-			connection->on_disconnection.python_args = connection->on_disconnection.user_data;
-		}
+			gattlib_disconnected_device_python_callback /* python_callback */,
+#else
+			NULL, // No Python support. So we do not need to check the callback against Python callback
 #endif
+			_gattlib_disconnected_device_task /* task_func */,
+			0 /* task_flags */,
+			_disconnected_device_task_args_allocator /* task_args_allocator */,
+			connection);
+	} else if (gattlib_has_valid_handler(&connection->on_disconnect_complete)) {
+		// Without disconnection handler, we still need a task to call the callback of gattlib_disconnect_async()
+		struct gattlib_disconnected_device_task_args* task_args = _disconnected_device_task_args_new(connection);
+		if (task_args == NULL) {
+			GATTLIB_LOG(GATTLIB_ERROR, "gattlib_on_disconnected_device: Failed to allocate task arguments");
+		} else if (gattlib_serial_queue_push(connection->serial_queue, _gattlib_disconnected_device_task, task_args, 0) != GATTLIB_SUCCESS) {
+			_gattlib_disconnected_device_task(task_args);
+		}
+	}
 
-		// For GATT disconnection we do not use thread to ensure the callback is synchronous.
-		connection->on_disconnection.callback.disconnection_handler(connection, connection->on_disconnection.user_data);
+	// The link is lost when the disconnection has not been requested by gattlib_disconnect()
+	bool is_link_lost = (connection->device->state == CONNECTED);
+	char* dst = NULL;
+	if (is_link_lost && (connection->reconnect != NULL) && (connection->backend.device != NULL)) {
+		dst = g_strdup(org_bluez_device1_get_address(connection->backend.device));
 	}
 
 	// Clean GATTLIB connection on disconnection
 	gattlib_connection_free(connection);
 
-	g_rec_mutex_unlock(&m_gattlib_mutex);
+	// Reconnect the device if the application has enabled the automatic reconnection
+	gattlib_reconnect_on_disconnection(connection, is_link_lost, dst);
+	g_free(dst);
 
-	// Signal the device is now disconnected
-	g_mutex_lock(&m_gattlib_signal.mutex);
-	m_gattlib_signal.signals |= GATTLIB_SIGNAL_DEVICE_DISCONNECTION;
-	g_cond_broadcast(&m_gattlib_signal.condition);
-	g_mutex_unlock(&m_gattlib_signal.mutex);
+	g_rec_mutex_unlock(&m_gattlib_mutex);
 }
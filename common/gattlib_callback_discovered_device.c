@@ -45,15 +45,22 @@ ON_ERROR:
 }
 #endif
 
-struct gattlib_discovered_device_thread_args {
+struct gattlib_discovered_device_task_args {
 	struct _gattlib_adapter* gattlib_adapter;
 	char* mac_address;
 	char* name;
-	OrgBluezDevice1* device1;
+	// Time the advertisement has entered gattlib
+	uint64_t timestamp_ns;
+	// Advertisement data parsed when the event has been received. Only set if the callback expects them.
+	gattlib_advertisement_data_t* advertisement_data;
+	size_t advertisement_data_count;
+	gattlib_manufacturer_data_t* manufacturer_data;
+	size_t manufacturer_data_count;
 };
 
-static gpointer _gattlib_discovered_device_thread(gpointer data) {
-	struct gattlib_discovered_device_thread_args* args = data;
+static void _gattlib_discovered_device_task(void* data) {
+	struct gattlib_discovered_device_task_args* args = data;
+	struct gattlib_handler handler;
 
 	g_rec_mutex_lock(&m_gattlib_mutex);
 
@@ -67,60 +74,110 @@ static gpointer _gattlib_discovered_device_thread(gpointer data) {
 		goto EXIT;
 	}
 
-	// Increase adapter reference counter to ensure the adapter is not freed while
-	// the callback is in use.
-	gattlib_adapter_ref(args->gattlib_adapter);
+	// Copy the handler as the scan might be stopped while the callback is in use
+	handler = args->gattlib_adapter->discovered_device_callback;
 
 	g_rec_mutex_unlock(&m_gattlib_mutex);
 
-	args->gattlib_adapter->discovered_device_callback.callback.discovered_device(
-		args->gattlib_adapter,
-		args->mac_address, args->name,
-		args->gattlib_adapter->discovered_device_callback.user_data
-	);
+	if (handler.with_data) {
+		handler.callback.discovered_device_with_data(
+			args->gattlib_adapter,
+			args->mac_address, args->name,
+			args->advertisement_data, args->advertisement_data_count,
+			args->manufacturer_data, args->manufacturer_data_count,
+			handler.user_data
+		);
+	} else if (handler.with_timestamp) {
+		handler.callback.discovered_device_with_timestamp(
+			args->gattlib_adapter,
+			args->mac_address, args->name,
+			args->timestamp_ns,
+			handler.user_data
+		);
+	} else {
+		handler.callback.discovered_device(
+			args->gattlib_adapter,
+			args->mac_address, args->name,
+			handler.user_data
+		);
+	}
 
+EXIT:
+	// Release the reference taken when the task has been queued
 	gattlib_adapter_unref(args->gattlib_adapter);
 
-EXIT:
 	free(args->mac_address);
 	if (args->name != NULL) {
 		free(args->name);
 		args->name = NULL;
 	}
+	free_advertisement_data(args->advertisement_data, args->advertisement_data_count,
+		args->manufacturer_data, args->manufacturer_data_count);
 	free(args);
-	return NULL;
 }
 
-static void* _discovered_device_thread_args_allocator(va_list args) {
+static void* _discovered_device_task_args_allocator(va_list args) {
 	gattlib_adapter_t* gattlib_adapter = va_arg(args, gattlib_adapter_t*);
-	OrgBluezDevice1* device1 = va_arg(args, OrgBluezDevice1*);
-
-	struct gattlib_discovered_device_thread_args* thread_args = calloc(sizeof(struct gattlib_discovered_device_thread_args), 1);
-	thread_args->gattlib_adapter = gattlib_adapter;
-	thread_args->mac_address = strdup(org_bluez_device1_get_address(device1));
-	const char* device_name = org_bluez_device1_get_name(device1);
-	if (device_name != NULL) {
-		thread_args->name = strdup(device_name);
+	GDBusProxy* device1_proxy = va_arg(args, GDBusProxy*);
+	uint64_t timestamp_ns = va_arg(args, uint64_t);
+	GVariant* variant;
+
+	// The properties have been cached by the D-Bus signals that have notified the device.
+	// Reading them does not involve any D-Bus round trip.
+	variant = g_dbus_proxy_get_cached_property(device1_proxy, "Address");
+	if (variant == NULL) {
+		GATTLIB_LOG(GATTLIB_ERROR, "Discovered device '%s' has no address", g_dbus_proxy_get_object_path(device1_proxy));
+		return NULL;
+	}
+
+	struct gattlib_discovered_device_task_args* task_args = calloc(sizeof(struct gattlib_discovered_device_task_args), 1);
+	if (task_args == NULL) {
+		g_variant_unref(variant);
+		return NULL;
+	}
+	task_args->gattlib_adapter = gattlib_adapter;
+	task_args->mac_address = strdup(g_variant_get_string(variant, NULL));
+	g_variant_unref(variant);
+
+	variant = g_dbus_proxy_get_cached_property(device1_proxy, "Name");
+	if (variant != NULL) {
+		task_args->name = strdup(g_variant_get_string(variant, NULL));
+		g_variant_unref(variant);
 	} else {
-		thread_args->name = NULL;
+		task_args->name = NULL;
 	}
-	return thread_args;
+	task_args->timestamp_ns = timestamp_ns;
+
+	// The data are parsed now as the cached properties might have changed when the task is executed
+	if (gattlib_adapter->discovered_device_callback.with_data) {
+		int ret = get_advertisement_data_from_proxy(device1_proxy,
+				&task_args->advertisement_data, &task_args->advertisement_data_count,
+				&task_args->manufacturer_data, &task_args->manufacturer_data_count);
+		if (ret != GATTLIB_SUCCESS) {
+			GATTLIB_LOG(GATTLIB_ERROR, "Could not parse the advertisement data of '%s' (ret:%d)", task_args->mac_address, ret);
+		}
+	}
+
+	// Increase adapter reference counter to ensure the adapter is not freed before the task is executed
+	gattlib_adapter_ref(gattlib_adapter);
+	return task_args;
 }
 
-void gattlib_on_discovered_device(gattlib_adapter_t* gattlib_adapter, OrgBluezDevice1* device1) {
+void gattlib_on_discovered_device(gattlib_adapter_t* gattlib_adapter, GDBusProxy* device1_proxy, uint64_t timestamp_ns) {
 	if (!gattlib_adapter_is_valid(gattlib_adapter)) {
 		return;
 	}
 
-	gattlib_handler_dispatch_to_thread(
+	gattlib_handler_dispatch_to_executor(
+		gattlib_adapter->serial_queue,
 		&gattlib_adapter->discovered_device_callback,
 #if defined(WITH_PYTHON)
 		gattlib_discovered_device_python_callback /* python_callback */,
 #else
 		NULL, // No Python support. So we do not need to check the callback against Python callback
 #endif
-		_gattlib_discovered_device_thread /* thread_func */,
-		"gattlib_discovered_device" /* thread_name */,
-		_discovered_device_thread_args_allocator /* thread_args_allocator */,
-		gattlib_adapter, device1);
+		_gattlib_discovered_device_task /* task_func */,
+		0 /* task_flags */,
+		_discovered_device_task_args_allocator /* task_args_allocator */,
+		gattlib_adapter, device1_proxy, timestamp_ns);
 }
@@ -45,70 +45,102 @@ void gattlib_notification_device_python_callback(const uuid_t* uuid, const uint8
 }
 #endif
 
-struct gattlib_notification_device_thread_args {
+struct gattlib_notification_device_task_args {
 	gattlib_connection_t* connection;
-	uuid_t* uuid;
+	// Copy of the handler at the time the notification has been received
+	struct gattlib_handler handler;
+	uuid_t uuid;
 	uint8_t* data;
 	size_t data_length;
+	// Time the notification has entered gattlib
+	uint64_t timestamp_ns;
 };
 
-void gattlib_notification_device_thread(gpointer data, gpointer user_data) {
-	struct gattlib_notification_device_thread_args* args = data;
-	struct gattlib_handler* handler = user_data;
-
-	g_rec_mutex_lock(&m_gattlib_mutex);
-
-	if (!gattlib_connection_is_connected(args->connection)) {
-		g_rec_mutex_unlock(&m_gattlib_mutex);
-		return;
+void gattlib_handler_invoke_notification(struct gattlib_handler* handler, const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns)
+{
+	if (handler->with_timestamp) {
+		handler->callback.notification_with_timestamp_handler(uuid, data, data_length, timestamp_ns, handler->user_data);
+	} else {
+		handler->callback.notification_handler(uuid, data, data_length, handler->user_data);
 	}
+}
 
-	handler->callback.notification_handler(
-		args->uuid, args->data, args->data_length,
-		handler->user_data
-	);
+static void _gattlib_notification_device_task(void* data) {
+	struct gattlib_notification_device_task_args* args = data;
 
-	g_rec_mutex_unlock(&m_gattlib_mutex);
+	// We do not check the connection is still connected. The notifications received before the disconnection
+	// are delivered before the disconnection callback. The device reference keeps the connection alive.
+	gattlib_handler_invoke_notification(&args->handler, &args->uuid, args->data, args->data_length, args->timestamp_ns);
+
+	// Release the reference taken when the task has been queued
+	gattlib_device_unref(args->connection->device);
 
-	if (args->uuid != NULL) {
-		free(args->uuid);
-		args->uuid = NULL;
-	}
 	if (args->data != NULL) {
 		free(args->data);
 		args->data = NULL;
 	}
+	free(args);
 }
 
-static void* _notification_device_thread_args_allocator(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length) {
-	struct gattlib_notification_device_thread_args* thread_args = calloc(sizeof(struct gattlib_notification_device_thread_args), 1);
-	thread_args->connection = connection;
-	thread_args->uuid = calloc(sizeof(uuid_t), 1);
-	if (thread_args->uuid != NULL) {
-		memcpy(thread_args->uuid, uuid, sizeof(uuid_t));
+static void* _notification_device_task_args_allocator(va_list args) {
+	gattlib_connection_t* connection = va_arg(args, gattlib_connection_t*);
+	struct gattlib_handler* handler = va_arg(args, struct gattlib_handler*);
+	const uuid_t* uuid = va_arg(args, const uuid_t*);
+	const uint8_t* data = va_arg(args, const uint8_t*);
+	size_t data_length = va_arg(args, size_t);
+	uint64_t timestamp_ns = va_arg(args, uint64_t);
+
+	struct gattlib_notification_device_task_args* task_args = calloc(sizeof(struct gattlib_notification_device_task_args), 1);
+	if (task_args == NULL) {
+		return NULL;
 	}
-	thread_args->data = malloc(data_length);
-	if (thread_args->data != NULL) {
-		memcpy(thread_args->data, data, data_length);
+	task_args->connection = connection;
+	task_args->handler = *handler;
+	memcpy(&task_args->uuid, uuid, sizeof(uuid_t));
+	task_args->data = malloc(data_length);
+	if (task_args->data != NULL) {
+		memcpy(task_args->data, data, data_length);
 	}
-	thread_args->data_length = data_length;
+	task_args->data_length = data_length;
+	task_args->timestamp_ns = timestamp_ns;
 
-	return thread_args;
+	// Ensure we increment device reference counter to prevent the device/connection is freed before the task is executed
+	gattlib_device_ref(connection->device);
+	return task_args;
 }
 
-void gattlib_on_gatt_notification(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length) {
-	GError *error = NULL;
-
-	assert(connection->notification.thread_pool != NULL);
-
-	void* arg = _notification_device_thread_args_allocator(connection, uuid, data, data_length);
-	if (arg == NULL) {
-		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_on_gatt_notification: Failed to allocate arguments for thread");
+static void _gattlib_on_gatt_event(gattlib_connection_t* connection, struct gattlib_handler* handler,
+		const uuid_t* uuid, const uint8_t* data, size_t data_length, uint64_t timestamp_ns)
+{
+	// The application consumes the notifications from its own event loop
+	if (gattlib_notification_queue_push(connection, uuid, data, data_length, timestamp_ns)) {
 		return;
 	}
-	g_thread_pool_push(connection->notification.thread_pool, arg, &error);
-	if (error != NULL) {
-		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_on_gatt_notification: Failed to push thread in pool: %s", error->message);
-		g_error_free(error);
-	}
+
+	// The event is queued behind the connection callback of the same connection to preserve ordering
+	gattlib_handler_dispatch_to_executor(
+		connection->serial_queue,
+		handler,
+#if defined(WITH_PYTHON)
+		gattlib_notification_device_python_callback /* python_callback */,
+#else
+		NULL, // No Python support. So we do not need to check the callback against Python callback
+#endif
+		_gattlib_notification_device_task /* task_func */,
+		0 /* task_flags */,
+		_notification_device_task_args_allocator /* task_args_allocator */,
+		connection, handler, uuid, data, data_length, timestamp_ns);
+}
+
+void gattlib_on_gatt_notification(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns)
+{
+	_gattlib_on_gatt_event(connection, &connection->notification, uuid, data, data_length, timestamp_ns);
+}
+
+void gattlib_on_gatt_indication(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns)
+{
+	_gattlib_on_gatt_event(connection, &connection->indication, uuid, data, data_length, timestamp_ns);
 }
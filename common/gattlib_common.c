@@ -9,8 +9,9 @@
 #include "gattlib_internal.h"
 
 
-int gattlib_register_notification(gattlib_connection_t* connection, gattlib_event_handler_t notification_handler, void* user_data) {
-	GError *error = NULL;
+static int _gattlib_register_event_handler(gattlib_connection_t* connection, struct gattlib_handler* handler,
+		void (*callback)(void), bool with_timestamp, void* user_data, const char* function_name)
+{
 	int ret = GATTLIB_SUCCESS;
 
 	g_rec_mutex_lock(&m_gattlib_mutex);
@@ -21,66 +22,42 @@ int gattlib_register_notification(gattlib_connection_t* connection, gattlib_even
 	}
 
 	if (!gattlib_connection_is_valid(connection)) {
-		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_register_notification: Device not valid");
+		GATTLIB_LOG(GATTLIB_ERROR, "%s: Device not valid", function_name);
 		ret = GATTLIB_DEVICE_DISCONNECTED;
 		goto EXIT;
 	}
 
-	connection->notification.callback.notification_handler = notification_handler;
-	connection->notification.user_data = user_data;
-
-	connection->notification.thread_pool = g_thread_pool_new(
-		gattlib_notification_device_thread,
-		&connection->notification,
-		1 /* max_threads */, FALSE /* exclusive */, &error);
-	if (error != NULL) {
-		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_register_notification: Failed to create thread pool: %s", error->message);
-		g_error_free(error);
-		ret = GATTLIB_ERROR_INTERNAL;
-		goto EXIT;
-	} else {
-		assert(connection->notification.thread_pool != NULL);
-	}
+	handler->callback.callback = callback;
+	handler->with_timestamp = with_timestamp;
+	handler->user_data = user_data;
 
 EXIT:
 	g_rec_mutex_unlock(&m_gattlib_mutex);
 	return ret;
 }
 
-int gattlib_register_indication(gattlib_connection_t* connection, gattlib_event_handler_t indication_handler, void* user_data) {
-	GError *error = NULL;
-	int ret = GATTLIB_SUCCESS;
-
-	g_rec_mutex_lock(&m_gattlib_mutex);
-
-	if (connection == NULL) {
-		ret = GATTLIB_INVALID_PARAMETER;
-		goto EXIT;
-	}
+int gattlib_register_notification(gattlib_connection_t* connection, gattlib_event_handler_t notification_handler, void* user_data) {
+	return _gattlib_register_event_handler(connection, &connection->notification,
+		(void (*)(void))notification_handler, false /* with_timestamp */, user_data,
+		"gattlib_register_notification");
+}
 
-	if (!gattlib_connection_is_valid(connection)) {
-		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_register_indication: Device not valid");
-		ret = GATTLIB_DEVICE_DISCONNECTED;
-		goto EXIT;
-	}
+int gattlib_register_indication(gattlib_connection_t* connection, gattlib_event_handler_t indication_handler, void* user_data) {
+	return _gattlib_register_event_handler(connection, &connection->indication,
+		(void (*)(void))indication_handler, false /* with_timestamp */, user_data,
+		"gattlib_register_indication");
+}
 
-	connection->indication.callback.notification_handler = indication_handler;
-	connection->indication.user_data = user_data;
-
-	connection->indication.thread_pool = g_thread_pool_new(
-		gattlib_notification_device_thread,
-		&connection->indication,
-		1 /* max_threads */, FALSE /* exclusive */, &error);
-	if (error != NULL) {
-		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_register_indication: Failed to create thread pool: %s", error->message);
-		g_error_free(error);
-		ret = GATTLIB_ERROR_INTERNAL;
-		goto EXIT;
-	}
+int gattlib_register_notification_with_timestamp(gattlib_connection_t* connection, gattlib_event_with_timestamp_handler_t notification_handler, void* user_data) {
+	return _gattlib_register_event_handler(connection, &connection->notification,
+		(void (*)(void))notification_handler, true /* with_timestamp */, user_data,
+		"gattlib_register_notification_with_timestamp");
+}
 
-EXIT:
-	g_rec_mutex_unlock(&m_gattlib_mutex);
-	return ret;
+int gattlib_register_indication_with_timestamp(gattlib_connection_t* connection, gattlib_event_with_timestamp_handler_t indication_handler, void* user_data) {
+	return _gattlib_register_event_handler(connection, &connection->indication,
+		(void (*)(void))indication_handler, true /* with_timestamp */, user_data,
+		"gattlib_register_indication_with_timestamp");
 }
 
 int gattlib_register_on_disconnect(gattlib_connection_t *connection, gattlib_disconnection_handler_t handler, void* user_data) {
@@ -232,6 +209,56 @@ int gattlib_uuid_cmp(const uuid_t *uuid1, const uuid_t *uuid2) {
 	}
 }
 
+int gattlib_string_to_address48(const char *str, uint64_t *address) {
+	uint64_t value = 0;
+	int i;
+
+	if ((str == NULL) || (address == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	for (i = 0; i < 17; i++) {
+		char c = str[i];
+
+		if ((i % 3) == 2) {
+			if (c != ':') {
+				return GATTLIB_INVALID_PARAMETER;
+			}
+		} else if ((c >= '0') && (c <= '9')) {
+			value = (value << 4) | (c - '0');
+		} else if ((c >= 'a') && (c <= 'f')) {
+			value = (value << 4) | (c - 'a' + 10);
+		} else if ((c >= 'A') && (c <= 'F')) {
+			value = (value << 4) | (c - 'A' + 10);
+		} else {
+			return GATTLIB_INVALID_PARAMETER;
+		}
+	}
+
+	if (str[17] != '\0') {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	*address = value;
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_address48_to_string(uint64_t address, char *str, size_t size) {
+	if ((str == NULL) || (size < 18)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	snprintf(str, size, "%02X:%02X:%02X:%02X:%02X:%02X",
+			(unsigned)(address >> 40) & 0xFF, (unsigned)(address >> 32) & 0xFF, (unsigned)(address >> 24) & 0xFF,
+			(unsigned)(address >> 16) & 0xFF, (unsigned)(address >> 8) & 0xFF, (unsigned)address & 0xFF);
+	return GATTLIB_SUCCESS;
+}
+
+uint64_t gattlib_address48_from_bytes(const uint8_t* address) {
+	return ((uint64_t)address[5] << 40) | ((uint64_t)address[4] << 32) | ((uint64_t)address[3] << 24) |
+	       ((uint64_t)address[2] << 16) | ((uint64_t)address[1] << 8) | address[0];
+}
+
 void gattlib_handler_free(struct gattlib_handler* handler) {
 	if (!gattlib_has_valid_handler(handler)) {
 		return;
@@ -254,20 +281,17 @@ void gattlib_handler_free(struct gattlib_handler* handler) {
 		handler->python_args = NULL;
 	}
 #endif
-
-	if (handler->thread_pool != NULL) {
-		g_thread_pool_free(handler->thread_pool, FALSE /* immediate */, TRUE /* wait */);
-		handler->thread_pool = NULL;
-	}
 }
 
 bool gattlib_has_valid_handler(struct gattlib_handler* handler) {
 	return (handler != NULL) && (handler->callback.callback != NULL);
 }
 
-void gattlib_handler_dispatch_to_thread(struct gattlib_handler* handler, void (*python_callback)(),
-		GThreadFunc thread_func, const char* thread_name, void* (*thread_args_allocator)(va_list args), ...) {
-	GError *error = NULL;
+void gattlib_handler_dispatch_to_executor(struct gattlib_serial_queue* queue, struct gattlib_handler* handler, void (*python_callback)(),
+		void (*task_func)(void* args), uint32_t task_flags, void* (*task_args_allocator)(va_list args), ...)
+{
+	void* task_args;
+	int ret;
 
 	g_rec_mutex_lock(&m_gattlib_mutex);
 
@@ -285,20 +309,76 @@ void gattlib_handler_dispatch_to_thread(struct gattlib_handler* handler, void (*
 	}
 #endif
 
-	g_rec_mutex_unlock(&m_gattlib_mutex);
-
-	// We create a thread to ensure the callback is not blocking the mainloop
+	// The arguments are allocated with the lock to capture a consistent copy of the handler
 	va_list args;
-	va_start(args, thread_args_allocator);
-	void* thread_args = thread_args_allocator(args);
+	va_start(args, task_args_allocator);
+	task_args = task_args_allocator(args);
 	va_end(args);
 
-	handler->thread = g_thread_try_new(thread_name, thread_func, thread_args, &error);
-	if (handler->thread == NULL) {
-		GATTLIB_LOG(GATTLIB_ERROR, "Failed to create thread '%s': %s", thread_name, error->message);
-		g_error_free(error);
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	if (task_args == NULL) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_handler_dispatch_to_executor: Failed to allocate task arguments");
 		return;
 	}
+
+	// The callback is executed by the gattlib executor to ensure it is not blocking the mainloop
+	ret = gattlib_serial_queue_push(queue, task_func, task_args, task_flags);
+	if (ret != GATTLIB_SUCCESS) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_handler_dispatch_to_executor: Failed to queue task (%d). Execute it inline.", ret);
+		// We do not want to lose the event
+		task_func(task_args);
+	}
+}
+
+void gattlib_completion_init(struct gattlib_completion* completion) {
+	g_mutex_init(&completion->mutex);
+	g_cond_init(&completion->condition);
+	completion->is_completed = false;
+	completion->result = GATTLIB_SUCCESS;
+}
+
+void gattlib_completion_clear(struct gattlib_completion* completion) {
+	g_cond_clear(&completion->condition);
+	g_mutex_clear(&completion->mutex);
+}
+
+void gattlib_completion_reset(struct gattlib_completion* completion) {
+	g_mutex_lock(&completion->mutex);
+	completion->is_completed = false;
+	completion->result = GATTLIB_SUCCESS;
+	g_mutex_unlock(&completion->mutex);
+}
+
+void gattlib_completion_complete(struct gattlib_completion* completion, int result) {
+	g_mutex_lock(&completion->mutex);
+	if (!completion->is_completed) {
+		completion->is_completed = true;
+		completion->result = result;
+		g_cond_broadcast(&completion->condition);
+	}
+	g_mutex_unlock(&completion->mutex);
+}
+
+int gattlib_completion_wait_until(struct gattlib_completion* completion, gint64 end_time) {
+	int ret;
+
+	g_mutex_lock(&completion->mutex);
+
+	while (!completion->is_completed) {
+		if (!g_cond_wait_until(&completion->condition, &completion->mutex, end_time)) {
+			break;
+		}
+	}
+
+	if (completion->is_completed) {
+		ret = completion->result;
+	} else {
+		ret = GATTLIB_TIMEOUT;
+	}
+
+	g_mutex_unlock(&completion->mutex);
+	return ret;
 }
 
 // Helper function to free memory from Python frontend
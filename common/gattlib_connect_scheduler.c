@@ -0,0 +1,512 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <string.h>
+
+#include "gattlib_internal.h"
+
+// Maximum delay between two connection attempts of a request
+#define GATTLIB_CONNECT_SCHEDULER_MAX_BACKOFF_MS	30000
+// Maximum duration of a connection attempt. An attempt whose result has not been reported
+// by then fails with GATTLIB_TIMEOUT and releases its connection slot.
+#define GATTLIB_CONNECT_SCHEDULER_ATTEMPT_TIMEOUT_MS	30000
+
+// Note: The scheduler and its requests are protected by 'm_gattlib_mutex'
+struct gattlib_connect_scheduler {
+	// Queue of 'struct gattlib_connect_request*' waiting for a connection attempt sorted by priority
+	GQueue pending;
+	// Number of connection attempts in progress
+	unsigned int in_flight;
+	// True while '_scheduler_run()' is starting connection attempts
+	bool is_running;
+
+	unsigned int max_in_flight;
+	unsigned int max_retries;
+	unsigned int retry_backoff_ms;
+
+	gattlib_latency_histogram_t queueing_histogram;
+	gattlib_latency_histogram_t connect_histogram;
+
+	// Queue used to report the completed requests. It is not the adapter queue as the application
+	// might queue connection requests from its discovery callback and wait for their completion.
+	struct gattlib_serial_queue* serial_queue;
+};
+
+struct gattlib_connect_request {
+	gattlib_adapter_t* adapter;
+	char* dst;
+	unsigned long options;
+	int priority;
+	// Monotonic time in nanoseconds. 0 means no deadline.
+	uint64_t deadline_ns;
+
+	gattlib_scheduled_connect_cb_t callback;
+	void* user_data;
+
+	uint64_t enqueue_timestamp_ns;
+	uint64_t first_attempt_timestamp_ns;
+	uint64_t attempt_timestamp_ns;
+	unsigned int attempts;
+
+	// Result passed to the application callback
+	gattlib_connection_t* connection;
+	int error;
+	gattlib_connect_report_t report;
+};
+
+// Connection attempt of a request. It outlives the request when the attempt has expired before completing.
+struct gattlib_connect_attempt {
+	// NULL once the attempt has expired
+	struct gattlib_connect_request* request;
+	// Timer expiring the attempt. 0 once expired.
+	guint timeout_id;
+};
+
+static void _scheduler_run(gattlib_adapter_t* adapter);
+
+static struct gattlib_connect_scheduler* _scheduler_get(gattlib_adapter_t* adapter) {
+	struct gattlib_connect_scheduler* scheduler = adapter->connect_scheduler;
+
+	if (scheduler == NULL) {
+		scheduler = calloc(sizeof(struct gattlib_connect_scheduler), 1);
+		if (scheduler == NULL) {
+			return NULL;
+		}
+
+		scheduler->serial_queue = gattlib_serial_queue_new();
+		if (scheduler->serial_queue == NULL) {
+			free(scheduler);
+			return NULL;
+		}
+
+		g_queue_init(&scheduler->pending);
+		scheduler->max_in_flight = GATTLIB_CONNECT_SCHEDULER_DEFAULT_MAX_IN_FLIGHT;
+		scheduler->max_retries = GATTLIB_CONNECT_SCHEDULER_DEFAULT_MAX_RETRIES;
+		scheduler->retry_backoff_ms = GATTLIB_CONNECT_SCHEDULER_DEFAULT_BACKOFF_MS;
+
+		adapter->connect_scheduler = scheduler;
+	}
+
+	return scheduler;
+}
+
+static gint _request_priority_cmp(gconstpointer a, gconstpointer b, gpointer user_data) {
+	const struct gattlib_connect_request* queued_request = a;
+	const struct gattlib_connect_request* new_request = b;
+
+	// Keep the FIFO order between the requests of the same priority
+	return (queued_request->priority >= new_request->priority) ? -1 : 1;
+}
+
+// Errors that a new attempt might not hit. The permanent errors (eg: GATTLIB_INVALID_PARAMETER, GATTLIB_NOT_FOUND,
+// GATTLIB_NOT_SUPPORTED) complete the request at once. The backend maps the permanent D-Bus errors to them.
+static bool _is_transient_error(int error) {
+	return (error == GATTLIB_BUSY) || (error == GATTLIB_TIMEOUT) ||
+		((error & GATTLIB_ERROR_MODULE_MASK) == GATTLIB_ERROR_DBUS);
+}
+
+static void _connect_request_free(struct gattlib_connect_request* request) {
+	free(request->dst);
+	free(request);
+}
+
+static void _connect_request_complete_task(void* data) {
+	struct gattlib_connect_request* request = data;
+	gattlib_adapter_t* adapter = request->adapter;
+
+	request->callback(adapter, request->dst, request->connection, request->error, &request->report, request->user_data);
+
+	if (request->connection != NULL) {
+		gattlib_device_unref(request->connection->device);
+	}
+	_connect_request_free(request);
+
+	// Release the reference taken when the request has been queued
+	gattlib_adapter_unref(adapter);
+}
+
+/**
+ * Complete the request. The application callback is invoked from the executor.
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+static void _connect_request_complete(struct gattlib_connect_request* request, gattlib_connection_t* connection, int error) {
+	uint64_t now = gattlib_get_monotonic_time_ns();
+	int ret;
+
+	request->connection = connection;
+	request->error = error;
+
+	request->report.attempts = request->attempts;
+	if (request->attempts > 0) {
+		request->report.queueing_latency_ns = request->first_attempt_timestamp_ns - request->enqueue_timestamp_ns;
+		request->report.connect_latency_ns = now - request->attempt_timestamp_ns;
+	} else {
+		request->report.queueing_latency_ns = now - request->enqueue_timestamp_ns;
+	}
+	request->report.total_latency_ns = now - request->enqueue_timestamp_ns;
+
+	if (connection != NULL) {
+		// Keep the connection until the application has been notified
+		gattlib_device_ref(connection->device);
+	}
+
+	// The application might do its work from the callback. Do not delay the completion of the other requests.
+	ret = gattlib_serial_queue_push(request->adapter->connect_scheduler->serial_queue, _connect_request_complete_task, request,
+		GATTLIB_TASK_DETACHED);
+	if (ret != GATTLIB_SUCCESS) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_connect_scheduler: Failed to queue completion (%d). Execute it inline.", ret);
+		_connect_request_complete_task(request);
+	}
+}
+
+static gboolean _connect_request_retry(gpointer data) {
+	struct gattlib_connect_request* request = data;
+	gattlib_adapter_t* adapter = request->adapter;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	g_queue_insert_sorted(&adapter->connect_scheduler->pending, request, _request_priority_cmp, NULL);
+	_scheduler_run(adapter);
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	// We return FALSE when it is a one-off event
+	return FALSE;
+}
+
+// Delay before the next attempt of a request. The delay doubles at each attempt up to GATTLIB_CONNECT_SCHEDULER_MAX_BACKOFF_MS.
+static uint64_t _get_retry_backoff_ms(const struct gattlib_connect_scheduler* scheduler, unsigned int attempts) {
+	uint64_t backoff_ms = scheduler->retry_backoff_ms;
+	unsigned int i;
+
+	for (i = 1; (i < attempts) && (backoff_ms < GATTLIB_CONNECT_SCHEDULER_MAX_BACKOFF_MS); i++) {
+		backoff_ms *= 2;
+	}
+
+	if (backoff_ms > GATTLIB_CONNECT_SCHEDULER_MAX_BACKOFF_MS) {
+		backoff_ms = GATTLIB_CONNECT_SCHEDULER_MAX_BACKOFF_MS;
+	}
+	return backoff_ms;
+}
+
+/**
+ * Release the connection slot of the attempt of the request and retry or complete the request
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+static void _connect_request_attempt_done(struct gattlib_connect_request* request, gattlib_connection_t* connection, int error) {
+	struct gattlib_connect_scheduler* scheduler = request->adapter->connect_scheduler;
+	uint64_t now = gattlib_get_monotonic_time_ns();
+
+	scheduler->in_flight--;
+	gattlib_latency_histogram_record(&scheduler->connect_histogram, now - request->attempt_timestamp_ns);
+
+	// Keep the error of the last attempt to report it if the request cannot be retried
+	request->error = error;
+
+	if (error == GATTLIB_SUCCESS) {
+		_connect_request_complete(request, connection, GATTLIB_SUCCESS);
+	} else if (_is_transient_error(error) && (request->attempts <= scheduler->max_retries)) {
+		uint64_t backoff_ms = _get_retry_backoff_ms(scheduler, request->attempts);
+
+		if ((request->deadline_ns != 0) && (now + backoff_ms * 1000000ULL >= request->deadline_ns)) {
+			GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_connect_scheduler: No time left to retry '%s'", request->dst);
+			_connect_request_complete(request, NULL, error);
+		} else {
+			GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_connect_scheduler: Retry to connect '%s' in %u ms (error:%d)",
+				request->dst, (unsigned int)backoff_ms, error);
+
+			// The request does not use a connection slot while waiting for its retry
+			g_timeout_add(backoff_ms, _connect_request_retry, request);
+		}
+	} else {
+		_connect_request_complete(request, NULL, error);
+	}
+}
+
+static void _on_scheduled_connect(gattlib_adapter_t* adapter, const char *dst, gattlib_connection_t* connection, int error, void* user_data) {
+	struct gattlib_connect_attempt* attempt = user_data;
+	struct gattlib_connect_request* request;
+	gattlib_adapter_t* scheduler_adapter;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	request = attempt->request;
+	if (attempt->timeout_id != 0) {
+		g_source_remove(attempt->timeout_id);
+	}
+	free(attempt);
+
+	if (request == NULL) {
+		// The attempt has expired and its request has already been retried or completed.
+		// Do not keep a connection nobody is waiting for.
+		if (error == GATTLIB_SUCCESS) {
+			GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_connect_scheduler: '%s' connected after its attempt has expired. Disconnect it.", dst);
+			gattlib_disconnect(connection, false /* wait_disconnection */);
+		}
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		return;
+	}
+
+	// Note: The request is freed once completed. Keep the adapter aside.
+	scheduler_adapter = request->adapter;
+	_connect_request_attempt_done(request, connection, error);
+
+	// A connection slot has been released
+	_scheduler_run(scheduler_adapter);
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+}
+
+/**
+ * Expire the connection attempt in progress
+ *
+ * The attempt fails with GATTLIB_TIMEOUT and its connection slot is released. It is retried unless the deadline
+ * of the request has been reached. The attempt is abandoned: its late result is dropped by '_on_scheduled_connect()'.
+ */
+static gboolean _connect_attempt_timeout(gpointer data) {
+	struct gattlib_connect_attempt* attempt = data;
+	struct gattlib_connect_request* request;
+	gattlib_adapter_t* adapter;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	attempt->timeout_id = 0;
+	request = g_steal_pointer(&attempt->request);
+	adapter = request->adapter;
+
+	GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_connect_scheduler: Attempt to connect '%s' has expired", request->dst);
+
+	_connect_request_attempt_done(request, NULL, GATTLIB_TIMEOUT);
+
+	// A connection slot has been released
+	_scheduler_run(adapter);
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	// We return FALSE when it is a one-off event
+	return FALSE;
+}
+
+/**
+ * Start the connection attempts of the pending requests while there are free connection slots
+ *
+ * The function does not nest: a call made while it is running (eg: from a callback invoked inline) returns
+ * immediately and the running loop serves the new requests and connection slots.
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+static void _scheduler_run(gattlib_adapter_t* adapter) {
+	struct gattlib_connect_scheduler* scheduler = adapter->connect_scheduler;
+	struct gattlib_connect_request* request;
+
+	if (scheduler->is_running) {
+		return;
+	}
+	scheduler->is_running = true;
+
+	while (scheduler->in_flight < scheduler->max_in_flight) {
+		request = g_queue_pop_head(&scheduler->pending);
+		if (request == NULL) {
+			break;
+		}
+
+		uint64_t now = gattlib_get_monotonic_time_ns();
+		uint64_t timeout_ms = GATTLIB_CONNECT_SCHEDULER_ATTEMPT_TIMEOUT_MS;
+
+		if ((request->deadline_ns != 0) && (now >= request->deadline_ns)) {
+			GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_connect_scheduler: Deadline of '%s' has expired", request->dst);
+			_connect_request_complete(request, NULL, (request->attempts > 0) ? request->error : GATTLIB_TIMEOUT);
+			continue;
+		}
+
+		struct gattlib_connect_attempt* attempt = calloc(sizeof(struct gattlib_connect_attempt), 1);
+		if (attempt == NULL) {
+			_connect_request_complete(request, NULL, GATTLIB_OUT_OF_MEMORY);
+			continue;
+		}
+		attempt->request = request;
+
+		if (request->attempts == 0) {
+			request->first_attempt_timestamp_ns = now;
+			gattlib_latency_histogram_record(&scheduler->queueing_histogram, now - request->enqueue_timestamp_ns);
+		}
+		request->attempts++;
+		request->attempt_timestamp_ns = now;
+		scheduler->in_flight++;
+
+		// Do not let a stuck attempt hold its connection slot. It does not outlive the deadline of the request either.
+		if ((request->deadline_ns != 0) && ((request->deadline_ns - now + 999999ULL) / 1000000ULL < timeout_ms)) {
+			timeout_ms = (request->deadline_ns - now + 999999ULL) / 1000000ULL;
+		}
+		attempt->timeout_id = g_timeout_add(timeout_ms, _connect_attempt_timeout, attempt);
+
+		// The result is reported to '_on_scheduled_connect()'. The errors returned by gattlib_connect() are not.
+		int ret = gattlib_connect(adapter, request->dst, request->options, _on_scheduled_connect, attempt);
+		if (ret != GATTLIB_SUCCESS) {
+			g_source_remove(attempt->timeout_id);
+			free(attempt);
+			_connect_request_attempt_done(request, NULL, ret);
+		}
+	}
+
+	scheduler->is_running = false;
+}
+
+int gattlib_adapter_connect_scheduler_configure(gattlib_adapter_t* adapter, unsigned int max_in_flight,
+		unsigned int max_retries, unsigned int retry_backoff_ms)
+{
+	struct gattlib_connect_scheduler* scheduler;
+	int ret = GATTLIB_SUCCESS;
+
+	if ((adapter == NULL) || (max_in_flight == 0)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_adapter_is_valid(adapter)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_adapter_connect_scheduler_configure: Adapter not valid");
+		ret = GATTLIB_ADAPTER_CLOSE;
+		goto EXIT;
+	}
+
+	scheduler = _scheduler_get(adapter);
+	if (scheduler == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	scheduler->max_in_flight = max_in_flight;
+	scheduler->max_retries = max_retries;
+	scheduler->retry_backoff_ms = retry_backoff_ms;
+
+	// More connection slots might be available
+	_scheduler_run(adapter);
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_adapter_connect_enqueue(gattlib_adapter_t* adapter, const char *dst, unsigned long options,
+		int priority, unsigned int timeout_ms,
+		gattlib_scheduled_connect_cb_t connect_cb, void* user_data)
+{
+	struct gattlib_connect_scheduler* scheduler;
+	struct gattlib_connect_request* request;
+	int ret = GATTLIB_SUCCESS;
+
+	if ((adapter == NULL) || (dst == NULL) || (connect_cb == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_adapter_is_valid(adapter)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_adapter_connect_enqueue: Adapter not valid");
+		ret = GATTLIB_ADAPTER_CLOSE;
+		goto EXIT;
+	}
+
+	scheduler = _scheduler_get(adapter);
+	if (scheduler == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	request = calloc(sizeof(struct gattlib_connect_request), 1);
+	if (request == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	request->dst = strdup(dst);
+	if (request->dst == NULL) {
+		free(request);
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	request->adapter = adapter;
+	request->options = options;
+	request->priority = priority;
+	request->callback = connect_cb;
+	request->user_data = user_data;
+	request->enqueue_timestamp_ns = gattlib_get_monotonic_time_ns();
+	if (timeout_ms > 0) {
+		request->deadline_ns = request->enqueue_timestamp_ns + (uint64_t)timeout_ms * 1000000ULL;
+	}
+
+	// The adapter must not be freed while the request has not completed
+	gattlib_adapter_ref(adapter);
+
+	g_queue_insert_sorted(&scheduler->pending, request, _request_priority_cmp, NULL);
+	_scheduler_run(adapter);
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_adapter_connect_scheduler_get_latency(gattlib_adapter_t* adapter,
+		gattlib_latency_histogram_t* queueing_histogram, gattlib_latency_histogram_t* connect_histogram, bool reset)
+{
+	struct gattlib_connect_scheduler* scheduler;
+	int ret = GATTLIB_SUCCESS;
+
+	if (adapter == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_adapter_is_valid(adapter)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_adapter_connect_scheduler_get_latency: Adapter not valid");
+		ret = GATTLIB_ADAPTER_CLOSE;
+		goto EXIT;
+	}
+
+	scheduler = _scheduler_get(adapter);
+	if (scheduler == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	if (queueing_histogram != NULL) {
+		memcpy(queueing_histogram, &scheduler->queueing_histogram, sizeof(gattlib_latency_histogram_t));
+	}
+	if (connect_histogram != NULL) {
+		memcpy(connect_histogram, &scheduler->connect_histogram, sizeof(gattlib_latency_histogram_t));
+	}
+
+	if (reset) {
+		memset(&scheduler->queueing_histogram, 0, sizeof(gattlib_latency_histogram_t));
+		memset(&scheduler->connect_histogram, 0, sizeof(gattlib_latency_histogram_t));
+	}
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+void gattlib_connect_scheduler_free(gattlib_adapter_t* adapter) {
+	struct gattlib_connect_scheduler* scheduler = g_steal_pointer(&adapter->connect_scheduler);
+
+	if (scheduler == NULL) {
+		return;
+	}
+
+	// Requests keep a reference on the adapter. So no request should be pending anymore.
+	if (!g_queue_is_empty(&scheduler->pending)) {
+		GATTLIB_LOG(GATTLIB_WARNING, "gattlib_connect_scheduler_free: %u connection requests have not been served",
+			g_queue_get_length(&scheduler->pending));
+		g_queue_clear_full(&scheduler->pending, (GDestroyNotify)_connect_request_free);
+	}
+	gattlib_serial_queue_unref(scheduler->serial_queue);
+	free(scheduler);
+}
@@ -68,6 +68,15 @@ int gattlib_device_set_state(gattlib_adapter_t* adapter, const char* device_id,
                 goto EXIT;
             }
 
+            // Queue to keep the connection, notification and disconnection callbacks of the device in order
+            device->connection.serial_queue = gattlib_serial_queue_new();
+            if (device->connection.serial_queue == NULL) {
+                GATTLIB_LOG(GATTLIB_ERROR, "gattlib_device_set_state: Cannot allocate device queue");
+                free(device);
+                ret = GATTLIB_OUT_OF_MEMORY;
+                goto EXIT;
+            }
+
             GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_device_set_state:%s: Set initial state %s", device_id, device_state_str[new_state]);
 
             device->reference_counter = 1;
@@ -75,6 +84,9 @@ int gattlib_device_set_state(gattlib_adapter_t* adapter, const char* device_id,
             device->device_id = g_strdup(device_id);
             device->state = new_state;
             device->connection.device = device;
+            gattlib_completion_init(&device->connection.disconnection);
+            gattlib_op_scheduler_init(&device->connection.op_scheduler);
+            device->characteristic_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
 
             adapter->devices = g_slist_append(adapter->devices, device);
         } else {
@@ -153,6 +165,18 @@ int gattlib_device_unref(gattlib_device_t* device) {
         goto EXIT;
     }
 
+    gattlib_notification_queue_free(&device->connection);
+    gattlib_serial_queue_unref(device->connection.serial_queue);
+    gattlib_completion_clear(&device->connection.disconnection);
+    gattlib_op_scheduler_clear(&device->connection.op_scheduler);
+    gattlib_reconnect_free(&device->connection);
+    if (device->connection.subscriptions != NULL) {
+        g_array_free(device->connection.subscriptions, TRUE);
+    }
+    g_hash_table_destroy(device->characteristic_cache);
+    if (device->write_coalescers != NULL) {
+        g_hash_table_destroy(device->write_coalescers);
+    }
     free(device);
 
 EXIT:
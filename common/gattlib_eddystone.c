@@ -20,43 +20,6 @@ const char *gattlib_eddystone_url_scheme_prefix[] = {
 };
 
 
-struct on_eddystone_discovered_device_arg {
-	gattlib_discovered_device_with_data_t discovered_device_cb;
-	void *user_data;
-};
-
-static void on_eddystone_discovered_device(gattlib_adapter_t* adapter, const char* addr, const char* name, void *user_data)
-{
-	struct on_eddystone_discovered_device_arg *callback_data = user_data;
-	gattlib_advertisement_data_t *advertisement_data = NULL;
-	size_t advertisement_data_count;
-	gattlib_manufacturer_data_t* manufacturer_data = NULL;
-	size_t manufacturer_data_count = 0;
-	int ret;
-
-	ret = gattlib_get_advertisement_data_from_mac(adapter, addr,
-			&advertisement_data, &advertisement_data_count,
-			&manufacturer_data, &manufacturer_data_count);
-	if (ret != 0) {
-		return;
-	}
-
-	callback_data->discovered_device_cb(adapter, addr, name,
-			advertisement_data, advertisement_data_count,
-			manufacturer_data, manufacturer_data_count,
-			callback_data->user_data);
-
-	if (advertisement_data != NULL) {
-		free(advertisement_data);
-	}
-	if (manufacturer_data != NULL) {
-		for (uintptr_t i = 0; i < manufacturer_data_count; i++) {
-			free(manufacturer_data[i].data);
-		}
-		free(manufacturer_data);
-	}
-}
-
 int gattlib_adapter_scan_eddystone(gattlib_adapter_t* adapter, int16_t rssi_threshold, uint32_t eddystone_types,
 		gattlib_discovered_device_with_data_t discovered_device_cb, size_t timeout, void *user_data)
 {
@@ -76,11 +39,7 @@ int gattlib_adapter_scan_eddystone(gattlib_adapter_t* adapter, int16_t rssi_thre
 		enabled_filters |= GATTLIB_DISCOVER_FILTER_USE_RSSI;
 	}
 
-	struct on_eddystone_discovered_device_arg callback_data = {
-			.discovered_device_cb = discovered_device_cb,
-			.user_data = user_data
-	};
-
-	return gattlib_adapter_scan_enable_with_filter(adapter, uuid_filter_list, rssi_threshold, enabled_filters,
-			on_eddystone_discovered_device, timeout, &callback_data);
+	// The advertisement data are passed with the discovered devices. There is no need to request them for each device.
+	return gattlib_adapter_scan_enable_with_data(adapter, uuid_filter_list, rssi_threshold, enabled_filters,
+			discovered_device_cb, timeout, user_data);
 }
@@ -0,0 +1,227 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include "gattlib_internal.h"
+
+// Maximum number of tasks executed from a serial queue before giving the thread back to the
+// other queues. It ensures a connection flooded with notifications does not starve the others.
+#define GATTLIB_SERIAL_QUEUE_BATCH_SIZE 16
+
+struct gattlib_task {
+	void (*func)(void* args);
+	void* args;
+	uint32_t flags;
+	// Time the task has been queued. Used to measure the dispatch latency.
+	uint64_t enqueue_timestamp_ns;
+};
+
+struct gattlib_serial_queue {
+	GMutex mutex;
+	// Queue of 'struct gattlib_task*'
+	GQueue tasks;
+	// True when the queue has been pushed to the executor or is being drained
+	bool is_scheduled;
+	gint reference_counter;
+};
+
+// Thread pool shared by all the callbacks of gattlib
+static GThreadPool* m_executor;
+static gint m_executor_max_threads = GATTLIB_EXECUTOR_DEFAULT_MAX_THREADS;
+static GMutex m_executor_mutex;
+
+static struct gattlib_serial_queue* _serial_queue_ref(struct gattlib_serial_queue* queue) {
+	g_atomic_int_inc(&queue->reference_counter);
+	return queue;
+}
+
+static int _executor_schedule(struct gattlib_serial_queue* queue);
+
+static void _serial_queue_drain(gpointer data, gpointer user_data) {
+	struct gattlib_serial_queue* queue = data;
+	struct gattlib_task* task;
+
+	for (size_t i = 0; ; i++) {
+		g_mutex_lock(&queue->mutex);
+
+		if ((i >= GATTLIB_SERIAL_QUEUE_BATCH_SIZE) && !g_queue_is_empty(&queue->tasks)) {
+			// Batch completed. Re-schedule the queue behind the other pending queues.
+			if (_executor_schedule(_serial_queue_ref(queue)) == GATTLIB_SUCCESS) {
+				g_mutex_unlock(&queue->mutex);
+				goto EXIT;
+			}
+			// The queue could not be re-scheduled. Keep draining it from this thread.
+			i = 0;
+		}
+
+		task = g_queue_pop_head(&queue->tasks);
+		if (task == NULL) {
+			queue->is_scheduled = false;
+			g_mutex_unlock(&queue->mutex);
+			goto EXIT;
+		}
+
+		if (task->flags & GATTLIB_TASK_DETACHED) {
+			bool is_draining = false;
+
+			// The task might block for a long time (eg: application work done in the connection callback).
+			// Its execution starts in order but we let the following tasks of the queue run on another thread.
+			if (g_queue_is_empty(&queue->tasks)) {
+				queue->is_scheduled = false;
+			} else if (_executor_schedule(_serial_queue_ref(queue)) != GATTLIB_SUCCESS) {
+				// The following tasks cannot run on another thread. Run them once the task has completed.
+				is_draining = true;
+			}
+			g_mutex_unlock(&queue->mutex);
+
+			gattlib_dispatch_latency_record(task->enqueue_timestamp_ns);
+			task->func(task->args);
+			free(task);
+
+			if (!is_draining) {
+				goto EXIT;
+			}
+			continue;
+		}
+		g_mutex_unlock(&queue->mutex);
+
+		gattlib_dispatch_latency_record(task->enqueue_timestamp_ns);
+		task->func(task->args);
+		free(task);
+	}
+
+EXIT:
+	gattlib_serial_queue_unref(queue);
+}
+
+static GThreadPool* _executor_get(void) {
+	GError *error = NULL;
+
+	g_mutex_lock(&m_executor_mutex);
+
+	if (m_executor == NULL) {
+		m_executor = g_thread_pool_new(_serial_queue_drain, NULL,
+			m_executor_max_threads, FALSE /* exclusive */, &error);
+		if (m_executor == NULL) {
+			GATTLIB_LOG(GATTLIB_ERROR, "gattlib_executor: Failed to create thread pool: %s", error->message);
+			g_error_free(error);
+		}
+	}
+
+	g_mutex_unlock(&m_executor_mutex);
+	return m_executor;
+}
+
+/**
+ * Push the serial queue to the executor. The caller gives its reference of the queue.
+ *
+ * @note On error, the reference is released and the caller stays in charge of the pending tasks
+ */
+static int _executor_schedule(struct gattlib_serial_queue* queue) {
+	GThreadPool* executor = _executor_get();
+	GError *error = NULL;
+
+	if (executor == NULL) {
+		gattlib_serial_queue_unref(queue);
+		return GATTLIB_ERROR_INTERNAL;
+	}
+
+	g_thread_pool_push(executor, queue, &error);
+	if (error != NULL) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_executor: Failed to push task: %s", error->message);
+		g_error_free(error);
+		gattlib_serial_queue_unref(queue);
+		return GATTLIB_ERROR_INTERNAL;
+	}
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_executor_set_max_threads(int max_threads) {
+	GError *error = NULL;
+	int ret = GATTLIB_SUCCESS;
+
+	if ((max_threads == 0) || (max_threads < -1)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_mutex_lock(&m_executor_mutex);
+
+	m_executor_max_threads = max_threads;
+
+	if (m_executor != NULL) {
+		if (!g_thread_pool_set_max_threads(m_executor, max_threads, &error)) {
+			GATTLIB_LOG(GATTLIB_ERROR, "gattlib_executor_set_max_threads: Failed to resize the executor: %s", error->message);
+			g_error_free(error);
+			ret = GATTLIB_ERROR_INTERNAL;
+		}
+	}
+
+	g_mutex_unlock(&m_executor_mutex);
+	return ret;
+}
+
+struct gattlib_serial_queue* gattlib_serial_queue_new(void) {
+	struct gattlib_serial_queue* queue = calloc(sizeof(struct gattlib_serial_queue), 1);
+	if (queue == NULL) {
+		return NULL;
+	}
+
+	g_mutex_init(&queue->mutex);
+	g_queue_init(&queue->tasks);
+	queue->reference_counter = 1;
+	return queue;
+}
+
+void gattlib_serial_queue_unref(struct gattlib_serial_queue* queue) {
+	if (queue == NULL) {
+		return;
+	}
+
+	if (!g_atomic_int_dec_and_test(&queue->reference_counter)) {
+		return;
+	}
+
+	// Tasks keep a reference on the object owning the queue. So no task should be pending anymore.
+	if (!g_queue_is_empty(&queue->tasks)) {
+		GATTLIB_LOG(GATTLIB_WARNING, "gattlib_serial_queue_unref: %u tasks have not been executed", g_queue_get_length(&queue->tasks));
+		g_queue_clear_full(&queue->tasks, free);
+	}
+	g_mutex_clear(&queue->mutex);
+	free(queue);
+}
+
+int gattlib_serial_queue_push(struct gattlib_serial_queue* queue, void (*task_func)(void* args), void* task_args, uint32_t flags) {
+	struct gattlib_task* task;
+	int ret = GATTLIB_SUCCESS;
+
+	if (queue == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	task = calloc(sizeof(struct gattlib_task), 1);
+	if (task == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	task->func = task_func;
+	task->args = task_args;
+	task->flags = flags;
+	task->enqueue_timestamp_ns = gattlib_get_monotonic_time_ns();
+
+	g_mutex_lock(&queue->mutex);
+	g_queue_push_tail(&queue->tasks, task);
+	if (!queue->is_scheduled) {
+		ret = _executor_schedule(_serial_queue_ref(queue));
+		if (ret == GATTLIB_SUCCESS) {
+			queue->is_scheduled = true;
+		} else {
+			// The task would not run until another task is pushed. Give it back to the caller.
+			g_queue_remove(&queue->tasks, task);
+			free(task);
+		}
+	}
+	g_mutex_unlock(&queue->mutex);
+
+	return ret;
+}
@@ -0,0 +1,755 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <string.h>
+
+#include "gattlib_internal.h"
+
+// Period of the check for devices with due jobs
+#define GATTLIB_FLEET_TICK_MS				100
+// Deadline given to the connection scheduler for each physical connection
+#define GATTLIB_FLEET_CONNECT_TIMEOUT_MS	10000
+// Delay before trying to connect again a device that has failed to connect
+#define GATTLIB_FLEET_RETRY_DELAY_MS		1000
+// Maximum time gattlib_fleet_stop() waits for the devices in use by the fleet. It covers the connection
+// deadline, a GATT operation in progress and the disconnection.
+#define GATTLIB_FLEET_STOP_TIMEOUT_MS		45000
+
+#define NSEC_PER_MSEC	1000000ULL
+
+enum gattlib_fleet_job_type {
+	GATTLIB_FLEET_JOB_READ,
+	GATTLIB_FLEET_JOB_WRITE,
+};
+
+// Note: The fleet objects are protected by 'm_gattlib_mutex'
+struct gattlib_fleet_job {
+	enum gattlib_fleet_job_type type;
+	// NULL when the job applies to all the devices of the fleet
+	char* dst;
+	uuid_t uuid;
+	// Value written by a write job
+	uint8_t* data;
+	size_t data_length;
+	uint64_t period_ns;
+	gattlib_fleet_job_cb_t callback;
+	void* user_data;
+	// The fleet and the devices executing the job hold a reference
+	unsigned int reference_counter;
+	// The job has been removed from the fleet. It completes its execution in progress.
+	bool is_removed;
+};
+
+struct gattlib_fleet_device_job {
+	struct gattlib_fleet_job* job;
+	uint64_t next_due_ns;
+};
+
+struct gattlib_fleet_device {
+	gattlib_fleet_t* fleet;
+	char* dst;
+	// List of 'struct gattlib_fleet_device_job*'
+	GSList* jobs;
+	// The device is being connected or is connected by the fleet
+	bool is_busy;
+	// Thread executing the jobs of the device. NULL if none.
+	GThread* job_thread;
+	// Do not try to connect the device before this time
+	uint64_t not_before_ns;
+	gattlib_fleet_device_stats_t stats;
+};
+
+struct _gattlib_fleet {
+	gattlib_adapter_t* adapter;
+	unsigned int max_connections;
+	unsigned int busy_count;
+
+	// List of 'struct gattlib_fleet_device*'
+	GSList* devices;
+	// List of 'struct gattlib_fleet_job*'
+	GSList* jobs;
+
+	bool is_started;
+	guint tick_id;
+	uint64_t start_timestamp_ns;
+	gattlib_fleet_stats_t stats;
+
+	// Completed when a device is released while the fleet is stopped
+	struct gattlib_completion device_released;
+	// The fleet has been destroyed while devices were still in use. The last of them frees it.
+	bool is_destroyed;
+};
+
+static void _fleet_schedule(gattlib_fleet_t* fleet);
+
+static struct gattlib_fleet_device* _fleet_get_device(gattlib_fleet_t* fleet, const char* dst) {
+	for (GSList* l = fleet->devices; l != NULL; l = l->next) {
+		struct gattlib_fleet_device* device = l->data;
+		if (g_ascii_strcasecmp(device->dst, dst) == 0) {
+			return device;
+		}
+	}
+	return NULL;
+}
+
+static int _fleet_device_add_job(gattlib_fleet_t* fleet, struct gattlib_fleet_device* device, struct gattlib_fleet_job* job) {
+	struct gattlib_fleet_device_job* device_job = calloc(sizeof(struct gattlib_fleet_device_job), 1);
+	if (device_job == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	device_job->job = job;
+	// A new job is due immediately
+	device_job->next_due_ns = gattlib_get_monotonic_time_ns();
+
+	device->jobs = g_slist_append(device->jobs, device_job);
+	return GATTLIB_SUCCESS;
+}
+
+static void _fleet_device_remove_job(struct gattlib_fleet_device* device, struct gattlib_fleet_job* job) {
+	for (GSList* l = device->jobs; l != NULL; l = l->next) {
+		struct gattlib_fleet_device_job* device_job = l->data;
+
+		if (device_job->job == job) {
+			device->jobs = g_slist_delete_link(device->jobs, l);
+			free(device_job);
+			return;
+		}
+	}
+}
+
+static void _fleet_device_free(gpointer data) {
+	struct gattlib_fleet_device* device = data;
+
+	g_slist_free_full(device->jobs, free);
+	free(device->dst);
+	free(device);
+}
+
+static struct gattlib_fleet_job* _fleet_job_ref(struct gattlib_fleet_job* job) {
+	job->reference_counter++;
+	return job;
+}
+
+static void _fleet_job_unref(gpointer data) {
+	struct gattlib_fleet_job* job = data;
+
+	job->reference_counter--;
+	if (job->reference_counter > 0) {
+		return;
+	}
+
+	free(job->dst);
+	free(job->data);
+	free(job);
+}
+
+static void _fleet_free(gattlib_fleet_t* fleet) {
+	gattlib_adapter_t* adapter = fleet->adapter;
+
+	g_slist_free_full(fleet->devices, _fleet_device_free);
+	g_slist_free_full(fleet->jobs, _fleet_job_unref);
+	gattlib_completion_clear(&fleet->device_released);
+	free(fleet);
+
+	gattlib_adapter_unref(adapter);
+}
+
+/**
+ * Release the connection slot used by the device and look for the next device to serve
+ *
+ * @note 'm_gattlib_mutex' must be held. The fleet might be freed on return.
+ */
+static void _fleet_device_release(struct gattlib_fleet_device* device) {
+	gattlib_fleet_t* fleet = device->fleet;
+
+	device->is_busy = false;
+	fleet->busy_count--;
+
+	if (fleet->is_destroyed) {
+		if (fleet->busy_count == 0) {
+			_fleet_free(fleet);
+		}
+		return;
+	}
+
+	if (!fleet->is_started) {
+		gattlib_completion_complete(&fleet->device_released, GATTLIB_SUCCESS);
+		return;
+	}
+
+	// Use the connection slot as soon as it is released
+	_fleet_schedule(fleet);
+}
+
+static void _fleet_device_run_jobs(struct gattlib_fleet_device* device, gattlib_connection_t* connection) {
+	gattlib_fleet_t* fleet = device->fleet;
+	GPtrArray* jobs = g_ptr_array_new_with_free_func(_fleet_job_unref);
+	uint64_t now = gattlib_get_monotonic_time_ns();
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	// Execute all the jobs that are due within half of their period to make the most of the connection.
+	// The jobs are referenced as they might be removed while they are executed.
+	for (GSList* l = device->jobs; l != NULL; l = l->next) {
+		struct gattlib_fleet_device_job* device_job = l->data;
+
+		if (device_job->next_due_ns <= now + device_job->job->period_ns / 2) {
+			g_ptr_array_add(jobs, _fleet_job_ref(device_job->job));
+		}
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	for (guint i = 0; i < jobs->len; i++) {
+		struct gattlib_fleet_job* job = g_ptr_array_index(jobs, i);
+		void* buffer = NULL;
+		size_t buffer_len = 0;
+		int ret;
+
+		g_rec_mutex_lock(&m_gattlib_mutex);
+		// Do not start new jobs once the fleet has been stopped
+		if (!fleet->is_started || job->is_removed) {
+			g_rec_mutex_unlock(&m_gattlib_mutex);
+			continue;
+		}
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+
+		if (job->type == GATTLIB_FLEET_JOB_WRITE) {
+			ret = gattlib_write_char_by_uuid(connection, &job->uuid, job->data, job->data_length);
+		} else {
+			ret = gattlib_read_char_by_uuid(connection, &job->uuid, &buffer, &buffer_len);
+		}
+
+		now = gattlib_get_monotonic_time_ns();
+
+		g_rec_mutex_lock(&m_gattlib_mutex);
+
+		if (ret == GATTLIB_SUCCESS) {
+			device->stats.jobs_completed++;
+			device->stats.last_update_ns = now;
+			fleet->stats.jobs_completed++;
+		} else {
+			device->stats.jobs_failed++;
+			fleet->stats.jobs_failed++;
+		}
+
+		for (GSList* l = device->jobs; l != NULL; l = l->next) {
+			struct gattlib_fleet_device_job* device_job = l->data;
+
+			if (device_job->job != job) {
+				continue;
+			}
+
+			if ((now > device_job->next_due_ns) && (now - device_job->next_due_ns > device->stats.max_lateness_ns)) {
+				device->stats.max_lateness_ns = now - device_job->next_due_ns;
+			}
+
+			// Keep the cadence of the job unless we are late by more than a period
+			device_job->next_due_ns += job->period_ns;
+			if (device_job->next_due_ns <= now) {
+				device_job->next_due_ns = now + job->period_ns;
+			}
+			break;
+		}
+
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+
+		job->callback(fleet, device->dst, &job->uuid, ret, buffer, buffer_len, job->user_data);
+
+		if (buffer != NULL) {
+			free(buffer);
+		}
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+	g_ptr_array_free(jobs, TRUE);
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+}
+
+static void _on_fleet_device_connect(gattlib_adapter_t* adapter, const char *dst, gattlib_connection_t* connection, int error,
+		const gattlib_connect_report_t* report, void* user_data)
+{
+	struct gattlib_fleet_device* device = user_data;
+
+	if (error != GATTLIB_SUCCESS) {
+		GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_fleet: Failed to connect '%s' (%d)", dst, error);
+
+		g_rec_mutex_lock(&m_gattlib_mutex);
+		device->stats.connection_failures++;
+		device->not_before_ns = gattlib_get_monotonic_time_ns() + GATTLIB_FLEET_RETRY_DELAY_MS * NSEC_PER_MSEC;
+		_fleet_device_release(device);
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		return;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+	device->stats.connections++;
+	device->fleet->stats.connections++;
+	device->job_thread = g_thread_self();
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	_fleet_device_run_jobs(device, connection);
+
+	// Release the physical connection for the other devices of the fleet
+	gattlib_disconnect(connection, true /* wait_disconnection */);
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+	device->job_thread = NULL;
+	_fleet_device_release(device);
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+}
+
+/**
+ * Connect the most overdue devices while there are free connection slots
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+static void _fleet_schedule(gattlib_fleet_t* fleet) {
+	uint64_t now = gattlib_get_monotonic_time_ns();
+	int ret;
+
+	if (!fleet->is_started) {
+		return;
+	}
+
+	while (fleet->busy_count < fleet->max_connections) {
+		struct gattlib_fleet_device* next_device = NULL;
+		uint64_t next_device_due_ns = UINT64_MAX;
+
+		for (GSList* l = fleet->devices; l != NULL; l = l->next) {
+			struct gattlib_fleet_device* device = l->data;
+
+			if (device->is_busy || (device->not_before_ns > now)) {
+				continue;
+			}
+
+			for (GSList* j = device->jobs; j != NULL; j = j->next) {
+				struct gattlib_fleet_device_job* device_job = j->data;
+
+				if ((device_job->next_due_ns <= now) && (device_job->next_due_ns < next_device_due_ns)) {
+					next_device = device;
+					next_device_due_ns = device_job->next_due_ns;
+				}
+			}
+		}
+
+		if (next_device == NULL) {
+			break;
+		}
+
+		next_device->is_busy = true;
+		fleet->busy_count++;
+
+		ret = gattlib_adapter_connect_enqueue(fleet->adapter, next_device->dst, GATTLIB_CONNECTION_OPTIONS_NONE,
+			0 /* priority */, GATTLIB_FLEET_CONNECT_TIMEOUT_MS,
+			_on_fleet_device_connect, next_device);
+		if (ret != GATTLIB_SUCCESS) {
+			GATTLIB_LOG(GATTLIB_ERROR, "gattlib_fleet: Failed to queue the connection of '%s' (%d)", next_device->dst, ret);
+			next_device->is_busy = false;
+			next_device->not_before_ns = now + GATTLIB_FLEET_RETRY_DELAY_MS * NSEC_PER_MSEC;
+			next_device->stats.connection_failures++;
+			fleet->busy_count--;
+		}
+	}
+}
+
+static gboolean _fleet_tick(gpointer data) {
+	gattlib_fleet_t* fleet = data;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+	_fleet_schedule(fleet);
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	return TRUE;
+}
+
+int gattlib_fleet_create(gattlib_adapter_t* adapter, unsigned int max_connections, gattlib_fleet_t** fleet) {
+	gattlib_fleet_t* new_fleet;
+	int ret = GATTLIB_SUCCESS;
+
+	if ((adapter == NULL) || (max_connections == 0) || (fleet == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_adapter_is_valid(adapter)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_fleet_create: Adapter not valid");
+		ret = GATTLIB_ADAPTER_CLOSE;
+		goto EXIT;
+	}
+
+	new_fleet = calloc(sizeof(gattlib_fleet_t), 1);
+	if (new_fleet == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	new_fleet->adapter = adapter;
+	new_fleet->max_connections = max_connections;
+	gattlib_completion_init(&new_fleet->device_released);
+
+	// The adapter must not be freed while the fleet is in use
+	gattlib_adapter_ref(adapter);
+
+	*fleet = new_fleet;
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_fleet_add_device(gattlib_fleet_t* fleet, const char* dst) {
+	struct gattlib_fleet_device* device;
+	int ret = GATTLIB_SUCCESS;
+
+	if ((fleet == NULL) || (dst == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (_fleet_get_device(fleet, dst) != NULL) {
+		ret = GATTLIB_BUSY;
+		goto EXIT;
+	}
+
+	device = calloc(sizeof(struct gattlib_fleet_device), 1);
+	if (device == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	device->fleet = fleet;
+	device->dst = strdup(dst);
+	if (device->dst == NULL) {
+		free(device);
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	// Add the jobs shared by all the devices of the fleet
+	for (GSList* l = fleet->jobs; l != NULL; l = l->next) {
+		struct gattlib_fleet_job* job = l->data;
+
+		if (job->dst == NULL) {
+			ret = _fleet_device_add_job(fleet, device, job);
+			if (ret != GATTLIB_SUCCESS) {
+				_fleet_device_free(device);
+				goto EXIT;
+			}
+		}
+	}
+
+	fleet->devices = g_slist_append(fleet->devices, device);
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_fleet_remove_device(gattlib_fleet_t* fleet, const char* dst) {
+	struct gattlib_fleet_device* device;
+	int ret = GATTLIB_SUCCESS;
+
+	if ((fleet == NULL) || (dst == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	device = _fleet_get_device(fleet, dst);
+	if (device == NULL) {
+		ret = GATTLIB_NOT_FOUND;
+		goto EXIT;
+	}
+
+	if (device->is_busy) {
+		ret = GATTLIB_BUSY;
+		goto EXIT;
+	}
+
+	fleet->devices = g_slist_remove(fleet->devices, device);
+	_fleet_device_free(device);
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+static int _fleet_add_job(gattlib_fleet_t* fleet, enum gattlib_fleet_job_type type, const char* dst, const uuid_t* uuid,
+		const void* data, size_t data_length, unsigned int period_ms, gattlib_fleet_job_cb_t job_cb, void* user_data)
+{
+	struct gattlib_fleet_device* device = NULL;
+	struct gattlib_fleet_job* job;
+	int ret = GATTLIB_SUCCESS;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (dst != NULL) {
+		device = _fleet_get_device(fleet, dst);
+		if (device == NULL) {
+			ret = GATTLIB_NOT_FOUND;
+			goto EXIT;
+		}
+	}
+
+	job = calloc(sizeof(struct gattlib_fleet_job), 1);
+	if (job == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+	job->reference_counter = 1;
+
+	if (dst != NULL) {
+		job->dst = strdup(dst);
+		if (job->dst == NULL) {
+			_fleet_job_unref(job);
+			ret = GATTLIB_OUT_OF_MEMORY;
+			goto EXIT;
+		}
+	}
+	if (data_length > 0) {
+		job->data = malloc(data_length);
+		if (job->data == NULL) {
+			_fleet_job_unref(job);
+			ret = GATTLIB_OUT_OF_MEMORY;
+			goto EXIT;
+		}
+		memcpy(job->data, data, data_length);
+	}
+	job->type = type;
+	job->data_length = data_length;
+	memcpy(&job->uuid, uuid, sizeof(uuid_t));
+	job->period_ns = (uint64_t)period_ms * NSEC_PER_MSEC;
+	job->callback = job_cb;
+	job->user_data = user_data;
+
+	fleet->jobs = g_slist_append(fleet->jobs, job);
+
+	if (device != NULL) {
+		ret = _fleet_device_add_job(fleet, device, job);
+	} else {
+		for (GSList* l = fleet->devices; l != NULL; l = l->next) {
+			ret = _fleet_device_add_job(fleet, l->data, job);
+			if (ret != GATTLIB_SUCCESS) {
+				break;
+			}
+		}
+	}
+
+	if (ret != GATTLIB_SUCCESS) {
+		// Do not leave the job on the devices it has already been added to
+		for (GSList* l = fleet->devices; l != NULL; l = l->next) {
+			_fleet_device_remove_job(l->data, job);
+		}
+		fleet->jobs = g_slist_remove(fleet->jobs, job);
+		_fleet_job_unref(job);
+	}
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_fleet_add_read_job(gattlib_fleet_t* fleet, const char* dst, const uuid_t* uuid, unsigned int period_ms,
+		gattlib_fleet_job_cb_t job_cb, void* user_data)
+{
+	if ((fleet == NULL) || (uuid == NULL) || (period_ms == 0) || (job_cb == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	return _fleet_add_job(fleet, GATTLIB_FLEET_JOB_READ, dst, uuid, NULL, 0, period_ms, job_cb, user_data);
+}
+
+int gattlib_fleet_add_write_job(gattlib_fleet_t* fleet, const char* dst, const uuid_t* uuid, const void* buffer, size_t buffer_len,
+		unsigned int period_ms, gattlib_fleet_job_cb_t job_cb, void* user_data)
+{
+	if ((fleet == NULL) || (uuid == NULL) || (buffer == NULL) || (buffer_len == 0) || (period_ms == 0) || (job_cb == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	return _fleet_add_job(fleet, GATTLIB_FLEET_JOB_WRITE, dst, uuid, buffer, buffer_len, period_ms, job_cb, user_data);
+}
+
+int gattlib_fleet_remove_job(gattlib_fleet_t* fleet, const char* dst, const uuid_t* uuid) {
+	int ret = GATTLIB_NOT_FOUND;
+	GSList* l;
+
+	if ((fleet == NULL) || (uuid == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	l = fleet->jobs;
+	while (l != NULL) {
+		struct gattlib_fleet_job* job = l->data;
+		GSList* next = l->next;
+
+		if ((gattlib_uuid_cmp(&job->uuid, uuid) == 0) &&
+		    (((dst == NULL) && (job->dst == NULL)) || ((dst != NULL) && (job->dst != NULL) && (g_ascii_strcasecmp(job->dst, dst) == 0)))) {
+			for (GSList* d = fleet->devices; d != NULL; d = d->next) {
+				_fleet_device_remove_job(d->data, job);
+			}
+
+			job->is_removed = true;
+			fleet->jobs = g_slist_delete_link(fleet->jobs, l);
+			_fleet_job_unref(job);
+			ret = GATTLIB_SUCCESS;
+		}
+
+		l = next;
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_fleet_start(gattlib_fleet_t* fleet) {
+	uint64_t now = gattlib_get_monotonic_time_ns();
+	int ret = GATTLIB_SUCCESS;
+
+	if (fleet == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (fleet->is_started) {
+		ret = GATTLIB_BUSY;
+		goto EXIT;
+	}
+
+	// All the jobs are due when the fleet starts
+	for (GSList* l = fleet->devices; l != NULL; l = l->next) {
+		struct gattlib_fleet_device* device = l->data;
+
+		for (GSList* j = device->jobs; j != NULL; j = j->next) {
+			struct gattlib_fleet_device_job* device_job = j->data;
+			device_job->next_due_ns = now;
+		}
+	}
+
+	fleet->is_started = true;
+	fleet->start_timestamp_ns = now;
+	fleet->tick_id = g_timeout_add(GATTLIB_FLEET_TICK_MS, _fleet_tick, fleet);
+
+	_fleet_schedule(fleet);
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_fleet_stop(gattlib_fleet_t* fleet) {
+	gint64 end_time = g_get_monotonic_time() + GATTLIB_FLEET_STOP_TIMEOUT_MS * G_TIME_SPAN_MILLISECOND;
+	int ret = GATTLIB_SUCCESS;
+
+	if (fleet == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	fleet->is_started = false;
+	if (fleet->tick_id != 0) {
+		g_source_remove(fleet->tick_id);
+		fleet->tick_id = 0;
+	}
+
+	// Wait for the devices in use to complete their current job and to be disconnected.
+	// The device whose job callback is calling this function cannot be waited for.
+	while (ret == GATTLIB_SUCCESS) {
+		unsigned int busy_count = fleet->busy_count;
+
+		for (GSList* l = fleet->devices; l != NULL; l = l->next) {
+			struct gattlib_fleet_device* device = l->data;
+			if (device->is_busy && (device->job_thread == g_thread_self())) {
+				busy_count--;
+			}
+		}
+
+		if (busy_count == 0) {
+			break;
+		}
+
+		gattlib_completion_reset(&fleet->device_released);
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+
+		ret = gattlib_completion_wait_until(&fleet->device_released, end_time);
+
+		g_rec_mutex_lock(&m_gattlib_mutex);
+	}
+
+	if (ret != GATTLIB_SUCCESS) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_fleet_stop: %u devices are still in use by the fleet", fleet->busy_count);
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_fleet_destroy(gattlib_fleet_t* fleet) {
+	if (fleet == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	// Stop the fleet if it is still running. Do not hold the lock while waiting for the devices in use.
+	gattlib_fleet_stop(fleet);
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (fleet->busy_count > 0) {
+		// The devices still in use do not start any new job. The last of them frees the fleet.
+		fleet->is_destroyed = true;
+	} else {
+		_fleet_free(fleet);
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_fleet_get_device_stats(gattlib_fleet_t* fleet, const char* dst, gattlib_fleet_device_stats_t* stats) {
+	struct gattlib_fleet_device* device;
+	int ret = GATTLIB_SUCCESS;
+
+	if ((fleet == NULL) || (dst == NULL) || (stats == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	device = _fleet_get_device(fleet, dst);
+	if (device == NULL) {
+		ret = GATTLIB_NOT_FOUND;
+		goto EXIT;
+	}
+
+	memcpy(stats, &device->stats, sizeof(gattlib_fleet_device_stats_t));
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_fleet_get_stats(gattlib_fleet_t* fleet, gattlib_fleet_stats_t* stats) {
+	if ((fleet == NULL) || (stats == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	memcpy(stats, &fleet->stats, sizeof(gattlib_fleet_stats_t));
+	if (fleet->start_timestamp_ns != 0) {
+		stats->elapsed_ns = gattlib_get_monotonic_time_ns() - fleet->start_timestamp_ns;
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return GATTLIB_SUCCESS;
+}
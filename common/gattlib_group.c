@@ -0,0 +1,404 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <string.h>
+
+#include "gattlib_internal.h"
+
+#define NSEC_PER_USEC	1000ULL
+#define NSEC_PER_MSEC	1000000ULL
+
+enum gattlib_group_item_state {
+	// Waiting for a slot on the adapter of the connection
+	GATTLIB_GROUP_ITEM_QUEUED,
+	// Given to the executor. It holds a slot of the adapter but its timeout is not started yet.
+	GATTLIB_GROUP_ITEM_PUSHED,
+	GATTLIB_GROUP_ITEM_RUNNING,
+	GATTLIB_GROUP_ITEM_COMPLETED,
+	// The result has been reported as GATTLIB_TIMEOUT. The operation might still be running and holds
+	// its slot until it returns.
+	GATTLIB_GROUP_ITEM_TIMED_OUT,
+};
+
+struct gattlib_group_run;
+
+// Operations of the group targeting a same adapter
+struct gattlib_group_lane {
+	gattlib_adapter_t* adapter;
+	// Number of operations given to the executor that have not returned yet
+	unsigned int in_flight;
+	// Queue of 'struct gattlib_group_item*' waiting for a slot
+	GQueue queued;
+};
+
+struct gattlib_group_item {
+	struct gattlib_group_run* run;
+	gattlib_connection_t* connection;
+	// Reference on the device of the connection. It is kept until the operation has returned
+	// as a timed out operation outlives gattlib_group_execute().
+	gattlib_device_t* device;
+	// Set once the operation has been given to the executor. Its task then releases 'device'.
+	bool is_pushed;
+	struct gattlib_group_lane* lane;
+	enum gattlib_group_item_state state;
+	uint64_t start_ns;
+	uint64_t latency_ns;
+	int error;
+	void* data;
+	size_t data_length;
+};
+
+// Note: The run is shared between the caller and the operations still running on the executor.
+//       The last one to release it frees it. Its fields are protected by 'mutex'.
+struct gattlib_group_run {
+	GMutex mutex;
+	gint reference_counter;
+
+	gattlib_group_operation_type_t type;
+	uuid_t uuid;
+	uint8_t* data;
+	size_t data_length;
+
+	unsigned int max_in_flight;
+	uint64_t timeout_ns;
+
+	struct gattlib_group_item* items;
+	size_t items_count;
+	struct gattlib_group_lane* lanes;
+	size_t lanes_count;
+
+	// Number of items neither completed nor timed out
+	size_t remaining;
+	// Completed when an operation starts or when 'remaining' reaches 0. Reset by the caller before checking the items.
+	struct gattlib_completion state_changed;
+};
+
+static void _group_lane_dispatch(struct gattlib_group_run* run, struct gattlib_group_lane* lane);
+
+static void _group_run_unref(struct gattlib_group_run* run) {
+	size_t i;
+
+	if (!g_atomic_int_dec_and_test(&run->reference_counter)) {
+		return;
+	}
+
+	for (i = 0; i < run->items_count; i++) {
+		if (run->items[i].data != NULL) {
+			gattlib_characteristic_free_value(run->items[i].data);
+		}
+	}
+	for (i = 0; i < run->lanes_count; i++) {
+		g_queue_clear(&run->lanes[i].queued);
+	}
+
+	gattlib_completion_clear(&run->state_changed);
+	g_mutex_clear(&run->mutex);
+	free(run->lanes);
+	free(run->items);
+	free(run->data);
+	free(run);
+}
+
+// Note: It must be called with 'run->mutex' held
+static void _group_item_finish(struct gattlib_group_item* item, enum gattlib_group_item_state state, int error,
+		void* data, size_t data_length)
+{
+	struct gattlib_group_run* run = item->run;
+
+	if (item->state == GATTLIB_GROUP_ITEM_RUNNING) {
+		item->latency_ns = gattlib_get_monotonic_time_ns() - item->start_ns;
+	}
+	item->state = state;
+	item->error = error;
+	item->data = data;
+	item->data_length = data_length;
+
+	run->remaining--;
+	if (run->remaining == 0) {
+		gattlib_completion_complete(&run->state_changed, GATTLIB_SUCCESS);
+	}
+}
+
+static void _group_item_execute(void* args) {
+	struct gattlib_group_item* item = args;
+	struct gattlib_group_run* run = item->run;
+	void* buffer = NULL;
+	size_t buffer_len = 0;
+	int ret;
+
+	// The timeout of the operation starts now. The time spent in the queue of the connection is not counted.
+	g_mutex_lock(&run->mutex);
+	item->state = GATTLIB_GROUP_ITEM_RUNNING;
+	item->start_ns = gattlib_get_monotonic_time_ns();
+	gattlib_completion_complete(&run->state_changed, GATTLIB_SUCCESS);
+	g_mutex_unlock(&run->mutex);
+
+	switch (run->type) {
+	case GATTLIB_GROUP_OPERATION_READ:
+		ret = gattlib_read_char_by_uuid(item->connection, &run->uuid, &buffer, &buffer_len);
+		break;
+	case GATTLIB_GROUP_OPERATION_WRITE:
+		ret = gattlib_write_char_by_uuid(item->connection, &run->uuid, run->data, run->data_length);
+		break;
+	case GATTLIB_GROUP_OPERATION_NOTIFICATION_START:
+		ret = gattlib_notification_start(item->connection, &run->uuid);
+		break;
+	case GATTLIB_GROUP_OPERATION_INDICATION_START:
+		ret = gattlib_indication_start(item->connection, &run->uuid);
+		break;
+	default:
+		ret = GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_mutex_lock(&run->mutex);
+	// The result is dropped if the operation has already been reported as timed out
+	if (item->state == GATTLIB_GROUP_ITEM_RUNNING) {
+		_group_item_finish(item, GATTLIB_GROUP_ITEM_COMPLETED, ret, buffer, buffer_len);
+		buffer = NULL;
+	}
+	// The slot is only given to the next operation of the adapter once this one has actually returned
+	item->lane->in_flight--;
+	_group_lane_dispatch(run, item->lane);
+	g_mutex_unlock(&run->mutex);
+
+	if (buffer != NULL) {
+		gattlib_characteristic_free_value(buffer);
+	}
+	gattlib_device_unref(item->device);
+	_group_run_unref(run);
+}
+
+// Note: It must be called with 'run->mutex' held
+static void _group_lane_dispatch(struct gattlib_group_run* run, struct gattlib_group_lane* lane) {
+	while ((lane->in_flight < run->max_in_flight) && !g_queue_is_empty(&lane->queued)) {
+		struct gattlib_group_item* item = g_queue_pop_head(&lane->queued);
+		int ret;
+
+		item->state = GATTLIB_GROUP_ITEM_PUSHED;
+		lane->in_flight++;
+
+		// The operations are blocking. They are detached so they do not hold back the events of the connection.
+		g_atomic_int_inc(&run->reference_counter);
+		ret = gattlib_serial_queue_push(item->connection->serial_queue, _group_item_execute, item, GATTLIB_TASK_DETACHED);
+		if (ret != GATTLIB_SUCCESS) {
+			g_atomic_int_dec_and_test(&run->reference_counter);
+			lane->in_flight--;
+			_group_item_finish(item, GATTLIB_GROUP_ITEM_COMPLETED, ret, NULL, 0);
+		} else {
+			item->is_pushed = true;
+		}
+	}
+}
+
+// Note: It must be called with 'run->mutex' held
+static struct gattlib_group_lane* _group_get_lane(struct gattlib_group_run* run, gattlib_adapter_t* adapter) {
+	struct gattlib_group_lane* lane;
+	size_t i;
+
+	for (i = 0; i < run->lanes_count; i++) {
+		if (run->lanes[i].adapter == adapter) {
+			return &run->lanes[i];
+		}
+	}
+
+	// 'lanes' has been allocated with one lane per connection
+	lane = &run->lanes[run->lanes_count++];
+	lane->adapter = adapter;
+	lane->in_flight = 0;
+	g_queue_init(&lane->queued);
+	return lane;
+}
+
+// Report as timed out the running operations that have reached their deadline. They keep their slot
+// until they return.
+// Return the earliest deadline of the operations still running. UINT64_MAX if none.
+// Note: It must be called with 'run->mutex' held
+static uint64_t _group_expire(struct gattlib_group_run* run) {
+	uint64_t now_ns = gattlib_get_monotonic_time_ns();
+	uint64_t next_deadline_ns = UINT64_MAX;
+	size_t i;
+
+	for (i = 0; i < run->items_count; i++) {
+		struct gattlib_group_item* item = &run->items[i];
+
+		if ((item->state == GATTLIB_GROUP_ITEM_RUNNING) && (item->start_ns + run->timeout_ns <= now_ns)) {
+			GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_group_execute: Operation on connection %p has timed out", item->connection);
+			_group_item_finish(item, GATTLIB_GROUP_ITEM_TIMED_OUT, GATTLIB_TIMEOUT, NULL, 0);
+		} else if ((item->state == GATTLIB_GROUP_ITEM_RUNNING) && (item->start_ns + run->timeout_ns < next_deadline_ns)) {
+			next_deadline_ns = item->start_ns + run->timeout_ns;
+		}
+	}
+
+	return next_deadline_ns;
+}
+
+int gattlib_group_execute(gattlib_connection_t** connections, size_t connections_count,
+		const gattlib_group_operation_t* operation, unsigned int max_in_flight_per_adapter, unsigned int timeout_ms,
+		gattlib_group_result_t* results, gattlib_group_report_t* report)
+{
+	struct gattlib_group_run* run;
+	uint64_t start_ns = gattlib_get_monotonic_time_ns();
+	int ret = GATTLIB_SUCCESS;
+	size_t i;
+
+	if ((connections == NULL) || (connections_count == 0) || (operation == NULL) || (results == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+	if ((operation->type == GATTLIB_GROUP_OPERATION_WRITE) && (operation->data == NULL) && (operation->data_length > 0)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	run = calloc(sizeof(struct gattlib_group_run), 1);
+	if (run == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	g_mutex_init(&run->mutex);
+	gattlib_completion_init(&run->state_changed);
+	run->reference_counter = 1;
+	run->type = operation->type;
+	memcpy(&run->uuid, &operation->uuid, sizeof(run->uuid));
+	run->max_in_flight = (max_in_flight_per_adapter > 0) ? max_in_flight_per_adapter : GATTLIB_GROUP_DEFAULT_MAX_IN_FLIGHT;
+	run->timeout_ns = (uint64_t)timeout_ms * NSEC_PER_MSEC;
+
+	run->items = calloc(sizeof(struct gattlib_group_item), connections_count);
+	run->lanes = calloc(sizeof(struct gattlib_group_lane), connections_count);
+	if ((run->items == NULL) || (run->lanes == NULL)) {
+		_group_run_unref(run);
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	run->items_count = connections_count;
+
+	// The value is copied as some operations might outlive this call when they time out
+	if ((operation->type == GATTLIB_GROUP_OPERATION_WRITE) && (operation->data_length > 0)) {
+		run->data = malloc(operation->data_length);
+		if (run->data == NULL) {
+			_group_run_unref(run);
+			return GATTLIB_OUT_OF_MEMORY;
+		}
+		memcpy(run->data, operation->data, operation->data_length);
+		run->data_length = operation->data_length;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+	g_mutex_lock(&run->mutex);
+
+	run->remaining = connections_count;
+	for (i = 0; i < connections_count; i++) {
+		struct gattlib_group_item* item = &run->items[i];
+
+		item->run = run;
+		item->connection = connections[i];
+
+		if (!gattlib_connection_is_connected(connections[i])) {
+			_group_item_finish(item, GATTLIB_GROUP_ITEM_COMPLETED, GATTLIB_DEVICE_NOT_CONNECTED, NULL, 0);
+			continue;
+		}
+
+		// Note: The reference is taken here where 'm_gattlib_mutex' is already held. The operations are
+		//       dispatched later with only 'run->mutex' held, which must not be held while taking 'm_gattlib_mutex'.
+		gattlib_device_ref(connections[i]->device);
+		item->device = connections[i]->device;
+
+		item->state = GATTLIB_GROUP_ITEM_QUEUED;
+		item->lane = _group_get_lane(run, connections[i]->device->adapter);
+		g_queue_push_tail(&item->lane->queued, item);
+	}
+
+	for (i = 0; i < run->lanes_count; i++) {
+		_group_lane_dispatch(run, &run->lanes[i]);
+	}
+
+	g_mutex_unlock(&run->mutex);
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	while (true) {
+		uint64_t next_deadline_ns = UINT64_MAX;
+		gint64 end_time = G_MAXINT64;
+
+		// Reset before checking the items so an operation starting after the check wakes up the wait
+		gattlib_completion_reset(&run->state_changed);
+
+		g_mutex_lock(&run->mutex);
+		if ((run->remaining > 0) && (run->timeout_ns > 0)) {
+			next_deadline_ns = _group_expire(run);
+		}
+		if (run->remaining == 0) {
+			g_mutex_unlock(&run->mutex);
+			break;
+		}
+		g_mutex_unlock(&run->mutex);
+
+		if (next_deadline_ns != UINT64_MAX) {
+			// Both clocks are based on CLOCK_MONOTONIC. Round up to not wake up before the deadline.
+			end_time = (gint64)((next_deadline_ns + NSEC_PER_USEC - 1) / NSEC_PER_USEC);
+		}
+		gattlib_completion_wait_until(&run->state_changed, end_time);
+	}
+
+	if (report != NULL) {
+		memset(report, 0, sizeof(gattlib_group_report_t));
+	}
+
+	g_mutex_lock(&run->mutex);
+	for (i = 0; i < connections_count; i++) {
+		struct gattlib_group_item* item = &run->items[i];
+
+		results[i].error = item->error;
+		results[i].data = item->data;
+		results[i].data_length = item->data_length;
+		results[i].latency_ns = item->latency_ns;
+		// The ownership of the value is given to the caller
+		item->data = NULL;
+
+		if ((ret == GATTLIB_SUCCESS) && (item->error != GATTLIB_SUCCESS)) {
+			ret = item->error;
+		}
+
+		if (report == NULL) {
+			continue;
+		}
+		if (item->state == GATTLIB_GROUP_ITEM_TIMED_OUT) {
+			report->timed_out++;
+		} else if (item->error == GATTLIB_SUCCESS) {
+			report->succeeded++;
+			gattlib_latency_histogram_record(&report->latency, item->latency_ns);
+		} else {
+			report->failed++;
+		}
+	}
+	g_mutex_unlock(&run->mutex);
+
+	// No operation is dispatched once all of them have been reported. So 'is_pushed' does not change anymore.
+	for (i = 0; i < connections_count; i++) {
+		struct gattlib_group_item* item = &run->items[i];
+
+		if ((item->device != NULL) && !item->is_pushed) {
+			gattlib_device_unref(item->device);
+		}
+	}
+
+	if (report != NULL) {
+		report->elapsed_ns = gattlib_get_monotonic_time_ns() - start_ns;
+	}
+
+	_group_run_unref(run);
+	return ret;
+}
+
+void gattlib_group_results_free(gattlib_group_result_t* results, size_t results_count) {
+	size_t i;
+
+	if (results == NULL) {
+		return;
+	}
+
+	for (i = 0; i < results_count; i++) {
+		if (results[i].data != NULL) {
+			gattlib_characteristic_free_value(results[i].data);
+			results[i].data = NULL;
+		}
+	}
+}
@@ -16,6 +16,9 @@
 
 #include "gattlib.h"
 #include "gattlib_backend.h"
+#include "gattlib_advertising_filter.h"
+#include "gattlib_address_set.h"
+#include "gattlib_scan_throttle.h"
 
 #if defined(WITH_PYTHON)
 struct gattlib_python_args {
@@ -24,11 +27,17 @@ struct gattlib_python_args {
 };
 #endif
 
-#define GATTLIB_SIGNAL_DEVICE_DISCONNECTION		(1 << 0)
+// By default, the executor grows with the number of callbacks running concurrently. Idle threads are reused.
+#define GATTLIB_EXECUTOR_DEFAULT_MAX_THREADS	-1
+
+// The task can run for a long time. The following tasks of its serial queue are allowed to start
+// while it is still running.
+#define GATTLIB_TASK_DETACHED					(1 << 0)
+
 #define GATTLIB_SIGNAL_ADAPTER_STOP_SCANNING    (1 << 1)
 
 struct gattlib_signal {
-	// Used by gattlib_disconnection when we want to wait for the disconnection to be effective
+	// Used when we want to wait for the adapter to stop scanning
 	GCond condition;
 	// Mutex for condition
 	GMutex mutex;
@@ -36,26 +45,79 @@ struct gattlib_signal {
 	uint32_t signals;
 };
 
+// Completion of an operation specific to one gattlib object. Only the threads waiting
+// for this operation are woken up on completion.
+struct gattlib_completion {
+	GMutex mutex;
+	GCond condition;
+	bool is_completed;
+	// GATTLIB_SUCCESS or GATTLIB_* error code of the operation
+	int result;
+};
+
+// Maximum number of high and normal priority operations of a connection in flight for an operation of
+// the class to start. Once submitted, BlueZ serves the operations in its own order. The scheduler only
+// orders the operations that have not been submitted yet. Unrelated reads and writes are submitted together.
+#define GATTLIB_OP_SCHEDULER_MAX_IN_FLIGHT_HIGH		8
+#define GATTLIB_OP_SCHEDULER_MAX_IN_FLIGHT_NORMAL	4
+// Maximum number of bulk operations of a connection in flight. They do not wait for the other classes
+// to be idle but they are not started while a high priority operation is in flight.
+#define GATTLIB_OP_SCHEDULER_MAX_IN_FLIGHT_BULK		2
+
+// Scheduler of the GATT operations of a connection
+struct gattlib_op_scheduler {
+	GMutex mutex;
+	GCond condition;
+	unsigned int in_flight[GATTLIB_PRIORITY_CLASSES];
+	// Each class starts its operations in ticket order. A class starts an operation only when all
+	// the classes with a higher priority have no waiting operation.
+	uint64_t next_ticket[GATTLIB_PRIORITY_CLASSES];
+	uint64_t serving_ticket[GATTLIB_PRIORITY_CLASSES];
+	// Time spent by the operations waiting for their turn
+	gattlib_latency_histogram_t queueing_latency[GATTLIB_PRIORITY_CLASSES];
+};
+
 struct gattlib_handler {
 	union {
 		gattlib_discovered_device_t discovered_device;
+		gattlib_discovered_device_with_timestamp_t discovered_device_with_timestamp;
+		gattlib_discovered_device_with_data_t discovered_device_with_data;
 		gatt_connect_cb_t connection_handler;
 		gattlib_event_handler_t notification_handler;
+		gattlib_event_with_timestamp_handler_t notification_with_timestamp_handler;
 		gattlib_disconnection_handler_t disconnection_handler;
+		gattlib_disconnect_cb_t disconnect_handler;
 		void (*callback)(void);
 	} callback;
 
 	void* user_data;
-	// We create a thread to ensure the callback is not blocking the mainloop
-	GThread *thread;
-	// Thread pool
-	GThreadPool *thread_pool;
+	// The callback expects the timestamp of the event (eg: 'notification_with_timestamp_handler')
+	bool with_timestamp;
+	// The callback expects the advertisement data of the discovered device ('discovered_device_with_data')
+	bool with_data;
 #if defined(WITH_PYTHON)
 	// In case of Python callback and argument, we keep track to free it when we stopped to discover BLE devices
 	void* python_args;
 #endif
 };
 
+struct gattlib_notification_queue {
+	// Note: The ring buffer is protected by 'm_gattlib_mutex'
+	// eventfd readable as long as the queue is not empty
+	int fd;
+	gattlib_notification_record_t* records;
+	size_t size;
+	size_t head;
+	size_t count;
+	// Number of notifications dropped because the queue was full
+	uint64_t dropped;
+};
+
+struct gattlib_subscription {
+	uuid_t uuid;
+	bool is_indication;
+};
+
 enum _gattlib_device_state {
 	NOT_FOUND = 0,
 	CONNECTING,
@@ -84,6 +146,25 @@ struct _gattlib_adapter {
 
 	// Handler calls on discovered device
 	struct gattlib_handler discovered_device_callback;
+
+	// Serial queue used to dispatch the discovered devices in order
+	struct gattlib_serial_queue* serial_queue;
+
+	// Connection scheduler. Allocated on first use.
+	struct gattlib_connect_scheduler* connect_scheduler;
+
+	// Filter of the discovered devices. NULL when all the devices are reported.
+	gattlib_advertising_filter_t* advertising_filter;
+
+	// Sets of the addresses of the devices to report and to drop. NULL when not used.
+	gattlib_address_set_t* address_allowlist;
+	gattlib_address_set_t* address_denylist;
+
+	// Throttling of the devices reported again by a scan. Only used when 'has_scan_throttle' is set.
+	bool has_scan_throttle;
+	gattlib_scan_throttle_t scan_throttle;
+	// Last-seen cache of the devices reported by the current scan. Allocated on first use.
+	struct gattlib_scan_throttle_cache* scan_throttle_cache;
 };
 
 struct _gattlib_connection {
@@ -96,6 +177,27 @@ struct _gattlib_connection {
 	struct gattlib_handler notification;
 	struct gattlib_handler indication;
 	struct gattlib_handler on_disconnection;
+	// Callback of 'gattlib_disconnect_async()'
+	struct gattlib_handler on_disconnect_complete;
+
+	// Completed when the disconnection initiated by 'gattlib_disconnect()' is effective
+	struct gattlib_completion disconnection;
+
+	// Serial queue used to dispatch the connection, notification and disconnection events in order
+	struct gattlib_serial_queue* serial_queue;
+
+	// When not NULL, notifications are queued for 'gattlib_notification_poll()' instead of being dispatched
+	struct gattlib_notification_queue* notification_queue;
+
+	// Array of 'struct gattlib_subscription'. Notifications and indications started by the application.
+	// They are restored on automatic reconnection.
+	GArray* subscriptions;
+
+	// Automatic reconnection policy. NULL when the automatic reconnection is disabled.
+	struct gattlib_reconnect* reconnect;
+
+	// Order the GATT operations of the connection by priority class
+	struct gattlib_op_scheduler op_scheduler;
 };
 
 typedef struct _gattlib_device {
@@ -110,6 +212,14 @@ typedef struct _gattlib_device {
 	// We keep the state to prevent concurrent connecting/connected/disconnecting operation
 	enum _gattlib_device_state state;
 
+	// Cache of the GATT characteristic identifiers (eg: DBUS object path) indexed by UUID string.
+	// It is kept across the connections of the device to avoid rediscovering the GATT tree.
+	GHashTable* characteristic_cache;
+
+	// Coalescers of the writes without response indexed by UUID string. NULL until the coalescing of
+	// a characteristic is enabled.
+	GHashTable* write_coalescers;
+
 	struct _gattlib_connection connection;
 } gattlib_device_t;
 
@@ -142,12 +252,43 @@ int gattlib_device_unref(gattlib_device_t* device);
 bool gattlib_connection_is_valid(gattlib_connection_t* connection);
 bool gattlib_connection_is_connected(gattlib_connection_t* connection);
 
-void gattlib_handler_dispatch_to_thread(struct gattlib_handler* handler, void (*python_callback)(),
-		GThreadFunc thread_func, const char* thread_name, void* (*thread_args_allocator)(va_list args), ...);
+/**
+ * Serial queues of tasks executed by the gattlib executor (a thread pool shared by all the callbacks).
+ * The tasks of a serial queue are executed one after the other in their queuing order.
+ */
+struct gattlib_serial_queue* gattlib_serial_queue_new(void);
+void gattlib_serial_queue_unref(struct gattlib_serial_queue* queue);
+int gattlib_serial_queue_push(struct gattlib_serial_queue* queue, void (*task_func)(void* args), void* task_args, uint32_t flags);
+
+void gattlib_completion_init(struct gattlib_completion* completion);
+void gattlib_completion_clear(struct gattlib_completion* completion);
+void gattlib_completion_reset(struct gattlib_completion* completion);
+void gattlib_completion_complete(struct gattlib_completion* completion, int result);
+/**
+ * Wait for the completion of the operation
+ *
+ * @return Result of the operation or GATTLIB_TIMEOUT if it has not completed before 'end_time'
+ *         (in g_get_monotonic_time() time base)
+ */
+int gattlib_completion_wait_until(struct gattlib_completion* completion, gint64 end_time);
+
+void gattlib_handler_dispatch_to_executor(struct gattlib_serial_queue* queue, struct gattlib_handler* handler, void (*python_callback)(),
+		void (*task_func)(void* args), uint32_t task_flags, void* (*task_args_allocator)(va_list args), ...);
 void gattlib_handler_free(struct gattlib_handler* handler);
+void gattlib_handler_invoke_notification(struct gattlib_handler* handler, const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns);
 bool gattlib_has_valid_handler(struct gattlib_handler* handler);
 
-void gattlib_notification_device_thread(gpointer data, gpointer user_data);
+
+/**
+ * Queue the notification if the application has enabled the notification queue
+ *
+ * @return true if the notification has been queued
+ */
+bool gattlib_notification_queue_push(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns);
+bool gattlib_notification_queue_is_enabled(gattlib_connection_t* connection);
+void gattlib_notification_queue_free(gattlib_connection_t* connection);
 
 /**
  * Clean GATTLIB connection on disconnection
@@ -157,6 +298,71 @@ void gattlib_notification_device_thread(gpointer data, gpointer user_data);
  */
 void gattlib_connection_free(gattlib_connection_t* connection);
 
+// Free the connection scheduler of the adapter
+void gattlib_connect_scheduler_free(gattlib_adapter_t* adapter);
+
+/**
+ * Keep track of the notifications/indications started by the application to restore them on reconnection
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+void gattlib_subscription_add(gattlib_connection_t* connection, const uuid_t* uuid, bool is_indication);
+void gattlib_subscription_remove(gattlib_connection_t* connection, const uuid_t* uuid);
+
+/**
+ * Called on disconnection once the connection has been freed.
+ * It starts the automatic reconnection if the link has been lost and the policy is enabled.
+ *
+ * @param connection  Disconnected connection
+ * @param is_link_lost True if the disconnection has not been requested by the application
+ * @param dst          Remote Bluetooth address of the device
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+void gattlib_reconnect_on_disconnection(gattlib_connection_t* connection, bool is_link_lost, const char* dst);
+// Free the automatic reconnection policy of the connection
+void gattlib_reconnect_free(gattlib_connection_t* connection);
+
+// Write without response of a value to the characteristic. Used by the writer of the write coalescing.
+typedef int (*gattlib_write_coalescing_write_t)(gattlib_connection_t* connection, const uuid_t* uuid,
+		const void* buffer, size_t buffer_len, gattlib_priority_t priority);
+
+/**
+ * Submit a write without response to the coalescing of the characteristic
+ *
+ * The value replaces the one not sent yet and the call returns at once. A single writer task per
+ * characteristic writes the latest value with 'write_func' until there is no newer one.
+ *
+ * @param result Set to the result of the submission when the value has been taken
+ *
+ * @return false if the coalescing is not enabled. The value must then be written as usual.
+ */
+bool gattlib_write_coalescing_submit(gattlib_connection_t* connection, const uuid_t* uuid,
+		const void* buffer, size_t buffer_len, gattlib_priority_t priority, gattlib_write_coalescing_write_t write_func,
+		int* result);
+void gattlib_write_coalescer_unref(gpointer data);
+
+void gattlib_op_scheduler_init(struct gattlib_op_scheduler* scheduler);
+void gattlib_op_scheduler_clear(struct gattlib_op_scheduler* scheduler);
+/**
+ * Wait for the turn of a GATT operation of the given priority class on the connection
+ *
+ * It only orders the operation against the operations of the connection that have not been submitted yet.
+ *
+ * Every call must be followed by 'gattlib_op_scheduler_release()' with the same priority class once
+ * the operation has completed.
+ */
+void gattlib_op_scheduler_acquire(gattlib_connection_t* connection, gattlib_priority_t priority);
+void gattlib_op_scheduler_release(gattlib_connection_t* connection, gattlib_priority_t priority);
+
+/**
+ * Monotonic time (CLOCK_MONOTONIC) in nanoseconds used to timestamp the events entering gattlib
+ */
+uint64_t gattlib_get_monotonic_time_ns(void);
+void gattlib_latency_histogram_record(gattlib_latency_histogram_t* histogram, uint64_t latency_ns);
+// Record in the dispatch latency histogram the time elapsed since the event has been queued
+void gattlib_dispatch_latency_record(uint64_t enqueue_timestamp_ns);
+
 extern const char* device_state_str[];
 gattlib_device_t* gattlib_device_get_device(gattlib_adapter_t* adapter, const char* device_id);
 enum _gattlib_device_state gattlib_device_get_state(gattlib_adapter_t* adapter, const char* device_id);
@@ -0,0 +1,66 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "gattlib_internal.h"
+
+// Histogram of the time between an event being queued and its callback being invoked
+static gattlib_latency_histogram_t m_dispatch_latency_histogram;
+static GMutex m_dispatch_latency_mutex;
+
+uint64_t gattlib_get_monotonic_time_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void gattlib_latency_histogram_record(gattlib_latency_histogram_t* histogram, uint64_t latency_ns) {
+	uint64_t latency_us = latency_ns / 1000;
+	size_t bucket = 0;
+
+	// Index of the most significant bit of the latency in microseconds
+	while ((latency_us > 1) && (bucket < GATTLIB_LATENCY_HISTOGRAM_BUCKETS - 1)) {
+		latency_us >>= 1;
+		bucket++;
+	}
+
+	if ((histogram->count == 0) || (latency_ns < histogram->min_ns)) {
+		histogram->min_ns = latency_ns;
+	}
+	if (latency_ns > histogram->max_ns) {
+		histogram->max_ns = latency_ns;
+	}
+	histogram->count++;
+	histogram->sum_ns += latency_ns;
+	histogram->buckets[bucket]++;
+}
+
+void gattlib_dispatch_latency_record(uint64_t enqueue_timestamp_ns) {
+	uint64_t now = gattlib_get_monotonic_time_ns();
+
+	g_mutex_lock(&m_dispatch_latency_mutex);
+	gattlib_latency_histogram_record(&m_dispatch_latency_histogram,
+		(now > enqueue_timestamp_ns) ? now - enqueue_timestamp_ns : 0);
+	g_mutex_unlock(&m_dispatch_latency_mutex);
+}
+
+int gattlib_get_dispatch_latency_histogram(gattlib_latency_histogram_t* histogram, bool reset) {
+	if (histogram == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_mutex_lock(&m_dispatch_latency_mutex);
+	memcpy(histogram, &m_dispatch_latency_histogram, sizeof(gattlib_latency_histogram_t));
+	if (reset) {
+		memset(&m_dispatch_latency_histogram, 0, sizeof(gattlib_latency_histogram_t));
+	}
+	g_mutex_unlock(&m_dispatch_latency_mutex);
+
+	return GATTLIB_SUCCESS;
+}
@@ -0,0 +1,231 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "gattlib_internal.h"
+
+static void _notification_queue_signal(struct gattlib_notification_queue* queue) {
+	uint64_t value = 1;
+
+	if (write(queue->fd, &value, sizeof(value)) < 0) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_notification_queue: Failed to signal eventfd: %s", strerror(errno));
+	}
+}
+
+static void _notification_queue_clear_signal(struct gattlib_notification_queue* queue) {
+	uint64_t value;
+
+	// The eventfd is non-blocking. EAGAIN only means it was not signaled.
+	if (read(queue->fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_notification_queue: Failed to clear eventfd: %s", strerror(errno));
+	}
+}
+
+static void _notification_queue_destroy(struct gattlib_notification_queue* queue) {
+	while (queue->count > 0) {
+		free(queue->records[queue->head].data);
+		queue->head = (queue->head + 1) % queue->size;
+		queue->count--;
+	}
+
+	close(queue->fd);
+	free(queue->records);
+	free(queue);
+}
+
+int gattlib_notification_queue_enable(gattlib_connection_t* connection, size_t queue_size, int* fd) {
+	struct gattlib_notification_queue* queue;
+	int ret = GATTLIB_SUCCESS;
+
+	if ((connection == NULL) || (queue_size == 0) || (fd == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_valid(connection)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_notification_queue_enable: Device not valid");
+		ret = GATTLIB_DEVICE_DISCONNECTED;
+		goto EXIT;
+	}
+
+	if (connection->notification_queue != NULL) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_notification_queue_enable: Notification queue already enabled");
+		ret = GATTLIB_BUSY;
+		goto EXIT;
+	}
+
+	queue = calloc(sizeof(struct gattlib_notification_queue), 1);
+	if (queue == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	queue->records = calloc(sizeof(gattlib_notification_record_t), queue_size);
+	if (queue->records == NULL) {
+		free(queue);
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	queue->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (queue->fd < 0) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_notification_queue_enable: Failed to create eventfd: %s", strerror(errno));
+		ret = GATTLIB_ERROR_UNIX_WITH_ERROR(errno);
+		free(queue->records);
+		free(queue);
+		goto EXIT;
+	}
+
+	queue->size = queue_size;
+
+	connection->notification_queue = queue;
+	*fd = queue->fd;
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_notification_queue_disable(gattlib_connection_t* connection) {
+	int ret = GATTLIB_SUCCESS;
+
+	if (connection == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_valid(connection)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_notification_queue_disable: Device not valid");
+		ret = GATTLIB_DEVICE_DISCONNECTED;
+		goto EXIT;
+	}
+
+	if (connection->notification_queue == NULL) {
+		ret = GATTLIB_NOT_FOUND;
+		goto EXIT;
+	}
+
+	gattlib_notification_queue_free(connection);
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_notification_poll(gattlib_connection_t* connection, gattlib_notification_record_t* records, size_t max_records, size_t* records_count) {
+	struct gattlib_notification_queue* queue;
+	size_t count = 0;
+	int ret = GATTLIB_SUCCESS;
+
+	if ((connection == NULL) || (records == NULL) || (records_count == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_valid(connection)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_notification_poll: Device not valid");
+		ret = GATTLIB_DEVICE_DISCONNECTED;
+		goto EXIT;
+	}
+
+	queue = connection->notification_queue;
+	if (queue == NULL) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_notification_poll: Notification queue not enabled");
+		ret = GATTLIB_INVALID_PARAMETER;
+		goto EXIT;
+	}
+
+	// Ownership of the payloads is transferred to the caller
+	while ((count < max_records) && (queue->count > 0)) {
+		records[count++] = queue->records[queue->head];
+		queue->head = (queue->head + 1) % queue->size;
+		queue->count--;
+	}
+
+	if (queue->count == 0) {
+		_notification_queue_clear_signal(queue);
+	}
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	*records_count = count;
+	return ret;
+}
+
+void gattlib_notification_records_free(gattlib_notification_record_t* records, size_t records_count) {
+	for (size_t i = 0; i < records_count; i++) {
+		free(records[i].data);
+		records[i].data = NULL;
+	}
+}
+
+bool gattlib_notification_queue_is_enabled(gattlib_connection_t* connection) {
+	return connection->notification_queue != NULL;
+}
+
+bool gattlib_notification_queue_push(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns)
+{
+	struct gattlib_notification_queue* queue;
+	gattlib_notification_record_t* record;
+	uint8_t* payload;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	queue = connection->notification_queue;
+	if (queue == NULL) {
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		return false;
+	}
+
+	payload = malloc(data_length);
+	if ((payload == NULL) && (data_length > 0)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_notification_queue_push: Failed to allocate notification");
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		return true;
+	}
+	memcpy(payload, data, data_length);
+
+	if (queue->count == queue->size) {
+		// Drop the oldest notification to make room
+		free(queue->records[queue->head].data);
+		queue->head = (queue->head + 1) % queue->size;
+		queue->count--;
+		queue->dropped++;
+		GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_notification_queue_push: Queue full - %" PRIu64 " notifications dropped", queue->dropped);
+	}
+
+	record = &queue->records[(queue->head + queue->count) % queue->size];
+	memcpy(&record->uuid, uuid, sizeof(uuid_t));
+	record->data = payload;
+	record->data_length = data_length;
+	record->timestamp_ns = timestamp_ns;
+
+	// Only signal the transition from empty to non-empty. The eventfd stays readable until
+	// the queue is drained by 'gattlib_notification_poll()'.
+	if (queue->count++ == 0) {
+		_notification_queue_signal(queue);
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return true;
+}
+
+void gattlib_notification_queue_free(gattlib_connection_t* connection) {
+	struct gattlib_notification_queue* queue = g_steal_pointer(&connection->notification_queue);
+
+	if (queue != NULL) {
+		_notification_queue_destroy(queue);
+	}
+}
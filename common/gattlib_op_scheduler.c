@@ -0,0 +1,127 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <string.h>
+
+#include "gattlib_internal.h"
+
+void gattlib_op_scheduler_init(struct gattlib_op_scheduler* scheduler) {
+	memset(scheduler, 0, sizeof(struct gattlib_op_scheduler));
+	g_mutex_init(&scheduler->mutex);
+	g_cond_init(&scheduler->condition);
+}
+
+void gattlib_op_scheduler_clear(struct gattlib_op_scheduler* scheduler) {
+	g_cond_clear(&scheduler->condition);
+	g_mutex_clear(&scheduler->mutex);
+}
+
+// Note: It must be called with 'scheduler->mutex' held
+static bool _op_scheduler_has_slot(struct gattlib_op_scheduler* scheduler, gattlib_priority_t priority) {
+	unsigned int in_flight = scheduler->in_flight[GATTLIB_PRIORITY_HIGH] + scheduler->in_flight[GATTLIB_PRIORITY_NORMAL];
+
+	switch (priority) {
+	case GATTLIB_PRIORITY_HIGH:
+		// Bulk operations in flight are not counted. They do not delay latency-critical operations.
+		return in_flight < GATTLIB_OP_SCHEDULER_MAX_IN_FLIGHT_HIGH;
+	case GATTLIB_PRIORITY_NORMAL:
+		return in_flight < GATTLIB_OP_SCHEDULER_MAX_IN_FLIGHT_NORMAL;
+	default:
+		return (scheduler->in_flight[GATTLIB_PRIORITY_BULK] < GATTLIB_OP_SCHEDULER_MAX_IN_FLIGHT_BULK) &&
+			(scheduler->in_flight[GATTLIB_PRIORITY_HIGH] == 0);
+	}
+}
+
+// Note: It must be called with 'scheduler->mutex' held
+static bool _op_scheduler_is_turn(struct gattlib_op_scheduler* scheduler, gattlib_priority_t priority, uint64_t ticket) {
+	int i;
+
+	if (!_op_scheduler_has_slot(scheduler, priority)) {
+		return false;
+	}
+	if (scheduler->serving_ticket[priority] != ticket) {
+		return false;
+	}
+
+	// Waiting operations of higher priority classes start first
+	for (i = 0; i < priority; i++) {
+		if (scheduler->next_ticket[i] != scheduler->serving_ticket[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void gattlib_op_scheduler_acquire(gattlib_connection_t* connection, gattlib_priority_t priority) {
+	struct gattlib_op_scheduler* scheduler = &connection->op_scheduler;
+	uint64_t enqueue_timestamp_ns = gattlib_get_monotonic_time_ns();
+	uint64_t ticket;
+
+	if ((unsigned int)priority >= GATTLIB_PRIORITY_CLASSES) {
+		priority = GATTLIB_PRIORITY_NORMAL;
+	}
+
+	g_mutex_lock(&scheduler->mutex);
+
+	ticket = scheduler->next_ticket[priority]++;
+	while (!_op_scheduler_is_turn(scheduler, priority, ticket)) {
+		g_cond_wait(&scheduler->condition, &scheduler->mutex);
+	}
+
+	scheduler->serving_ticket[priority]++;
+	scheduler->in_flight[priority]++;
+	gattlib_latency_histogram_record(&scheduler->queueing_latency[priority],
+		gattlib_get_monotonic_time_ns() - enqueue_timestamp_ns);
+
+	// The next operation of the class might also be allowed to start
+	g_cond_broadcast(&scheduler->condition);
+	g_mutex_unlock(&scheduler->mutex);
+}
+
+void gattlib_op_scheduler_release(gattlib_connection_t* connection, gattlib_priority_t priority) {
+	struct gattlib_op_scheduler* scheduler = &connection->op_scheduler;
+
+	if ((unsigned int)priority >= GATTLIB_PRIORITY_CLASSES) {
+		priority = GATTLIB_PRIORITY_NORMAL;
+	}
+
+	g_mutex_lock(&scheduler->mutex);
+	scheduler->in_flight[priority]--;
+	g_cond_broadcast(&scheduler->condition);
+	g_mutex_unlock(&scheduler->mutex);
+}
+
+int gattlib_connection_get_queueing_latency(gattlib_connection_t* connection, gattlib_priority_t priority,
+		gattlib_latency_histogram_t* histogram, bool reset)
+{
+	struct gattlib_op_scheduler* scheduler;
+	int ret = GATTLIB_SUCCESS;
+
+	if ((histogram == NULL) || ((unsigned int)priority >= GATTLIB_PRIORITY_CLASSES)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_valid(connection)) {
+		ret = GATTLIB_INVALID_PARAMETER;
+		goto EXIT;
+	}
+
+	scheduler = &connection->op_scheduler;
+
+	g_mutex_lock(&scheduler->mutex);
+	memcpy(histogram, &scheduler->queueing_latency[priority], sizeof(gattlib_latency_histogram_t));
+	if (reset) {
+		memset(&scheduler->queueing_latency[priority], 0, sizeof(gattlib_latency_histogram_t));
+	}
+	g_mutex_unlock(&scheduler->mutex);
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
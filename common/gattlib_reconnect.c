@@ -0,0 +1,389 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include "gattlib_internal.h"
+
+// Note: The reconnection state is protected by 'm_gattlib_mutex'
+struct gattlib_reconnect {
+	unsigned int max_attempts;
+	unsigned int initial_backoff_ms;
+	unsigned int max_backoff_ms;
+	gattlib_reconnect_event_cb_t event_cb;
+	void* user_data;
+
+	// State of the reconnection in progress
+	bool is_reconnecting;
+	unsigned int attempt;
+	unsigned int backoff_ms;
+	guint timeout_id;
+	uint64_t link_lost_timestamp_ns;
+	char* dst;
+
+	// Connection handler of the application. gattlib_connect() overrides it while we are reconnecting.
+	struct gattlib_handler on_connection;
+};
+
+struct gattlib_reconnect_event_task_args {
+	gattlib_connection_t* connection;
+	gattlib_reconnect_event_cb_t event_cb;
+	void* user_data;
+	gattlib_reconnect_event_t event;
+	unsigned int attempt;
+	int error;
+	uint64_t latency_ns;
+};
+
+static void _reconnect_event_task(void* data) {
+	struct gattlib_reconnect_event_task_args* args = data;
+
+	args->event_cb(args->connection, args->event, args->attempt, args->error, args->latency_ns, args->user_data);
+
+	// Release the reference taken when the task has been queued
+	gattlib_device_unref(args->connection->device);
+	free(args);
+}
+
+/**
+ * Report the reconnection event to the application from the serial queue of the connection
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+static void _reconnect_emit(gattlib_connection_t* connection, gattlib_reconnect_event_t event, int error) {
+	struct gattlib_reconnect* reconnect = connection->reconnect;
+	struct gattlib_reconnect_event_task_args* task_args;
+
+	if (reconnect->event_cb == NULL) {
+		return;
+	}
+
+	task_args = calloc(sizeof(struct gattlib_reconnect_event_task_args), 1);
+	if (task_args == NULL) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_reconnect: Failed to allocate event");
+		return;
+	}
+	task_args->connection = connection;
+	task_args->event_cb = reconnect->event_cb;
+	task_args->user_data = reconnect->user_data;
+	task_args->event = event;
+	task_args->attempt = reconnect->attempt;
+	task_args->error = error;
+	task_args->latency_ns = gattlib_get_monotonic_time_ns() - reconnect->link_lost_timestamp_ns;
+
+	// Ensure the device/connection is not freed before the task is executed
+	gattlib_device_ref(connection->device);
+
+	if (gattlib_serial_queue_push(connection->serial_queue, _reconnect_event_task, task_args, 0) != GATTLIB_SUCCESS) {
+		_reconnect_event_task(task_args);
+	}
+}
+
+/**
+ * Stop the reconnection in progress
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+static void _reconnect_stop(gattlib_connection_t* connection) {
+	struct gattlib_reconnect* reconnect = connection->reconnect;
+
+	if (!reconnect->is_reconnecting) {
+		return;
+	}
+
+	if (reconnect->timeout_id != 0) {
+		g_source_remove(reconnect->timeout_id);
+		reconnect->timeout_id = 0;
+	}
+
+	reconnect->is_reconnecting = false;
+	free(reconnect->dst);
+	reconnect->dst = NULL;
+
+	// Release the reference taken when the link has been lost
+	gattlib_device_unref(connection->device);
+}
+
+/**
+ * Give up the reconnection. The subscriptions cannot be restored anymore.
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+static void _reconnect_failed(gattlib_connection_t* connection, int error) {
+	struct gattlib_reconnect* reconnect = connection->reconnect;
+
+	GATTLIB_LOG(GATTLIB_ERROR, "gattlib_reconnect: Failed to reconnect '%s' after %u attempts (%d)",
+		reconnect->dst, reconnect->attempt, error);
+
+	connection->on_connection = reconnect->on_connection;
+	if (connection->subscriptions != NULL) {
+		g_array_set_size(connection->subscriptions, 0);
+	}
+
+	_reconnect_emit(connection, GATTLIB_RECONNECT_EVENT_FAILED, error);
+	_reconnect_stop(connection);
+}
+
+static gboolean _reconnect_attempt(gpointer data);
+
+static void _reconnect_schedule(gattlib_connection_t* connection) {
+	struct gattlib_reconnect* reconnect = connection->reconnect;
+
+	reconnect->timeout_id = g_timeout_add(reconnect->backoff_ms, _reconnect_attempt, connection);
+}
+
+static void _on_reconnect_connected(gattlib_adapter_t* adapter, const char *dst, gattlib_connection_t* new_connection, int error, void* user_data) {
+	gattlib_connection_t* connection = user_data;
+	struct gattlib_reconnect* reconnect;
+	GArray* subscriptions = NULL;
+	int ret = GATTLIB_SUCCESS;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	reconnect = connection->reconnect;
+	if ((reconnect == NULL) || !reconnect->is_reconnecting) {
+		// The automatic reconnection has been disabled in the meantime
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		return;
+	}
+
+	if (error != GATTLIB_SUCCESS) {
+		GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_reconnect: Attempt %u to reconnect '%s' has failed (%d)",
+			reconnect->attempt, reconnect->dst, error);
+
+		if (reconnect->attempt >= reconnect->max_attempts) {
+			_reconnect_failed(connection, error);
+		} else {
+			reconnect->backoff_ms = MIN(reconnect->backoff_ms * 2, reconnect->max_backoff_ms);
+			_reconnect_schedule(connection);
+		}
+
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		return;
+	}
+
+	// Give the connection handler back to the application
+	connection->on_connection = reconnect->on_connection;
+
+	if ((connection->subscriptions != NULL) && (connection->subscriptions->len > 0)) {
+		subscriptions = g_array_sized_new(FALSE, FALSE, sizeof(struct gattlib_subscription), connection->subscriptions->len);
+		g_array_append_vals(subscriptions, connection->subscriptions->data, connection->subscriptions->len);
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	// Restore the subscriptions. The GATT characteristics are resolved from the cache of the device.
+	if (subscriptions != NULL) {
+		for (guint i = 0; i < subscriptions->len; i++) {
+			struct gattlib_subscription* subscription = &g_array_index(subscriptions, struct gattlib_subscription, i);
+			int subscription_ret;
+
+			if (subscription->is_indication) {
+				subscription_ret = gattlib_indication_start(connection, &subscription->uuid);
+			} else {
+				subscription_ret = gattlib_notification_start(connection, &subscription->uuid);
+			}
+
+			if (subscription_ret != GATTLIB_SUCCESS) {
+				char uuid_str[MAX_LEN_UUID_STR + 1];
+
+				gattlib_uuid_to_string(&subscription->uuid, uuid_str, sizeof(uuid_str));
+				GATTLIB_LOG(GATTLIB_ERROR, "gattlib_reconnect: Failed to restore the subscription to '%s' (%d)",
+					uuid_str, subscription_ret);
+				if (ret == GATTLIB_SUCCESS) {
+					ret = subscription_ret;
+				}
+			}
+		}
+		g_array_free(subscriptions, TRUE);
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if ((connection->reconnect != NULL) && connection->reconnect->is_reconnecting) {
+		_reconnect_emit(connection, GATTLIB_RECONNECT_EVENT_RECONNECTED, ret);
+		_reconnect_stop(connection);
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+}
+
+static gboolean _reconnect_attempt(gpointer data) {
+	gattlib_connection_t* connection = data;
+	struct gattlib_reconnect* reconnect;
+	gattlib_device_t* device;
+	int ret;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	reconnect = connection->reconnect;
+	if ((reconnect == NULL) || !reconnect->is_reconnecting) {
+		goto EXIT;
+	}
+
+	reconnect->timeout_id = 0;
+	device = connection->device;
+
+	if (!gattlib_adapter_is_valid(device->adapter)) {
+		_reconnect_failed(connection, GATTLIB_ADAPTER_CLOSE);
+		goto EXIT;
+	}
+
+	if (gattlib_device_get_device(device->adapter, device->device_id) != device) {
+		// The device has been removed from the adapter
+		_reconnect_failed(connection, GATTLIB_NOT_FOUND);
+		goto EXIT;
+	}
+
+	if (device->state != DISCONNECTED) {
+		// The application is already reconnecting the device by itself
+		GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_reconnect: '%s' is in state %s. Stop the reconnection.",
+			reconnect->dst, device_state_str[device->state]);
+		connection->on_connection = reconnect->on_connection;
+		_reconnect_stop(connection);
+		goto EXIT;
+	}
+
+	reconnect->attempt++;
+	_reconnect_emit(connection, GATTLIB_RECONNECT_EVENT_ATTEMPT, GATTLIB_SUCCESS);
+
+	ret = gattlib_connect(device->adapter, reconnect->dst, GATTLIB_CONNECTION_OPTIONS_NONE, _on_reconnect_connected, connection);
+	if (ret != GATTLIB_SUCCESS) {
+		GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_reconnect: Failed to request the connection (%d)", ret);
+		// The errors returned by gattlib_connect() are not reported to its callback
+		_on_reconnect_connected(device->adapter, reconnect->dst, NULL, ret, connection);
+	}
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	// We return FALSE when it is a one-off event
+	return FALSE;
+}
+
+void gattlib_reconnect_on_disconnection(gattlib_connection_t* connection, bool is_link_lost, const char* dst) {
+	struct gattlib_reconnect* reconnect = connection->reconnect;
+
+	if (!is_link_lost || (reconnect == NULL) || (dst == NULL)) {
+		// The subscriptions are only kept to be restored by the automatic reconnection
+		if (connection->subscriptions != NULL) {
+			g_array_set_size(connection->subscriptions, 0);
+		}
+		return;
+	}
+
+	if (reconnect->is_reconnecting) {
+		return;
+	}
+
+	GATTLIB_LOG(GATTLIB_INFO, "gattlib_reconnect: Link to '%s' lost. Reconnecting.", dst);
+
+	reconnect->is_reconnecting = true;
+	reconnect->attempt = 0;
+	reconnect->backoff_ms = reconnect->initial_backoff_ms;
+	reconnect->link_lost_timestamp_ns = gattlib_get_monotonic_time_ns();
+	reconnect->dst = strdup(dst);
+	reconnect->on_connection = connection->on_connection;
+
+	// Keep the device while we are reconnecting it
+	gattlib_device_ref(connection->device);
+
+	_reconnect_emit(connection, GATTLIB_RECONNECT_EVENT_LINK_LOST, GATTLIB_DEVICE_DISCONNECTED);
+	_reconnect_schedule(connection);
+}
+
+void gattlib_reconnect_free(gattlib_connection_t* connection) {
+	struct gattlib_reconnect* reconnect = connection->reconnect;
+
+	if (reconnect == NULL) {
+		return;
+	}
+
+	if (reconnect->is_reconnecting) {
+		connection->on_connection = reconnect->on_connection;
+		_reconnect_stop(connection);
+	}
+
+	free(reconnect);
+	connection->reconnect = NULL;
+}
+
+int gattlib_connection_set_auto_reconnect(gattlib_connection_t* connection, unsigned int max_attempts,
+		unsigned int initial_backoff_ms, unsigned int max_backoff_ms,
+		gattlib_reconnect_event_cb_t event_cb, void* user_data)
+{
+	struct gattlib_reconnect* reconnect;
+	int ret = GATTLIB_SUCCESS;
+
+	if (connection == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_valid(connection)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_connection_set_auto_reconnect: Device not valid");
+		ret = GATTLIB_DEVICE_DISCONNECTED;
+		goto EXIT;
+	}
+
+	if (max_attempts == 0) {
+		gattlib_reconnect_free(connection);
+		goto EXIT;
+	}
+
+	reconnect = connection->reconnect;
+	if (reconnect == NULL) {
+		reconnect = calloc(sizeof(struct gattlib_reconnect), 1);
+		if (reconnect == NULL) {
+			ret = GATTLIB_OUT_OF_MEMORY;
+			goto EXIT;
+		}
+		connection->reconnect = reconnect;
+	}
+
+	reconnect->max_attempts = max_attempts;
+	reconnect->initial_backoff_ms = initial_backoff_ms;
+	reconnect->max_backoff_ms = MAX(initial_backoff_ms, max_backoff_ms);
+	reconnect->event_cb = event_cb;
+	reconnect->user_data = user_data;
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+void gattlib_subscription_add(gattlib_connection_t* connection, const uuid_t* uuid, bool is_indication) {
+	struct gattlib_subscription subscription;
+
+	if (connection->subscriptions == NULL) {
+		connection->subscriptions = g_array_new(FALSE, FALSE, sizeof(struct gattlib_subscription));
+	}
+
+	for (guint i = 0; i < connection->subscriptions->len; i++) {
+		struct gattlib_subscription* existing = &g_array_index(connection->subscriptions, struct gattlib_subscription, i);
+		if (gattlib_uuid_cmp(&existing->uuid, uuid) == GATTLIB_SUCCESS) {
+			existing->is_indication = is_indication;
+			return;
+		}
+	}
+
+	memcpy(&subscription.uuid, uuid, sizeof(uuid_t));
+	subscription.is_indication = is_indication;
+	g_array_append_val(connection->subscriptions, subscription);
+}
+
+void gattlib_subscription_remove(gattlib_connection_t* connection, const uuid_t* uuid) {
+	if (connection->subscriptions == NULL) {
+		return;
+	}
+
+	for (guint i = 0; i < connection->subscriptions->len; i++) {
+		struct gattlib_subscription* existing = &g_array_index(connection->subscriptions, struct gattlib_subscription, i);
+		if (gattlib_uuid_cmp(&existing->uuid, uuid) == GATTLIB_SUCCESS) {
+			g_array_remove_index(connection->subscriptions, i);
+			return;
+		}
+	}
+}
@@ -0,0 +1,146 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <stdlib.h>
+
+#include <glib.h>
+
+#include "gattlib_scan_throttle.h"
+
+// Devices not seen for this duration are removed from the cache. They are reported again when they come back.
+#define SCAN_THROTTLE_EXPIRY_NS         (60ULL * 1000000000ULL)
+// Interval between two removals of the expired devices
+#define SCAN_THROTTLE_PRUNE_INTERVAL_NS (10ULL * 1000000000ULL)
+
+#define SCAN_THROTTLE_PAYLOAD_COUNT     2
+
+struct scan_throttle_entry {
+	// Key of the entry in the cache
+	uint64_t address;
+	uint64_t last_seen_ns;
+
+	// State of the device when it has been reported for the last time
+	uint64_t reported_ns;
+	int16_t reported_rssi;
+	uint64_t reported_payload_hash[SCAN_THROTTLE_PAYLOAD_COUNT];
+	// Bitmask of the payloads already reported
+	uint8_t reported_payloads;
+};
+
+struct gattlib_scan_throttle_cache {
+	// Entries 'struct scan_throttle_entry' indexed by their address
+	GHashTable* entries;
+	uint64_t next_prune_ns;
+};
+
+struct gattlib_scan_throttle_cache* gattlib_scan_throttle_cache_new(void) {
+	struct gattlib_scan_throttle_cache* cache = calloc(1, sizeof(struct gattlib_scan_throttle_cache));
+	if (cache == NULL) {
+		return NULL;
+	}
+
+	cache->entries = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, free);
+	return cache;
+}
+
+void gattlib_scan_throttle_cache_free(struct gattlib_scan_throttle_cache* cache) {
+	if (cache == NULL) {
+		return;
+	}
+
+	g_hash_table_destroy(cache->entries);
+	free(cache);
+}
+
+// 64-bit FNV-1a
+uint64_t gattlib_scan_throttle_hash(uint64_t hash, const uint8_t* data, size_t length) {
+	size_t i;
+
+	for (i = 0; i < length; i++) {
+		hash ^= data[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static gboolean is_entry_expired(gpointer key, gpointer value, gpointer user_data) {
+	const struct scan_throttle_entry* entry = value;
+	uint64_t expiry_ns = *(const uint64_t*)user_data;
+
+	return entry->last_seen_ns < expiry_ns;
+}
+
+static void record_report(struct scan_throttle_entry* entry, int16_t rssi, unsigned int payload_index, uint64_t payload_hash,
+		uint64_t timestamp_ns)
+{
+	entry->reported_ns = timestamp_ns;
+	entry->reported_rssi = rssi;
+	entry->reported_payload_hash[payload_index] = payload_hash;
+	entry->reported_payloads |= 1 << payload_index;
+}
+
+bool gattlib_scan_throttle_cache_update(struct gattlib_scan_throttle_cache* cache, const gattlib_scan_throttle_t* throttle,
+		uint64_t address, int16_t rssi, unsigned int payload_index, uint64_t payload_hash, uint64_t timestamp_ns)
+{
+	struct scan_throttle_entry* entry;
+	bool is_changed = false;
+
+	if (payload_index >= SCAN_THROTTLE_PAYLOAD_COUNT) {
+		return false;
+	}
+
+	// Forget the devices that have not been seen for a while
+	if (timestamp_ns >= cache->next_prune_ns) {
+		if (timestamp_ns > SCAN_THROTTLE_EXPIRY_NS) {
+			uint64_t expiry_ns = timestamp_ns - SCAN_THROTTLE_EXPIRY_NS;
+			g_hash_table_foreach_remove(cache->entries, is_entry_expired, &expiry_ns);
+		}
+		cache->next_prune_ns = timestamp_ns + SCAN_THROTTLE_PRUNE_INTERVAL_NS;
+	}
+
+	entry = g_hash_table_lookup(cache->entries, &address);
+	if (entry == NULL) {
+		// First advertisement of the device. It is always reported.
+		entry = calloc(1, sizeof(struct scan_throttle_entry));
+		if (entry == NULL) {
+			return true;
+		}
+		entry->address = address;
+		entry->last_seen_ns = timestamp_ns;
+		record_report(entry, rssi, payload_index, payload_hash, timestamp_ns);
+		g_hash_table_insert(cache->entries, &entry->address, entry);
+		return true;
+	}
+
+	entry->last_seen_ns = timestamp_ns;
+
+	if (throttle->report_payload_change) {
+		if (((entry->reported_payloads & (1 << payload_index)) == 0) ||
+		    (entry->reported_payload_hash[payload_index] != payload_hash)) {
+			is_changed = true;
+		}
+	}
+
+	if ((throttle->rssi_delta_threshold > 0) && (rssi != GATTLIB_ADVERTISING_REPORT_RSSI_UNKNOWN)) {
+		if ((entry->reported_rssi == GATTLIB_ADVERTISING_REPORT_RSSI_UNKNOWN) || (abs(rssi - entry->reported_rssi) >= throttle->rssi_delta_threshold)) {
+			is_changed = true;
+		}
+	}
+
+	// Without any change criteria, the devices are reported periodically
+	if ((throttle->rssi_delta_threshold == 0) && !throttle->report_payload_change) {
+		is_changed = true;
+	}
+
+	// A change not reported because of the minimum interval is compared again with the next advertisements.
+	// It is reported once the interval has elapsed.
+	if (!is_changed || (timestamp_ns - entry->reported_ns < (uint64_t)throttle->min_report_interval_ms * 1000000ULL)) {
+		return false;
+	}
+
+	record_report(entry, rssi, payload_index, payload_hash, timestamp_ns);
+	return true;
+}
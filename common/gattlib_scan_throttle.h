@@ -0,0 +1,34 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#ifndef __GATTLIB_SCAN_THROTTLE_H__
+#define __GATTLIB_SCAN_THROTTLE_H__
+
+#include "gattlib.h"
+
+// The advertising data and the scan response data of a device are compared separately
+#define GATTLIB_SCAN_THROTTLE_PAYLOAD_ADVERTISING       0
+#define GATTLIB_SCAN_THROTTLE_PAYLOAD_SCAN_RESPONSE     1
+
+// Initial value of 'gattlib_scan_throttle_hash()'
+#define GATTLIB_SCAN_THROTTLE_HASH_INIT                 0xCBF29CE484222325ULL
+
+// Last-seen cache of the devices reported by a scan
+struct gattlib_scan_throttle_cache;
+
+struct gattlib_scan_throttle_cache* gattlib_scan_throttle_cache_new(void);
+
+void gattlib_scan_throttle_cache_free(struct gattlib_scan_throttle_cache* cache);
+
+// Hash the payload of an advertisement. Several buffers can be chained by passing the previous hash.
+uint64_t gattlib_scan_throttle_hash(uint64_t hash, const uint8_t* data, size_t length);
+
+// Record an advertisement of a device. Return true if it must be reported to the application:
+// either the device is new or it has changed enough since its last report.
+bool gattlib_scan_throttle_cache_update(struct gattlib_scan_throttle_cache* cache, const gattlib_scan_throttle_t* throttle,
+		uint64_t address, int16_t rssi, unsigned int payload_index, uint64_t payload_hash, uint64_t timestamp_ns);
+
+#endif
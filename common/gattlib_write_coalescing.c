@@ -0,0 +1,257 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <string.h>
+
+#include "gattlib_internal.h"
+
+// Note: The coalescers are kept until the device is freed. Disabling the coalescing of a characteristic
+//       only prevents new writes from being coalesced. The writer task holds a reference on the coalescer
+//       and on the device while it drains the values.
+struct gattlib_write_coalescer {
+	GMutex mutex;
+	gint reference_counter;
+	bool is_enabled;
+	// Queue of the writer task. The task is not held back by the events of the connection.
+	struct gattlib_serial_queue* queue;
+	// A writer task is sending the values of the characteristic
+	bool is_writing;
+	gattlib_connection_t* connection;
+	uuid_t uuid;
+	gattlib_write_coalescing_write_t write_func;
+	// Latest value not sent yet. NULL if none.
+	uint8_t* pending;
+	size_t pending_length;
+	gattlib_priority_t pending_priority;
+	uint64_t written;
+	uint64_t coalesced;
+};
+
+void gattlib_write_coalescer_unref(gpointer data) {
+	struct gattlib_write_coalescer* coalescer = data;
+
+	if (!g_atomic_int_dec_and_test(&coalescer->reference_counter)) {
+		return;
+	}
+
+	gattlib_serial_queue_unref(coalescer->queue);
+	g_mutex_clear(&coalescer->mutex);
+	free(coalescer->pending);
+	free(coalescer);
+}
+
+// Write the latest value of the characteristic until there is no newer one
+static void _coalescer_drain(void* args) {
+	struct gattlib_write_coalescer* coalescer = args;
+	gattlib_device_t* device = coalescer->connection->device;
+	gattlib_priority_t priority;
+	uint8_t* value;
+	size_t value_len;
+	int ret;
+
+	while (true) {
+		g_mutex_lock(&coalescer->mutex);
+		value = coalescer->pending;
+		value_len = coalescer->pending_length;
+		priority = coalescer->pending_priority;
+		coalescer->pending = NULL;
+		if (value == NULL) {
+			coalescer->is_writing = false;
+			g_mutex_unlock(&coalescer->mutex);
+			break;
+		}
+		coalescer->written++;
+		g_mutex_unlock(&coalescer->mutex);
+
+		ret = coalescer->write_func(coalescer->connection, &coalescer->uuid, value, value_len, priority);
+		if (ret != GATTLIB_SUCCESS) {
+			GATTLIB_LOG(GATTLIB_WARNING, "Coalesced write without response has failed (ret:%d)", ret);
+		}
+		free(value);
+	}
+
+	gattlib_device_unref(device);
+	gattlib_write_coalescer_unref(coalescer);
+}
+
+// Note: 'm_gattlib_mutex' must be held
+static struct gattlib_write_coalescer* _coalescer_lookup(gattlib_connection_t* connection, const uuid_t* uuid) {
+	char uuid_str[MAX_LEN_UUID_STR + 1];
+
+	if (connection->device->write_coalescers == NULL) {
+		return NULL;
+	}
+
+	gattlib_uuid_to_string(uuid, uuid_str, sizeof(uuid_str));
+	return g_hash_table_lookup(connection->device->write_coalescers, uuid_str);
+}
+
+int gattlib_write_coalescing_enable(gattlib_connection_t* connection, const uuid_t* uuid, bool enable) {
+	struct gattlib_write_coalescer* coalescer;
+	char uuid_str[MAX_LEN_UUID_STR + 1];
+	int ret = GATTLIB_SUCCESS;
+
+	if (uuid == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_valid(connection)) {
+		ret = GATTLIB_INVALID_PARAMETER;
+		goto EXIT;
+	}
+
+	coalescer = _coalescer_lookup(connection, uuid);
+	if (coalescer == NULL) {
+		if (!enable) {
+			goto EXIT;
+		}
+
+		coalescer = calloc(sizeof(struct gattlib_write_coalescer), 1);
+		if (coalescer == NULL) {
+			ret = GATTLIB_OUT_OF_MEMORY;
+			goto EXIT;
+		}
+		coalescer->queue = gattlib_serial_queue_new();
+		if (coalescer->queue == NULL) {
+			free(coalescer);
+			ret = GATTLIB_OUT_OF_MEMORY;
+			goto EXIT;
+		}
+		g_mutex_init(&coalescer->mutex);
+		// Reference of the device
+		coalescer->reference_counter = 1;
+
+		if (connection->device->write_coalescers == NULL) {
+			connection->device->write_coalescers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					gattlib_write_coalescer_unref);
+		}
+		gattlib_uuid_to_string(uuid, uuid_str, sizeof(uuid_str));
+		g_hash_table_insert(connection->device->write_coalescers, g_strdup(uuid_str), coalescer);
+	}
+
+	g_mutex_lock(&coalescer->mutex);
+	coalescer->is_enabled = enable;
+	g_mutex_unlock(&coalescer->mutex);
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+int gattlib_write_coalescing_get_stats(gattlib_connection_t* connection, const uuid_t* uuid,
+		uint64_t* written, uint64_t* coalesced)
+{
+	struct gattlib_write_coalescer* coalescer;
+	int ret = GATTLIB_SUCCESS;
+
+	if (uuid == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_valid(connection)) {
+		ret = GATTLIB_INVALID_PARAMETER;
+		goto EXIT;
+	}
+
+	coalescer = _coalescer_lookup(connection, uuid);
+	if (coalescer == NULL) {
+		ret = GATTLIB_NOT_FOUND;
+		goto EXIT;
+	}
+
+	g_mutex_lock(&coalescer->mutex);
+	if (written != NULL) {
+		*written = coalescer->written;
+	}
+	if (coalesced != NULL) {
+		*coalesced = coalescer->coalesced;
+	}
+	g_mutex_unlock(&coalescer->mutex);
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
+bool gattlib_write_coalescing_submit(gattlib_connection_t* connection, const uuid_t* uuid,
+		const void* buffer, size_t buffer_len, gattlib_priority_t priority, gattlib_write_coalescing_write_t write_func,
+		int* result)
+{
+	struct gattlib_write_coalescer* coalescer;
+	uint8_t* value;
+	bool is_queued = false;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_valid(connection)) {
+		goto EXIT;
+	}
+
+	coalescer = _coalescer_lookup(connection, uuid);
+	if (coalescer == NULL) {
+		goto EXIT;
+	}
+
+	g_mutex_lock(&coalescer->mutex);
+
+	if (!coalescer->is_enabled) {
+		g_mutex_unlock(&coalescer->mutex);
+		goto EXIT;
+	}
+
+	value = malloc(buffer_len > 0 ? buffer_len : 1);
+	if (value == NULL) {
+		GATTLIB_LOG(GATTLIB_WARNING, "gattlib_write_coalescing_submit: Cannot allocate value. Write it directly.");
+		g_mutex_unlock(&coalescer->mutex);
+		goto EXIT;
+	}
+	memcpy(value, buffer, buffer_len);
+
+	// The value replaces the one not sent yet
+	if (coalescer->pending != NULL) {
+		free(coalescer->pending);
+		coalescer->coalesced++;
+	}
+	coalescer->pending = value;
+	coalescer->pending_length = buffer_len;
+	coalescer->pending_priority = priority;
+	is_queued = true;
+	*result = GATTLIB_SUCCESS;
+
+	if (!coalescer->is_writing) {
+		int ret;
+
+		// Start the writer. It keeps the device, and so the connection, alive until it has drained the values.
+		gattlib_device_ref(connection->device);
+		g_atomic_int_inc(&coalescer->reference_counter);
+		coalescer->connection = connection;
+		memcpy(&coalescer->uuid, uuid, sizeof(coalescer->uuid));
+		coalescer->write_func = write_func;
+		coalescer->is_writing = true;
+
+		ret = gattlib_serial_queue_push(coalescer->queue, _coalescer_drain, coalescer, 0);
+		if (ret != GATTLIB_SUCCESS) {
+			coalescer->is_writing = false;
+			free(coalescer->pending);
+			coalescer->pending = NULL;
+			*result = ret;
+			g_mutex_unlock(&coalescer->mutex);
+			gattlib_device_unref(connection->device);
+			gattlib_write_coalescer_unref(coalescer);
+			goto EXIT;
+		}
+	}
+
+	g_mutex_unlock(&coalescer->mutex);
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return is_queued;
+}
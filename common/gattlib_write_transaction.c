@@ -0,0 +1,65 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gattlib_write_transaction.h"
+
+static void gattlib_write_transaction_item_free(gpointer data) {
+	struct gattlib_write_transaction_item* item = data;
+
+	free(item->value);
+	free(item);
+}
+
+int gattlib_write_transaction_begin(gattlib_connection_t* connection, gattlib_write_transaction_t** transaction) {
+	if ((connection == NULL) || (transaction == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	*transaction = calloc(sizeof(gattlib_write_transaction_t), 1);
+	if (*transaction == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	(*transaction)->connection = connection;
+	(*transaction)->items = g_ptr_array_new_with_free_func(gattlib_write_transaction_item_free);
+
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_write_transaction_add(gattlib_write_transaction_t* transaction, const uuid_t* uuid, const void* buffer, size_t buffer_len) {
+	struct gattlib_write_transaction_item* item;
+
+	if ((transaction == NULL) || (uuid == NULL) || ((buffer == NULL) && (buffer_len > 0))) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	item = calloc(sizeof(struct gattlib_write_transaction_item), 1);
+	if (item == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	item->value = malloc(buffer_len > 0 ? buffer_len : 1);
+	if (item->value == NULL) {
+		free(item);
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	memcpy(&item->uuid, uuid, sizeof(uuid_t));
+	memcpy(item->value, buffer, buffer_len);
+	item->value_length = buffer_len;
+
+	g_ptr_array_add(transaction->items, item);
+	return GATTLIB_SUCCESS;
+}
+
+void gattlib_write_transaction_abort(gattlib_write_transaction_t* transaction) {
+	if (transaction == NULL) {
+		return;
+	}
+
+	g_ptr_array_free(transaction->items, TRUE);
+	free(transaction);
+}
@@ -0,0 +1,27 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#ifndef __GATTLIB_WRITE_TRANSACTION_H__
+#define __GATTLIB_WRITE_TRANSACTION_H__
+
+#include <glib.h>
+
+#include "gattlib.h"
+
+struct gattlib_write_transaction_item {
+	uuid_t   uuid;
+	uint8_t* value;
+	size_t   value_length;
+};
+
+// Values of the transaction. Each backend only implements 'gattlib_write_transaction_commit()'.
+struct _gattlib_write_transaction {
+	gattlib_connection_t* connection;
+	// Array of 'struct gattlib_write_transaction_item*'
+	GPtrArray*            items;
+};
+
+#endif
@@ -157,10 +157,146 @@ EXIT:
 	return FALSE;
 }
 
+struct gattlib_connect_context {
+	gattlib_connection_t* connection;
+	char* dst;
+};
+
+static void _gattlib_connect_context_free(struct gattlib_connect_context* context) {
+	// Release the reference taken by gattlib_connect()
+	gattlib_device_unref(context->connection->device);
+	free(context->dst);
+	free(context);
+}
+
+static void _gattlib_connect_failed(struct gattlib_connect_context* context, int error) {
+	gattlib_connection_t* connection = context->connection;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (connection->backend.on_handle_device_property_change_id != 0) {
+		g_signal_handler_disconnect(connection->backend.device, connection->backend.on_handle_device_property_change_id);
+		connection->backend.on_handle_device_property_change_id = 0;
+	}
+
+	if (connection->backend.device != NULL) {
+		g_object_unref(connection->backend.device);
+		connection->backend.device = NULL;
+	}
+
+	free(connection->backend.device_object_path);
+	connection->backend.device_object_path = NULL;
+
+	// Fail to connect. Mark the device has disconnected to be able to reconnect
+	gattlib_device_set_state(connection->device->adapter, connection->device->device_id, DISCONNECTED);
+
+	// The error is reported through the connection callback
+	gattlib_on_connection_failure(connection, context->dst, error);
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+}
+
+static void _on_device_connect_ready(GObject* source_object, GAsyncResult* res, gpointer user_data) {
+	struct gattlib_connect_context* context = user_data;
+	gattlib_connection_t* connection = context->connection;
+	GError *error = NULL;
+	int ret;
+
+	org_bluez_device1_call_connect_finish(ORG_BLUEZ_DEVICE1(source_object), res, &error);
+	if (error) {
+		gchar* remote_error = g_dbus_error_get_remote_error(error);
+
+		if (strncmp(error->message, m_dbus_error_unknown_object, strlen(m_dbus_error_unknown_object)) == 0) {
+			// You might have this error if the computer has not scanned or has not already had
+			// pairing information about the targetted device.
+			GATTLIB_LOG(GATTLIB_ERROR, "Device '%s' cannot be found (%d, %d)", context->dst, error->domain, error->code);
+			ret = GATTLIB_NOT_FOUND;
+		} else if ((error->domain == 238) && (error->code == 60952)) {
+			GATTLIB_LOG(GATTLIB_ERROR, "Device '%s': %s", context->dst, error->message);
+			ret = GATTLIB_TIMEOUT;
+		} else if ((remote_error != NULL) && (strcmp(remote_error, "org.bluez.Error.InProgress") == 0)) {
+			GATTLIB_LOG(GATTLIB_ERROR, "Device '%s': %s", context->dst, error->message);
+			ret = GATTLIB_BUSY;
+		} else if ((remote_error != NULL) && (strcmp(remote_error, "org.bluez.Error.InvalidArguments") == 0)) {
+			// Permanent errors are mapped to gattlib errors so the callers do not retry them
+			GATTLIB_LOG(GATTLIB_ERROR, "Device '%s': %s", context->dst, error->message);
+			ret = GATTLIB_INVALID_PARAMETER;
+		} else if ((remote_error != NULL) && (strcmp(remote_error, "org.bluez.Error.NotSupported") == 0)) {
+			GATTLIB_LOG(GATTLIB_ERROR, "Device '%s': %s", context->dst, error->message);
+			ret = GATTLIB_NOT_SUPPORTED;
+		} else {
+			GATTLIB_LOG(GATTLIB_ERROR, "Device connected error (device:%s): %s",
+				connection->device->device_id,
+				error->message);
+			ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
+		}
+
+		g_free(remote_error);
+		g_error_free(error);
+
+		_gattlib_connect_failed(context, ret);
+		goto EXIT;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	// Wait for the property 'UUIDs' to be changed. We assume 'org.bluez.GattService1
+	// and 'org.bluez.GattCharacteristic1' to be advertised at that moment.
+	// Note: The services might have already been resolved before we received the reply.
+	if (connection->device->state == CONNECTING) {
+		connection->backend.connection_timeout_id = g_timeout_add_seconds(CONNECT_TIMEOUT_SEC, _stop_connect_func, connection);
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+EXIT:
+	_gattlib_connect_context_free(context);
+}
+
+static void _on_device_proxy_ready(GObject* source_object, GAsyncResult* res, gpointer user_data) {
+	struct gattlib_connect_context* context = user_data;
+	gattlib_connection_t* connection = context->connection;
+	GError *error = NULL;
+	int ret;
+
+	OrgBluezDevice1* bluez_device = org_bluez_device1_proxy_new_for_bus_finish(res, &error);
+	if (bluez_device == NULL) {
+		ret = GATTLIB_ERROR_DBUS;
+		if (error) {
+			ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
+			GATTLIB_LOG(GATTLIB_ERROR, "Failed to connect to DBus Bluez Device: %s", error->message);
+			g_error_free(error);
+		} else {
+			GATTLIB_LOG(GATTLIB_ERROR, "gattlib_connect: Failed to connect to DBus Bluez Device");
+		}
+
+		_gattlib_connect_failed(context, ret);
+		_gattlib_connect_context_free(context);
+		return;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	connection->backend.device = bluez_device;
+	connection->backend.device_object_path = strdup(connection->device->device_id);
+
+	// Register a handle for notification
+	connection->backend.on_handle_device_property_change_id = g_signal_connect(bluez_device,
+		"g-properties-changed",
+		G_CALLBACK(on_handle_device_property_change),
+		connection);
+
+	// The result is reported by '_on_device_connect_ready()'. The context is now owned by this request.
+	org_bluez_device1_call_connect(bluez_device, NULL, _on_device_connect_ready, context);
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+}
+
 /**
  * @brief Function to asynchronously connect to a BLE device
  *
- * @note This function is mainly used before Bluez v5.42 (prior to D-BUS support)
+ * The D-Bus requests are asynchronous. The function returns as soon as the connection has been
+ * requested. The result of the connection is reported to 'connect_cb'.
  *
  * @param adapter	Local Adaptater interface. When passing NULL, we use default adapter.
  * @param dst		Remote Bluetooth address
@@ -175,8 +311,8 @@ int gattlib_connect(gattlib_adapter_t* adapter, const char *dst,
 		gatt_connect_cb_t connect_cb,
 		void* user_data)
 {
+	struct gattlib_connect_context* context;
 	const char* adapter_name = NULL;
-	GError *error = NULL;
 	char object_path[GATTLIB_DBUS_OBJECT_PATH_SIZE_MAX];
 	int ret = GATTLIB_SUCCESS;
 
@@ -218,91 +354,37 @@ int gattlib_connect(gattlib_adapter_t* adapter, const char *dst,
 		goto EXIT;
 	}
 
+	context = calloc(sizeof(struct gattlib_connect_context), 1);
+	if (context == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+	context->connection = &device->connection;
+	context->dst = strdup(dst);
+
+	// Keep the device while the connection is in progress
+	gattlib_device_ref(device);
+
 	device->connection.on_connection.callback.connection_handler = connect_cb;
 	device->connection.on_connection.user_data = user_data;
 
 	GATTLIB_LOG(GATTLIB_DEBUG, "Connecting bluetooth device %s", dst);
 
-	// Mark the device has disconnected
+	// Mark the device has connecting
 	gattlib_device_set_state(device->adapter, device->device_id, CONNECTING);
 
-	OrgBluezDevice1* bluez_device = org_bluez_device1_proxy_new_for_bus_sync(
+	// The connection continues in '_on_device_proxy_ready()'
+	org_bluez_device1_proxy_new_for_bus(
 			G_BUS_TYPE_SYSTEM,
 			G_DBUS_PROXY_FLAGS_NONE,
 			"org.bluez",
 			object_path,
 			NULL,
-			&error);
-	if (bluez_device == NULL) {
-		ret = GATTLIB_ERROR_DBUS;
-		if (error) {
-			ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
-			GATTLIB_LOG(GATTLIB_ERROR, "Failed to connect to DBus Bluez Device: %s", error->message);
-			g_error_free(error);
-		} else {
-			GATTLIB_LOG(GATTLIB_ERROR, "gattlib_connect: Failed to connect to DBus Bluez Device");
-		}
-		goto EXIT;
-	} else {
-		device->connection.backend.device = bluez_device;
-		device->connection.backend.device_object_path = strdup(object_path);
-	}
-
-	// Register a handle for notification
-	device->connection.backend.on_handle_device_property_change_id = g_signal_connect(bluez_device,
-		"g-properties-changed",
-		G_CALLBACK(on_handle_device_property_change),
-		&device->connection);
-
-	error = NULL;
-	org_bluez_device1_call_connect_sync(bluez_device, NULL, &error);
-	if (error) {
-		if (strncmp(error->message, m_dbus_error_unknown_object, strlen(m_dbus_error_unknown_object)) == 0) {
-			// You might have this error if the computer has not scanned or has not already had
-			// pairing information about the targetted device.
-			GATTLIB_LOG(GATTLIB_ERROR, "Device '%s' cannot be found (%d, %d)", dst, error->domain, error->code);
-			ret = GATTLIB_NOT_FOUND;
-		} else if ((error->domain == 238) && (error->code == 60952)) {
-			GATTLIB_LOG(GATTLIB_ERROR, "Device '%s': %s", dst, error->message);
-			ret = GATTLIB_TIMEOUT;
-		} else {
-			GATTLIB_LOG(GATTLIB_ERROR, "Device connected error (device:%s): %s",
-				device->connection.backend.device_object_path,
-				error->message);
-			ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
-		}
-
-		g_error_free(error);
-
-		// Fail to connect. Mark the device has disconnected to be able to reconnect
-		gattlib_device_set_state(adapter, device->device_id, DISCONNECTED);
-
-		goto FREE_DEVICE;
-	}
-
-	// Wait for the property 'UUIDs' to be changed. We assume 'org.bluez.GattService1
-	// and 'org.bluez.GattCharacteristic1' to be advertised at that moment.
-	device->connection.backend.connection_timeout_id = g_timeout_add_seconds(CONNECT_TIMEOUT_SEC, _stop_connect_func, &device->connection);
-
-	g_rec_mutex_unlock(&m_gattlib_mutex);
-	return GATTLIB_SUCCESS;
-
-FREE_DEVICE:
-	g_rec_mutex_lock(&m_gattlib_mutex);
-	free(device->connection.backend.device_object_path);
-	device->connection.backend.device_object_path = NULL;
-	g_rec_mutex_unlock(&m_gattlib_mutex);
-
-	// destroy default adapter
-	if(adapter == NULL) {
-		gattlib_adapter_close(adapter);
-	}
+			_on_device_proxy_ready,
+			context);
 
 EXIT:
-	if (ret != GATTLIB_SUCCESS) {
-		connect_cb(adapter, dst, NULL, ret /* error */, user_data);
-	}
-
+	// Note: The errors returned by this function are not reported to 'connect_cb'
 	g_rec_mutex_unlock(&m_gattlib_mutex);
 	return ret;
 }
@@ -352,33 +434,70 @@ void gattlib_connection_free(gattlib_connection_t* connection) {
 	gattlib_device_set_state(connection->device->adapter, device_id, DISCONNECTED);
 }
 
-int gattlib_disconnect(gattlib_connection_t* connection, bool wait_disconnection) {
+static void _on_device_disconnect_ready(GObject* source_object, GAsyncResult* res, gpointer user_data) {
+	gattlib_connection_t* connection = user_data;
+	struct gattlib_handler on_disconnect_complete = { 0 };
 	GError *error = NULL;
-	int ret = GATTLIB_SUCCESS;
+	int ret;
 
-	if (connection == NULL) {
-		GATTLIB_LOG(GATTLIB_ERROR, "Cannot disconnect - connection parameter is not valid.");
-		return GATTLIB_INVALID_PARAMETER;
+	org_bluez_device1_call_disconnect_finish(ORG_BLUEZ_DEVICE1(source_object), res, &error);
+	if (error == NULL) {
+		// The disconnection is completed by the disconnection callback
+		// See gattlib_on_disconnected_device()
+		goto EXIT;
 	}
 
+	GATTLIB_LOG(GATTLIB_ERROR, "Failed to disconnect DBus Bluez Device: %s", error->message);
+	ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
+	g_error_free(error);
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	// The device has not been disconnected. Restore its state to allow a new disconnection.
+	if (connection->device->state == DISCONNECTING) {
+		gattlib_device_set_state(connection->device->adapter, connection->device->device_id, CONNECTED);
+
+		on_disconnect_complete = connection->on_disconnect_complete;
+		connection->on_disconnect_complete.callback.callback = NULL;
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	if (gattlib_has_valid_handler(&on_disconnect_complete)) {
+		on_disconnect_complete.callback.disconnect_handler(connection, ret, on_disconnect_complete.user_data);
+	}
+
+	gattlib_completion_complete(&connection->disconnection, ret);
+
+EXIT:
+	// Release the reference taken when the disconnection has been requested
+	gattlib_device_unref(connection->device);
+}
+
+static int _gattlib_disconnect(gattlib_connection_t* connection, gattlib_disconnect_cb_t disconnect_cb, void* user_data) {
+	int ret = GATTLIB_SUCCESS;
+
 	g_rec_mutex_lock(&m_gattlib_mutex);
 
 	if (!gattlib_connection_is_connected(connection)) {
 		GATTLIB_LOG(GATTLIB_ERROR, "Cannot disconnect - connection is not in connected state (state=%s).",
 			device_state_str[connection->device->state]);
-		g_rec_mutex_unlock(&m_gattlib_mutex);
-		return GATTLIB_BUSY;
+		ret = GATTLIB_BUSY;
+		goto EXIT;
 	}
 
 	GATTLIB_LOG(GATTLIB_DEBUG, "Disconnecting bluetooth device %s", connection->backend.device_object_path);
 
-	org_bluez_device1_call_disconnect_sync(connection->backend.device, NULL, &error);
-	if (error) {
-		GATTLIB_LOG(GATTLIB_ERROR, "Failed to disconnect DBus Bluez Device: %s", error->message);
-		g_error_free(error);
+	gattlib_completion_reset(&connection->disconnection);
 
-		// We continue, we still want to set the correct state
-	}
+	connection->on_disconnect_complete.callback.disconnect_handler = disconnect_cb;
+	connection->on_disconnect_complete.user_data = user_data;
+
+	// Ensure the connection is not freed before the D-Bus request completes
+	gattlib_device_ref(connection->device);
+
+	// The request is asynchronous to allow many devices to be disconnected in parallel
+	org_bluez_device1_call_disconnect(connection->backend.device, NULL, _on_device_disconnect_ready, connection);
 
 	// Mark the device has disconnected
 	gattlib_device_set_state(connection->device->adapter, connection->device->device_id, DISCONNECTING);
@@ -386,29 +505,50 @@ int gattlib_disconnect(gattlib_connection_t* connection, bool wait_disconnection
 	//Note: Signals and memory will be removed/clean on disconnction callback
 	//      See _gattlib_clean_on_disconnection()
 
-	// We must release the mutex before the loop to leave other threads to signal the disconnection
+EXIT:
 	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
 
-	if (wait_disconnection) {
-		gint64 end_time;
-
-		g_mutex_lock(&m_gattlib_signal.mutex);
+int gattlib_disconnect(gattlib_connection_t* connection, bool wait_disconnection) {
+	int ret;
 
-		end_time = g_get_monotonic_time() + GATTLIB_DISCONNECTION_WAIT_TIMEOUT_SEC * G_TIME_SPAN_SECOND;
+	if (connection == NULL) {
+		GATTLIB_LOG(GATTLIB_ERROR, "Cannot disconnect - connection parameter is not valid.");
+		return GATTLIB_INVALID_PARAMETER;
+	}
 
-		while (gattlib_connection_is_connected(connection)) {
-			if (!g_cond_wait_until(&m_gattlib_signal.condition, &m_gattlib_signal.mutex, end_time)) {
-				ret = GATTLIB_TIMEOUT;
-				break;
-			}
-		}
+	g_rec_mutex_lock(&m_gattlib_mutex);
 
-		g_mutex_unlock(&m_gattlib_signal.mutex);
+	ret = _gattlib_disconnect(connection, NULL, NULL);
+	if ((ret != GATTLIB_SUCCESS) || !wait_disconnection) {
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		return ret;
 	}
 
+	// Keep the connection while we are waiting for its disconnection
+	gattlib_device_ref(connection->device);
+
+	// We must release the mutex before waiting to leave other threads to signal the disconnection
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	// Only this connection's disconnection wakes us up
+	ret = gattlib_completion_wait_until(&connection->disconnection,
+		g_get_monotonic_time() + GATTLIB_DISCONNECTION_WAIT_TIMEOUT_SEC * G_TIME_SPAN_SECOND);
+
+	gattlib_device_unref(connection->device);
 	return ret;
 }
 
+int gattlib_disconnect_async(gattlib_connection_t* connection, gattlib_disconnect_cb_t disconnect_cb, void* user_data) {
+	if (connection == NULL) {
+		GATTLIB_LOG(GATTLIB_ERROR, "Cannot disconnect - connection parameter is not valid.");
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	return _gattlib_disconnect(connection, disconnect_cb, user_data);
+}
+
 // Bluez was using org.bluez.Device1.GattServices until 5.37 to expose the list of available GATT Services
 #if BLUEZ_VERSION < BLUEZ_VERSIONS(5, 38)
 int gattlib_discover_primary(gattlib_connection_t* connection, gattlib_primary_service_t** services, int* services_count) {
@@ -1152,6 +1292,73 @@ int gattlib_get_rssi(gattlib_connection_t *connection, int16_t *rssi)
 	return GATTLIB_SUCCESS;
 }
 
+int gattlib_get_mtu(gattlib_connection_t* connection, uint16_t* mtu)
+{
+	GError *error = NULL;
+	GDBusObjectManager *device_manager;
+	uint16_t characteristic_mtu = 0;
+	int ret = GATTLIB_SUCCESS;
+
+	if (mtu == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_connected(connection)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_get_mtu: Device not connected");
+		ret = GATTLIB_DEVICE_DISCONNECTED;
+		goto EXIT;
+	}
+
+	device_manager = get_device_manager_from_adapter(connection->device->adapter, &error);
+	if (device_manager == NULL) {
+		if (error != NULL) {
+			ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
+			GATTLIB_LOG(GATTLIB_ERROR, "Gattlib Context not initialized (%d, %d).", error->domain, error->code);
+			g_error_free(error);
+		} else {
+			ret = GATTLIB_ERROR_DBUS;
+			GATTLIB_LOG(GATTLIB_ERROR, "Gattlib Context not initialized.");
+		}
+		goto EXIT;
+	}
+
+	// BlueZ does not expose the MTU of the connection but the MTU used by each of its GATT characteristics.
+	// The property is only available from BlueZ v5.48.
+	for (GList *l = connection->backend.dbus_objects; (l != NULL) && (characteristic_mtu == 0); l = l->next) {
+		GDBusObject *object = l->data;
+		const char* object_path = g_dbus_object_get_object_path(G_DBUS_OBJECT(object));
+
+		if (!g_str_has_prefix(object_path, connection->backend.device_object_path)) {
+			continue;
+		}
+
+		GDBusInterface *interface = g_dbus_object_manager_get_interface(device_manager, object_path, "org.bluez.GattCharacteristic1");
+		if (!interface) {
+			continue;
+		}
+
+		GVariant *value = g_dbus_proxy_get_cached_property(G_DBUS_PROXY(interface), "MTU");
+		if (value != NULL) {
+			characteristic_mtu = g_variant_get_uint16(value);
+			g_variant_unref(value);
+		}
+
+		g_object_unref(interface);
+	}
+
+	if (characteristic_mtu == 0) {
+		ret = GATTLIB_NOT_SUPPORTED;
+	} else {
+		*mtu = characteristic_mtu;
+	}
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
 int gattlib_get_rssi_from_mac(gattlib_adapter_t* adapter, const char *mac_address, int16_t *rssi)
 {
 	OrgBluezDevice1 *bluez_device1;
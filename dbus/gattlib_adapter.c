@@ -74,6 +74,16 @@ int gattlib_adapter_open(const char* adapter_name, gattlib_adapter_t** adapter)
 	gattlib_adapter->reference_counter = 1;
 	gattlib_adapter->backend.adapter_proxy = adapter_proxy;
 
+	// Queue to serialize the discovery callbacks of the adapter
+	gattlib_adapter->serial_queue = gattlib_serial_queue_new();
+	if (gattlib_adapter->serial_queue == NULL) {
+		free(gattlib_adapter->id);
+		free(gattlib_adapter->name);
+		free(gattlib_adapter);
+		g_object_unref(adapter_proxy);
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
 	g_rec_mutex_lock(&m_gattlib_mutex);
 	m_adapter_list = g_slist_append(m_adapter_list, gattlib_adapter);
 	*adapter = gattlib_adapter;
@@ -128,51 +138,222 @@ EXIT:
 	return gattlib_adapter->backend.device_manager;
 }
 
-static void device_manager_on_added_device1_signal(const char* device1_path, gattlib_adapter_t* gattlib_adapter)
-{
-	GError *error = NULL;
-	OrgBluezDevice1* device1 = org_bluez_device1_proxy_new_for_bus_sync(
-			G_BUS_TYPE_SYSTEM,
-			G_DBUS_PROXY_FLAGS_NONE,
-			"org.bluez",
-			device1_path,
-			NULL,
-			&error);
-	if (error) {
-		GATTLIB_LOG(GATTLIB_ERROR, "Failed to connection to new DBus Bluez Device: %s",
-			error->message);
-		g_error_free(error);
+// Convert the UUID string of a 'ServiceData' key into its advertising form (little-endian, shortest form)
+static size_t _get_service_data_uuid(const char* uuid_str, uint8_t* ad_type, uint8_t* uuid_le) {
+	uuid_t uuid;
+	size_t length;
+
+	if (gattlib_string_to_uuid(uuid_str, strlen(uuid_str) + 1, &uuid) != 0) {
+		return 0;
+	}
+
+	length = gattlib_advertising_uuid_to_le(&uuid, uuid_le);
+	if (length == 16) {
+		*ad_type = 0x21;
+		return 16;
+	} else if (length == 0) {
+		return 0;
 	}
 
-	if (device1) {
-		const gchar *address = org_bluez_device1_get_address(device1);
-		int ret;
+	// Move the short form at the beginning of the buffer
+	memmove(uuid_le, &uuid_le[12], length);
+	*ad_type = (length == 2) ? 0x16 : 0x20;
+	return length;
+}
+
+static bool _get_device1_address(GDBusProxy* device1_proxy, uint64_t* address) {
+	GVariant *variant = g_dbus_proxy_get_cached_property(device1_proxy, "Address");
+	int ret;
+
+	if (variant == NULL) {
+		return false;
+	}
+	ret = gattlib_string_to_address48(g_variant_get_string(variant, NULL), address);
+	g_variant_unref(variant);
+
+	return (ret == GATTLIB_SUCCESS);
+}
 
-		// Sometimes org_bluez_device1_get_address returns null addresses. If that's the case, early return.
-		if (address == NULL) {
-			g_object_unref(device1);
-			return;
+/**
+ * Check the cached properties of a 'org.bluez.Device1' proxy against the address lists and the advertising
+ * filter of the adapter
+ *
+ * BlueZ does not forward the raw advertising data. The AD structures are rebuilt from the properties
+ * 'Name', 'ManufacturerData' and 'ServiceData'. The cached properties do not require any D-Bus round trip.
+ *
+ * @note Caller must hold 'm_gattlib_mutex'
+ */
+static bool _is_device1_reported(gattlib_adapter_t* gattlib_adapter, GDBusProxy* device1_proxy) {
+	const gattlib_advertising_filter_t* filter = gattlib_adapter->advertising_filter;
+	struct gattlib_advertising_filter_state state;
+	GVariant *variant;
+	uint64_t address;
+	int16_t rssi = GATTLIB_ADVERTISING_REPORT_RSSI_UNKNOWN;
+	bool is_matching = false;
+
+	if ((filter == NULL) && (gattlib_adapter->address_allowlist == NULL) && (gattlib_adapter->address_denylist == NULL)) {
+		return true;
+	}
+
+	if (!_get_device1_address(device1_proxy, &address)) {
+		return false;
+	}
+
+	if (!gattlib_address_set_is_reported(gattlib_adapter->address_allowlist, gattlib_adapter->address_denylist, address)) {
+		return false;
+	}
+	if (filter == NULL) {
+		return true;
+	}
+
+	variant = g_dbus_proxy_get_cached_property(device1_proxy, "RSSI");
+	if (variant != NULL) {
+		rssi = g_variant_get_int16(variant);
+		g_variant_unref(variant);
+	}
+
+	if (gattlib_advertising_filter_begin(filter, address, rssi, &state)) {
+		return true;
+	}
+
+	variant = g_dbus_proxy_get_cached_property(device1_proxy, "Name");
+	if (variant != NULL) {
+		gsize name_length;
+		const gchar* name = g_variant_get_string(variant, &name_length);
+
+		is_matching = gattlib_advertising_filter_feed(filter, &state, 0x09, NULL, 0, (const uint8_t*)name, name_length);
+		g_variant_unref(variant);
+		if (is_matching) {
+			return true;
 		}
+	}
 
-		g_rec_mutex_lock(&m_gattlib_mutex);
+	variant = g_dbus_proxy_get_cached_property(device1_proxy, "ManufacturerData");
+	if (variant != NULL) {
+		GVariantIter iter;
+		GVariant *value;
+		guint16 manufacturer_id;
+
+		g_variant_iter_init(&iter, variant);
+		while (!is_matching && g_variant_iter_next(&iter, "{qv}", &manufacturer_id, &value)) {
+			uint8_t header[2] = { manufacturer_id & 0xFF, manufacturer_id >> 8 };
+			gsize data_length = 0;
+			const uint8_t* data = g_variant_get_fixed_array(value, &data_length, sizeof(guchar));
+
+			is_matching = gattlib_advertising_filter_feed(filter, &state, 0xFF, header, sizeof(header), data, data_length);
+			g_variant_unref(value);
+		}
+		g_variant_unref(variant);
+		if (is_matching) {
+			return true;
+		}
+	}
+
+	variant = g_dbus_proxy_get_cached_property(device1_proxy, "ServiceData");
+	if (variant != NULL) {
+		GVariantIter iter;
+		GVariant *value;
+		const gchar *key;
+
+		g_variant_iter_init(&iter, variant);
+		while (!is_matching && g_variant_iter_next(&iter, "{&sv}", &key, &value)) {
+			uint8_t header[16];
+			uint8_t ad_type;
+			size_t header_length = _get_service_data_uuid(key, &ad_type, header);
+
+			if (header_length > 0) {
+				gsize data_length = 0;
+				const uint8_t* data = g_variant_get_fixed_array(value, &data_length, sizeof(guchar));
+
+				is_matching = gattlib_advertising_filter_feed(filter, &state, ad_type, header, header_length, data, data_length);
+			}
+			g_variant_unref(value);
+		}
+		g_variant_unref(variant);
+	}
+
+	return is_matching;
+}
 
-		if (!gattlib_adapter_is_valid(gattlib_adapter)) {
-			GATTLIB_LOG(GATTLIB_ERROR, "device_manager_on_added_device1_signal: Adapter not valid");
-			g_rec_mutex_unlock(&m_gattlib_mutex);
-			g_object_unref(device1);
-			return;
+/**
+ * Record an advertisement of a 'org.bluez.Device1' in the last-seen cache of the adapter
+ *
+ * The payload of the device is the content of its cached properties 'ManufacturerData' and 'ServiceData'.
+ *
+ * @return true if the device is new or has changed enough to be reported again
+ *
+ * @note Caller must hold 'm_gattlib_mutex'
+ */
+static bool _scan_throttle_update_device1(gattlib_adapter_t* gattlib_adapter, GDBusProxy* device1_proxy, uint64_t timestamp_ns) {
+	static const char* payload_properties[] = { "ManufacturerData", "ServiceData" };
+	uint64_t payload_hash = GATTLIB_SCAN_THROTTLE_HASH_INIT;
+	int16_t rssi = GATTLIB_ADVERTISING_REPORT_RSSI_UNKNOWN;
+	GVariant *variant;
+	uint64_t address;
+	size_t i;
+
+	if (gattlib_adapter->scan_throttle_cache == NULL) {
+		gattlib_adapter->scan_throttle_cache = gattlib_scan_throttle_cache_new();
+		if (gattlib_adapter->scan_throttle_cache == NULL) {
+			return true;
 		}
+	}
+
+	if (!_get_device1_address(device1_proxy, &address)) {
+		return true;
+	}
 
-		//TODO: Add support for connected device with 'gboolean org_bluez_device1_get_connected (OrgBluezDevice1 *object);'
-		//      When the device is connected, we potentially need to initialize some attributes
-		ret = gattlib_device_set_state(gattlib_adapter, device1_path, DISCONNECTED);
-		if (ret == GATTLIB_SUCCESS) {
-			gattlib_on_discovered_device(gattlib_adapter, device1);
+	variant = g_dbus_proxy_get_cached_property(device1_proxy, "RSSI");
+	if (variant != NULL) {
+		rssi = g_variant_get_int16(variant);
+		g_variant_unref(variant);
+	}
+
+	for (i = 0; i < sizeof(payload_properties) / sizeof(payload_properties[0]); i++) {
+		variant = g_dbus_proxy_get_cached_property(device1_proxy, payload_properties[i]);
+		if (variant != NULL) {
+			payload_hash = gattlib_scan_throttle_hash(payload_hash, g_variant_get_data(variant), g_variant_get_size(variant));
+			g_variant_unref(variant);
 		}
+	}
+
+	return gattlib_scan_throttle_cache_update(gattlib_adapter->scan_throttle_cache, &gattlib_adapter->scan_throttle,
+			address, rssi, GATTLIB_SCAN_THROTTLE_PAYLOAD_ADVERTISING, payload_hash, timestamp_ns);
+}
+
+static void device_manager_on_added_device1_signal(GDBusProxy* device1_proxy, gattlib_adapter_t* gattlib_adapter, uint64_t timestamp_ns)
+{
+	const char* device1_path = g_dbus_proxy_get_object_path(device1_proxy);
+	GVariant* address;
+	int ret;
+
+	// Sometimes the device is added without its address. If that's the case, early return.
+	address = g_dbus_proxy_get_cached_property(device1_proxy, "Address");
+	if (address == NULL) {
+		return;
+	}
+	g_variant_unref(address);
 
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_adapter_is_valid(gattlib_adapter)) {
+		GATTLIB_LOG(GATTLIB_ERROR, "device_manager_on_added_device1_signal: Adapter not valid");
 		g_rec_mutex_unlock(&m_gattlib_mutex);
-		g_object_unref(device1);
+		return;
+	}
+
+	//TODO: Add support for connected device with the property 'Connected'
+	//      When the device is connected, we potentially need to initialize some attributes
+	ret = gattlib_device_set_state(gattlib_adapter, device1_path, DISCONNECTED);
+	if (ret == GATTLIB_SUCCESS) {
+		// Seed the last-seen cache to not report the device again on its next advertisement
+		if (gattlib_adapter->has_scan_throttle) {
+			_scan_throttle_update_device1(gattlib_adapter, device1_proxy, timestamp_ns);
+		}
+		gattlib_on_discovered_device(gattlib_adapter, device1_proxy, timestamp_ns);
 	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
 }
 
 static void on_dbus_object_added(GDBusObjectManager *device_manager,
@@ -180,6 +361,8 @@ static void on_dbus_object_added(GDBusObjectManager *device_manager,
                      gpointer            user_data)
 {
 	const char* object_path = g_dbus_object_get_object_path(G_DBUS_OBJECT(object));
+	// Timestamp the event as soon as it enters gattlib
+	uint64_t timestamp_ns = gattlib_get_monotonic_time_ns();
 
 	GDBusInterface *interface = g_dbus_object_manager_get_interface(device_manager, object_path, "org.bluez.Device1");
 	if (!interface) {
@@ -189,8 +372,16 @@ static void on_dbus_object_added(GDBusObjectManager *device_manager,
 
 	GATTLIB_LOG(GATTLIB_DEBUG, "DBUS: on_object_added: %s (has 'org.bluez.Device1')", object_path);
 
+	// Drop the devices not matching the address lists or the advertising filter
+	g_rec_mutex_lock(&m_gattlib_mutex);
+	bool is_matching = !gattlib_adapter_is_valid(user_data) ||
+			_is_device1_reported(user_data, G_DBUS_PROXY(interface));
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
 	// It is a 'org.bluez.Device1'
-	device_manager_on_added_device1_signal(object_path, user_data);
+	if (is_matching) {
+		device_manager_on_added_device1_signal(G_DBUS_PROXY(interface), user_data, timestamp_ns);
+	}
 
 	g_object_unref(interface);
 }
@@ -218,6 +409,8 @@ on_interface_proxy_properties_changed (GDBusObjectManagerClient *device_manager,
 {
 	const char* proxy_object_path = g_dbus_proxy_get_object_path(interface_proxy);
 	gattlib_adapter_t* gattlib_adapter = user_data;
+	// Timestamp the event as soon as it enters gattlib
+	uint64_t timestamp_ns = gattlib_get_monotonic_time_ns();
 
 	// Count number of invalidated properties
 	size_t invalidated_properties_count = 0;
@@ -249,41 +442,45 @@ on_interface_proxy_properties_changed (GDBusObjectManagerClient *device_manager,
 	// Check if the object is a 'org.bluez.Device1'
 	if (strcmp(g_dbus_proxy_get_interface_name(interface_proxy), "org.bluez.Device1") == 0) {
 		// It is a 'org.bluez.Device1'
-		GError *error = NULL;
+		bool is_reported = false;
 
-		OrgBluezDevice1* device1 = org_bluez_device1_proxy_new_for_bus_sync(
-				G_BUS_TYPE_SYSTEM,
-				G_DBUS_PROXY_FLAGS_NONE,
-				"org.bluez",
-				proxy_object_path, NULL, &error);
-		if (error) {
-			GATTLIB_LOG(GATTLIB_ERROR, "Failed to connection to new DBus Bluez Device: %s", error->message);
-			g_error_free(error);
-			goto EXIT;
-		} else if (device1 == NULL) {
-			GATTLIB_LOG(GATTLIB_ERROR, "Unexpected NULL device");
-			goto EXIT;
-		}
-
-		// Check if the device has been disconnected
 		GVariantDict dict;
 		g_variant_dict_init(&dict, changed_properties);
-		GVariant* has_rssi = g_variant_dict_lookup_value(&dict, "RSSI", NULL);
-		GVariant* has_manufacturer_data = g_variant_dict_lookup_value(&dict, "ManufacturerData", NULL);
+		bool has_advertisement = g_variant_dict_contains(&dict, "RSSI") || g_variant_dict_contains(&dict, "ManufacturerData");
+		bool has_service_data = g_variant_dict_contains(&dict, "ServiceData");
+		g_variant_dict_clear(&dict);
 
 		enum _gattlib_device_state old_device_state = gattlib_device_get_state(gattlib_adapter, proxy_object_path);
 
 		if (old_device_state == NOT_FOUND) {
-			if (has_rssi || has_manufacturer_data) {
-				int ret = gattlib_device_set_state(gattlib_adapter, proxy_object_path, DISCONNECTED);
-				if (ret == GATTLIB_SUCCESS) {
-					gattlib_on_discovered_device(gattlib_adapter, device1);
-				}
-			}
+			is_reported = has_advertisement;
+		} else if ((old_device_state == DISCONNECTED) && (has_advertisement || has_service_data)) {
+			// The changes of the devices already discovered are only reported on demand
+			is_reported = gattlib_adapter->has_scan_throttle ||
+					(gattlib_adapter->backend.ble_scan.enabled_filters & GATTLIB_DISCOVER_FILTER_NOTIFY_CHANGE);
+		}
+
+		// Drop the devices not matching the address lists or the advertising filter
+		if (is_reported) {
+			is_reported = _is_device1_reported(gattlib_adapter, interface_proxy);
+		}
+
+		if (is_reported && gattlib_adapter->has_scan_throttle) {
+			bool is_changed = _scan_throttle_update_device1(gattlib_adapter, interface_proxy, timestamp_ns);
+			// A new device is always reported. It only seeds the last-seen cache.
+			is_reported = (old_device_state == NOT_FOUND) || is_changed;
 		}
 
-		g_variant_dict_end(&dict);
-		g_object_unref(device1);
+		if (!is_reported) {
+			goto EXIT;
+		}
+
+		// The interface proxy of the device manager has already cached the properties of the device.
+		// There is no need to create a new proxy for the device.
+		if ((old_device_state != NOT_FOUND) ||
+		    (gattlib_device_set_state(gattlib_adapter, proxy_object_path, DISCONNECTED) == GATTLIB_SUCCESS)) {
+			gattlib_on_discovered_device(gattlib_adapter, interface_proxy, timestamp_ns);
+		}
 	}
 
 EXIT:
@@ -389,7 +586,7 @@ EXIT:
 }
 
 static int _gattlib_adapter_scan_enable_with_filter(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
-	gattlib_discovered_device_t discovered_device_cb, size_t timeout, void *user_data)
+	void (*discovered_device_cb)(void), bool with_timestamp, bool with_data, size_t timeout, void *user_data)
 {
 	GDBusObjectManager *device_manager;
 	GError *error = NULL;
@@ -462,11 +659,19 @@ static int _gattlib_adapter_scan_enable_with_filter(gattlib_adapter_t* adapter,
 		return ret;
 	}
 
+	// Each scan reports again all the devices
+	g_rec_mutex_lock(&m_gattlib_mutex);
+	gattlib_scan_throttle_cache_free(adapter->scan_throttle_cache);
+	adapter->scan_throttle_cache = NULL;
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
 	// Clear BLE scan structure
 	memset(&adapter->backend.ble_scan, 0, sizeof(adapter->backend.ble_scan));
 	adapter->backend.ble_scan.enabled_filters = enabled_filters;
 	adapter->backend.ble_scan.ble_scan_timeout = timeout;
-	adapter->discovered_device_callback.callback.discovered_device = discovered_device_cb;
+	adapter->discovered_device_callback.callback.callback = discovered_device_cb;
+	adapter->discovered_device_callback.with_timestamp = with_timestamp;
+	adapter->discovered_device_callback.with_data = with_data;
 	adapter->discovered_device_callback.user_data = user_data;
 
 	adapter->backend.ble_scan.added_signal_id = g_signal_connect(G_DBUS_OBJECT_MANAGER(device_manager),
@@ -498,8 +703,8 @@ static int _gattlib_adapter_scan_enable_with_filter(gattlib_adapter_t* adapter,
 	return GATTLIB_SUCCESS;
 }
 
-int gattlib_adapter_scan_enable_with_filter(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
-		gattlib_discovered_device_t discovered_device_cb, size_t timeout, void *user_data)
+static int _gattlib_adapter_scan_enable_blocking(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
+		void (*discovered_device_cb)(void), bool with_data, size_t timeout, void *user_data)
 {
 	GError *error = NULL;
 	int ret = GATTLIB_SUCCESS;
@@ -513,7 +718,7 @@ int gattlib_adapter_scan_enable_with_filter(gattlib_adapter_t* adapter, uuid_t *
 	}
 
 	ret = _gattlib_adapter_scan_enable_with_filter(adapter, uuid_list, rssi_threshold, enabled_filters,
-		discovered_device_cb, timeout, user_data);
+		discovered_device_cb, false /* with_timestamp */, with_data, timeout, user_data);
 	if (ret != GATTLIB_SUCCESS) {
 		goto EXIT;
 	}
@@ -556,8 +761,22 @@ EXIT:
 	return ret;
 }
 
-int gattlib_adapter_scan_enable_with_filter_non_blocking(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
+int gattlib_adapter_scan_enable_with_filter(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
 		gattlib_discovered_device_t discovered_device_cb, size_t timeout, void *user_data)
+{
+	return _gattlib_adapter_scan_enable_blocking(adapter, uuid_list, rssi_threshold, enabled_filters,
+		(void (*)(void))discovered_device_cb, false /* with_data */, timeout, user_data);
+}
+
+int gattlib_adapter_scan_enable_with_data(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
+		gattlib_discovered_device_with_data_t discovered_device_cb, size_t timeout, void *user_data)
+{
+	return _gattlib_adapter_scan_enable_blocking(adapter, uuid_list, rssi_threshold, enabled_filters,
+		(void (*)(void))discovered_device_cb, true /* with_data */, timeout, user_data);
+}
+
+static int _gattlib_adapter_scan_enable_non_blocking(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
+		void (*discovered_device_cb)(void), bool with_timestamp, size_t timeout, void *user_data)
 {
 	GError *error = NULL;
 	int ret = GATTLIB_SUCCESS;
@@ -571,7 +790,7 @@ int gattlib_adapter_scan_enable_with_filter_non_blocking(gattlib_adapter_t* adap
 	}
 
 	ret = _gattlib_adapter_scan_enable_with_filter(adapter, uuid_list, rssi_threshold, enabled_filters,
-		discovered_device_cb, timeout, user_data);
+		discovered_device_cb, with_timestamp, false /* with_data */, timeout, user_data);
 	if (ret != GATTLIB_SUCCESS) {
 		goto EXIT;
 	}
@@ -589,6 +808,20 @@ EXIT:
 	return ret;
 }
 
+int gattlib_adapter_scan_enable_with_filter_non_blocking(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
+		gattlib_discovered_device_t discovered_device_cb, size_t timeout, void *user_data)
+{
+	return _gattlib_adapter_scan_enable_non_blocking(adapter, uuid_list, rssi_threshold, enabled_filters,
+		(void (*)(void))discovered_device_cb, false /* with_timestamp */, timeout, user_data);
+}
+
+int gattlib_adapter_scan_enable_with_timestamp(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
+		gattlib_discovered_device_with_timestamp_t discovered_device_cb, size_t timeout, void *user_data)
+{
+	return _gattlib_adapter_scan_enable_non_blocking(adapter, uuid_list, rssi_threshold, enabled_filters,
+		(void (*)(void))discovered_device_cb, true /* with_timestamp */, timeout, user_data);
+}
+
 int gattlib_adapter_scan_enable(gattlib_adapter_t* adapter, gattlib_discovered_device_t discovered_device_cb, size_t timeout, void *user_data)
 {
 	return gattlib_adapter_scan_enable_with_filter(adapter,
@@ -597,6 +830,103 @@ int gattlib_adapter_scan_enable(gattlib_adapter_t* adapter, gattlib_discovered_d
 			discovered_device_cb, timeout, user_data);
 }
 
+int gattlib_adapter_scan_enable_with_reports(gattlib_adapter_t* adapter, gattlib_advertising_report_cb_t report_cb,
+		size_t timeout, void *user_data)
+{
+	// BlueZ does not forward the raw advertising reports over D-Bus
+	return GATTLIB_NOT_SUPPORTED;
+}
+
+int gattlib_adapter_set_advertising_filter(gattlib_adapter_t* adapter, gattlib_advertising_filter_t* filter) {
+	gattlib_advertising_filter_t* previous_filter;
+
+	if (adapter == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	gattlib_advertising_filter_ref(filter);
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_adapter_is_valid(adapter)) {
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		gattlib_advertising_filter_unref(filter);
+		return GATTLIB_ADAPTER_CLOSE;
+	}
+
+	previous_filter = adapter->advertising_filter;
+	adapter->advertising_filter = filter;
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	gattlib_advertising_filter_unref(previous_filter);
+	return GATTLIB_SUCCESS;
+}
+
+static int _gattlib_adapter_set_address_list(gattlib_adapter_t* adapter, gattlib_address_set_t** list, gattlib_address_set_t* set) {
+	gattlib_address_set_t* previous_set;
+
+	gattlib_address_set_ref(set);
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_adapter_is_valid(adapter)) {
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		gattlib_address_set_unref(set);
+		return GATTLIB_ADAPTER_CLOSE;
+	}
+
+	previous_set = *list;
+	*list = set;
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	gattlib_address_set_unref(previous_set);
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_adapter_set_address_allowlist(gattlib_adapter_t* adapter, gattlib_address_set_t* allowlist) {
+	if (adapter == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+	return _gattlib_adapter_set_address_list(adapter, &adapter->address_allowlist, allowlist);
+}
+
+int gattlib_adapter_set_address_denylist(gattlib_adapter_t* adapter, gattlib_address_set_t* denylist) {
+	if (adapter == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+	return _gattlib_adapter_set_address_list(adapter, &adapter->address_denylist, denylist);
+}
+
+int gattlib_adapter_set_scan_throttle(gattlib_adapter_t* adapter, const gattlib_scan_throttle_t* throttle) {
+	int ret = GATTLIB_SUCCESS;
+
+	if (adapter == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_adapter_is_valid(adapter)) {
+		ret = GATTLIB_ADAPTER_CLOSE;
+		goto EXIT;
+	}
+
+	if (throttle != NULL) {
+		adapter->scan_throttle = *throttle;
+		adapter->has_scan_throttle = true;
+	} else {
+		adapter->has_scan_throttle = false;
+		gattlib_scan_throttle_cache_free(adapter->scan_throttle_cache);
+		adapter->scan_throttle_cache = NULL;
+	}
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
 int gattlib_adapter_scan_disable(gattlib_adapter_t* adapter) {
 	GError *error = NULL;
 	int ret = GATTLIB_SUCCESS;
@@ -757,6 +1087,20 @@ int gattlib_adapter_unref(gattlib_adapter_t* adapter) {
 
 	gattlib_devices_free(adapter);
 
+	gattlib_connect_scheduler_free(adapter);
+
+	gattlib_advertising_filter_unref(adapter->advertising_filter);
+	adapter->advertising_filter = NULL;
+	gattlib_address_set_unref(adapter->address_allowlist);
+	adapter->address_allowlist = NULL;
+	gattlib_address_set_unref(adapter->address_denylist);
+	adapter->address_denylist = NULL;
+	gattlib_scan_throttle_cache_free(adapter->scan_throttle_cache);
+	adapter->scan_throttle_cache = NULL;
+
+	gattlib_serial_queue_unref(adapter->serial_queue);
+	adapter->serial_queue = NULL;
+
 	// Remove adapter from the global list
 	m_adapter_list = g_slist_remove(m_adapter_list, adapter);
 
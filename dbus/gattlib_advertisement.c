@@ -6,133 +6,177 @@
 
 #include "gattlib_internal.h"
 
-#if BLUEZ_VERSION < BLUEZ_VERSIONS(5, 40)
-
-int gattlib_get_advertisement_data(gattlib_connection_t *connection,
-		gattlib_advertisement_data_t **advertisement_data, size_t *advertisement_data_count,
-		gattlib_manufacturer_data_t** manufacturer_data, size_t* manufacturer_data_count)
+void free_advertisement_data(gattlib_advertisement_data_t *advertisement_data, size_t advertisement_data_count,
+		gattlib_manufacturer_data_t* manufacturer_data, size_t manufacturer_data_count)
 {
-	return GATTLIB_NOT_SUPPORTED;
+	if (advertisement_data != NULL) {
+		for (size_t i = 0; i < advertisement_data_count; i++) {
+			free(advertisement_data[i].data);
+		}
+		free(advertisement_data);
+	}
+	if (manufacturer_data != NULL) {
+		for (size_t i = 0; i < manufacturer_data_count; i++) {
+			free(manufacturer_data[i].data);
+		}
+		free(manufacturer_data);
+	}
 }
 
-int gattlib_get_advertisement_data_from_mac(gattlib_adapter_t* adapter, const char *mac_address,
-		gattlib_advertisement_data_t **advertisement_data, size_t *advertisement_data_count,
-		gattlib_manufacturer_data_t** manufacturer_data, size_t* manufacturer_data_count)
-{
-	return GATTLIB_NOT_SUPPORTED;
-}
+static uint8_t* copy_byte_array(GVariant *value, size_t *length) {
+	gsize n_elements = 0;
+	gconstpointer const_buffer = g_variant_get_fixed_array(value, &n_elements, sizeof(guchar));
 
-#else
+	// Always allocate a buffer to distinguish an empty array from an allocation failure
+	uint8_t* buffer = malloc(n_elements > 0 ? n_elements : 1);
+	if (buffer != NULL) {
+		if (n_elements > 0) {
+			memcpy(buffer, const_buffer, n_elements);
+		}
+		*length = n_elements;
+	}
+	return buffer;
+}
 
-int get_advertisement_data_from_device(OrgBluezDevice1 *bluez_device1,
+int get_advertisement_data_from_proxy(GDBusProxy *device1_proxy,
 		gattlib_advertisement_data_t **advertisement_data, size_t *advertisement_data_count,
 		gattlib_manufacturer_data_t** manufacturer_data, size_t* manufacturer_data_count)
 {
 	GVariant *manufacturer_data_variant;
 	GVariant *service_data_variant;
+	GVariantIter iter;
+	GVariant *value;
+	int ret = GATTLIB_SUCCESS;
 
-	if (advertisement_data == NULL) {
+	if ((advertisement_data == NULL) || (advertisement_data_count == NULL) ||
+	    (manufacturer_data == NULL) || (manufacturer_data_count == NULL)) {
 		return GATTLIB_INVALID_PARAMETER;
 	}
 
-	*manufacturer_data_count = 0;
+	*advertisement_data = NULL;
+	*advertisement_data_count = 0;
 	*manufacturer_data = NULL;
-	manufacturer_data_variant = org_bluez_device1_get_manufacturer_data(bluez_device1);
+	*manufacturer_data_count = 0;
+
+	manufacturer_data_variant = g_dbus_proxy_get_cached_property(device1_proxy, "ManufacturerData");
 	if (manufacturer_data_variant != NULL) {
-		*manufacturer_data_count = g_variant_n_children(manufacturer_data_variant);
-		*manufacturer_data = malloc(sizeof(gattlib_manufacturer_data_t) * (*manufacturer_data_count));
+		guint16 manufacturer_id;
+
+		*manufacturer_data = calloc(g_variant_n_children(manufacturer_data_variant), sizeof(gattlib_manufacturer_data_t));
 		if (*manufacturer_data == NULL) {
+			g_variant_unref(manufacturer_data_variant);
 			return GATTLIB_OUT_OF_MEMORY;
 		}
 
-		for (uintptr_t i = 0; i < *manufacturer_data_count; i++) {
-			GVariant* manufacturer_data_dict = g_variant_get_child_value(manufacturer_data_variant, i);
-			GVariantIter *iter;
-			GVariant* values;
-			uint16_t manufacturer_id = 0;
-
-			g_variant_get(manufacturer_data_dict, "{qv}", &manufacturer_id, &values);
-			(*manufacturer_data)[i].manufacturer_id = manufacturer_id;
-			(*manufacturer_data)[i].data_size = g_variant_n_children(values);
-			(*manufacturer_data)[i].data = calloc((*manufacturer_data)[i].data_size, sizeof(guchar));
-			if ((*manufacturer_data)[i].data == NULL) {
-				return GATTLIB_OUT_OF_MEMORY;
-			}
+		g_variant_iter_init(&iter, manufacturer_data_variant);
+		while (g_variant_iter_next(&iter, "{qv}", &manufacturer_id, &value)) {
+			gattlib_manufacturer_data_t* entry = &(*manufacturer_data)[*manufacturer_data_count];
 
-			// Copy manufacturer data to structure
-			for (unsigned int j = 0; j < (*manufacturer_data)[i].data_size; j++)
-			{
-				GVariant *v = g_variant_get_child_value(values, j);
-
-				(*manufacturer_data)[i].data[j] = g_variant_get_byte(v);
+			entry->manufacturer_id = manufacturer_id;
+			entry->data = copy_byte_array(value, &entry->data_size);
+			g_variant_unref(value);
+			if (entry->data == NULL) {
+				ret = GATTLIB_OUT_OF_MEMORY;
+				break;
 			}
+			(*manufacturer_data_count)++;
+		}
+		g_variant_unref(manufacturer_data_variant);
+
+		if (ret != GATTLIB_SUCCESS) {
+			goto ON_ERROR;
 		}
 	}
 
-	service_data_variant = org_bluez_device1_get_service_data(bluez_device1);
+	service_data_variant = g_dbus_proxy_get_cached_property(device1_proxy, "ServiceData");
 	if (service_data_variant != NULL) {
-		GVariantIter *iter;
 		const gchar *key;
-		GVariant *value;
-		size_t index = 0;
-
-		*advertisement_data_count = g_variant_n_children(service_data_variant);
 
-		gattlib_advertisement_data_t *advertisement_data_ptr = calloc(sizeof(gattlib_advertisement_data_t), *advertisement_data_count);
-		if (advertisement_data_ptr == NULL) {
-			return GATTLIB_OUT_OF_MEMORY;
+		*advertisement_data = calloc(g_variant_n_children(service_data_variant), sizeof(gattlib_advertisement_data_t));
+		if (*advertisement_data == NULL) {
+			g_variant_unref(service_data_variant);
+			ret = GATTLIB_OUT_OF_MEMORY;
+			goto ON_ERROR;
 		}
 
-		g_variant_get(service_data_variant, "a{sv}", &iter);
-		while (g_variant_iter_loop(iter, "{&sv}", &key, &value)) {
-			gattlib_string_to_uuid(key, strlen(key), &advertisement_data_ptr[index].uuid);
-
-			gsize n_elements = 0;
-			gconstpointer const_buffer = g_variant_get_fixed_array(value, &n_elements, sizeof(guchar));
-			if (const_buffer) {
-				advertisement_data_ptr[index].data = malloc(n_elements);
-				if (advertisement_data_ptr[index].data == NULL) {
-					return GATTLIB_OUT_OF_MEMORY;
-				}
+		g_variant_iter_init(&iter, service_data_variant);
+		while (g_variant_iter_next(&iter, "{&sv}", &key, &value)) {
+			gattlib_advertisement_data_t* entry = &(*advertisement_data)[*advertisement_data_count];
 
-				advertisement_data_ptr[index].data_length = n_elements;
-				memcpy(advertisement_data_ptr[index].data, const_buffer, n_elements);
-			} else {
-				advertisement_data_ptr[index].data_length = 0;
+			gattlib_string_to_uuid(key, strlen(key), &entry->uuid);
+			entry->data = copy_byte_array(value, &entry->data_length);
+			g_variant_unref(value);
+			if (entry->data == NULL) {
+				ret = GATTLIB_OUT_OF_MEMORY;
+				break;
 			}
-
-			index++;
+			(*advertisement_data_count)++;
 		}
-		g_variant_iter_free(iter);
+		g_variant_unref(service_data_variant);
 
-		*advertisement_data = advertisement_data_ptr;
+		if (ret != GATTLIB_SUCCESS) {
+			goto ON_ERROR;
+		}
 	} else {
-		const gchar* const* service_strs = org_bluez_device1_get_uuids(bluez_device1);
-		if (service_strs && (*service_strs)) {
+		// Without service data, report the first advertised service UUID
+		GVariant *uuids_variant = g_dbus_proxy_get_cached_property(device1_proxy, "UUIDs");
+		if (uuids_variant != NULL) {
+			const gchar* const* service_strs = g_variant_get_strv(uuids_variant, NULL);
 			uuid_t uuid;
-			int ret, len = strlen((char *)*service_strs);
-			if (!len) goto error_return;
-
-			ret = gattlib_string_to_uuid((char *)*service_strs, len, &uuid);
-			if (ret) goto error_return;
 
-			*advertisement_data = calloc(sizeof(gattlib_advertisement_data_t), 1);
-			if (!(*advertisement_data)) {
-				*advertisement_data_count = 0;
-				return GATTLIB_OUT_OF_MEMORY;
+			if ((service_strs != NULL) && (*service_strs != NULL) && (strlen(*service_strs) > 0) &&
+			    (gattlib_string_to_uuid(*service_strs, strlen(*service_strs), &uuid) == 0)) {
+				*advertisement_data = calloc(1, sizeof(gattlib_advertisement_data_t));
+				if (*advertisement_data == NULL) {
+					g_free((gpointer)service_strs);
+					g_variant_unref(uuids_variant);
+					ret = GATTLIB_OUT_OF_MEMORY;
+					goto ON_ERROR;
+				}
+				memcpy(&(*advertisement_data)[0].uuid, &uuid, sizeof(uuid));
+				*advertisement_data_count = 1;
 			}
-			*advertisement_data_count = 1;
-			memcpy(&(*advertisement_data)[0].uuid, &uuid, sizeof(uuid));
-		}
-		else
-		{
-		error_return:
-			*advertisement_data_count = 0;
-			*advertisement_data = NULL;
+			g_free((gpointer)service_strs);
+			g_variant_unref(uuids_variant);
 		}
 	}
 
 	return GATTLIB_SUCCESS;
+
+ON_ERROR:
+	free_advertisement_data(*advertisement_data, *advertisement_data_count, *manufacturer_data, *manufacturer_data_count);
+	*advertisement_data = NULL;
+	*advertisement_data_count = 0;
+	*manufacturer_data = NULL;
+	*manufacturer_data_count = 0;
+	return ret;
+}
+
+#if BLUEZ_VERSION < BLUEZ_VERSIONS(5, 40)
+
+int gattlib_get_advertisement_data(gattlib_connection_t *connection,
+		gattlib_advertisement_data_t **advertisement_data, size_t *advertisement_data_count,
+		gattlib_manufacturer_data_t** manufacturer_data, size_t* manufacturer_data_count)
+{
+	return GATTLIB_NOT_SUPPORTED;
+}
+
+int gattlib_get_advertisement_data_from_mac(gattlib_adapter_t* adapter, const char *mac_address,
+		gattlib_advertisement_data_t **advertisement_data, size_t *advertisement_data_count,
+		gattlib_manufacturer_data_t** manufacturer_data, size_t* manufacturer_data_count)
+{
+	return GATTLIB_NOT_SUPPORTED;
+}
+
+#else
+
+int get_advertisement_data_from_device(OrgBluezDevice1 *bluez_device1,
+		gattlib_advertisement_data_t **advertisement_data, size_t *advertisement_data_count,
+		gattlib_manufacturer_data_t** manufacturer_data, size_t* manufacturer_data_count)
+{
+	return get_advertisement_data_from_proxy(G_DBUS_PROXY(bluez_device1),
+			advertisement_data, advertisement_data_count,
+			manufacturer_data, manufacturer_data_count);
 }
 
 int gattlib_get_advertisement_data(gattlib_connection_t *connection,
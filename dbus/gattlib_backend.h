@@ -101,17 +101,56 @@ void get_device_path_from_mac_with_adapter(OrgBluezAdapter1* adapter, const char
 void get_device_path_from_mac(const char *adapter_name, const char *mac_address, char *object_path, size_t object_path_len);
 int get_bluez_device_from_mac(struct _gattlib_adapter *adapter, const char *mac_address, OrgBluezDevice1 **bluez_device1);
 
+/**
+ * Parse the advertisement data from the cached properties 'ManufacturerData' and 'ServiceData' of a 'org.bluez.Device1'
+ * proxy. It does not require any D-Bus round trip. The data must be freed with `free_advertisement_data()`.
+ */
+int get_advertisement_data_from_proxy(GDBusProxy *device1_proxy,
+		gattlib_advertisement_data_t **advertisement_data, size_t *advertisement_data_count,
+		gattlib_manufacturer_data_t** manufacturer_data, size_t* manufacturer_data_count);
+void free_advertisement_data(gattlib_advertisement_data_t *advertisement_data, size_t advertisement_data_count,
+		gattlib_manufacturer_data_t* manufacturer_data, size_t manufacturer_data_count);
+
 struct dbus_characteristic get_characteristic_from_uuid(gattlib_connection_t* connection, const uuid_t* uuid);
+/**
+ * Resolve many characteristics at once. The characteristics not found are of type TYPE_NONE.
+ * Each characteristic found holds a reference that must be released by the caller.
+ */
+void get_characteristics_from_uuids(gattlib_connection_t* connection, const uuid_t* uuids, size_t uuids_count,
+		struct dbus_characteristic* dbus_characteristics);
+// Release the reference returned by the characteristic lookups. Nothing to do for TYPE_NONE.
+void release_characteristic(const struct dbus_characteristic* dbus_characteristic);
 
-// Invoke when a new device has been discovered
-void gattlib_on_discovered_device(gattlib_adapter_t* gattlib_adapter, OrgBluezDevice1* device1);
+// Invoke when a new device has been discovered. The data of the device are read from the cached properties of its proxy.
+void gattlib_on_discovered_device(gattlib_adapter_t* gattlib_adapter, GDBusProxy* device1_proxy, uint64_t timestamp_ns);
 // Invoke when a new device is being connected
 void gattlib_on_connected_device(gattlib_connection_t* connection);
+// Invoke when the connection to a device has failed
+void gattlib_on_connection_failure(gattlib_connection_t* connection, const char* dst, int error);
 // Invoke when a new device is being disconnected
 void gattlib_on_disconnected_device(gattlib_connection_t* connection);
 // Invoke when a new device receive a GATT notification
-void gattlib_on_gatt_notification(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length);
+void gattlib_on_gatt_notification(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns);
+// Invoke when a new device receive a GATT indication
+void gattlib_on_gatt_indication(gattlib_connection_t* connection, const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns);
 
 void disconnect_all_notifications(struct _gattlib_connection_backend* backend);
 
+typedef void (*gattlib_notification_start_cb_t)(gattlib_connection_t* connection, const uuid_t* uuid, int error, void* user_data);
+
+/**
+ * Start the notification/indication of a characteristic resolved by `get_characteristics_from_uuids()`
+ * without waiting for BlueZ
+ *
+ * On success, the notification keeps the reference of 'dbus_characteristic'. On error, the caller still owns it.
+ *
+ * The result is reported to 'start_cb' from the D-Bus loop. It is not called if the function returns an error.
+ * If there is nothing to start (eg: battery level), 'start_cb' is called before the function returns
+ * with 'm_gattlib_mutex' held.
+ */
+int gattlib_notification_start_async(gattlib_connection_t* connection, const uuid_t* uuid, bool is_indication,
+		const struct dbus_characteristic* dbus_characteristic, gattlib_notification_start_cb_t start_cb, void* user_data);
+
 #endif
@@ -7,17 +7,43 @@
 #include <stdlib.h>
 
 #include "gattlib_internal.h"
+#include "gattlib_write_transaction.h"
 
 #define BLUEZ_GATT_WRITE_VALUE_TYPE_MASK                    (0x7)
 #define BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITH_RESPONSE     (1 << 0)
 #define BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITHOUT_RESPONSE  (1 << 1)
 #define BLUEZ_GATT_WRITE_VALUE_TYPE_RELIABLE_WRITE          (1 << 2)
 
+// ATT_MTU used when the negotiated MTU is not known
+#define GATTLIB_ATT_DEFAULT_MTU                             23
+
 
 const uuid_t m_battery_level_uuid = CREATE_UUID16(0x2A19);
 static const uuid_t m_ccc_uuid = CREATE_UUID16(0x2902);
 
 
+static bool is_characteristic_of_device(struct _gattlib_connection_backend* backend, OrgBluezGattCharacteristic1 *characteristic,
+		GError **error)
+{
+	bool found = false;
+
+	*error = NULL;
+	OrgBluezGattService1* service = org_bluez_gatt_service1_proxy_new_for_bus_sync (
+		G_BUS_TYPE_SYSTEM,
+		G_DBUS_PROXY_FLAGS_NONE,
+		"org.bluez",
+		org_bluez_gatt_characteristic1_get_service(characteristic),
+		NULL,
+		error);
+
+	if (service) {
+		found = !strcmp(backend->device_object_path, org_bluez_gatt_service1_get_device(service));
+		g_object_unref(service);
+	}
+
+	return found;
+}
+
 static bool handle_dbus_gattcharacteristic_from_path(struct _gattlib_connection_backend* backend, const uuid_t* uuid,
 		struct dbus_characteristic *dbus_characteristic, const char* object_path, GError **error)
 {
@@ -51,25 +77,10 @@ static bool handle_dbus_gattcharacteristic_from_path(struct _gattlib_connection_
 		}
 
 		// We found the right characteristic, now we check if it's the right device.
-		*error = NULL;
-		OrgBluezGattService1* service = org_bluez_gatt_service1_proxy_new_for_bus_sync (
-			G_BUS_TYPE_SYSTEM,
-			G_DBUS_PROXY_FLAGS_NONE,
-			"org.bluez",
-			org_bluez_gatt_characteristic1_get_service(characteristic),
-			NULL,
-			error);
-
-		if (service) {
-			const bool found = !strcmp(backend->device_object_path, org_bluez_gatt_service1_get_device(service));
-
-			g_object_unref(service);
-
-			if (found) {
-				dbus_characteristic->gatt = characteristic;
-				dbus_characteristic->type = TYPE_GATT;
-				return true;
-			}
+		if (is_characteristic_of_device(backend, characteristic, error)) {
+			dbus_characteristic->gatt = characteristic;
+			dbus_characteristic->type = TYPE_GATT;
+			return true;
 		}
 
 		g_object_unref(characteristic);
@@ -101,10 +112,65 @@ static bool handle_dbus_battery_from_uuid(struct _gattlib_connection_backend* ba
 }
 #endif
 
+/**
+ * Look for the characteristic in the cache of the device
+ *
+ * BlueZ keeps the object paths of the GATT attributes of a device across its connections.
+ * A cached path saves the discovery of the characteristic among all the DBUS objects.
+ */
+static bool get_characteristic_from_cache(gattlib_connection_t* connection, const uuid_t* uuid, const char* uuid_str,
+		struct dbus_characteristic *dbus_characteristic)
+{
+	const char* object_path = g_hash_table_lookup(connection->device->characteristic_cache, uuid_str);
+	uuid_t characteristic_uuid;
+	GError *error = NULL;
+
+	if (object_path == NULL) {
+		return false;
+	}
+
+	OrgBluezGattCharacteristic1 *characteristic = org_bluez_gatt_characteristic1_proxy_new_for_bus_sync (
+			G_BUS_TYPE_SYSTEM,
+			G_DBUS_PROXY_FLAGS_NONE,
+			"org.bluez",
+			object_path,
+			NULL,
+			&error);
+	if (characteristic == NULL) {
+		if (error != NULL) {
+			g_error_free(error);
+		}
+		goto INVALIDATE;
+	}
+
+	// Ensure the GATT database of the device has not changed
+	const gchar *characteristic_uuid_str = org_bluez_gatt_characteristic1_get_uuid(characteristic);
+	if (characteristic_uuid_str == NULL) {
+		g_object_unref(characteristic);
+		goto INVALIDATE;
+	}
+
+	gattlib_string_to_uuid(characteristic_uuid_str, strlen(characteristic_uuid_str) + 1, &characteristic_uuid);
+	if (gattlib_uuid_cmp(uuid, &characteristic_uuid) != 0) {
+		g_object_unref(characteristic);
+		goto INVALIDATE;
+	}
+
+	dbus_characteristic->gatt = characteristic;
+	dbus_characteristic->type = TYPE_GATT;
+	return true;
+
+INVALIDATE:
+	GATTLIB_LOG(GATTLIB_DEBUG, "Cached characteristic %s of %s is not valid anymore", uuid_str, connection->device->device_id);
+	g_hash_table_remove(connection->device->characteristic_cache, uuid_str);
+	return false;
+}
+
 struct dbus_characteristic get_characteristic_from_uuid(gattlib_connection_t* connection, const uuid_t* uuid) {
 	GError *error = NULL;
 	GDBusObjectManager *device_manager;
 	bool is_battery_level_uuid = false;
+	char uuid_str[MAX_LEN_UUID_STR + 1];
 	struct dbus_characteristic dbus_characteristic = {
 		.type = TYPE_NONE
 	};
@@ -115,6 +181,12 @@ struct dbus_characteristic get_characteristic_from_uuid(gattlib_connection_t* co
 		goto EXIT;
 	}
 
+	gattlib_uuid_to_string(uuid, uuid_str, sizeof(uuid_str));
+
+	if (get_characteristic_from_cache(connection, uuid, uuid_str, &dbus_characteristic)) {
+		goto EXIT;
+	}
+
 	device_manager = get_device_manager_from_adapter(connection->device->adapter, &error);
 
 	if (device_manager == NULL) {
@@ -148,6 +220,7 @@ struct dbus_characteristic get_characteristic_from_uuid(gattlib_connection_t* co
 
 			found = handle_dbus_gattcharacteristic_from_path(&connection->backend, uuid, &dbus_characteristic, object_path, &error);
 			if (found) {
+				g_hash_table_replace(connection->device->characteristic_cache, g_strdup(uuid_str), g_strdup(object_path));
 				break;
 			}
 		}
@@ -174,6 +247,138 @@ EXIT:
 	return dbus_characteristic;
 }
 
+void release_characteristic(const struct dbus_characteristic* dbus_characteristic) {
+	if (dbus_characteristic->type == TYPE_GATT) {
+		g_object_unref(dbus_characteristic->gatt);
+	}
+#if BLUEZ_VERSION > BLUEZ_VERSIONS(5, 40)
+	else if (dbus_characteristic->type == TYPE_BATTERY_LEVEL) {
+		g_object_unref(dbus_characteristic->battery);
+	}
+#endif
+}
+
+void get_characteristics_from_uuids(gattlib_connection_t* connection, const uuid_t* uuids, size_t uuids_count,
+		struct dbus_characteristic* dbus_characteristics)
+{
+	GError *error = NULL;
+	GDBusObjectManager *device_manager;
+	char uuid_str[MAX_LEN_UUID_STR + 1];
+	size_t missing_count = 0;
+
+	for (size_t i = 0; i < uuids_count; i++) {
+		dbus_characteristics[i].type = TYPE_NONE;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_connected(connection)) {
+		goto EXIT;
+	}
+
+	for (size_t i = 0; i < uuids_count; i++) {
+		gattlib_uuid_to_string(&uuids[i], uuid_str, sizeof(uuid_str));
+
+		if (get_characteristic_from_cache(connection, &uuids[i], uuid_str, &dbus_characteristics[i])) {
+			continue;
+		}
+
+		if ((gattlib_uuid_cmp(&uuids[i], &m_battery_level_uuid) == 0) || (gattlib_uuid_cmp(&uuids[i], &m_ccc_uuid) == 0)) {
+			// These characteristics are not GATT characteristics for BlueZ
+			dbus_characteristics[i] = get_characteristic_from_uuid(connection, &uuids[i]);
+			continue;
+		}
+
+		missing_count++;
+	}
+
+	if (missing_count == 0) {
+		goto EXIT;
+	}
+
+	device_manager = get_device_manager_from_adapter(connection->device->adapter, &error);
+	if (device_manager == NULL) {
+		if (error != NULL) {
+			GATTLIB_LOG(GATTLIB_ERROR, "Gattlib Context not initialized (%d, %d).", error->domain, error->code);
+			g_error_free(error);
+		} else {
+			GATTLIB_LOG(GATTLIB_ERROR, "Gattlib Context not initialized.");
+		}
+		goto EXIT;
+	}
+
+	// Resolve all the missing characteristics with a single walk of the DBUS objects of the device
+	for (GList *l = connection->backend.dbus_objects; (l != NULL) && (missing_count > 0); l = l->next)  {
+		GDBusObject *object = l->data;
+		const char* object_path = g_dbus_object_get_object_path(G_DBUS_OBJECT(object));
+		OrgBluezGattCharacteristic1 *characteristic;
+		uuid_t characteristic_uuid;
+		bool is_requested = false;
+
+		GDBusInterface *interface = g_dbus_object_manager_get_interface(device_manager, object_path, "org.bluez.GattCharacteristic1");
+		if (interface == NULL) {
+			continue;
+		}
+		g_object_unref(interface);
+
+		characteristic = org_bluez_gatt_characteristic1_proxy_new_for_bus_sync (
+				G_BUS_TYPE_SYSTEM,
+				G_DBUS_PROXY_FLAGS_NONE,
+				"org.bluez",
+				object_path,
+				NULL,
+				&error);
+		if (characteristic == NULL) {
+			if (error != NULL) {
+				g_error_free(error);
+				error = NULL;
+			}
+			continue;
+		}
+
+		const gchar *characteristic_uuid_str = org_bluez_gatt_characteristic1_get_uuid(characteristic);
+		if (characteristic_uuid_str == NULL) {
+			g_object_unref(characteristic);
+			continue;
+		}
+		gattlib_string_to_uuid(characteristic_uuid_str, strlen(characteristic_uuid_str) + 1, &characteristic_uuid);
+
+		for (size_t i = 0; i < uuids_count; i++) {
+			if ((dbus_characteristics[i].type == TYPE_NONE) && (gattlib_uuid_cmp(&uuids[i], &characteristic_uuid) == 0)) {
+				is_requested = true;
+				break;
+			}
+		}
+
+		if (!is_requested || !is_characteristic_of_device(&connection->backend, characteristic, &error)) {
+			if (error != NULL) {
+				g_error_free(error);
+				error = NULL;
+			}
+			g_object_unref(characteristic);
+			continue;
+		}
+
+		gattlib_uuid_to_string(&characteristic_uuid, uuid_str, sizeof(uuid_str));
+		g_hash_table_replace(connection->device->characteristic_cache, g_strdup(uuid_str), g_strdup(object_path));
+
+		// The same UUID might have been requested more than once. Each entry owns a reference.
+		for (size_t i = 0; i < uuids_count; i++) {
+			if ((dbus_characteristics[i].type == TYPE_NONE) && (gattlib_uuid_cmp(&uuids[i], &characteristic_uuid) == 0)) {
+				dbus_characteristics[i].gatt = g_object_ref(characteristic);
+				dbus_characteristics[i].type = TYPE_GATT;
+				if (missing_count > 0) {
+					missing_count--;
+				}
+			}
+		}
+		g_object_unref(characteristic);
+	}
+
+EXIT:
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+}
+
 static struct dbus_characteristic get_characteristic_from_handle(gattlib_connection_t* connection, unsigned int handle) {
 	GError *error = NULL;
 	unsigned int char_handle;
@@ -230,11 +435,14 @@ EXIT:
 	return dbus_characteristic;
 }
 
-static int read_gatt_characteristic(struct dbus_characteristic *dbus_characteristic, void **buffer, size_t* buffer_len) {
+static int read_gatt_characteristic(gattlib_connection_t* connection, struct dbus_characteristic *dbus_characteristic,
+		void **buffer, size_t* buffer_len)
+{
 	GVariant *out_value;
 	GError *error = NULL;
 	int ret = GATTLIB_SUCCESS;
 
+	gattlib_op_scheduler_acquire(connection, GATTLIB_PRIORITY_NORMAL);
 #if BLUEZ_VERSION < BLUEZ_VERSIONS(5, 40)
 	org_bluez_gatt_characteristic1_call_read_value_sync(
 		dbus_characteristic->gatt, &out_value, NULL, &error);
@@ -244,6 +452,7 @@ static int read_gatt_characteristic(struct dbus_characteristic *dbus_characteris
 			dbus_characteristic->gatt, g_variant_builder_end(options), &out_value, NULL, &error);
 	g_variant_builder_unref(options);
 #endif
+	gattlib_op_scheduler_release(connection, GATTLIB_PRIORITY_NORMAL);
 	if (error != NULL) {
 		ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
 		GATTLIB_LOG(GATTLIB_ERROR, "Failed to read DBus GATT characteristic: %s", error->message);
@@ -309,7 +518,7 @@ int gattlib_read_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, vo
 
 		assert(dbus_characteristic.type == TYPE_GATT);
 
-		ret = read_gatt_characteristic(&dbus_characteristic, buffer, buffer_len);
+		ret = read_gatt_characteristic(connection, &dbus_characteristic, buffer, buffer_len);
 
 		g_object_unref(dbus_characteristic.gatt);
 
@@ -317,6 +526,25 @@ int gattlib_read_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, vo
 	}
 }
 
+int gattlib_read_char_by_handle(gattlib_connection_t* connection, uint16_t handle, void **buffer, size_t *buffer_len) {
+	int ret;
+
+	//
+	// No need of locking the gattlib mutex. get_characteristic_from_handle() is taking care of the gattlib
+	// object coherency. And 'dbus_characteristic' is not linked to gattlib object
+	//
+
+	struct dbus_characteristic dbus_characteristic = get_characteristic_from_handle(connection, handle);
+	if (dbus_characteristic.type == TYPE_NONE) {
+		return GATTLIB_NOT_FOUND;
+	}
+
+	ret = read_gatt_characteristic(connection, &dbus_characteristic, buffer, buffer_len);
+
+	g_object_unref(dbus_characteristic.gatt);
+	return ret;
+}
+
 int gattlib_read_char_by_uuid_async(gattlib_connection_t* connection, uuid_t* uuid, gatt_read_cb_t gatt_read_cb) {
 	int ret = GATTLIB_SUCCESS;
 
@@ -347,6 +575,7 @@ int gattlib_read_char_by_uuid_async(gattlib_connection_t* connection, uuid_t* uu
 	GVariant *out_value;
 	GError *error = NULL;
 
+	gattlib_op_scheduler_acquire(connection, GATTLIB_PRIORITY_NORMAL);
 #if BLUEZ_VERSION < BLUEZ_VERSIONS(5, 40)
 	org_bluez_gatt_characteristic1_call_read_value_sync(
 		dbus_characteristic.gatt, &out_value, NULL, &error);
@@ -356,6 +585,7 @@ int gattlib_read_char_by_uuid_async(gattlib_connection_t* connection, uuid_t* uu
 			dbus_characteristic.gatt, g_variant_builder_end(options), &out_value, NULL, &error);
 	g_variant_builder_unref(options);
 #endif
+	gattlib_op_scheduler_release(connection, GATTLIB_PRIORITY_NORMAL);
 	if (error != NULL) {
 		ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
 		GATTLIB_LOG(GATTLIB_ERROR, "Failed to read DBus GATT characteristic: %s", error->message);
@@ -376,12 +606,14 @@ EXIT:
 	return ret;
 }
 
-static int write_char(struct dbus_characteristic *dbus_characteristic, const void* buffer, size_t buffer_len, uint32_t options)
+static int write_char(gattlib_connection_t* connection, struct dbus_characteristic *dbus_characteristic,
+		const void* buffer, size_t buffer_len, uint32_t options, gattlib_priority_t priority)
 {
 	GVariant *value = g_variant_new_from_data(G_VARIANT_TYPE ("ay"), buffer, buffer_len, TRUE, NULL, NULL);
 	GError *error = NULL;
 	int ret = GATTLIB_SUCCESS;
 
+	gattlib_op_scheduler_acquire(connection, priority);
 #if BLUEZ_VERSION < BLUEZ_VERSIONS(5, 40)
 	org_bluez_gatt_characteristic1_call_write_value_sync(dbus_characteristic->gatt, value, NULL, &error);
 #else
@@ -389,11 +621,14 @@ static int write_char(struct dbus_characteristic *dbus_characteristic, const voi
 
 	if ((options & BLUEZ_GATT_WRITE_VALUE_TYPE_MASK) == BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITHOUT_RESPONSE) {
 		g_variant_builder_add(variant_options, "{sv}", "type", g_variant_new("s", "command"));
+	} else if ((options & BLUEZ_GATT_WRITE_VALUE_TYPE_MASK) == BLUEZ_GATT_WRITE_VALUE_TYPE_RELIABLE_WRITE) {
+		g_variant_builder_add(variant_options, "{sv}", "type", g_variant_new("s", "reliable"));
 	}
 
 	org_bluez_gatt_characteristic1_call_write_value_sync(dbus_characteristic->gatt, value, g_variant_builder_end(variant_options), NULL, &error);
 	g_variant_builder_unref(variant_options);
 #endif
+	gattlib_op_scheduler_release(connection, priority);
 
 	if (error != NULL) {
 		if ((error->domain == 238) && (error->code == 36)) {
@@ -415,7 +650,8 @@ static int write_char(struct dbus_characteristic *dbus_characteristic, const voi
 	return ret;
 }
 
-int gattlib_write_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, const void* buffer, size_t buffer_len)
+int gattlib_write_char_by_uuid_with_priority(gattlib_connection_t* connection, uuid_t* uuid, const void* buffer, size_t buffer_len,
+		gattlib_priority_t priority)
 {
 	int ret;
 
@@ -433,12 +669,18 @@ int gattlib_write_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, c
 		assert(dbus_characteristic.type == TYPE_GATT);
 	}
 
-	ret = write_char(&dbus_characteristic, buffer, buffer_len, BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITH_RESPONSE);
+	ret = write_char(connection, &dbus_characteristic, buffer, buffer_len, BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITH_RESPONSE,
+			priority);
 
 	g_object_unref(dbus_characteristic.gatt);
 	return ret;
 }
 
+int gattlib_write_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, const void* buffer, size_t buffer_len)
+{
+	return gattlib_write_char_by_uuid_with_priority(connection, uuid, buffer, buffer_len, GATTLIB_PRIORITY_NORMAL);
+}
+
 int gattlib_write_char_by_handle(gattlib_connection_t* connection, uint16_t handle, const void* buffer, size_t buffer_len)
 {
 	int ret;
@@ -453,13 +695,15 @@ int gattlib_write_char_by_handle(gattlib_connection_t* connection, uint16_t hand
 		return GATTLIB_NOT_FOUND;
 	}
 
-	ret = write_char(&dbus_characteristic, buffer, buffer_len, BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITH_RESPONSE);
+	ret = write_char(connection, &dbus_characteristic, buffer, buffer_len, BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITH_RESPONSE,
+			GATTLIB_PRIORITY_NORMAL);
 
 	g_object_unref(dbus_characteristic.gatt);
 	return ret;
 }
 
-int gattlib_write_without_response_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, const void* buffer, size_t buffer_len)
+static int _write_without_response_char_by_uuid(gattlib_connection_t* connection, const uuid_t* uuid,
+		const void* buffer, size_t buffer_len, gattlib_priority_t priority)
 {
 	int ret;
 
@@ -477,12 +721,33 @@ int gattlib_write_without_response_char_by_uuid(gattlib_connection_t* connection
 		assert(dbus_characteristic.type == TYPE_GATT);
 	}
 
-	ret = write_char(&dbus_characteristic, buffer, buffer_len, BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITHOUT_RESPONSE);
+	ret = write_char(connection, &dbus_characteristic, buffer, buffer_len, BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITHOUT_RESPONSE,
+			priority);
 
 	g_object_unref(dbus_characteristic.gatt);
 	return ret;
 }
 
+int gattlib_write_without_response_char_by_uuid_with_priority(gattlib_connection_t* connection, uuid_t* uuid,
+		const void* buffer, size_t buffer_len, gattlib_priority_t priority)
+{
+	int ret;
+
+	// When the coalescing is enabled, the value replaces the one not sent yet and is written by the writer
+	// of the characteristic
+	if (gattlib_write_coalescing_submit(connection, uuid, buffer, buffer_len, priority,
+			_write_without_response_char_by_uuid, &ret)) {
+		return ret;
+	}
+
+	return _write_without_response_char_by_uuid(connection, uuid, buffer, buffer_len, priority);
+}
+
+int gattlib_write_without_response_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, const void* buffer, size_t buffer_len)
+{
+	return gattlib_write_without_response_char_by_uuid_with_priority(connection, uuid, buffer, buffer_len, GATTLIB_PRIORITY_BULK);
+}
+
 int gattlib_write_without_response_char_by_handle(gattlib_connection_t* connection, uint16_t handle, const void* buffer, size_t buffer_len)
 {
 	int ret;
@@ -497,12 +762,276 @@ int gattlib_write_without_response_char_by_handle(gattlib_connection_t* connecti
 		return GATTLIB_NOT_FOUND;
 	}
 
-	ret = write_char(&dbus_characteristic, buffer, buffer_len, BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITHOUT_RESPONSE);
+	ret = write_char(connection, &dbus_characteristic, buffer, buffer_len, BLUEZ_GATT_WRITE_VALUE_TYPE_WRITE_WITHOUT_RESPONSE,
+			GATTLIB_PRIORITY_BULK);
 
 	g_object_unref(dbus_characteristic.gatt);
 	return ret;
 }
 
+#if BLUEZ_VERSION < BLUEZ_VERSIONS(5, 40)
+int gattlib_read_char_by_uuid_long(gattlib_connection_t* connection, uuid_t* uuid, gattlib_long_read_cb_t chunk_cb, void* user_data)
+{
+	// The 'offset' option of 'ReadValue' is not available before BlueZ v5.40
+	return GATTLIB_NOT_SUPPORTED;
+}
+
+int gattlib_write_char_by_uuid_long(gattlib_connection_t* connection, uuid_t* uuid, gattlib_long_write_cb_t chunk_cb, void* user_data)
+{
+	// The 'offset' option of 'WriteValue' is not available before BlueZ v5.40
+	return GATTLIB_NOT_SUPPORTED;
+}
+#else
+static uint16_t get_characteristic_mtu(struct dbus_characteristic *dbus_characteristic) {
+	uint16_t mtu = 0;
+
+#if BLUEZ_VERSION >= BLUEZ_VERSIONS(5, 48)
+	// The property is only exposed by recent BlueZ versions. Its getter returns 0 otherwise.
+	mtu = org_bluez_gatt_characteristic1_get_mtu(dbus_characteristic->gatt);
+#endif
+	if (mtu < GATTLIB_ATT_DEFAULT_MTU) {
+		mtu = GATTLIB_ATT_DEFAULT_MTU;
+	}
+	return mtu;
+}
+
+int gattlib_read_char_by_uuid_long(gattlib_connection_t* connection, uuid_t* uuid, gattlib_long_read_cb_t chunk_cb, void* user_data)
+{
+	size_t chunk_max_length;
+	size_t offset = 0;
+	int ret = GATTLIB_SUCCESS;
+
+	if (chunk_cb == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	//
+	// No need of locking the gattlib mutex. get_characteristic_from_uuid() is taking care of the gattlib
+	// object coherency. And 'dbus_characteristic' is not linked to gattlib object
+	//
+
+	struct dbus_characteristic dbus_characteristic = get_characteristic_from_uuid(connection, uuid);
+	if (dbus_characteristic.type == TYPE_NONE) {
+		return GATTLIB_NOT_FOUND;
+	}
+#if BLUEZ_VERSION > BLUEZ_VERSIONS(5, 40)
+	else if (dbus_characteristic.type == TYPE_BATTERY_LEVEL) {
+		void* buffer;
+		size_t buffer_len;
+
+		ret = read_battery_level(&dbus_characteristic, &buffer, &buffer_len);
+		if (ret == GATTLIB_SUCCESS) {
+			chunk_cb(buffer, buffer_len, 0, user_data);
+			free(buffer);
+		}
+		return ret;
+	}
+#endif
+
+	assert(dbus_characteristic.type == TYPE_GATT);
+
+	// A Read Blob Response carries up to ATT_MTU - 1 bytes of the value
+	chunk_max_length = get_characteristic_mtu(&dbus_characteristic) - 1;
+
+	while (true) {
+		GVariantBuilder *options = g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
+		GVariant *out_value;
+		GError *error = NULL;
+		gsize n_elements = 0;
+
+		if (offset > G_MAXUINT16) {
+			GATTLIB_LOG(GATTLIB_ERROR, "gattlib_read_char_by_uuid_long: Value is too long");
+			g_variant_builder_unref(options);
+			ret = GATTLIB_NOT_SUPPORTED;
+			break;
+		}
+		g_variant_builder_add(options, "{sv}", "offset", g_variant_new_uint16(offset));
+
+		gattlib_op_scheduler_acquire(connection, GATTLIB_PRIORITY_NORMAL);
+		org_bluez_gatt_characteristic1_call_read_value_sync(
+				dbus_characteristic.gatt, g_variant_builder_end(options), &out_value, NULL, &error);
+		gattlib_op_scheduler_release(connection, GATTLIB_PRIORITY_NORMAL);
+		g_variant_builder_unref(options);
+
+		if (error != NULL) {
+			gchar* remote_error = g_dbus_error_get_remote_error(error);
+
+			// The value length was a multiple of the chunk length. There is nothing left to read.
+			if ((offset > 0) && (remote_error != NULL) && (strcmp(remote_error, "org.bluez.Error.InvalidOffset") == 0)) {
+				g_free(remote_error);
+				g_error_free(error);
+				break;
+			}
+
+			ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
+			GATTLIB_LOG(GATTLIB_ERROR, "Failed to read DBus GATT characteristic at offset %zu: %s", offset, error->message);
+			g_free(remote_error);
+			g_error_free(error);
+			break;
+		}
+
+		gconstpointer chunk = g_variant_get_fixed_array(out_value, &n_elements, sizeof(guchar));
+		if ((chunk != NULL) && (n_elements > 0)) {
+			chunk_cb(chunk, n_elements, offset, user_data);
+		}
+		g_variant_unref(out_value);
+
+		offset += n_elements;
+
+		// A short chunk is the end of the value. BlueZ might also have returned all the remaining value at once.
+		if (n_elements != chunk_max_length) {
+			break;
+		}
+	}
+
+	g_object_unref(dbus_characteristic.gatt);
+	return ret;
+}
+
+int gattlib_write_char_by_uuid_long(gattlib_connection_t* connection, uuid_t* uuid, gattlib_long_write_cb_t chunk_cb, void* user_data)
+{
+	size_t chunk_max_length;
+	size_t chunk_length;
+	size_t offset = 0;
+	uint8_t* chunk;
+	int ret = GATTLIB_SUCCESS;
+
+	if (chunk_cb == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	//
+	// No need of locking the gattlib mutex. get_characteristic_from_uuid() is taking care of the gattlib
+	// object coherency. And 'dbus_characteristic' is not linked to gattlib object
+	//
+
+	struct dbus_characteristic dbus_characteristic = get_characteristic_from_uuid(connection, uuid);
+	if (dbus_characteristic.type == TYPE_NONE) {
+		return GATTLIB_NOT_FOUND;
+	} else if (dbus_characteristic.type == TYPE_BATTERY_LEVEL) {
+		return GATTLIB_NOT_SUPPORTED; // Battery level does not support write
+	} else {
+		assert(dbus_characteristic.type == TYPE_GATT);
+	}
+
+	// A Prepare Write Request carries up to ATT_MTU - 5 bytes of the value
+	chunk_max_length = get_characteristic_mtu(&dbus_characteristic) - 5;
+
+	chunk = malloc(chunk_max_length);
+	if (chunk == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	while ((chunk_length = chunk_cb(chunk, chunk_max_length, offset, user_data)) > 0) {
+		GVariantBuilder *options;
+		GVariant *value;
+		GError *error = NULL;
+
+		if ((chunk_length > chunk_max_length) || (offset > G_MAXUINT16)) {
+			ret = GATTLIB_INVALID_PARAMETER;
+			break;
+		}
+
+		value = g_variant_new_from_data(G_VARIANT_TYPE ("ay"), chunk, chunk_length, TRUE, NULL, NULL);
+		options = g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
+		g_variant_builder_add(options, "{sv}", "offset", g_variant_new_uint16(offset));
+
+		gattlib_op_scheduler_acquire(connection, GATTLIB_PRIORITY_NORMAL);
+		org_bluez_gatt_characteristic1_call_write_value_sync(dbus_characteristic.gatt, value, g_variant_builder_end(options), NULL, &error);
+		gattlib_op_scheduler_release(connection, GATTLIB_PRIORITY_NORMAL);
+		g_variant_builder_unref(options);
+
+		if (error != NULL) {
+			ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
+			GATTLIB_LOG(GATTLIB_ERROR, "Failed to write DBus GATT characteristic at offset %zu: %s", offset, error->message);
+			g_error_free(error);
+			break;
+		}
+
+		offset += chunk_length;
+	}
+
+	free(chunk);
+
+EXIT:
+	g_object_unref(dbus_characteristic.gatt);
+	return ret;
+}
+#endif
+
+int gattlib_write_transaction_commit(gattlib_write_transaction_t* transaction) {
+#if BLUEZ_VERSION < BLUEZ_VERSIONS(5, 40)
+	// The write 'type' option is not available before BlueZ v5.40
+	gattlib_write_transaction_abort(transaction);
+	return GATTLIB_NOT_SUPPORTED;
+#else
+	struct dbus_characteristic* dbus_characteristics;
+	int ret = GATTLIB_SUCCESS;
+	guint i;
+
+	if (transaction == NULL) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	// BlueZ executes the prepared writes of each characteristic on its own. The values of several
+	// characteristics cannot be applied atomically.
+	if (transaction->items->len > 1) {
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_write_transaction_commit: BlueZ cannot apply several characteristics at once");
+		ret = GATTLIB_NOT_SUPPORTED;
+		goto EXIT;
+	}
+
+	dbus_characteristics = calloc(sizeof(struct dbus_characteristic), transaction->items->len + 1);
+	if (dbus_characteristics == NULL) {
+		ret = GATTLIB_OUT_OF_MEMORY;
+		goto EXIT;
+	}
+
+	// Resolve all the characteristics first to not start writing a transaction that cannot complete
+	for (i = 0; i < transaction->items->len; i++) {
+		struct gattlib_write_transaction_item* item = g_ptr_array_index(transaction->items, i);
+
+		dbus_characteristics[i] = get_characteristic_from_uuid(transaction->connection, &item->uuid);
+		if (dbus_characteristics[i].type == TYPE_NONE) {
+			ret = GATTLIB_NOT_FOUND;
+			goto FREE_CHARACTERISTICS;
+		} else if (dbus_characteristics[i].type != TYPE_GATT) {
+			ret = GATTLIB_NOT_SUPPORTED;
+			goto FREE_CHARACTERISTICS;
+		}
+	}
+
+	for (i = 0; i < transaction->items->len; i++) {
+		struct gattlib_write_transaction_item* item = g_ptr_array_index(transaction->items, i);
+
+		ret = write_char(transaction->connection, &dbus_characteristics[i], item->value, item->value_length,
+				BLUEZ_GATT_WRITE_VALUE_TYPE_RELIABLE_WRITE, GATTLIB_PRIORITY_NORMAL);
+		if (ret != GATTLIB_SUCCESS) {
+			GATTLIB_LOG(GATTLIB_ERROR, "gattlib_write_transaction_commit: Write %u of %u has failed", i + 1, transaction->items->len);
+			break;
+		}
+	}
+
+FREE_CHARACTERISTICS:
+	for (i = 0; i < transaction->items->len; i++) {
+		if (dbus_characteristics[i].type == TYPE_GATT) {
+			g_object_unref(dbus_characteristics[i].gatt);
+		}
+#if BLUEZ_VERSION > BLUEZ_VERSIONS(5, 40)
+		else if (dbus_characteristics[i].type == TYPE_BATTERY_LEVEL) {
+			g_object_unref(dbus_characteristics[i].battery);
+		}
+#endif
+	}
+	free(dbus_characteristics);
+
+EXIT:
+	gattlib_write_transaction_abort(transaction);
+	return ret;
+#endif
+}
+
 void gattlib_characteristic_free_value(void *ptr) {
 	free(ptr);
 }
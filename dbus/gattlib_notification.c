@@ -11,6 +11,9 @@
 
 #include "gattlib_internal.h"
 
+// Maximum time gattlib_notifications_start/stop() wait for BlueZ. It is longer than the D-Bus default timeout.
+#define GATTLIB_NOTIFICATION_BATCH_TIMEOUT_SEC	30
+
 struct gattlib_notification_handle {
 	OrgBluezGattCharacteristic1 *gatt;
 	gulong signal_id;
@@ -26,6 +29,7 @@ gboolean on_handle_battery_level_property_change(
 {
 	static guint8 percentage;
 	gattlib_connection_t* connection = user_data;
+	uint64_t timestamp_ns = gattlib_get_monotonic_time_ns();
 
 	GATTLIB_LOG(GATTLIB_DEBUG, "DBUS: on_handle_battery_level_property_change: changed_properties:%s invalidated_properties:%s",
 			g_variant_print(arg_changed_properties, TRUE),
@@ -38,7 +42,7 @@ gboolean on_handle_battery_level_property_change(
 		return FALSE;
 	}
 
-	if (gattlib_has_valid_handler(&connection->notification)) {
+	if (gattlib_has_valid_handler(&connection->notification) || gattlib_notification_queue_is_enabled(connection)) {
 		// Retrieve 'Value' from 'arg_changed_properties'
 		if (g_variant_n_children (arg_changed_properties) > 0) {
 			GVariantIter *iter;
@@ -54,7 +58,7 @@ gboolean on_handle_battery_level_property_change(
 
 					gattlib_on_gatt_notification(connection,
 							&m_battery_level_uuid,
-							(const uint8_t*)&percentage, sizeof(percentage));
+							(const uint8_t*)&percentage, sizeof(percentage), timestamp_ns);
 					break;
 				}
 			}
@@ -73,6 +77,8 @@ static gboolean on_handle_characteristic_property_change(
 	    gpointer user_data)
 {
 	gattlib_connection_t* connection = user_data;
+	// Timestamp the event as soon as it enters gattlib
+	uint64_t timestamp_ns = gattlib_get_monotonic_time_ns();
 
 	g_rec_mutex_lock(&m_gattlib_mutex);
 
@@ -81,7 +87,7 @@ static gboolean on_handle_characteristic_property_change(
 		return FALSE;
 	}
 
-	if (gattlib_has_valid_handler(&connection->notification)) {
+	if (gattlib_has_valid_handler(&connection->notification) || gattlib_notification_queue_is_enabled(connection)) {
 		GVariantDict dict;
 		g_variant_dict_init(&dict, arg_changed_properties);
 
@@ -101,7 +107,7 @@ static gboolean on_handle_characteristic_property_change(
 					MAX_LEN_UUID_STR + 1,
 					&uuid);
 
-			gattlib_on_gatt_notification(connection, &uuid, data, data_length);
+			gattlib_on_gatt_notification(connection, &uuid, data, data_length, timestamp_ns);
 
 			// As per https://developer.gnome.org/glib/stable/glib-GVariant.html#g-variant-iter-loop, clean up `key` and `value`.
 			g_variant_unref(value);
@@ -123,8 +129,10 @@ static gboolean on_handle_characteristic_indication(
 	    gpointer user_data)
 {
 	gattlib_connection_t* connection = user_data;
+	// Timestamp the event as soon as it enters gattlib
+	uint64_t timestamp_ns = gattlib_get_monotonic_time_ns();
 
-	if (gattlib_has_valid_handler(&connection->indication)) {
+	if (gattlib_has_valid_handler(&connection->indication) || gattlib_notification_queue_is_enabled(connection)) {
 		// Retrieve 'Value' from 'arg_changed_properties'
 		if (g_variant_n_children (arg_changed_properties) > 0) {
 			GVariantIter *iter;
@@ -146,7 +154,7 @@ static gboolean on_handle_characteristic_indication(
 							MAX_LEN_UUID_STR + 1,
 							&uuid);
 
-					gattlib_on_gatt_notification(connection, &uuid, data, data_length);
+					gattlib_on_gatt_indication(connection, &uuid, data, data_length, timestamp_ns);
 					break;
 				}
 			}
@@ -158,64 +166,120 @@ static gboolean on_handle_characteristic_indication(
 	return TRUE;
 }
 
-static int connect_signal_to_characteristic_uuid(gattlib_connection_t* connection, const uuid_t* uuid, void *callback) {
-	int ret = GATTLIB_SUCCESS;
-
-	assert(callback != NULL);
-
-	g_rec_mutex_lock(&m_gattlib_mutex);
-
+/**
+ * @note 'm_gattlib_mutex' must be held
+ */
+static int lookup_characteristic(gattlib_connection_t* connection, const uuid_t* uuid, struct dbus_characteristic* dbus_characteristic) {
 	if (!gattlib_connection_is_connected(connection)) {
-		ret = GATTLIB_INVALID_PARAMETER;
-		goto EXIT;
+		return GATTLIB_INVALID_PARAMETER;
 	}
 
-	struct dbus_characteristic dbus_characteristic = get_characteristic_from_uuid(connection, uuid);
-	if (dbus_characteristic.type == TYPE_NONE) {
+	*dbus_characteristic = get_characteristic_from_uuid(connection, uuid);
+	if (dbus_characteristic->type == TYPE_NONE) {
 		char uuid_str[MAX_LEN_UUID_STR + 1];
 
 		gattlib_uuid_to_string(uuid, uuid_str, sizeof(uuid_str));
 
 		GATTLIB_LOG(GATTLIB_ERROR, "GATT characteristic '%s' not found", uuid_str);
-		ret = GATTLIB_NOT_FOUND;
-		goto EXIT;
+		return GATTLIB_NOT_FOUND;
 	}
+
+	return GATTLIB_SUCCESS;
+}
+
+/**
+ * Register the handler of the notifications/indications of the characteristic
+ *
+ * The notification of the GATT characteristic still needs to be started with StartNotify.
+ * For the battery level, the notifications are handled by BlueZ. There is nothing to start.
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+static int register_characteristic_signal(gattlib_connection_t* connection, const uuid_t* uuid, void *callback,
+		const struct dbus_characteristic* dbus_characteristic, gulong* signal_id)
+{
+	assert(callback != NULL);
+
+	*signal_id = 0;
+
 #if BLUEZ_VERSION > BLUEZ_VERSIONS(5, 40)
-	else if (dbus_characteristic.type == TYPE_BATTERY_LEVEL) {
+	if (dbus_characteristic->type == TYPE_BATTERY_LEVEL) {
 		// Register a handle for notification
-		g_signal_connect(dbus_characteristic.battery,
+		g_signal_connect(dbus_characteristic->battery,
 			"g-properties-changed",
 			G_CALLBACK (on_handle_battery_level_property_change),
 			connection);
 
-		ret = GATTLIB_SUCCESS;
-		goto EXIT;
+		return GATTLIB_SUCCESS;
 	} else {
-		assert(dbus_characteristic.type == TYPE_GATT);
+		assert(dbus_characteristic->type == TYPE_GATT);
 	}
 #endif
 
+	// Add signal to the list
+	struct gattlib_notification_handle *notification_handle = calloc(sizeof(struct gattlib_notification_handle), 1);
+	if (notification_handle == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
 	// Register a handle for notification
-	gulong signal_id = g_signal_connect(dbus_characteristic.gatt,
+	notification_handle->signal_id = g_signal_connect(dbus_characteristic->gatt,
 		"g-properties-changed",
 		G_CALLBACK(callback),
 		connection);
-	if (signal_id == 0) {
+	if (notification_handle->signal_id == 0) {
 		GATTLIB_LOG(GATTLIB_ERROR, "Failed to connect signal to DBus GATT notification");
-		ret = GATTLIB_ERROR_DBUS;
+		free(notification_handle);
+		return GATTLIB_ERROR_DBUS;
+	}
+
+	notification_handle->gatt = dbus_characteristic->gatt;
+	memcpy(&notification_handle->uuid, uuid, sizeof(*uuid));
+	connection->backend.notified_characteristics = g_list_append(connection->backend.notified_characteristics, notification_handle);
+
+	*signal_id = notification_handle->signal_id;
+	return GATTLIB_SUCCESS;
+}
+
+/**
+ * Remove the handler registered by register_characteristic_signal() when StartNotify has failed
+ *
+ * The handler might already be gone if the connection has been disconnected in the meantime.
+ *
+ * @note 'm_gattlib_mutex' must be held
+ */
+static void unregister_characteristic_signal(gattlib_connection_t* connection, OrgBluezGattCharacteristic1 *gatt, gulong signal_id) {
+	for (GList *l = connection->backend.notified_characteristics; l != NULL; l = l->next) {
+		struct gattlib_notification_handle *notification_handle = l->data;
+		if ((notification_handle->gatt == gatt) && (notification_handle->signal_id == signal_id)) {
+			connection->backend.notified_characteristics = g_list_delete_link(connection->backend.notified_characteristics, l);
+
+			g_signal_handler_disconnect(notification_handle->gatt, notification_handle->signal_id);
+			free(notification_handle);
+			return;
+		}
+	}
+}
+
+static int connect_signal_to_characteristic_uuid(gattlib_connection_t* connection, const uuid_t* uuid, void *callback) {
+	struct dbus_characteristic dbus_characteristic;
+	gulong signal_id;
+	int ret;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	ret = lookup_characteristic(connection, uuid, &dbus_characteristic);
+	if (ret != GATTLIB_SUCCESS) {
 		goto EXIT;
 	}
 
-	// Add signal to the list
-	struct gattlib_notification_handle *notification_handle = calloc(sizeof(struct gattlib_notification_handle), 1);
-	if (notification_handle == NULL) {
-		ret = GATTLIB_OUT_OF_MEMORY;
+	ret = register_characteristic_signal(connection, uuid, callback, &dbus_characteristic, &signal_id);
+	if (ret != GATTLIB_SUCCESS) {
+		release_characteristic(&dbus_characteristic);
+		goto EXIT;
+	} else if (dbus_characteristic.type != TYPE_GATT) {
 		goto EXIT;
 	}
-	notification_handle->gatt = dbus_characteristic.gatt;
-	notification_handle->signal_id = signal_id;
-	memcpy(&notification_handle->uuid, uuid, sizeof(*uuid));
-	connection->backend.notified_characteristics = g_list_append(connection->backend.notified_characteristics, notification_handle);
 
 	// Note: An optimisation could be to release mutex here after increasing reference counter of 'dbus_characteristic.gatt'
 
@@ -225,14 +289,131 @@ static int connect_signal_to_characteristic_uuid(gattlib_connection_t* connectio
 		ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
 		GATTLIB_LOG(GATTLIB_ERROR, "Failed to start DBus GATT notification: %s", error->message);
 		g_error_free(error);
+
+		unregister_characteristic_signal(connection, dbus_characteristic.gatt, signal_id);
+		release_characteristic(&dbus_characteristic);
 		goto EXIT;
 	}
 
+	// Keep track of the subscription to restore it on automatic reconnection
+	gattlib_subscription_add(connection, uuid, callback == on_handle_characteristic_indication);
+
 EXIT:
 	g_rec_mutex_unlock(&m_gattlib_mutex);
 	return ret;
 }
 
+struct gattlib_notification_start_context {
+	gattlib_connection_t* connection;
+	uuid_t uuid;
+	bool is_indication;
+	gulong signal_id;
+	gattlib_notification_start_cb_t start_cb;
+	void* user_data;
+};
+
+static void _on_start_notify_ready(GObject* source_object, GAsyncResult* res, gpointer user_data) {
+	struct gattlib_notification_start_context* context = user_data;
+	gattlib_connection_t* connection = context->connection;
+	GError *error = NULL;
+	int ret = GATTLIB_SUCCESS;
+
+	org_bluez_gatt_characteristic1_call_start_notify_finish(ORG_BLUEZ_GATT_CHARACTERISTIC1(source_object), res, &error);
+	if (error) {
+		ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
+		GATTLIB_LOG(GATTLIB_ERROR, "Failed to start DBus GATT notification: %s", error->message);
+		g_error_free(error);
+
+		// Do not leave a handler behind for a notification that has not started
+		g_rec_mutex_lock(&m_gattlib_mutex);
+		if (gattlib_connection_is_connected(connection)) {
+			unregister_characteristic_signal(connection, ORG_BLUEZ_GATT_CHARACTERISTIC1(source_object), context->signal_id);
+		}
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+
+		// Release the reference returned by the characteristic lookup. Only active notifications keep it.
+		g_object_unref(source_object);
+	} else {
+		g_rec_mutex_lock(&m_gattlib_mutex);
+		if (gattlib_connection_is_connected(connection)) {
+			gattlib_subscription_add(connection, &context->uuid, context->is_indication);
+		}
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+	}
+
+	context->start_cb(connection, &context->uuid, ret, context->user_data);
+
+	// Release the reference taken when the notification has been requested
+	gattlib_device_unref(connection->device);
+	free(context);
+}
+
+/**
+ * Start the notification of a resolved characteristic without waiting for BlueZ
+ *
+ * On success, the notification keeps the reference of 'dbus_characteristic'. On error, the caller
+ * still owns it.
+ *
+ * @note 'm_gattlib_mutex' must be held. 'start_cb' might be called with the mutex held.
+ */
+static int start_notify_async(gattlib_connection_t* connection, const uuid_t* uuid, bool is_indication,
+		const struct dbus_characteristic* dbus_characteristic, gattlib_notification_start_cb_t start_cb, void* user_data)
+{
+	struct gattlib_notification_start_context* context;
+	gulong signal_id;
+	int ret;
+
+	ret = register_characteristic_signal(connection, uuid,
+		is_indication ? (void*)on_handle_characteristic_indication : (void*)on_handle_characteristic_property_change,
+		dbus_characteristic, &signal_id);
+	if (ret != GATTLIB_SUCCESS) {
+		return ret;
+	}
+
+	if (dbus_characteristic->type != TYPE_GATT) {
+		// Nothing to start. The notification is already active.
+		start_cb(connection, uuid, GATTLIB_SUCCESS, user_data);
+		return GATTLIB_SUCCESS;
+	}
+
+	context = calloc(sizeof(struct gattlib_notification_start_context), 1);
+	if (context == NULL) {
+		unregister_characteristic_signal(connection, dbus_characteristic->gatt, signal_id);
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+	context->connection = connection;
+	memcpy(&context->uuid, uuid, sizeof(uuid_t));
+	context->is_indication = is_indication;
+	context->signal_id = signal_id;
+	context->start_cb = start_cb;
+	context->user_data = user_data;
+
+	// Keep the connection until StartNotify has completed
+	gattlib_device_ref(connection->device);
+
+	org_bluez_gatt_characteristic1_call_start_notify(dbus_characteristic->gatt, NULL, _on_start_notify_ready, context);
+	return GATTLIB_SUCCESS;
+}
+
+int gattlib_notification_start_async(gattlib_connection_t* connection, const uuid_t* uuid, bool is_indication,
+		const struct dbus_characteristic* dbus_characteristic, gattlib_notification_start_cb_t start_cb, void* user_data)
+{
+	int ret;
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_connected(connection)) {
+		ret = GATTLIB_INVALID_PARAMETER;
+	} else if (dbus_characteristic->type == TYPE_NONE) {
+		ret = GATTLIB_NOT_FOUND;
+	} else {
+		ret = start_notify_async(connection, uuid, is_indication, dbus_characteristic, start_cb, user_data);
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+	return ret;
+}
+
 static int disconnect_signal_to_characteristic_uuid(gattlib_connection_t* connection, const uuid_t* uuid, void *callback) {
 	struct gattlib_notification_handle *notification_handle = NULL;
 	int ret = GATTLIB_SUCCESS;
@@ -260,6 +441,8 @@ static int disconnect_signal_to_characteristic_uuid(gattlib_connection_t* connec
 		goto EXIT;
 	}
 
+	gattlib_subscription_remove(connection, uuid);
+
 	g_signal_handler_disconnect(notification_handle->gatt, notification_handle->signal_id);
 
 	GError *error = NULL;
@@ -296,6 +479,244 @@ int gattlib_indication_stop(gattlib_connection_t* connection, const uuid_t* uuid
 	return disconnect_signal_to_characteristic_uuid(connection, uuid, on_handle_characteristic_indication);
 }
 
+// State shared by the concurrent requests of gattlib_notifications_start/stop(). It outlives the caller
+// when the requests have not completed before GATTLIB_NOTIFICATION_BATCH_TIMEOUT_SEC.
+struct gattlib_notification_batch {
+	struct gattlib_completion completion;
+	// References held by the caller and by each request that has not completed yet
+	gint reference_counter;
+	// Result of each request. Accessed with g_atomic_int_*() as the caller might read them while requests complete.
+	gint* results;
+	struct gattlib_notification_batch_item* items;
+	size_t count;
+};
+
+struct gattlib_notification_batch_item {
+	struct gattlib_notification_batch* batch;
+	size_t index;
+};
+
+static struct gattlib_notification_batch* _notification_batch_new(size_t count) {
+	struct gattlib_notification_batch* batch = calloc(sizeof(struct gattlib_notification_batch), 1);
+	if (batch == NULL) {
+		return NULL;
+	}
+
+	batch->results = calloc(sizeof(gint), count);
+	batch->items = calloc(sizeof(struct gattlib_notification_batch_item), count);
+	if ((batch->results == NULL) || (batch->items == NULL)) {
+		free(batch->results);
+		free(batch->items);
+		free(batch);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		batch->items[i].batch = batch;
+		batch->items[i].index = i;
+	}
+
+	gattlib_completion_init(&batch->completion);
+	batch->reference_counter = 1;
+	batch->count = count;
+	return batch;
+}
+
+static void _notification_batch_unref(struct gattlib_notification_batch* batch) {
+	gint old_reference_counter = g_atomic_int_add(&batch->reference_counter, -1);
+
+	if (old_reference_counter == 2) {
+		// Only the caller is left: all the requests have completed
+		gattlib_completion_complete(&batch->completion, GATTLIB_SUCCESS);
+	} else if (old_reference_counter == 1) {
+		gattlib_completion_clear(&batch->completion);
+		free(batch->results);
+		free(batch->items);
+		free(batch);
+	}
+}
+
+/**
+ * Mark the request of the item as issued. Its result is GATTLIB_TIMEOUT until it completes.
+ */
+static struct gattlib_notification_batch_item* _notification_batch_issue(struct gattlib_notification_batch* batch, size_t index) {
+	g_atomic_int_set(&batch->results[index], GATTLIB_TIMEOUT);
+	g_atomic_int_inc(&batch->reference_counter);
+	return &batch->items[index];
+}
+
+static void _on_batch_notification_started(gattlib_connection_t* connection, const uuid_t* uuid, int error, void* user_data) {
+	struct gattlib_notification_batch_item* item = user_data;
+
+	g_atomic_int_set(&item->batch->results[item->index], error);
+	_notification_batch_unref(item->batch);
+}
+
+static void _on_batch_notification_stopped(GObject* source_object, GAsyncResult* res, gpointer user_data) {
+	struct gattlib_notification_batch_item* item = user_data;
+	GError *error = NULL;
+	int ret = GATTLIB_SUCCESS;
+
+	org_bluez_gatt_characteristic1_call_stop_notify_finish(ORG_BLUEZ_GATT_CHARACTERISTIC1(source_object), res, &error);
+	if (error) {
+		GATTLIB_LOG(GATTLIB_ERROR, "Failed to stop DBus GATT notification: %s", error->message);
+		ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
+		g_error_free(error);
+	}
+
+	g_atomic_int_set(&item->batch->results[item->index], ret);
+	_notification_batch_unref(item->batch);
+}
+
+/**
+ * Wait for all the requests of the batch, report their results and release the batch
+ *
+ * The replies of BlueZ are dispatched by the GLib main loop. When called from the thread running it,
+ * the main loop is iterated while waiting.
+ *
+ * @return GATTLIB_SUCCESS if all the requests have succeeded or the error of the first failing request.
+ *         The requests that have not completed in time fail with GATTLIB_TIMEOUT.
+ */
+static int _notification_batch_wait(struct gattlib_notification_batch* batch, int* results) {
+	gint64 end_time = g_get_monotonic_time() + GATTLIB_NOTIFICATION_BATCH_TIMEOUT_SEC * G_TIME_SPAN_SECOND;
+	int ret = GATTLIB_SUCCESS;
+
+	if (g_main_context_is_owner(NULL)) {
+		// Every D-Bus request completes (at worst with a D-Bus timeout). So the iteration cannot block forever.
+		while ((g_atomic_int_get(&batch->reference_counter) > 1) && (g_get_monotonic_time() < end_time)) {
+			g_main_context_iteration(NULL, TRUE);
+		}
+	} else if (g_atomic_int_get(&batch->reference_counter) > 1) {
+		gattlib_completion_wait_until(&batch->completion, end_time);
+	}
+
+	for (size_t i = 0; i < batch->count; i++) {
+		int item_ret = g_atomic_int_get(&batch->results[i]);
+
+		if ((ret == GATTLIB_SUCCESS) && (item_ret != GATTLIB_SUCCESS)) {
+			ret = item_ret;
+		}
+		if (results != NULL) {
+			results[i] = item_ret;
+		}
+	}
+
+	// The requests still in progress release the batch once they complete
+	_notification_batch_unref(batch);
+	return ret;
+}
+
+int gattlib_notifications_start(gattlib_connection_t* connection, const uuid_t* uuids, size_t uuids_count, uint32_t flags, int* results) {
+	struct gattlib_notification_batch* batch;
+	struct dbus_characteristic* dbus_characteristics;
+	const bool is_indication = (flags & GATTLIB_NOTIFICATIONS_INDICATION) != 0;
+
+	if ((connection == NULL) || (uuids == NULL) || (uuids_count == 0)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	dbus_characteristics = calloc(sizeof(struct dbus_characteristic), uuids_count);
+	if (dbus_characteristics == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	batch = _notification_batch_new(uuids_count);
+	if (batch == NULL) {
+		free(dbus_characteristics);
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_connected(connection)) {
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		_notification_batch_unref(batch);
+		free(dbus_characteristics);
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	// Resolve all the characteristics at once before issuing the requests
+	get_characteristics_from_uuids(connection, uuids, uuids_count, dbus_characteristics);
+
+	for (size_t i = 0; i < uuids_count; i++) {
+		int item_ret;
+
+		if (dbus_characteristics[i].type == TYPE_NONE) {
+			batch->results[i] = GATTLIB_NOT_FOUND;
+			continue;
+		}
+
+		item_ret = start_notify_async(connection, &uuids[i], is_indication, &dbus_characteristics[i],
+			_on_batch_notification_started, _notification_batch_issue(batch, i));
+		if (item_ret != GATTLIB_SUCCESS) {
+			// The callback will not be called for this request
+			g_atomic_int_set(&batch->results[i], item_ret);
+			_notification_batch_unref(batch);
+
+			release_characteristic(&dbus_characteristics[i]);
+		}
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	free(dbus_characteristics);
+	return _notification_batch_wait(batch, results);
+}
+
+int gattlib_notifications_stop(gattlib_connection_t* connection, const uuid_t* uuids, size_t uuids_count, int* results) {
+	struct gattlib_notification_batch* batch;
+
+	if ((connection == NULL) || (uuids == NULL) || (uuids_count == 0)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	batch = _notification_batch_new(uuids_count);
+	if (batch == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+
+	if (!gattlib_connection_is_connected(connection)) {
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		_notification_batch_unref(batch);
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	for (size_t i = 0; i < uuids_count; i++) {
+		struct gattlib_notification_handle *notification_handle = NULL;
+
+		// Find notification handle
+		for (GList *l = connection->backend.notified_characteristics; l != NULL; l = l->next) {
+			struct gattlib_notification_handle *notification_handle_ptr = l->data;
+			if (gattlib_uuid_cmp(&notification_handle_ptr->uuid, &uuids[i]) == GATTLIB_SUCCESS) {
+				notification_handle = notification_handle_ptr;
+
+				connection->backend.notified_characteristics = g_list_delete_link(connection->backend.notified_characteristics, l);
+				break;
+			}
+		}
+
+		if (notification_handle == NULL) {
+			batch->results[i] = GATTLIB_NOT_FOUND;
+			continue;
+		}
+
+		gattlib_subscription_remove(connection, &uuids[i]);
+
+		g_signal_handler_disconnect(notification_handle->gatt, notification_handle->signal_id);
+
+		org_bluez_gatt_characteristic1_call_stop_notify(notification_handle->gatt, NULL, _on_batch_notification_stopped,
+			_notification_batch_issue(batch, i));
+
+		free(notification_handle);
+	}
+
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	return _notification_batch_wait(batch, results);
+}
+
 static void end_notification(void *notified_characteristic) {
 	struct gattlib_notification_handle *notification_handle = notified_characteristic;
 
@@ -0,0 +1,392 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2024, Olivier Martin <olivier@labapart.org>
+ */
+
+#include <stdlib.h>
+
+#include "gattlib_internal.h"
+
+// The notifications, indications and reads are issued first. The writes are issued once they have
+// completed to not miss a notification triggered by a write.
+enum gattlib_profile_phase {
+	PROFILE_PHASE_SUBSCRIBE_AND_READ = 0,
+	PROFILE_PHASE_WRITE,
+};
+
+struct gattlib_profile_context;
+
+struct gattlib_profile_step_context {
+	struct gattlib_profile_context* profile;
+	size_t index;
+};
+
+struct gattlib_profile_context {
+	gattlib_adapter_t* adapter;
+	char* dst;
+	gattlib_connection_t* connection;
+
+	gattlib_profile_step_t* steps;
+	gattlib_profile_step_result_t* results;
+	struct gattlib_profile_step_context* step_contexts;
+	// Characteristic of each step. Resolved once connected. Each step takes the reference of its characteristic.
+	struct dbus_characteristic* characteristics;
+	size_t steps_count;
+
+	gattlib_event_handler_t notification_handler;
+	gattlib_event_handler_t indication_handler;
+	void* handler_user_data;
+
+	gattlib_profile_ready_cb_t ready_cb;
+	void* user_data;
+
+	enum gattlib_profile_phase phase;
+	// Number of steps of the current phase that have not completed
+	gint pending_steps;
+
+	uint64_t start_timestamp_ns;
+	uint64_t connected_timestamp_ns;
+	uint64_t ready_timestamp_ns;
+};
+
+static void _profile_context_free(struct gattlib_profile_context* context) {
+	for (size_t i = 0; i < context->steps_count; i++) {
+		free((void*)context->steps[i].data);
+		free(context->results[i].data);
+	}
+	free(context->steps);
+	free(context->results);
+	free(context->step_contexts);
+	free(context->characteristics);
+	free(context->dst);
+	free(context);
+}
+
+static void _profile_report(struct gattlib_profile_context* context, int error) {
+	gattlib_profile_report_t report = {
+		.error = error,
+		.steps_failed = 0,
+	};
+
+	if (context->connected_timestamp_ns != 0) {
+		report.connect_latency_ns = context->connected_timestamp_ns - context->start_timestamp_ns;
+	}
+	if (context->ready_timestamp_ns != 0) {
+		report.time_to_ready_ns = context->ready_timestamp_ns - context->start_timestamp_ns;
+	}
+
+	if (context->connection != NULL) {
+		for (size_t i = 0; i < context->steps_count; i++) {
+			if (context->results[i].error != GATTLIB_SUCCESS) {
+				if (report.error == GATTLIB_SUCCESS) {
+					report.error = context->results[i].error;
+				}
+				report.steps_failed++;
+			}
+		}
+	}
+
+	context->ready_cb(context->adapter, context->dst, context->connection, &report,
+		context->connection != NULL ? context->results : NULL, context->steps_count,
+		context->user_data);
+}
+
+static void _profile_ready_task(void* data) {
+	struct gattlib_profile_context* context = data;
+	gattlib_device_t* device = context->connection->device;
+
+	_profile_report(context, GATTLIB_SUCCESS);
+	_profile_context_free(context);
+
+	// Release the reference taken when the device has been connected
+	gattlib_device_unref(device);
+}
+
+static void _profile_run_phase(struct gattlib_profile_context* context, enum gattlib_profile_phase phase);
+
+static void _profile_step_done(struct gattlib_profile_context* context) {
+	if (!g_atomic_int_dec_and_test(&context->pending_steps)) {
+		return;
+	}
+
+	if (context->phase == PROFILE_PHASE_SUBSCRIBE_AND_READ) {
+		_profile_run_phase(context, PROFILE_PHASE_WRITE);
+		return;
+	}
+
+	context->ready_timestamp_ns = gattlib_get_monotonic_time_ns();
+
+	// Do not call the application from the D-Bus loop
+	if (gattlib_serial_queue_push(context->connection->serial_queue, _profile_ready_task, context, GATTLIB_TASK_DETACHED) != GATTLIB_SUCCESS) {
+		_profile_ready_task(context);
+	}
+}
+
+static void _profile_step_complete(struct gattlib_profile_step_context* step_context, int error) {
+	step_context->profile->results[step_context->index].error = error;
+	_profile_step_done(step_context->profile);
+}
+
+static void _on_profile_subscribed(gattlib_connection_t* connection, const uuid_t* uuid, int error, void* user_data) {
+	_profile_step_complete(user_data, error);
+}
+
+static void _on_profile_read_ready(GObject* source_object, GAsyncResult* res, gpointer user_data) {
+	struct gattlib_profile_step_context* step_context = user_data;
+	gattlib_profile_step_result_t* result = &step_context->profile->results[step_context->index];
+	GVariant *out_value = NULL;
+	GError *error = NULL;
+	int ret = GATTLIB_SUCCESS;
+
+	org_bluez_gatt_characteristic1_call_read_value_finish(ORG_BLUEZ_GATT_CHARACTERISTIC1(source_object), &out_value, res, &error);
+	if (error != NULL) {
+		ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
+		GATTLIB_LOG(GATTLIB_ERROR, "Failed to read DBus GATT characteristic: %s", error->message);
+		g_error_free(error);
+		goto EXIT;
+	}
+
+	gsize n_elements = 0;
+	gconstpointer const_buffer = g_variant_get_fixed_array(out_value, &n_elements, sizeof(guchar));
+	if (const_buffer && (n_elements > 0)) {
+		result->data = malloc(n_elements);
+		if (result->data == NULL) {
+			ret = GATTLIB_OUT_OF_MEMORY;
+		} else {
+			memcpy(result->data, const_buffer, n_elements);
+			result->data_length = n_elements;
+		}
+	}
+	g_variant_unref(out_value);
+
+EXIT:
+	// Release the reference taken by get_characteristics_from_uuids()
+	g_object_unref(source_object);
+	_profile_step_complete(step_context, ret);
+}
+
+static void _on_profile_write_ready(GObject* source_object, GAsyncResult* res, gpointer user_data) {
+	struct gattlib_profile_step_context* step_context = user_data;
+	GError *error = NULL;
+	int ret = GATTLIB_SUCCESS;
+
+	org_bluez_gatt_characteristic1_call_write_value_finish(ORG_BLUEZ_GATT_CHARACTERISTIC1(source_object), res, &error);
+	if (error != NULL) {
+		ret = GATTLIB_ERROR_DBUS_WITH_ERROR(error);
+		GATTLIB_LOG(GATTLIB_ERROR, "Failed to write DBus GATT characteristic: %s (%d,%d)",
+			error->message, error->domain, error->code);
+		g_error_free(error);
+	}
+
+	// Release the reference taken by get_characteristics_from_uuids()
+	g_object_unref(source_object);
+	_profile_step_complete(step_context, ret);
+}
+
+/**
+ * Issue the step. Its completion is reported with _profile_step_complete().
+ */
+static void _profile_step_start(struct gattlib_profile_context* context, size_t index) {
+	struct gattlib_profile_step_context* step_context = &context->step_contexts[index];
+	gattlib_profile_step_t* step = &context->steps[index];
+	struct dbus_characteristic dbus_characteristic = context->characteristics[index];
+	int ret;
+
+	if (dbus_characteristic.type == TYPE_NONE) {
+		char uuid_str[MAX_LEN_UUID_STR + 1];
+
+		gattlib_uuid_to_string(&step->uuid, uuid_str, sizeof(uuid_str));
+		GATTLIB_LOG(GATTLIB_ERROR, "GATT characteristic '%s' not found", uuid_str);
+
+		_profile_step_complete(step_context, GATTLIB_NOT_FOUND);
+		return;
+	}
+
+	if ((step->type == GATTLIB_PROFILE_STEP_NOTIFY) || (step->type == GATTLIB_PROFILE_STEP_INDICATE)) {
+		ret = gattlib_notification_start_async(context->connection, &step->uuid,
+			step->type == GATTLIB_PROFILE_STEP_INDICATE, &dbus_characteristic,
+			_on_profile_subscribed, step_context);
+		if (ret != GATTLIB_SUCCESS) {
+			release_characteristic(&dbus_characteristic);
+			_profile_step_complete(step_context, ret);
+		}
+		return;
+	}
+
+#if BLUEZ_VERSION > BLUEZ_VERSIONS(5, 40)
+	else if (dbus_characteristic.type == TYPE_BATTERY_LEVEL) {
+		gattlib_profile_step_result_t* result = &context->results[index];
+
+		if (step->type == GATTLIB_PROFILE_STEP_WRITE) {
+			ret = GATTLIB_NOT_SUPPORTED;
+		} else {
+			result->data = malloc(sizeof(uint8_t));
+			if (result->data == NULL) {
+				ret = GATTLIB_OUT_OF_MEMORY;
+			} else {
+				result->data[0] = org_bluez_battery1_get_percentage(dbus_characteristic.battery);
+				result->data_length = sizeof(uint8_t);
+				ret = GATTLIB_SUCCESS;
+			}
+		}
+
+		g_object_unref(dbus_characteristic.battery);
+		_profile_step_complete(step_context, ret);
+		return;
+	}
+#endif
+
+	if (step->type == GATTLIB_PROFILE_STEP_READ) {
+#if BLUEZ_VERSION < BLUEZ_VERSIONS(5, 40)
+		org_bluez_gatt_characteristic1_call_read_value(dbus_characteristic.gatt, NULL, _on_profile_read_ready, step_context);
+#else
+		GVariantBuilder *options =  g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
+		org_bluez_gatt_characteristic1_call_read_value(dbus_characteristic.gatt, g_variant_builder_end(options), NULL,
+			_on_profile_read_ready, step_context);
+		g_variant_builder_unref(options);
+#endif
+	} else {
+		GVariant *value = g_variant_new_from_data(G_VARIANT_TYPE ("ay"), step->data, step->data_length, TRUE, NULL, NULL);
+
+#if BLUEZ_VERSION < BLUEZ_VERSIONS(5, 40)
+		org_bluez_gatt_characteristic1_call_write_value(dbus_characteristic.gatt, value, NULL, _on_profile_write_ready, step_context);
+#else
+		GVariantBuilder *options =  g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
+		org_bluez_gatt_characteristic1_call_write_value(dbus_characteristic.gatt, value, g_variant_builder_end(options), NULL,
+			_on_profile_write_ready, step_context);
+		g_variant_builder_unref(options);
+#endif
+	}
+}
+
+static void _profile_run_phase(struct gattlib_profile_context* context, enum gattlib_profile_phase phase) {
+	context->phase = phase;
+
+	// The extra step prevents the phase to complete before all its steps have been issued
+	g_atomic_int_set(&context->pending_steps, 1);
+
+	for (size_t i = 0; i < context->steps_count; i++) {
+		bool is_write = (context->steps[i].type == GATTLIB_PROFILE_STEP_WRITE);
+
+		if (is_write == (phase == PROFILE_PHASE_WRITE)) {
+			g_atomic_int_inc(&context->pending_steps);
+			_profile_step_start(context, i);
+		}
+	}
+
+	_profile_step_done(context);
+}
+
+static void _on_profile_connected(gattlib_adapter_t* adapter, const char *dst, gattlib_connection_t* connection, int error, void* user_data) {
+	struct gattlib_profile_context* context = user_data;
+	uuid_t* uuids;
+
+	context->connected_timestamp_ns = gattlib_get_monotonic_time_ns();
+
+	if (error != GATTLIB_SUCCESS) {
+		_profile_report(context, error);
+		_profile_context_free(context);
+		return;
+	}
+
+	// Keep the connection until the application has been notified
+	g_rec_mutex_lock(&m_gattlib_mutex);
+	context->connection = connection;
+	gattlib_device_ref(connection->device);
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	// The handlers must be in place before the first notification can be triggered
+	if (context->notification_handler != NULL) {
+		gattlib_register_notification(connection, context->notification_handler, context->handler_user_data);
+	}
+	if (context->indication_handler != NULL) {
+		gattlib_register_indication(connection, context->indication_handler, context->handler_user_data);
+	}
+
+	// Resolve the characteristics of all the steps with a single walk of the D-Bus objects of the device
+	uuids = calloc(sizeof(uuid_t), context->steps_count + 1);
+	if (uuids == NULL) {
+		// The steps fail with GATTLIB_NOT_FOUND
+		GATTLIB_LOG(GATTLIB_ERROR, "gattlib_connect_with_profile: Failed to allocate the UUIDs");
+	} else {
+		for (size_t i = 0; i < context->steps_count; i++) {
+			memcpy(&uuids[i], &context->steps[i].uuid, sizeof(uuid_t));
+		}
+		get_characteristics_from_uuids(connection, uuids, context->steps_count, context->characteristics);
+		free(uuids);
+	}
+
+	_profile_run_phase(context, PROFILE_PHASE_SUBSCRIBE_AND_READ);
+}
+
+int gattlib_connect_with_profile(gattlib_adapter_t* adapter, const char *dst, unsigned long options,
+		const gattlib_profile_t* profile, gattlib_profile_ready_cb_t ready_cb, void* user_data)
+{
+	struct gattlib_profile_context* context;
+
+	if ((dst == NULL) || (profile == NULL) || ((profile->steps == NULL) && (profile->steps_count > 0)) || (ready_cb == NULL)) {
+		return GATTLIB_INVALID_PARAMETER;
+	}
+
+	// Resolve the default adapter here to report it to 'ready_cb'
+	if (adapter == NULL) {
+		adapter = init_default_adapter();
+		if (adapter == NULL) {
+			GATTLIB_LOG(GATTLIB_DEBUG, "gattlib_connect_with_profile: No default adapter");
+			return GATTLIB_NOT_FOUND;
+		}
+	}
+
+	context = calloc(sizeof(struct gattlib_profile_context), 1);
+	if (context == NULL) {
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	context->adapter = adapter;
+	context->dst = strdup(dst);
+	context->steps_count = profile->steps_count;
+	context->ready_cb = ready_cb;
+	context->user_data = user_data;
+	context->notification_handler = profile->notification_handler;
+	context->indication_handler = profile->indication_handler;
+	context->handler_user_data = profile->handler_user_data;
+	context->start_timestamp_ns = gattlib_get_monotonic_time_ns();
+
+	// calloc() of a zero-sized array might return NULL. Always allocate at least one element.
+	context->steps = calloc(sizeof(gattlib_profile_step_t), profile->steps_count + 1);
+	context->results = calloc(sizeof(gattlib_profile_step_result_t), profile->steps_count + 1);
+	context->step_contexts = calloc(sizeof(struct gattlib_profile_step_context), profile->steps_count + 1);
+	context->characteristics = calloc(sizeof(struct dbus_characteristic), profile->steps_count + 1);
+	if ((context->dst == NULL) || (context->steps == NULL) || (context->results == NULL) || (context->step_contexts == NULL) ||
+	    (context->characteristics == NULL)) {
+		_profile_context_free(context);
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	// Copy the profile. The application does not need to keep it during the connection.
+	for (size_t i = 0; i < profile->steps_count; i++) {
+		context->steps[i].type = profile->steps[i].type;
+		memcpy(&context->steps[i].uuid, &profile->steps[i].uuid, sizeof(uuid_t));
+		context->step_contexts[i].profile = context;
+		context->step_contexts[i].index = i;
+
+		if ((profile->steps[i].type == GATTLIB_PROFILE_STEP_WRITE) && (profile->steps[i].data_length > 0)) {
+			void* data = malloc(profile->steps[i].data_length);
+			if (data == NULL) {
+				_profile_context_free(context);
+				return GATTLIB_OUT_OF_MEMORY;
+			}
+			memcpy(data, profile->steps[i].data, profile->steps[i].data_length);
+			context->steps[i].data = data;
+			context->steps[i].data_length = profile->steps[i].data_length;
+		}
+	}
+
+	// Note: On error, gattlib_connect() does not call '_on_profile_connected()'. The context is still ours.
+	int ret = gattlib_connect(adapter, dst, options, _on_profile_connected, context);
+	if (ret != GATTLIB_SUCCESS) {
+		_profile_context_free(context);
+	}
+	return ret;
+}
@@ -5,6 +5,8 @@
  */
 
 #include <errno.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
 
 #include <gio/gunixfdlist.h>
 
@@ -29,6 +31,17 @@ int gattlib_write_char_stream_close(gattlib_stream_t *stream)
 
 #else
 
+// A stream write keeps its bulk slot until bluetoothd has read the packet from the socket.
+// It gives up waiting after GATTLIB_STREAM_DRAIN_TIMEOUT_US.
+#define GATTLIB_STREAM_DRAIN_POLL_US		500
+#define GATTLIB_STREAM_DRAIN_TIMEOUT_US		100000
+
+struct _gattlib_stream_t {
+	// The stream holds a reference on the device of the connection
+	gattlib_connection_t* connection;
+	int fd;
+};
+
 int gattlib_write_char_by_uuid_stream_open(gattlib_connection_t* connection, uuid_t* uuid, gattlib_stream_t **stream, uint16_t *mtu)
 {
 	GError *error = NULL;
@@ -72,17 +85,60 @@ int gattlib_write_char_by_uuid_stream_open(gattlib_connection_t* connection, uui
 		return ret;
 	}
 
-	// We abuse the pointer 'stream' to pass the 'File Descriptor'
-	*stream = (gattlib_stream_t*)(unsigned long)fd;
+	*stream = calloc(sizeof(gattlib_stream_t), 1);
+	if (*stream == NULL) {
+		close(fd);
+		return GATTLIB_OUT_OF_MEMORY;
+	}
+
+	g_rec_mutex_lock(&m_gattlib_mutex);
+	if (!gattlib_connection_is_valid(connection)) {
+		g_rec_mutex_unlock(&m_gattlib_mutex);
+		close(fd);
+		free(*stream);
+		*stream = NULL;
+		return GATTLIB_INVALID_PARAMETER;
+	}
+	gattlib_device_ref(connection->device);
+	g_rec_mutex_unlock(&m_gattlib_mutex);
+
+	(*stream)->connection = connection;
+	(*stream)->fd = fd;
 
 	return GATTLIB_SUCCESS;
 }
 
+static void _stream_wait_drained(gattlib_stream_t *stream) {
+	gint64 end_time = g_get_monotonic_time() + GATTLIB_STREAM_DRAIN_TIMEOUT_US;
+	int queued;
+
+	while ((ioctl(stream->fd, SIOCOUTQ, &queued) == 0) && (queued > 0)) {
+		if (g_get_monotonic_time() >= end_time) {
+			GATTLIB_LOG(GATTLIB_DEBUG, "Stream socket has not been drained (%d bytes left)", queued);
+			break;
+		}
+		g_usleep(GATTLIB_STREAM_DRAIN_POLL_US);
+	}
+}
+
 int gattlib_write_char_stream_write(gattlib_stream_t *stream, const void *buffer, size_t buffer_len)
 {
-	ssize_t ret = write((unsigned long)stream, buffer, buffer_len);
+	ssize_t ret;
+	int write_errno;
+
+	// Stream writes are bulk traffic. Latency-critical operations of the connection start before the waiting ones.
+	// The slot is held until bluetoothd has taken the packet so the number of bulk packets queued in the socket
+	// stays bounded and a high priority operation is not submitted behind all of them.
+	gattlib_op_scheduler_acquire(stream->connection, GATTLIB_PRIORITY_BULK);
+	ret = write(stream->fd, buffer, buffer_len);
+	write_errno = errno;
+	if (ret >= 0) {
+		_stream_wait_drained(stream);
+	}
+	gattlib_op_scheduler_release(stream->connection, GATTLIB_PRIORITY_BULK);
+
 	if (ret < 0) {
-		return GATTLIB_ERROR_UNIX_WITH_ERROR(errno);
+		return GATTLIB_ERROR_UNIX_WITH_ERROR(write_errno);
 	} else {
 		return GATTLIB_SUCCESS;
 	}
@@ -90,7 +146,9 @@ int gattlib_write_char_stream_write(gattlib_stream_t *stream, const void *buffer
 
 int gattlib_write_char_stream_close(gattlib_stream_t *stream)
 {
-	close((unsigned long)stream);
+	close(stream->fd);
+	gattlib_device_unref(stream->connection->device);
+	free(stream);
 	return GATTLIB_SUCCESS;
 }
 
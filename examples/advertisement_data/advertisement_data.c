@@ -35,20 +35,11 @@
 
 static const char* adapter_name;
 
-static void ble_advertising_device(gattlib_adapter_t* adapter, const char* addr, const char* name, void *user_data) {
-	gattlib_advertisement_data_t *advertisement_data;
-	size_t advertisement_data_count;
-	gattlib_manufacturer_data_t* manufacturer_data = NULL;
-	size_t manufacturer_data_count = 0;
-	int ret;
-
-	ret = gattlib_get_advertisement_data_from_mac(adapter, addr,
-			&advertisement_data, &advertisement_data_count,
-			&manufacturer_data, &manufacturer_data_count);
-	if (ret != 0) {
-		return;
-	}
-
+static void ble_advertising_device(gattlib_adapter_t* adapter, const char* addr, const char* name,
+		gattlib_advertisement_data_t *advertisement_data, size_t advertisement_data_count,
+		gattlib_manufacturer_data_t* manufacturer_data, size_t manufacturer_data_count,
+		void *user_data)
+{
 	if (name) {
 		printf("Device %s - '%s': ", addr, name);
 	} else {
@@ -65,6 +56,12 @@ static void ble_advertising_device(gattlib_adapter_t* adapter, const char* addr,
 }
 
 static void* ble_task(void *arg) {
+	// Report a device again when its advertising data has changed, at most once per second
+	const gattlib_scan_throttle_t throttle = {
+		.min_report_interval_ms = 1000,
+		.rssi_delta_threshold = 0,
+		.report_payload_change = true,
+	};
 	gattlib_adapter_t* adapter;
 	int ret;
 
@@ -74,7 +71,9 @@ static void* ble_task(void *arg) {
 		return NULL;
 	}
 
-	ret = gattlib_adapter_scan_enable_with_filter(adapter,
+	gattlib_adapter_set_scan_throttle(adapter, &throttle);
+
+	ret = gattlib_adapter_scan_enable_with_data(adapter,
 			NULL, /* Do not filter on any specific Service UUID */
 			0 /* RSSI Threshold */,
 			GATTLIB_DISCOVER_FILTER_NOTIFY_CHANGE, /* Notify change of advertising data/RSSI */
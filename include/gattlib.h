@@ -101,8 +101,8 @@ extern "C" {
 #define GATTLIB_CONNECTION_OPTIONS_LEGACY_PSM(value)        (((value) & 0x3FF) << 11) //< We encode PSM on 10 bits (up to 1023)
 #define GATTLIB_CONNECTION_OPTIONS_LEGACY_MTU(value)        (((value) & 0x3FF) << 21) //< We encode MTU on 10 bits (up to 1023)
 
-#define GATTLIB_CONNECTION_OPTIONS_LEGACY_GET_PSM(options)  (((options) >> 11) && 0x3FF)
-#define GATTLIB_CONNECTION_OPTIONS_LEGACY_GET_MTU(options)  (((options) >> 21) && 0x3FF)
+#define GATTLIB_CONNECTION_OPTIONS_LEGACY_GET_PSM(options)  (((options) >> 11) & 0x3FF)
+#define GATTLIB_CONNECTION_OPTIONS_LEGACY_GET_MTU(options)  (((options) >> 21) & 0x3FF)
 
 #define GATTLIB_CONNECTION_OPTIONS_LEGACY_DEFAULT \
 		GATTLIB_CONNECTION_OPTIONS_LEGACY_BDADDR_LE_PUBLIC | \
@@ -154,6 +154,8 @@ extern "C" {
 typedef struct _gattlib_adapter gattlib_adapter_t;
 typedef struct _gattlib_connection gattlib_connection_t;
 typedef struct _gattlib_stream_t gattlib_stream_t;
+typedef struct _gattlib_write_transaction gattlib_write_transaction_t;
+typedef struct _gattlib_fleet gattlib_fleet_t;
 
 /**
  * Structure to represent a GATT Service and its data in the BLE advertisement packet
@@ -173,8 +175,72 @@ typedef struct {
 	size_t data_size;
 } gattlib_manufacturer_data_t;
 
+/**
+ * Structure to represent a GATT notification/indication retrieved with `gattlib_notification_poll()`
+ */
+typedef struct {
+	uuid_t   uuid;         /**< UUID of the GATT characteristic that has notified */
+	uint8_t* data;         /**< Payload of the notification. Freed by `gattlib_notification_records_free()` */
+	size_t   data_length;  /**< Length of the payload */
+	uint64_t timestamp_ns; /**< Monotonic time (CLOCK_MONOTONIC) in nanoseconds when gattlib received the notification */
+} gattlib_notification_record_t;
+
+/**
+ * Number of buckets of `gattlib_latency_histogram_t`
+ */
+#define GATTLIB_LATENCY_HISTOGRAM_BUCKETS 32
+
+/**
+ * Structure to represent a latency histogram
+ *
+ * The bucket `i` counts the latencies in the range [2^i, 2^(i+1)) microseconds.
+ * The first bucket also counts the latencies below 1 microsecond.
+ */
+typedef struct {
+	uint64_t count;                                       /**< Number of samples */
+	uint64_t sum_ns;                                      /**< Sum of all the latencies in nanoseconds */
+	uint64_t min_ns;                                      /**< Minimum latency in nanoseconds */
+	uint64_t max_ns;                                      /**< Maximum latency in nanoseconds */
+	uint64_t buckets[GATTLIB_LATENCY_HISTOGRAM_BUCKETS];  /**< Number of samples per bucket */
+} gattlib_latency_histogram_t;
+
+/**
+ * Priority classes of the GATT operations of a connection
+ *
+ * A waiting operation of a higher priority class is started before all the waiting operations of the
+ * lower priority classes. Operations of a same class are started in their submission order.
+ *
+ * The classes only order the operations that have not been submitted to BlueZ yet. Several operations
+ * of a connection might be in flight at the same time, and an operation already submitted is not
+ * overtaken. At most two bulk operations of a connection are in flight, and none is submitted while a
+ * high priority operation is in flight. A stream write stays in flight until BlueZ has taken the packet
+ * from the stream socket, so a high priority operation is not queued behind a backlog of stream packets.
+ */
+typedef enum {
+	GATTLIB_PRIORITY_HIGH,      /**< Latency-critical operations (eg: control commands) */
+	GATTLIB_PRIORITY_NORMAL,    /**< Default class of the reads and writes with response */
+	GATTLIB_PRIORITY_BULK,      /**< Default class of the writes without response and stream writes */
+} gattlib_priority_t;
+
+/**
+ * Number of priority classes of `gattlib_priority_t`
+ */
+#define GATTLIB_PRIORITY_CLASSES 3
+
 typedef void (*gattlib_event_handler_t)(const uuid_t* uuid, const uint8_t* data, size_t data_length, void* user_data);
 
+/**
+ * @brief Handler called on GATT notification/indication with the time gattlib has received it
+ *
+ * @param uuid is the UUID of the GATT characteristic that has notified
+ * @param data is the payload of the notification
+ * @param data_length is the length of the payload
+ * @param timestamp_ns is the monotonic time (CLOCK_MONOTONIC) in nanoseconds when the notification entered gattlib
+ * @param user_data  Data defined when registering the handler
+ */
+typedef void (*gattlib_event_with_timestamp_handler_t)(const uuid_t* uuid, const uint8_t* data, size_t data_length,
+		uint64_t timestamp_ns, void* user_data);
+
 /**
  * @brief Handler called on disconnection
  *
@@ -183,6 +249,15 @@ typedef void (*gattlib_event_handler_t)(const uuid_t* uuid, const uint8_t* data,
  */
 typedef void (*gattlib_disconnection_handler_t)(gattlib_connection_t* connection, void* user_data);
 
+/**
+ * @brief Handler called when the disconnection requested by `gattlib_disconnect_async()` has completed
+ *
+ * @param connection Connection that has been disconnected. It must not be used for GATT operations anymore.
+ * @param error      GATTLIB_SUCCESS on success or GATTLIB_* error code
+ * @param user_data  Data defined when calling `gattlib_disconnect_async()`
+ */
+typedef void (*gattlib_disconnect_cb_t)(gattlib_connection_t* connection, int error, void* user_data);
+
 /**
  * @brief Handler called on new discovered BLE device
  *
@@ -193,6 +268,18 @@ typedef void (*gattlib_disconnection_handler_t)(gattlib_connection_t* connection
  */
 typedef void (*gattlib_discovered_device_t)(gattlib_adapter_t* adapter, const char* addr, const char* name, void *user_data);
 
+/**
+ * @brief Handler called on new discovered BLE device with the time gattlib has received the advertisement
+ *
+ * @param adapter is the adapter that has found the BLE device
+ * @param addr is the MAC address of the BLE device
+ * @param name is the name of BLE device if advertised
+ * @param timestamp_ns is the monotonic time (CLOCK_MONOTONIC) in nanoseconds when the event entered gattlib
+ * @param user_data  Data defined when calling `gattlib_adapter_scan_enable_with_timestamp()`
+ */
+typedef void (*gattlib_discovered_device_with_timestamp_t)(gattlib_adapter_t* adapter, const char* addr, const char* name,
+		uint64_t timestamp_ns, void *user_data);
+
 /**
  * @brief Handler called on new discovered BLE device
  *
@@ -210,6 +297,132 @@ typedef void (*gattlib_discovered_device_with_data_t)(gattlib_adapter_t* adapter
 		gattlib_manufacturer_data_t* manufacturer_data, size_t manufacturer_data_count,
 		void *user_data);
 
+/**
+ * @name Properties of an advertising report
+ */
+//@{
+#define GATTLIB_ADVERTISING_REPORT_CONNECTABLE              (1 << 0)
+#define GATTLIB_ADVERTISING_REPORT_SCANNABLE                (1 << 1)
+#define GATTLIB_ADVERTISING_REPORT_DIRECTED                 (1 << 2)
+#define GATTLIB_ADVERTISING_REPORT_SCAN_RESPONSE            (1 << 3)
+#define GATTLIB_ADVERTISING_REPORT_LEGACY                   (1 << 4)
+#define GATTLIB_ADVERTISING_REPORT_TRUNCATED                (1 << 5)
+//@}
+
+/**
+ * Value of `gattlib_advertising_report_t.rssi` when the RSSI is not available
+ */
+#define GATTLIB_ADVERTISING_REPORT_RSSI_UNKNOWN             127
+
+/**
+ * Value of `gattlib_advertising_report_t.tx_power` when the TX power is unknown
+ */
+#define GATTLIB_ADVERTISING_REPORT_TX_POWER_UNKNOWN         127
+
+/**
+ * Structure to represent an AD structure of an advertising report
+ */
+typedef struct {
+	uint8_t        type;         /**< AD type (eg: 0x09 for the complete local name) */
+	uint8_t        data_length;  /**< Length of the AD data */
+	const uint8_t* data;         /**< AD data */
+} gattlib_ad_structure_t;
+
+/**
+ * Structure to represent an advertising report received from the controller
+ *
+ * The report and the data it points to are only valid during the call of the report handler.
+ */
+typedef struct {
+	uint8_t  address[6];                    /**< Address of the advertiser in HCI order (least significant byte first) */
+	uint8_t  address_type;                  /**< HCI address type (0x00: public, 0x01: random, ...) */
+	uint16_t properties;                    /**< `GATTLIB_ADVERTISING_REPORT_*` properties */
+	int8_t   rssi;                          /**< RSSI in dBm or `GATTLIB_ADVERTISING_REPORT_RSSI_UNKNOWN` */
+	int8_t   tx_power;                      /**< TX power in dBm or `GATTLIB_ADVERTISING_REPORT_TX_POWER_UNKNOWN` */
+	uint8_t  primary_phy;                   /**< Primary PHY. 0 for legacy reports */
+	uint8_t  secondary_phy;                 /**< Secondary PHY. 0 if none */
+	uint8_t  sid;                           /**< Advertising set identifier. 0xFF if none */
+	const uint8_t* data;                    /**< Raw AD data */
+	size_t   data_length;                   /**< Length of the raw AD data */
+	const gattlib_ad_structure_t* ad;       /**< AD structures decoded from the raw AD data */
+	size_t   ad_count;                      /**< Number of AD structures */
+} gattlib_advertising_report_t;
+
+/**
+ * @brief Handler called for each advertising report
+ *
+ * @param adapter is the adapter that has received the report (NULL when parsing recorded events)
+ * @param report is the advertising report. It is only valid during the call.
+ * @param user_data is the data passed with the handler
+ */
+typedef void (*gattlib_advertising_report_cb_t)(gattlib_adapter_t* adapter, const gattlib_advertising_report_t* report,
+		void *user_data);
+
+typedef struct _gattlib_advertising_parser gattlib_advertising_parser_t;
+
+/**
+ * Maximum number of rules of an advertising filter
+ */
+#define GATTLIB_ADVERTISING_FILTER_MAX_RULES                64
+
+/**
+ * Types of the rules of an advertising filter
+ */
+typedef enum {
+	GATTLIB_ADVERTISING_RULE_MANUFACTURER_ID,    /**< Manufacturer specific data with the given company identifier */
+	GATTLIB_ADVERTISING_RULE_SERVICE_DATA_UUID,  /**< Service data of the given service UUID (16, 32 or 128-bit form) */
+	GATTLIB_ADVERTISING_RULE_AD_PREFIX,          /**< Data of an AD type starting with a masked byte prefix */
+	GATTLIB_ADVERTISING_RULE_ADDRESS_RANGE,      /**< Address within an inclusive range */
+	GATTLIB_ADVERTISING_RULE_RSSI,               /**< RSSI greater than or equal to a threshold */
+	GATTLIB_ADVERTISING_RULE_NAME_PREFIX,        /**< Shortened or complete local name starting with a prefix */
+} gattlib_advertising_rule_type_t;
+
+/**
+ * Structure to represent a rule of an advertising filter
+ *
+ * The rules sharing the same group must all match. An advertisement matches the filter when all the rules of
+ * any of its groups match.
+ *
+ * The addresses are packed in 48-bit integers: the address 'AA:BB:CC:DD:EE:FF' is 0xAABBCCDDEEFF.
+ */
+typedef struct {
+	gattlib_advertising_rule_type_t type;
+	unsigned int group;                           /**< Group of the rule */
+	union {
+		uint16_t manufacturer_id;                 /**< GATTLIB_ADVERTISING_RULE_MANUFACTURER_ID */
+		uuid_t   service_data_uuid;               /**< GATTLIB_ADVERTISING_RULE_SERVICE_DATA_UUID */
+		struct {
+			uint8_t        ad_type;               /**< AD type (eg: 0xFF for the manufacturer specific data) */
+			const uint8_t* value;                 /**< Expected prefix of the AD data */
+			const uint8_t* mask;                  /**< Bits of the prefix to compare. NULL to compare all the bits */
+			size_t         length;                /**< Length of the prefix and of the mask */
+		} ad_prefix;                              /**< GATTLIB_ADVERTISING_RULE_AD_PREFIX */
+		struct {
+			uint64_t first;                       /**< First address of the range */
+			uint64_t last;                        /**< Last address of the range */
+		} address_range;                          /**< GATTLIB_ADVERTISING_RULE_ADDRESS_RANGE */
+		int16_t  rssi_threshold;                  /**< GATTLIB_ADVERTISING_RULE_RSSI */
+		const char* name_prefix;                  /**< GATTLIB_ADVERTISING_RULE_NAME_PREFIX */
+	} rule;
+} gattlib_advertising_rule_t;
+
+typedef struct _gattlib_advertising_filter gattlib_advertising_filter_t;
+
+typedef struct _gattlib_address_set gattlib_address_set_t;
+
+/**
+ * Throttling of the devices reported again by a scan
+ *
+ * A device already reported is reported again when it has changed (RSSI or payload) and at least
+ * `min_report_interval_ms` have elapsed since its last report. Without any change criteria, the devices
+ * are reported at most every `min_report_interval_ms`.
+ */
+typedef struct {
+	uint32_t min_report_interval_ms; /**< Minimum interval between two reports of the same device. 0 for no minimum. */
+	uint16_t rssi_delta_threshold;   /**< Report a device whose RSSI has changed by at least this value. 0 to ignore the RSSI. */
+	bool     report_payload_change;  /**< Report a device whose advertising data (or scan response data) has changed */
+} gattlib_scan_throttle_t;
+
 /**
  * @brief Handler called on asynchronous connection when connection is ready or on connection error
  *
@@ -221,6 +434,29 @@ typedef void (*gattlib_discovered_device_with_data_t)(gattlib_adapter_t* adapter
  */
 typedef void (*gatt_connect_cb_t)(gattlib_adapter_t* adapter, const char *dst, gattlib_connection_t* connection, int error, void* user_data);
 
+/**
+ * Structure reporting how a connection request of the connection scheduler has been served
+ */
+typedef struct {
+	unsigned int attempts;          /**< Number of connection attempts */
+	uint64_t queueing_latency_ns;   /**< Time between the request being queued and its first attempt */
+	uint64_t connect_latency_ns;    /**< Duration of the last connection attempt */
+	uint64_t total_latency_ns;      /**< Time between the request being queued and its completion */
+} gattlib_connect_report_t;
+
+/**
+ * @brief Handler called when a connection request of the connection scheduler has completed
+ *
+ * @param adapter    Adapter the request has been queued on
+ * @param dst        Remote Bluetooth address
+ * @param connection Connection on success, NULL on error
+ * @param error      GATTLIB_SUCCESS on success or GATTLIB_* error code of the last attempt
+ * @param report     Number of attempts and latencies of the request
+ * @param user_data  Data defined when calling `gattlib_adapter_connect_enqueue()`
+ */
+typedef void (*gattlib_scheduled_connect_cb_t)(gattlib_adapter_t* adapter, const char *dst, gattlib_connection_t* connection, int error,
+		const gattlib_connect_report_t* report, void* user_data);
+
 /**
  * @brief Callback called when GATT characteristic read value has been received
  *
@@ -313,6 +549,51 @@ int gattlib_adapter_scan_enable_with_filter(gattlib_adapter_t* adapter, uuid_t *
 int gattlib_adapter_scan_enable_with_filter_non_blocking(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
 		gattlib_discovered_device_t discovered_device_cb, size_t timeout, void *user_data);
 
+/**
+ * @brief Enable Bluetooth scanning on a given adapter and timestamp the discovered devices (non-blocking)
+ *
+ * This function will return as soon as the BLE scan has been started.
+ *
+ * @param adapter is the context of the newly opened adapter
+ * @param uuid_list is a NULL-terminated list of UUIDs to filter. The rule only applies to advertised UUID.
+ *        Returned devices would match any of the UUIDs of the list.
+ * @param rssi_threshold is the imposed RSSI threshold for the returned devices.
+ * @param enabled_filters defines the parameters to use for filtering. There are selected by using the macros
+ *        GATTLIB_DISCOVER_FILTER_USE_UUID and GATTLIB_DISCOVER_FILTER_USE_RSSI.
+ * @param discovered_device_cb is the function callback called for each new Bluetooth device discovered
+ * @param timeout defines the duration of the Bluetooth scanning. When timeout=0, we scan indefinitely.
+ * @param user_data is the data passed to the callback `discovered_device_cb()`
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_adapter_scan_enable_with_timestamp(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
+		gattlib_discovered_device_with_timestamp_t discovered_device_cb, size_t timeout, void *user_data);
+
+/**
+ * @brief Enable Bluetooth scanning on a given adapter and pass the advertisement data of the discovered devices
+ *
+ * The advertisement data are parsed from the event that has notified the device. It does not require
+ * to call `gattlib_get_advertisement_data_from_mac()` for each discovered device.
+ *
+ * This function will block until either the timeout has expired or gattlib_adapter_scan_disable() has been called.
+ *
+ * @note The advertisement data and the manufacturer data passed to the callback are only valid during the callback.
+ *
+ * @param adapter is the context of the newly opened adapter
+ * @param uuid_list is a NULL-terminated list of UUIDs to filter. The rule only applies to advertised UUID.
+ *        Returned devices would match any of the UUIDs of the list.
+ * @param rssi_threshold is the imposed RSSI threshold for the returned devices.
+ * @param enabled_filters defines the parameters to use for filtering. There are selected by using the macros
+ *        GATTLIB_DISCOVER_FILTER_USE_UUID and GATTLIB_DISCOVER_FILTER_USE_RSSI.
+ * @param discovered_device_cb is the function callback called for each new Bluetooth device discovered
+ * @param timeout defines the duration of the Bluetooth scanning. When timeout=0, we scan indefinitely.
+ * @param user_data is the data passed to the callback `discovered_device_cb()`
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_adapter_scan_enable_with_data(gattlib_adapter_t* adapter, uuid_t **uuid_list, int16_t rssi_threshold, uint32_t enabled_filters,
+		gattlib_discovered_device_with_data_t discovered_device_cb, size_t timeout, void *user_data);
+
 /**
  * @brief Enable Eddystone Bluetooth Device scanning on a given adapter
  *
@@ -332,6 +613,281 @@ int gattlib_adapter_scan_enable_with_filter_non_blocking(gattlib_adapter_t* adap
 int gattlib_adapter_scan_eddystone(gattlib_adapter_t* adapter, int16_t rssi_threshold, uint32_t eddystone_types,
 		gattlib_discovered_device_with_data_t discovered_device_cb, size_t timeout, void *user_data);
 
+/**
+ * @brief Enable Bluetooth scanning on a given adapter and report every raw advertising report
+ *
+ * Every report of the legacy, directed and extended advertising report events is passed to the handler
+ * with its AD structures. The handler is called from the scanning thread.
+ *
+ * This function will block until the timeout has expired.
+ *
+ * @note This function is only supported by the legacy (non D-Bus) backend.
+ *
+ * @param adapter is the context of the newly opened adapter
+ * @param report_cb is the function callback called for each advertising report
+ * @param timeout defines the duration of the Bluetooth scanning. When timeout=0, we scan indefinitely.
+ * @param user_data is the data passed to the callback `report_cb()`
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_adapter_scan_enable_with_reports(gattlib_adapter_t* adapter, gattlib_advertising_report_cb_t report_cb,
+		size_t timeout, void *user_data);
+
+/**
+ * @brief Create a parser of HCI advertising report events
+ *
+ * The parser keeps the memory used to decode the events between two events and reassembles the
+ * fragmented extended advertising data.
+ *
+ * @param parser is the newly created parser
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_advertising_parser_new(gattlib_advertising_parser_t** parser);
+
+/**
+ * @brief Free a parser created by `gattlib_advertising_parser_new()`
+ *
+ * @param parser is the parser to free
+ */
+void gattlib_advertising_parser_free(gattlib_advertising_parser_t* parser);
+
+/**
+ * @brief Parse an HCI event and call the handler for each advertising report it contains
+ *
+ * Events other than the LE Advertising Report, LE Directed Advertising Report and LE Extended Advertising Report
+ * events are ignored.
+ *
+ * @param parser is the parser created by `gattlib_advertising_parser_new()`
+ * @param adapter is the adapter passed to the handler
+ * @param event is the HCI event starting with its event code (ie: without the HCI packet type)
+ * @param event_length is the length of the HCI event
+ * @param report_cb is the function callback called for each advertising report
+ * @param user_data is the data passed to the callback `report_cb()`
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code. GATTLIB_INVALID_PARAMETER if the event is malformed.
+ */
+int gattlib_advertising_parser_parse_hci_event(gattlib_advertising_parser_t* parser, gattlib_adapter_t* adapter,
+		const uint8_t* event, size_t event_length, gattlib_advertising_report_cb_t report_cb, void *user_data);
+
+/**
+ * @brief Set the advertising filter of a parser
+ *
+ * The reports that do not match the filter are dropped before their AD structures are decoded.
+ *
+ * @param parser is the parser created by `gattlib_advertising_parser_new()`
+ * @param filter is the filter to apply. NULL to remove the filter. The parser keeps a reference on the filter.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_advertising_parser_set_filter(gattlib_advertising_parser_t* parser, gattlib_advertising_filter_t* filter);
+
+/**
+ * @brief Set the address allowlist and denylist of a parser
+ *
+ * The reports whose address is in the denylist or, when there is an allowlist, is not in the allowlist
+ * are dropped before the advertising filter is applied.
+ *
+ * @param parser is the parser created by `gattlib_advertising_parser_new()`
+ * @param allowlist is the set of the addresses to report. NULL to report all the addresses.
+ * @param denylist is the set of the addresses to drop. NULL to drop none.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_advertising_parser_set_address_lists(gattlib_advertising_parser_t* parser,
+		gattlib_address_set_t* allowlist, gattlib_address_set_t* denylist);
+
+/**
+ * @brief Compile advertising rules into a filter
+ *
+ * The rules are compiled once into a matcher that walks the raw advertising data a single time.
+ * The filter can be shared by several adapters and parsers.
+ *
+ * @param rules is the array of rules
+ * @param rule_count is the number of rules (from 1 to `GATTLIB_ADVERTISING_FILTER_MAX_RULES`)
+ * @param filter is the compiled filter. It must be released with `gattlib_advertising_filter_unref()`
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_advertising_filter_compile(const gattlib_advertising_rule_t* rules, size_t rule_count,
+		gattlib_advertising_filter_t** filter);
+
+/**
+ * @brief Take a reference on an advertising filter
+ *
+ * @param filter is the compiled filter
+ *
+ * @return The filter
+ */
+gattlib_advertising_filter_t* gattlib_advertising_filter_ref(gattlib_advertising_filter_t* filter);
+
+/**
+ * @brief Release a reference on an advertising filter. The filter is freed with its last reference.
+ *
+ * @param filter is the compiled filter
+ */
+void gattlib_advertising_filter_unref(gattlib_advertising_filter_t* filter);
+
+/**
+ * @brief Check whether an advertisement matches a filter
+ *
+ * @param filter is the compiled filter
+ * @param address is the address of the advertiser packed in a 48-bit integer
+ * @param rssi is the RSSI of the advertisement. GATTLIB_ADVERTISING_REPORT_RSSI_UNKNOWN if unknown.
+ * @param data is the raw advertising data
+ * @param data_length is the length of the raw advertising data
+ *
+ * @return true if the advertisement matches the filter
+ */
+bool gattlib_advertising_filter_match(const gattlib_advertising_filter_t* filter, uint64_t address, int16_t rssi,
+		const uint8_t* data, size_t data_length);
+
+/**
+ * @brief Filter the devices discovered by an adapter
+ *
+ * The filter is applied by the library to every advertisement before the device is registered and before
+ * any callback is dispatched. It can be changed while scanning.
+ *
+ * @param adapter is the context of the newly opened adapter
+ * @param filter is the filter to apply. NULL to remove the filter. The adapter keeps a reference on the filter.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_adapter_set_advertising_filter(gattlib_adapter_t* adapter, gattlib_advertising_filter_t* filter);
+
+/**
+ * @brief Create an empty set of Bluetooth addresses
+ *
+ * The set is a hash set of the packed 48-bit addresses with a Bloom filter in front of it. It is designed
+ * for scans looking for a large number of known devices (eg: asset tracking tags) among many others.
+ * A set can be updated at any time, including while it is used by a scan.
+ *
+ * @param set is the new set. It must be released with `gattlib_address_set_unref()`
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_address_set_new(gattlib_address_set_t** set);
+
+/**
+ * @brief Take a reference on a set of addresses
+ *
+ * @param set is the set of addresses
+ *
+ * @return The set
+ */
+gattlib_address_set_t* gattlib_address_set_ref(gattlib_address_set_t* set);
+
+/**
+ * @brief Release a reference on a set of addresses. The set is freed with its last reference.
+ *
+ * @param set is the set of addresses
+ */
+void gattlib_address_set_unref(gattlib_address_set_t* set);
+
+/**
+ * @brief Add an address to a set
+ *
+ * @param set is the set of addresses
+ * @param address is the address packed in a 48-bit integer (see `gattlib_string_to_address48()`)
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_address_set_add(gattlib_address_set_t* set, uint64_t address);
+
+/**
+ * @brief Add a list of addresses to a set
+ *
+ * The set is grown once for the whole list.
+ *
+ * @param set is the set of addresses
+ * @param addresses is the array of addresses packed in 48-bit integers
+ * @param count is the number of addresses
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code. GATTLIB_INVALID_PARAMETER if the set
+ *         cannot hold that many addresses.
+ */
+int gattlib_address_set_add_list(gattlib_address_set_t* set, const uint64_t* addresses, size_t count);
+
+/**
+ * @brief Remove an address from a set
+ *
+ * @param set is the set of addresses
+ * @param address is the address packed in a 48-bit integer
+ *
+ * @return GATTLIB_SUCCESS on success, GATTLIB_NOT_FOUND if the address is not in the set or GATTLIB_* error code
+ */
+int gattlib_address_set_remove(gattlib_address_set_t* set, uint64_t address);
+
+/**
+ * @brief Remove all the addresses of a set
+ *
+ * @param set is the set of addresses
+ */
+void gattlib_address_set_clear(gattlib_address_set_t* set);
+
+/**
+ * @brief Check whether an address is in a set
+ *
+ * @param set is the set of addresses
+ * @param address is the address packed in a 48-bit integer
+ *
+ * @return true if the address is in the set
+ */
+bool gattlib_address_set_contains(gattlib_address_set_t* set, uint64_t address);
+
+/**
+ * @brief Get the number of addresses of a set
+ *
+ * @param set is the set of addresses
+ *
+ * @return The number of addresses
+ */
+size_t gattlib_address_set_size(gattlib_address_set_t* set);
+
+/**
+ * @brief Only report the devices whose address is in the allowlist
+ *
+ * The allowlist is checked by the library before the device is registered and before any callback
+ * is dispatched. The set can be updated while scanning.
+ *
+ * @param adapter is the context of the newly opened adapter
+ * @param allowlist is the set of the addresses to report. NULL to report all the addresses.
+ *        The adapter keeps a reference on the set.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_adapter_set_address_allowlist(gattlib_adapter_t* adapter, gattlib_address_set_t* allowlist);
+
+/**
+ * @brief Never report the devices whose address is in the denylist
+ *
+ * The denylist is checked by the library before the device is registered and before any callback
+ * is dispatched. It takes precedence over the allowlist. The set can be updated while scanning.
+ *
+ * @param adapter is the context of the newly opened adapter
+ * @param denylist is the set of the addresses to drop. NULL to drop none.
+ *        The adapter keeps a reference on the set.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_adapter_set_address_denylist(gattlib_adapter_t* adapter, gattlib_address_set_t* denylist);
+
+/**
+ * @brief Report the changes of the devices already discovered with a throttling
+ *
+ * By default, a device is reported once by a scan. With a throttling, the library keeps a last-seen cache of the
+ * devices and reports a device again on each meaningful change, instead of on each of its advertisements.
+ *
+ * The throttling can be changed while scanning. On the legacy backend, the duplicate filtering of the controller
+ * is disabled by the scans started with a throttling.
+ *
+ * @param adapter is the context of the newly opened adapter
+ * @param throttle is the throttling to apply. NULL to report the devices once.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_adapter_set_scan_throttle(gattlib_adapter_t* adapter, const gattlib_scan_throttle_t* throttle);
+
 /**
  * @brief Disable Bluetooth scanning on a given adapter
  *
@@ -348,25 +904,449 @@ int gattlib_adapter_scan_disable(gattlib_adapter_t* adapter);
  *
  * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
  */
-int gattlib_adapter_close(gattlib_adapter_t* adapter);
+int gattlib_adapter_close(gattlib_adapter_t* adapter);
+
+/**
+ * @brief Function to asynchronously connect to a BLE device
+ *
+ * The function returns as soon as the connection has been requested. Many connections can be in progress
+ * at the same time.
+ *
+ * When the function returns GATTLIB_SUCCESS, the result of the connection is reported once to 'connect_cb'.
+ * When the function returns an error (eg: invalid address, adapter closed), 'connect_cb' is not called.
+ *
+ * @note The notification and disconnection callbacks of the connection might run while 'connect_cb'
+ * is still running (see `gattlib_executor_set_max_threads()`).
+ *
+ * @param adapter	Local Adaptater interface. When passing NULL, we use default adapter.
+ * @param dst		Remote Bluetooth address
+ * @param options	Options to connect to BLE device. See `GATTLIB_CONNECTION_OPTIONS_*`
+ * @param connect_cb is the callback to call when the connection is established
+ * @param user_data is the user specific data to pass to the callback
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_connect(gattlib_adapter_t* adapter, const char *dst,
+		unsigned long options,
+		gatt_connect_cb_t connect_cb,
+		void* user_data);
+
+/**
+ * Default maximum number of connection attempts in flight per adapter
+ */
+#define GATTLIB_CONNECT_SCHEDULER_DEFAULT_MAX_IN_FLIGHT  1
+/**
+ * Default number of retries of a connection request failing with a transient error
+ */
+#define GATTLIB_CONNECT_SCHEDULER_DEFAULT_MAX_RETRIES    3
+/**
+ * Default delay before the first retry. The delay doubles at each retry.
+ */
+#define GATTLIB_CONNECT_SCHEDULER_DEFAULT_BACKOFF_MS     500
+
+/**
+ * @brief Configure the connection scheduler of the adapter
+ *
+ * The scheduler serves the requests queued by `gattlib_adapter_connect_enqueue()`.
+ *
+ * @param adapter          Local Adaptater interface
+ * @param max_in_flight    Maximum number of connection attempts running at the same time on the adapter
+ * @param max_retries      Number of retries of a request failing with a transient error (busy, timeout, BlueZ error).
+ *                         The permanent errors (eg: invalid parameter, device not found, not supported) are not retried.
+ * @param retry_backoff_ms Delay before the first retry. The delay doubles at each retry up to 30 seconds.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_adapter_connect_scheduler_configure(gattlib_adapter_t* adapter, unsigned int max_in_flight,
+		unsigned int max_retries, unsigned int retry_backoff_ms);
+
+/**
+ * @brief Queue a connection request on the connection scheduler of the adapter
+ *
+ * The requests are served by priority order (FIFO within a same priority) with at most `max_in_flight`
+ * connection attempts in progress on the adapter. Transient failures are retried with an exponential backoff.
+ *
+ * @param adapter    Local Adaptater interface
+ * @param dst        Remote Bluetooth address
+ * @param options    Options to connect to BLE device. See `GATTLIB_CONNECTION_OPTIONS_*`
+ * @param priority   Priority of the request. The higher the value the sooner the request is served.
+ * @param timeout_ms Deadline of the request relative to now. 0 means no deadline. A request that has not
+ *                   been connected before its deadline completes with GATTLIB_TIMEOUT. This includes an
+ *                   attempt still in progress at the deadline: its connection slot is released and the
+ *                   device is disconnected if the attempt succeeds later. Whatever the deadline, an attempt
+ *                   lasting more than 30 seconds is abandoned the same way and fails with GATTLIB_TIMEOUT.
+ * @param connect_cb Callback called once when the request has completed
+ * @param user_data  Data passed to the callback
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_adapter_connect_enqueue(gattlib_adapter_t* adapter, const char *dst, unsigned long options,
+		int priority, unsigned int timeout_ms,
+		gattlib_scheduled_connect_cb_t connect_cb, void* user_data);
+
+/**
+ * @brief Get the latency histograms of the connection scheduler of the adapter
+ *
+ * @param adapter            Local Adaptater interface
+ * @param queueing_histogram Filled with the time between the requests being queued and their first attempt. It can be NULL.
+ * @param connect_histogram  Filled with the duration of the connection attempts. It can be NULL.
+ * @param reset              Resets the histograms once they have been copied
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_adapter_connect_scheduler_get_latency(gattlib_adapter_t* adapter,
+		gattlib_latency_histogram_t* queueing_histogram, gattlib_latency_histogram_t* connect_histogram, bool reset);
+
+/**
+ * Type of the steps of a connection profile
+ */
+typedef enum {
+	GATTLIB_PROFILE_STEP_NOTIFY = 0,   /**< Start the notification of the characteristic */
+	GATTLIB_PROFILE_STEP_INDICATE,     /**< Start the indication of the characteristic */
+	GATTLIB_PROFILE_STEP_READ,         /**< Read the initial value of the characteristic */
+	GATTLIB_PROFILE_STEP_WRITE,        /**< Write the initial value of the characteristic */
+} gattlib_profile_step_type_t;
+
+/**
+ * Step of a connection profile
+ */
+typedef struct {
+	gattlib_profile_step_type_t type;
+	uuid_t uuid;                /**< UUID of the GATT characteristic */
+	const void* data;           /**< Value to write. Only used by GATTLIB_PROFILE_STEP_WRITE */
+	size_t data_length;         /**< Length of the value to write */
+} gattlib_profile_step_t;
+
+/**
+ * Connection profile: what must be done on a device once connected to bring it into service
+ */
+typedef struct {
+	const gattlib_profile_step_t* steps;
+	size_t steps_count;
+	gattlib_event_handler_t notification_handler; /**< Handler of the notifications of the connection. It can be NULL. */
+	gattlib_event_handler_t indication_handler;   /**< Handler of the indications of the connection. It can be NULL. */
+	void* handler_user_data;                      /**< Data passed to the notification and indication handlers */
+} gattlib_profile_t;
+
+/**
+ * Result of a step of a connection profile
+ */
+typedef struct {
+	int error;                  /**< GATTLIB_SUCCESS or GATTLIB_* error code of the step */
+	uint8_t* data;              /**< Value read by GATTLIB_PROFILE_STEP_READ. Freed once the callback returns. */
+	size_t data_length;         /**< Length of the value read */
+} gattlib_profile_step_result_t;
+
+/**
+ * Structure reporting how the connection profile has been applied
+ */
+typedef struct {
+	int error;                  /**< Connection error or error of the first failing step */
+	size_t steps_failed;        /**< Number of steps that have failed */
+	uint64_t connect_latency_ns;    /**< Time between the request and the GATT services being resolved */
+	uint64_t time_to_ready_ns;      /**< Time between the request and the completion of all the steps */
+} gattlib_profile_report_t;
+
+/**
+ * @brief Handler called when the connection profile has been applied
+ *
+ * @param adapter    Local Adaptater interface
+ * @param dst        Remote Bluetooth address
+ * @param connection Connection to the device. NULL if the connection has failed.
+ * @param report     Latencies and error of the profile
+ * @param results    Result of each step of the profile, in the order of the profile. NULL if the connection has failed.
+ * @param results_count Number of results
+ * @param user_data  Data defined when calling `gattlib_connect_with_profile()`
+ */
+typedef void (*gattlib_profile_ready_cb_t)(gattlib_adapter_t* adapter, const char *dst, gattlib_connection_t* connection,
+		const gattlib_profile_report_t* report, const gattlib_profile_step_result_t* results, size_t results_count,
+		void* user_data);
+
+/**
+ * @brief Connect to a device and apply a connection profile
+ *
+ * Once the GATT services of the device are resolved, the notification and indication handlers of the
+ * profile are registered (as with `gattlib_register_notification()` and `gattlib_register_indication()`).
+ * The notifications, indications and reads of the profile are then issued concurrently. The writes are
+ * issued once they have completed to ensure no notification triggered by a write is missed.
+ * The notifications received before 'ready_cb' is called are delivered to the handlers.
+ * The profile and its values are copied.
+ *
+ * @param adapter   Local Adaptater interface. When passing NULL, we use default adapter.
+ * @param dst       Remote Bluetooth address
+ * @param options   Options to connect to BLE device. See `GATTLIB_CONNECTION_OPTIONS_*`
+ * @param profile   Steps to apply once connected
+ * @param ready_cb  Callback called once all the steps have completed or the connection has failed
+ * @param user_data Data passed to the callback
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code. On error, 'ready_cb' is not called.
+ */
+int gattlib_connect_with_profile(gattlib_adapter_t* adapter, const char *dst, unsigned long options,
+		const gattlib_profile_t* profile, gattlib_profile_ready_cb_t ready_cb, void* user_data);
+
+/**
+ * @brief Handler called when a periodic job of a fleet has been executed
+ *
+ * @param fleet       Fleet the job belongs to
+ * @param dst         Remote Bluetooth address of the device
+ * @param uuid        UUID of the GATT characteristic read or written by the job
+ * @param error       GATTLIB_SUCCESS on success or GATTLIB_* error code
+ * @param data        Value read by a read job on success. It is only valid during the callback. NULL for a write job.
+ * @param data_length Length of the value
+ * @param user_data   Data defined when adding the job
+ */
+typedef void (*gattlib_fleet_job_cb_t)(gattlib_fleet_t* fleet, const char* dst, const uuid_t* uuid, int error,
+		const uint8_t* data, size_t data_length, void* user_data);
+
+/**
+ * Freshness statistics of a device of a fleet
+ */
+typedef struct {
+	uint64_t jobs_completed;        /**< Number of jobs successfully executed */
+	uint64_t jobs_failed;           /**< Number of jobs that have failed */
+	uint64_t connections;           /**< Number of physical connections */
+	uint64_t connection_failures;   /**< Number of physical connections that have failed */
+	uint64_t last_update_ns;        /**< Monotonic time of the last successful job. 0 if none. */
+	uint64_t max_lateness_ns;       /**< Maximum time between a job being due and being executed */
+} gattlib_fleet_device_stats_t;
+
+/**
+ * Statistics of a fleet
+ */
+typedef struct {
+	uint64_t jobs_completed;        /**< Number of jobs successfully executed */
+	uint64_t jobs_failed;           /**< Number of jobs that have failed */
+	uint64_t connections;           /**< Number of physical connections */
+	uint64_t elapsed_ns;            /**< Time since the fleet has been started */
+} gattlib_fleet_stats_t;
+
+/**
+ * @brief Create a fleet of virtual connections
+ *
+ * A fleet time-slices the physical connections of the adapter across a set of devices larger than the
+ * number of connections supported by the controller. Each physical connection executes all the jobs of
+ * the device that are due (or almost due) before being disconnected to release the connection slot.
+ * The most overdue devices are served first.
+ *
+ * @note The devices must have been discovered by the adapter before they can be connected.
+ *
+ * @param adapter         Local Adaptater interface
+ * @param max_connections Maximum number of devices connected at the same time
+ * @param fleet           Newly created fleet
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_fleet_create(gattlib_adapter_t* adapter, unsigned int max_connections, gattlib_fleet_t** fleet);
+
+/**
+ * @brief Add a device to the fleet
+ *
+ * @param fleet Fleet of virtual connections
+ * @param dst   Remote Bluetooth address
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_fleet_add_device(gattlib_fleet_t* fleet, const char* dst);
+
+/**
+ * @brief Remove a device from the fleet
+ *
+ * @param fleet Fleet of virtual connections
+ * @param dst   Remote Bluetooth address
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ * @return GATTLIB_BUSY if the device is currently connected by the fleet
+ */
+int gattlib_fleet_remove_device(gattlib_fleet_t* fleet, const char* dst);
+
+/**
+ * @brief Add a periodic read of a GATT characteristic
+ *
+ * @param fleet     Fleet of virtual connections
+ * @param dst       Remote Bluetooth address of the device. NULL to add the job to all the devices of the fleet
+ *                  (including the devices added later).
+ * @param uuid      UUID of the GATT characteristic to read
+ * @param period_ms Period of the job
+ * @param job_cb    Callback called after each execution of the job
+ * @param user_data Data passed to the callback
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_fleet_add_read_job(gattlib_fleet_t* fleet, const char* dst, const uuid_t* uuid, unsigned int period_ms,
+		gattlib_fleet_job_cb_t job_cb, void* user_data);
+
+/**
+ * @brief Add a periodic write of a GATT characteristic
+ *
+ * @param fleet      Fleet of virtual connections
+ * @param dst        Remote Bluetooth address of the device. NULL to add the job to all the devices of the fleet
+ *                   (including the devices added later).
+ * @param uuid       UUID of the GATT characteristic to write
+ * @param buffer     Value to write. It is copied.
+ * @param buffer_len Length of the value
+ * @param period_ms  Period of the job
+ * @param job_cb     Callback called after each execution of the job
+ * @param user_data  Data passed to the callback
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_fleet_add_write_job(gattlib_fleet_t* fleet, const char* dst, const uuid_t* uuid, const void* buffer, size_t buffer_len,
+		unsigned int period_ms, gattlib_fleet_job_cb_t job_cb, void* user_data);
+
+/**
+ * @brief Remove the jobs of a GATT characteristic
+ *
+ * A job being executed completes its execution: its callback might still be called once after the function returns.
+ *
+ * @param fleet Fleet of virtual connections
+ * @param dst   Remote Bluetooth address the jobs have been added with. NULL for the jobs of all the devices.
+ * @param uuid  UUID of the GATT characteristic of the jobs
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ * @return GATTLIB_NOT_FOUND if no job matches
+ */
+int gattlib_fleet_remove_job(gattlib_fleet_t* fleet, const char* dst, const uuid_t* uuid);
+
+/**
+ * @brief Start to execute the jobs of the fleet
+ *
+ * @param fleet Fleet of virtual connections
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_fleet_start(gattlib_fleet_t* fleet);
+
+/**
+ * @brief Stop the fleet and wait for the devices in use
+ *
+ * No new physical connection is scheduled. The connected devices complete the job in progress, skip their
+ * other jobs and are disconnected. The function returns once no device is in use by the fleet anymore.
+ *
+ * @note When called from a job callback, the device of the callback is not waited for.
+ * @note The connections are completed by the GLib main loop. The function must not be called from its thread.
+ *
+ * @param fleet Fleet of virtual connections
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ * @return GATTLIB_TIMEOUT if devices are still in use after 45 seconds
+ */
+int gattlib_fleet_stop(gattlib_fleet_t* fleet);
+
+/**
+ * @brief Free the fleet
+ *
+ * The fleet is stopped first if it is still running (see `gattlib_fleet_stop()`). A device still in use
+ * (eg: when called from a job callback) does not execute any other job. The fleet is then freed once
+ * the device has been released.
+ *
+ * @param fleet Fleet of virtual connections
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_fleet_destroy(gattlib_fleet_t* fleet);
+
+/**
+ * @brief Get the freshness statistics of a device of the fleet
+ *
+ * @param fleet Fleet of virtual connections
+ * @param dst   Remote Bluetooth address
+ * @param stats Statistics of the device
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_fleet_get_device_stats(gattlib_fleet_t* fleet, const char* dst, gattlib_fleet_device_stats_t* stats);
+
+/**
+ * @brief Get the statistics of the fleet
+ *
+ * @param fleet Fleet of virtual connections
+ * @param stats Statistics of the fleet
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_fleet_get_stats(gattlib_fleet_t* fleet, gattlib_fleet_stats_t* stats);
+
+/**
+ * Default maximum number of group operations running at the same time on an adapter
+ */
+#define GATTLIB_GROUP_DEFAULT_MAX_IN_FLIGHT  4
+
+/**
+ * GATT operation executed by `gattlib_group_execute()`
+ */
+typedef enum {
+	GATTLIB_GROUP_OPERATION_READ,               /**< Read the characteristic */
+	GATTLIB_GROUP_OPERATION_WRITE,              /**< Write the characteristic with response */
+	GATTLIB_GROUP_OPERATION_NOTIFICATION_START, /**< Enable the notifications of the characteristic */
+	GATTLIB_GROUP_OPERATION_INDICATION_START,   /**< Enable the indications of the characteristic */
+} gattlib_group_operation_type_t;
+
+/**
+ * Operation executed on all the connections of a group
+ */
+typedef struct {
+	gattlib_group_operation_type_t type;
+	uuid_t uuid;                    /**< UUID of the GATT characteristic */
+	const uint8_t* data;            /**< Value to write. Only used by GATTLIB_GROUP_OPERATION_WRITE. */
+	size_t data_length;             /**< Length of the value to write */
+} gattlib_group_operation_t;
+
+/**
+ * Result of the operation on one connection of the group
+ */
+typedef struct {
+	int error;                      /**< GATTLIB_SUCCESS on success or GATTLIB_* error code */
+	void* data;                     /**< Value read. To be freed with `gattlib_group_results_free()`. */
+	size_t data_length;             /**< Length of the value read */
+	uint64_t latency_ns;            /**< Time between the operation being started and its completion */
+} gattlib_group_result_t;
+
+/**
+ * Aggregated report of a group operation
+ */
+typedef struct {
+	unsigned int succeeded;         /**< Number of connections where the operation has succeeded */
+	unsigned int failed;            /**< Number of connections where the operation has failed */
+	unsigned int timed_out;         /**< Number of connections where the operation has timed out */
+	uint64_t elapsed_ns;            /**< Duration of the whole group operation */
+	gattlib_latency_histogram_t latency; /**< Latency of the successful operations */
+} gattlib_group_report_t;
 
 /**
- * @brief Function to asynchronously connect to a BLE device
- *
- * @note This function is mainly used before Bluez v5.42 (prior to D-BUS support)
- *
- * @param adapter	Local Adaptater interface. When passing NULL, we use default adapter.
- * @param dst		Remote Bluetooth address
- * @param options	Options to connect to BLE device. See `GATTLIB_CONNECTION_OPTIONS_*`
- * @param connect_cb is the callback to call when the connection is established
- * @param user_data is the user specific data to pass to the callback
+ * @brief Execute the same GATT operation on a group of connections concurrently
+ *
+ * The operations are started in the order of the connections with at most `max_in_flight_per_adapter`
+ * operations running at the same time on each adapter. The function returns once every operation has
+ * completed or timed out.
+ *
+ * @note An operation that has timed out might still be running on its connection when the function returns.
+ *       It keeps its slot on the adapter until it returns. The operations waiting for this slot are not
+ *       started before.
+ *
+ * @param connections               Array of active GATT connections
+ * @param connections_count         Number of connections
+ * @param operation                 Operation to execute. Its value is copied.
+ * @param max_in_flight_per_adapter Maximum number of operations running at the same time on an adapter.
+ *                                  0 to use GATTLIB_GROUP_DEFAULT_MAX_IN_FLIGHT.
+ * @param timeout_ms                Timeout of the operation on each connection, starting when the operation is
+ *                                  started on the connection. 0 for no timeout.
+ * @param results                   Array of `connections_count` results, one per connection
+ * @param report                    Aggregated report. Can be NULL.
+ *
+ * @return GATTLIB_SUCCESS if the operation has succeeded on all the connections or the GATTLIB_* error code
+ *         of the first connection that has failed
+ */
+int gattlib_group_execute(gattlib_connection_t** connections, size_t connections_count,
+		const gattlib_group_operation_t* operation, unsigned int max_in_flight_per_adapter, unsigned int timeout_ms,
+		gattlib_group_result_t* results, gattlib_group_report_t* report);
+
+/**
+ * @brief Free the values read by `gattlib_group_execute()`
  *
- * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ * @param results       Array of results
+ * @param results_count Number of results
  */
-int gattlib_connect(gattlib_adapter_t* adapter, const char *dst,
-		unsigned long options,
-		gatt_connect_cb_t connect_cb,
-		void* user_data);
+void gattlib_group_results_free(gattlib_group_result_t* results, size_t results_count);
 
 /**
  * @brief Function to disconnect the GATT connection
@@ -376,7 +1356,9 @@ int gattlib_connect(gattlib_adapter_t* adapter, const char *dst,
  *
  * @param connection          Active GATT connection
  * @param wait_disconnection  If false gattlib_disconnect does not wait for the device to confirm it has been
- *                            disconnected and return immediately.
+ *                            disconnected and return immediately. When waiting, the function returns as soon as
+ *                            the device has signaled its disconnection. The disconnection callback might run after.
+ *                            It can be called from a callback of the connection (eg: a notification handler).
  *
  * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
  * @return GATTLIB_TIMEOUT when wait_disconnection is true and the device has not been disconnected for
@@ -384,6 +1366,21 @@ int gattlib_connect(gattlib_adapter_t* adapter, const char *dst,
  */
 int gattlib_disconnect(gattlib_connection_t* connection, bool wait_disconnection);
 
+/**
+ * @brief Function to asynchronously disconnect the GATT connection
+ *
+ * The function returns immediately. The callback is called from a gattlib thread once the device has
+ * been disconnected, after the callback registered by gattlib_register_on_disconnect().
+ * It allows to disconnect many devices in parallel without a thread waiting for each of them.
+ *
+ * @param connection    Active GATT connection
+ * @param disconnect_cb Callback called when the disconnection has completed. It can be NULL.
+ * @param user_data     Data passed to the callback
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_disconnect_async(gattlib_connection_t* connection, gattlib_disconnect_cb_t disconnect_cb, void* user_data);
+
 /**
  * @brief Function to register a callback on GATT disconnection
  *
@@ -395,6 +1392,52 @@ int gattlib_disconnect(gattlib_connection_t* connection, bool wait_disconnection
  */
 int gattlib_register_on_disconnect(gattlib_connection_t *connection, gattlib_disconnection_handler_t handler, void* user_data);
 
+/**
+ * Events reported by the automatic reconnection of a connection
+ */
+typedef enum {
+	GATTLIB_RECONNECT_EVENT_LINK_LOST = 0,  /**< The link has been lost. The reconnection starts. */
+	GATTLIB_RECONNECT_EVENT_ATTEMPT,        /**< A reconnection attempt is starting */
+	GATTLIB_RECONNECT_EVENT_RECONNECTED,    /**< The device is connected again and its subscriptions are restored */
+	GATTLIB_RECONNECT_EVENT_FAILED,         /**< All the reconnection attempts have failed */
+} gattlib_reconnect_event_t;
+
+/**
+ * @brief Handler called on each step of the automatic reconnection
+ *
+ * @param connection Connection being reconnected
+ * @param event      Reconnection event
+ * @param attempt    Number of the reconnection attempt (starting at 1). 0 for GATTLIB_RECONNECT_EVENT_LINK_LOST.
+ * @param error      GATTLIB_SUCCESS or GATTLIB_* error code of the last attempt
+ * @param latency_ns Time elapsed since the link has been lost
+ * @param user_data  Data defined when calling `gattlib_connection_set_auto_reconnect()`
+ */
+typedef void (*gattlib_reconnect_event_cb_t)(gattlib_connection_t* connection, gattlib_reconnect_event_t event,
+		unsigned int attempt, int error, uint64_t latency_ns, void* user_data);
+
+/**
+ * @brief Enable the automatic reconnection of the connection when its link is lost
+ *
+ * When the link drops (ie: the disconnection has not been requested by gattlib_disconnect()), gattlib
+ * reconnects the device with an exponential backoff starting at 'initial_backoff_ms' and capped at
+ * 'max_backoff_ms'. Once reconnected, the notifications and indications started on the connection are
+ * started again. The connection keeps its registered handlers. The connection callback passed to
+ * gattlib_connect() is not called on reconnection.
+ *
+ * @param connection         Active GATT connection
+ * @param max_attempts       Maximum number of reconnection attempts. 0 disables the automatic reconnection and
+ *                           stops the reconnection in progress.
+ * @param initial_backoff_ms Delay before the first reconnection attempt
+ * @param max_backoff_ms     Maximum delay between two reconnection attempts
+ * @param event_cb           Callback to report the reconnection events. It can be NULL.
+ * @param user_data          Data passed to the callback
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_connection_set_auto_reconnect(gattlib_connection_t* connection, unsigned int max_attempts,
+		unsigned int initial_backoff_ms, unsigned int max_backoff_ms,
+		gattlib_reconnect_event_cb_t event_cb, void* user_data);
+
 /**
  * Structure to represent GATT Primary Service
  */
@@ -502,6 +1545,22 @@ int gattlib_discover_desc(gattlib_connection_t* connection, gattlib_descriptor_t
  */
 int gattlib_read_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, void** buffer, size_t* buffer_len);
 
+/**
+ * @brief Function to read GATT characteristic from its handle
+ *
+ * The value is read with a single ATT Read Request on the handle.
+ *
+ * @note buffer is allocated by the function. It is the responsibility of the caller to free the buffer.
+ *
+ * @param connection Active GATT connection
+ * @param handle is the value handle of the GATT characteristic (see `gattlib_characteristic_t.value_handle`)
+ * @param buffer contains the value to read. It is allocated by the function.
+ * @param buffer_len Length of the read data
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_read_char_by_handle(gattlib_connection_t* connection, uint16_t handle, void** buffer, size_t* buffer_len);
+
 /**
  * @brief Function to asynchronously read GATT characteristic
  *
@@ -513,6 +1572,108 @@ int gattlib_read_char_by_uuid(gattlib_connection_t* connection, uuid_t* uuid, vo
  */
 int gattlib_read_char_by_uuid_async(gattlib_connection_t* connection, uuid_t* uuid, gatt_read_cb_t gatt_read_cb);
 
+/**
+ * @brief Handler called with each chunk of a long read
+ *
+ * @param chunk        Part of the value. It is only valid during the callback.
+ * @param chunk_length Length of the chunk
+ * @param offset       Offset of the chunk in the value
+ * @param user_data    Data defined when calling `gattlib_read_char_by_uuid_long()`
+ */
+typedef void (*gattlib_long_read_cb_t)(const uint8_t* chunk, size_t chunk_length, size_t offset, void* user_data);
+
+/**
+ * @brief Handler providing the chunks of a long write
+ *
+ * @param chunk            Buffer to fill with the next part of the value
+ * @param chunk_max_length Size of the buffer. It is derived from the negotiated MTU.
+ * @param offset           Offset of the chunk in the value
+ * @param user_data        Data defined when calling `gattlib_write_char_by_uuid_long()`
+ *
+ * @return Number of bytes copied into `chunk`. 0 once the whole value has been provided.
+ */
+typedef size_t (*gattlib_long_write_cb_t)(uint8_t* chunk, size_t chunk_max_length, size_t offset, void* user_data);
+
+/**
+ * @brief Function to read a GATT characteristic value longer than an ATT PDU
+ *
+ * The value is read chunk by chunk (ATT Read Blob) with chunks sized from the negotiated MTU.
+ * The chunks are passed to the callback in order as they are received.
+ *
+ * @param connection Active GATT connection
+ * @param uuid UUID of the GATT characteristic to read
+ * @param chunk_cb Callback called with each chunk of the value
+ * @param user_data Data passed to the callback
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_read_char_by_uuid_long(gattlib_connection_t* connection, uuid_t* uuid, gattlib_long_read_cb_t chunk_cb, void* user_data);
+
+/**
+ * @brief Function to write a GATT characteristic value longer than an ATT PDU
+ *
+ * The value is requested chunk by chunk from the callback and written at increasing offsets
+ * (ATT Prepare Write) with chunks sized from the negotiated MTU.
+ *
+ * @note On the legacy backend, the chunks are committed together once the callback has returned 0.
+ *       With D-Bus, BlueZ commits each chunk on its own.
+ *
+ * @param connection Active GATT connection
+ * @param uuid UUID of the GATT characteristic to write
+ * @param chunk_cb Callback providing the chunks of the value
+ * @param user_data Data passed to the callback
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_write_char_by_uuid_long(gattlib_connection_t* connection, uuid_t* uuid, gattlib_long_write_cb_t chunk_cb, void* user_data);
+
+/**
+ * @brief Start a transaction of writes to several GATT characteristics
+ *
+ * The values added to the transaction are queued on the device as prepared writes and applied together
+ * by a single Execute Write on commit. Either all the values are applied or none of them.
+ *
+ * @note With the D-Bus backend, BlueZ executes the prepared writes of each characteristic on its own.
+ *       A transaction can only hold the value of a single characteristic, written as a reliable write.
+ *       `gattlib_write_transaction_commit()` returns GATTLIB_NOT_SUPPORTED without writing anything
+ *       for a transaction of several values.
+ *
+ * @param connection Active GATT connection
+ * @param transaction New transaction. It is freed by `gattlib_write_transaction_commit()` or
+ *                    `gattlib_write_transaction_abort()`.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_write_transaction_begin(gattlib_connection_t* connection, gattlib_write_transaction_t** transaction);
+
+/**
+ * @brief Add a write to the transaction
+ *
+ * @param transaction Transaction started by `gattlib_write_transaction_begin()`
+ * @param uuid UUID of the GATT characteristic to write
+ * @param buffer contains the values to write to the GATT characteristic. It is copied.
+ * @param buffer_len is the length of the buffer to write
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_write_transaction_add(gattlib_write_transaction_t* transaction, const uuid_t* uuid, const void* buffer, size_t buffer_len);
+
+/**
+ * @brief Write all the values of the transaction and free it
+ *
+ * @param transaction Transaction started by `gattlib_write_transaction_begin()`
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code. On error, none of the values has been applied.
+ */
+int gattlib_write_transaction_commit(gattlib_write_transaction_t* transaction);
+
+/**
+ * @brief Free the transaction without writing its values
+ *
+ * @param transaction Transaction started by `gattlib_write_transaction_begin()`
+ */
+void gattlib_write_transaction_abort(gattlib_write_transaction_t* transaction);
+
 /**
  * @brief Free buffer allocated by the characteristic reading to store the value
  *
@@ -547,6 +1708,10 @@ int gattlib_write_char_by_handle(gattlib_connection_t* connection, uint16_t hand
 /**
  * @brief Function to write without response to the GATT characteristic UUID
  *
+ * @note: The value must fit in a single ATT PDU (ATT MTU - 3 bytes). With the legacy backend, the function
+ * returns once the write is queued. It blocks while the queue of the connection is full, that is while
+ * the socket does not accept more data.
+ *
  * @param connection Active GATT connection
  * @param uuid UUID of the GATT characteristic to read
  * @param buffer contains the values to write to the GATT characteristic
@@ -602,6 +1767,74 @@ int gattlib_write_char_stream_close(gattlib_stream_t *stream);
  */
 int gattlib_write_without_response_char_by_handle(gattlib_connection_t* connection, uint16_t handle, const void* buffer, size_t buffer_len);
 
+/**
+ * @brief Function to write to the GATT characteristic UUID with a given priority class
+ *
+ * `gattlib_write_char_by_uuid()` uses GATTLIB_PRIORITY_NORMAL. A GATTLIB_PRIORITY_HIGH write is started
+ * before the operations of lower classes still waiting on the connection (eg: stream writes). It does not
+ * overtake the operations already submitted to BlueZ.
+ *
+ * @param connection Active GATT connection
+ * @param uuid UUID of the GATT characteristic to write
+ * @param buffer contains the values to write to the GATT characteristic
+ * @param buffer_len is the length of the buffer to write
+ * @param priority Priority class of the write
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_write_char_by_uuid_with_priority(gattlib_connection_t* connection, uuid_t* uuid, const void* buffer, size_t buffer_len,
+		gattlib_priority_t priority);
+
+/**
+ * @brief Function to write without response to the GATT characteristic UUID with a given priority class
+ *
+ * `gattlib_write_without_response_char_by_uuid()` uses GATTLIB_PRIORITY_BULK.
+ *
+ * @param connection Active GATT connection
+ * @param uuid UUID of the GATT characteristic to write
+ * @param buffer contains the values to write to the GATT characteristic
+ * @param buffer_len is the length of the buffer to write
+ * @param priority Priority class of the write
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_write_without_response_char_by_uuid_with_priority(gattlib_connection_t* connection, uuid_t* uuid,
+		const void* buffer, size_t buffer_len, gattlib_priority_t priority);
+
+/**
+ * @brief Enable the 'latest wins' coalescing of the writes without response to a GATT characteristic
+ *
+ * A write without response to the characteristic stores its value and returns at once. A single writer
+ * sends the values in the background: once a write has completed, it sends the latest value stored in the
+ * meantime. The values replaced before being sent are counted as coalesced. It suits setpoints
+ * (eg: LED colour, motor speed) where only the freshest value matters.
+ *
+ * @note A write returns GATTLIB_SUCCESS once its value has been stored. The errors of the writes done in
+ *       the background are only logged.
+ * @note The coalescing is only supported by the DBUS backend.
+ *
+ * @param connection Active GATT connection
+ * @param uuid UUID of the GATT characteristic
+ * @param enable true to enable the coalescing, false to disable it
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_write_coalescing_enable(gattlib_connection_t* connection, const uuid_t* uuid, bool enable);
+
+/**
+ * @brief Get the counters of the write coalescing of a GATT characteristic
+ *
+ * @param connection Active GATT connection
+ * @param uuid UUID of the GATT characteristic
+ * @param written Number of values written to the characteristic while the coalescing was enabled. Can be NULL.
+ * @param coalesced Number of values replaced by a newer value before being written. Can be NULL.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ * @return GATTLIB_NOT_FOUND if the coalescing has never been enabled for the characteristic
+ */
+int gattlib_write_coalescing_get_stats(gattlib_connection_t* connection, const uuid_t* uuid,
+		uint64_t* written, uint64_t* coalesced);
+
 /*
  * @brief Enable notification on GATT characteristic represented by its UUID
  *
@@ -642,6 +1875,46 @@ int gattlib_indication_start(gattlib_connection_t* connection, const uuid_t* uui
  */
 int gattlib_indication_stop(gattlib_connection_t* connection, const uuid_t* uuid);
 
+/**
+ * @name Flags for gattlib_notifications_start()
+ */
+//@{
+#define GATTLIB_NOTIFICATIONS_INDICATION                    (1 << 0) //< Start indications instead of notifications
+//@}
+
+/**
+ * @brief Enable notification/indication on many GATT characteristics at once
+ *
+ * The characteristics are resolved once and the subscriptions are requested concurrently.
+ * The function returns when all the subscriptions have completed or after 30 seconds. The subscriptions
+ * that have not completed by then are reported with GATTLIB_TIMEOUT.
+ *
+ * @note It can be called from the thread running the GLib main loop. The loop is then iterated while waiting.
+ *
+ * @param connection  Active GATT connection
+ * @param uuids       UUIDs of the characteristics
+ * @param uuids_count Number of UUIDs
+ * @param flags       See `GATTLIB_NOTIFICATIONS_*`
+ * @param results     Filled with GATTLIB_SUCCESS or the GATTLIB_* error code of each characteristic. It can be NULL.
+ *
+ * @return GATTLIB_SUCCESS if all the subscriptions have succeeded or the error of the first failing one
+ */
+int gattlib_notifications_start(gattlib_connection_t* connection, const uuid_t* uuids, size_t uuids_count, uint32_t flags, int* results);
+
+/**
+ * @brief Disable notification/indication on many GATT characteristics at once
+ *
+ * The requests are issued concurrently. The function waits for them as `gattlib_notifications_start()` does.
+ *
+ * @param connection  Active GATT connection
+ * @param uuids       UUIDs of the characteristics
+ * @param uuids_count Number of UUIDs
+ * @param results     Filled with GATTLIB_SUCCESS or the GATTLIB_* error code of each characteristic. It can be NULL.
+ *
+ * @return GATTLIB_SUCCESS if all the requests have succeeded or the error of the first failing one
+ */
+int gattlib_notifications_stop(gattlib_connection_t* connection, const uuid_t* uuids, size_t uuids_count, int* results);
+
 /*
  * @brief Register a handle for the GATT notifications
  *
@@ -664,6 +1937,92 @@ int gattlib_register_notification(gattlib_connection_t* connection, gattlib_even
  */
 int gattlib_register_indication(gattlib_connection_t* connection, gattlib_event_handler_t indication_handler, void* user_data);
 
+/*
+ * @brief Register a handle for the GATT notifications that also receives the notification timestamp
+ *
+ * @param connection Active GATT connection
+ * @param notification_handler is the handler to call on notification
+ * @param user_data if the user specific data to pass to the handler
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_register_notification_with_timestamp(gattlib_connection_t* connection, gattlib_event_with_timestamp_handler_t notification_handler, void* user_data);
+
+/*
+ * @brief Register a handle for the GATT indications that also receives the indication timestamp
+ *
+ * @param connection Active GATT connection
+ * @param indication_handler is the handler to call on indications
+ * @param user_data if the user specific data to pass to the handler
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_register_indication_with_timestamp(gattlib_connection_t* connection, gattlib_event_with_timestamp_handler_t indication_handler, void* user_data);
+
+/**
+ * @brief Queue the GATT notifications/indications of the connection instead of dispatching them to a handler
+ *
+ * Once enabled, the notifications are stored in a per-connection queue and a Linux eventfd becomes
+ * readable as long as the queue is not empty. The file descriptor can be added to any external event
+ * loop (epoll, libuv, asio, etc) and the notifications drained with `gattlib_notification_poll()`
+ * from the event loop thread.
+ *
+ * @note When the queue is full, the oldest notification is dropped.
+ *
+ * @param connection Active GATT connection
+ * @param queue_size is the maximum number of notifications kept in the queue
+ * @param fd is the file descriptor to poll for reading. It is owned by gattlib and stays valid until
+ *        `gattlib_notification_queue_disable()` is called.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_notification_queue_enable(gattlib_connection_t* connection, size_t queue_size, int* fd);
+
+/**
+ * @brief Stop queuing GATT notifications/indications and release the queue and its file descriptor
+ *
+ * @param connection Active GATT connection
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_notification_queue_disable(gattlib_connection_t* connection);
+
+/**
+ * @brief Drain the notifications queued since `gattlib_notification_queue_enable()` (non-blocking)
+ *
+ * @param connection Active GATT connection
+ * @param records is an array of `max_records` records filled by the function
+ * @param max_records is the maximum number of records to retrieve
+ * @param records_count is the number of records actually retrieved
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_notification_poll(gattlib_connection_t* connection, gattlib_notification_record_t* records, size_t max_records, size_t* records_count);
+
+/**
+ * @brief Free the payloads of the records retrieved by `gattlib_notification_poll()`
+ *
+ * @param records is the array of records
+ * @param records_count is the number of records retrieved by `gattlib_notification_poll()`
+ */
+void gattlib_notification_records_free(gattlib_notification_record_t* records, size_t records_count);
+
+/**
+ * @brief Function to retrieve the ATT MTU of a GATT connection
+ *
+ * The MTU is the one negotiated with the remote device (ATT Exchange MTU). It bounds the size of
+ * the PDUs exchanged on the connection: a notification or a read response carries up to 'mtu - 3' bytes.
+ *
+ * @note: With the legacy backend, the MTU requested at connection time can be set with
+ * GATTLIB_CONNECTION_OPTIONS_LEGACY_MTU(). The largest MTU supported by the library is requested otherwise.
+ *
+ * @param connection Active GATT connection
+ * @param mtu is the ATT MTU of the GATT connection
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_get_mtu(gattlib_connection_t* connection, uint16_t* mtu);
+
 #if 0 // Disable until https://github.com/labapart/gattlib/issues/75 is resolved
 /**
  * @brief Function to retrieve RSSI from a GATT connection
@@ -753,6 +2112,89 @@ int gattlib_string_to_uuid(const char *str, size_t size, uuid_t *uuid);
  */
 int gattlib_uuid_cmp(const uuid_t *uuid1, const uuid_t *uuid2);
 
+/**
+ * @brief Convert a string representing a Bluetooth address into its packed 48-bit form
+ *
+ * The address "AA:BB:CC:DD:EE:FF" is packed into 0xAABBCCDDEEFF.
+ *
+ * @param str is the string of the address (eg: "AA:BB:CC:DD:EE:FF")
+ * @param address is the packed address
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_string_to_address48(const char *str, uint64_t *address);
+
+/**
+ * @brief Convert a packed 48-bit Bluetooth address into a string
+ *
+ * @param address is the packed address
+ * @param str is the buffer that will contain the string
+ * @param size is the size of the buffer. It must be at least 18 bytes long.
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_address48_to_string(uint64_t address, char *str, size_t size);
+
+/**
+ * @brief Pack a Bluetooth address in HCI byte order into its 48-bit form
+ *
+ * The bytes { 0xFF, 0xEE, 0xDD, 0xCC, 0xBB, 0xAA } are packed into 0xAABBCCDDEEFF.
+ *
+ * @param address is the address of 6 bytes in HCI byte order (least significant byte first)
+ *
+ * @return the packed address
+ */
+uint64_t gattlib_address48_from_bytes(const uint8_t* address);
+
+/**
+ * @brief Set the maximum number of threads used to invoke the gattlib callbacks
+ *
+ * All the callbacks (discovered device, connection, notification, disconnection) are executed by a
+ * thread pool shared by all the adapters and connections. The events of a given connection are
+ * started in order (connection, then notifications, then disconnection). The notification and
+ * disconnection callbacks of a connection never run concurrently with each other.
+ *
+ * The connection callback is the exception: it commonly runs the application logic for the whole
+ * connection, so the following events of the connection do not wait for it to return. The notification
+ * and disconnection callbacks might run while the connection callback is still running. The application
+ * must synchronise the state shared between them.
+ *
+ * @note Limiting the number of threads requires the callbacks not to block for too long.
+ *
+ * @param max_threads is the maximum number of threads. -1 means no limit (default).
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_executor_set_max_threads(int max_threads);
+
+/**
+ * @brief Get the histogram of the dispatch latency of the callbacks
+ *
+ * The dispatch latency is the time between the event being queued by gattlib and
+ * the application callback being invoked.
+ *
+ * @param histogram is the structure to fill with the current histogram
+ * @param reset resets the histogram once it has been copied
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_get_dispatch_latency_histogram(gattlib_latency_histogram_t* histogram, bool reset);
+
+/**
+ * @brief Get the histogram of the queueing delay of a priority class of the connection
+ *
+ * The queueing delay is the time a GATT operation waits for its turn on the connection.
+ *
+ * @param connection Active GATT connection
+ * @param priority Priority class
+ * @param histogram is the structure to fill with the current histogram
+ * @param reset resets the histogram once it has been copied
+ *
+ * @return GATTLIB_SUCCESS on success or GATTLIB_* error code
+ */
+int gattlib_connection_get_queueing_latency(gattlib_connection_t* connection, gattlib_priority_t priority,
+		gattlib_latency_histogram_t* histogram, bool reset);
+
 /**
  * @brief Logging function used by Gattlib
  *
@@ -0,0 +1,224 @@
+/*
+ *
+ *  GattLib - GATT Library
+ *
+ *  Copyright (C) 2024  Olivier Martin <olivier@labapart.org>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * Microbenchmark of the advertising filter.
+ *
+ * A population of advertisements typical of a beacon gateway (iBeacon, Eddystone, named tags and
+ * other devices) is matched again and again against a compiled filter.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gattlib.h"
+
+#define BENCHMARK_DEFAULT_ITERATIONS    2000
+#define BENCHMARK_ADVERTISEMENTS        4096
+#define ADVERTISING_DATA_MAX_LENGTH     31
+
+#define TAG_ADDRESS_FIRST               0xC0DE42000000ULL
+#define TAG_ADDRESS_LAST                0xC0DE42FFFFFFULL
+
+struct advertisement {
+	uint64_t address;
+	int16_t rssi;
+	size_t data_length;
+	uint8_t data[ADVERTISING_DATA_MAX_LENGTH];
+	// The advertisement is expected to match the filter
+	bool is_expected;
+};
+
+static struct advertisement m_advertisements[BENCHMARK_ADVERTISEMENTS];
+
+// Proximity UUID prefix of the iBeacons of interest
+static const uint8_t m_ibeacon_prefix[] = { 0x4C, 0x00, 0x02, 0x15, 0xE2, 0xC5, 0x6D, 0xB5 };
+static const uint8_t m_ibeacon_mask[]   = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+// Append an AD structure. Return the new offset.
+static size_t put_ad(uint8_t* p, size_t offset, uint8_t type, const uint8_t* data, uint8_t length) {
+	p[offset] = length + 1;
+	p[offset + 1] = type;
+	memcpy(&p[offset + 2], data, length);
+	return offset + 2 + length;
+}
+
+static void generate_advertisements(void) {
+	static const uint8_t flags[] = { 0x06 };
+	unsigned int i;
+
+	srand(42);
+
+	for (i = 0; i < BENCHMARK_ADVERTISEMENTS; i++) {
+		struct advertisement* advertisement = &m_advertisements[i];
+		uint8_t payload[32];
+		size_t offset = 0;
+
+		advertisement->address = ((uint64_t)rand() << 16 | (rand() & 0xFFFF)) & 0xFFFFFFFFFFFFULL;
+		advertisement->rssi = -30 - (rand() % 70);
+		offset = put_ad(advertisement->data, offset, 0x01, flags, sizeof(flags));
+
+		switch (rand() % 20) {
+		case 0:
+			// iBeacon of interest
+			memcpy(payload, m_ibeacon_prefix, sizeof(m_ibeacon_prefix));
+			memset(&payload[sizeof(m_ibeacon_prefix)], i & 0xFF, 17);
+			offset = put_ad(advertisement->data, offset, 0xFF, payload, 25);
+			advertisement->is_expected = (advertisement->rssi >= -70);
+			break;
+		case 1:
+			// Eddystone
+			payload[0] = 0xAA;
+			payload[1] = 0xFE;
+			memset(&payload[2], i & 0xFF, 18);
+			offset = put_ad(advertisement->data, offset, 0x16, payload, 20);
+			advertisement->is_expected = true;
+			break;
+		case 2:
+			// Named tag
+			advertisement->address = TAG_ADDRESS_FIRST | (advertisement->address & 0xFFFFFF);
+			offset = put_ad(advertisement->data, offset, 0x09, (const uint8_t*)"Tag-1234", 8);
+			advertisement->is_expected = true;
+			break;
+		default:
+			// Other iBeacons and manufacturer data
+			payload[0] = 0x4C;
+			payload[1] = 0x00;
+			payload[2] = 0x10 + (rand() % 4);
+			memset(&payload[3], i & 0xFF, 20);
+			offset = put_ad(advertisement->data, offset, 0xFF, payload, 23);
+			advertisement->is_expected = false;
+			break;
+		}
+
+		advertisement->data_length = offset;
+	}
+}
+
+static int compile_filter(gattlib_advertising_filter_t** filter) {
+	gattlib_advertising_rule_t rules[6];
+
+	memset(rules, 0, sizeof(rules));
+
+	// iBeacons of interest close enough to the gateway
+	rules[0].type = GATTLIB_ADVERTISING_RULE_MANUFACTURER_ID;
+	rules[0].group = 0;
+	rules[0].rule.manufacturer_id = 0x004C;
+	rules[1].type = GATTLIB_ADVERTISING_RULE_AD_PREFIX;
+	rules[1].group = 0;
+	rules[1].rule.ad_prefix.ad_type = 0xFF;
+	rules[1].rule.ad_prefix.value = m_ibeacon_prefix;
+	rules[1].rule.ad_prefix.mask = m_ibeacon_mask;
+	rules[1].rule.ad_prefix.length = sizeof(m_ibeacon_prefix);
+	rules[2].type = GATTLIB_ADVERTISING_RULE_RSSI;
+	rules[2].group = 0;
+	rules[2].rule.rssi_threshold = -70;
+
+	// Eddystone beacons
+	rules[3].type = GATTLIB_ADVERTISING_RULE_SERVICE_DATA_UUID;
+	rules[3].group = 1;
+	rules[3].rule.service_data_uuid.type = SDP_UUID16;
+	rules[3].rule.service_data_uuid.value.uuid16 = 0xFEAA;
+
+	// Named tags of our address range
+	rules[4].type = GATTLIB_ADVERTISING_RULE_NAME_PREFIX;
+	rules[4].group = 2;
+	rules[4].rule.name_prefix = "Tag-";
+	rules[5].type = GATTLIB_ADVERTISING_RULE_ADDRESS_RANGE;
+	rules[5].group = 2;
+	rules[5].rule.address_range.first = TAG_ADDRESS_FIRST;
+	rules[5].rule.address_range.last = TAG_ADDRESS_LAST;
+
+	return gattlib_advertising_filter_compile(rules, sizeof(rules) / sizeof(rules[0]), filter);
+}
+
+static uint64_t get_time_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int main(int argc, const char *argv[]) {
+	gattlib_advertising_filter_t* filter;
+	unsigned long iterations = BENCHMARK_DEFAULT_ITERATIONS;
+	uint64_t start_ns, duration_ns, evaluations, matches = 0;
+	unsigned long i;
+	size_t j;
+	int ret;
+
+	if (argc > 2) {
+		printf("%s [<iterations>]\n", argv[0]);
+		return 1;
+	} else if (argc == 2) {
+		iterations = strtoul(argv[1], NULL, 0);
+	}
+
+	generate_advertisements();
+
+	ret = compile_filter(&filter);
+	if (ret != GATTLIB_SUCCESS) {
+		fprintf(stderr, "Failed to compile the filter: %d\n", ret);
+		return 1;
+	}
+
+	// Check the filter before measuring it
+	for (j = 0; j < BENCHMARK_ADVERTISEMENTS; j++) {
+		const struct advertisement* advertisement = &m_advertisements[j];
+
+		if (gattlib_advertising_filter_match(filter, advertisement->address, advertisement->rssi,
+				advertisement->data, advertisement->data_length) != advertisement->is_expected) {
+			fprintf(stderr, "Unexpected result for the advertisement %zu\n", j);
+			gattlib_advertising_filter_unref(filter);
+			return 1;
+		}
+	}
+
+	start_ns = get_time_ns();
+	for (i = 0; i < iterations; i++) {
+		for (j = 0; j < BENCHMARK_ADVERTISEMENTS; j++) {
+			const struct advertisement* advertisement = &m_advertisements[j];
+
+			matches += gattlib_advertising_filter_match(filter, advertisement->address, advertisement->rssi,
+					advertisement->data, advertisement->data_length);
+		}
+	}
+	duration_ns = get_time_ns() - start_ns;
+	if (duration_ns == 0) {
+		duration_ns = 1;
+	}
+
+	evaluations = (uint64_t)BENCHMARK_ADVERTISEMENTS * iterations;
+
+	printf("Evaluations:   %llu\n", (unsigned long long)evaluations);
+	printf("Matches:       %llu (%.1f%%)\n", (unsigned long long)matches, evaluations ? 100.0 * matches / evaluations : 0.0);
+	printf("Duration:      %.3f ms\n", duration_ns / 1e6);
+	printf("Evaluations/s: %.0f\n", evaluations * 1e9 / duration_ns);
+	printf("Matches/s:     %.0f\n", matches * 1e9 / duration_ns);
+	printf("ns/evaluation: %.1f\n", (double)duration_ns / evaluations);
+
+	gattlib_advertising_filter_unref(filter);
+	return 0;
+}
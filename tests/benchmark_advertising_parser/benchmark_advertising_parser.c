@@ -0,0 +1,332 @@
+/*
+ *
+ *  GattLib - GATT Library
+ *
+ *  Copyright (C) 2024  Olivier Martin <olivier@labapart.org>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * Benchmark of the HCI advertising report parser.
+ *
+ * The HCI events are either read from a btsnoop file (eg: recorded with 'btmon -w' or 'hcidump -w')
+ * or generated by the benchmark. They are parsed again and again by the same parser as the scanner.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gattlib.h"
+
+#define BENCHMARK_DEFAULT_ITERATIONS    1000
+#define BENCHMARK_GENERATED_EVENTS      1024
+#define HCI_EVENT_MAX_LENGTH            257
+
+#define BTSNOOP_HEADER_SIZE             16
+#define BTSNOOP_RECORD_HEADER_SIZE      24
+#define BTSNOOP_DATALINK_HCI            1001
+#define BTSNOOP_DATALINK_H4             1002
+#define BTSNOOP_DATALINK_MONITOR        2001
+
+#define BTSNOOP_HCI_FLAG_EVENT          0x02
+#define BTSNOOP_H4_EVENT                0x04
+#define BTSNOOP_MONITOR_OPCODE_EVENT    0x0003
+
+struct hci_event {
+	size_t length;
+	uint8_t data[HCI_EVENT_MAX_LENGTH];
+};
+
+static struct hci_event* m_events;
+static size_t m_event_count;
+
+static uint64_t m_report_count;
+static uint64_t m_ad_count;
+
+static uint32_t get_be32(const uint8_t* p) {
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static int add_event(const uint8_t* data, size_t length) {
+	if ((length < 2) || (length > HCI_EVENT_MAX_LENGTH)) {
+		return 0;
+	}
+
+	struct hci_event* events = realloc(m_events, (m_event_count + 1) * sizeof(struct hci_event));
+	if (events == NULL) {
+		return -1;
+	}
+	m_events = events;
+
+	memcpy(m_events[m_event_count].data, data, length);
+	m_events[m_event_count].length = length;
+	m_event_count++;
+	return 0;
+}
+
+static int load_btsnoop(const char* path) {
+	uint8_t header[BTSNOOP_RECORD_HEADER_SIZE];
+	uint8_t data[2048];
+	uint32_t datalink;
+	int ret = -1;
+
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) {
+		fprintf(stderr, "Cannot open '%s'\n", path);
+		return -1;
+	}
+
+	if ((fread(header, 1, BTSNOOP_HEADER_SIZE, file) != BTSNOOP_HEADER_SIZE) || (memcmp(header, "btsnoop\0", 8) != 0)) {
+		fprintf(stderr, "'%s' is not a btsnoop file\n", path);
+		goto EXIT;
+	}
+
+	datalink = get_be32(&header[12]);
+	if ((datalink != BTSNOOP_DATALINK_HCI) && (datalink != BTSNOOP_DATALINK_H4) && (datalink != BTSNOOP_DATALINK_MONITOR)) {
+		fprintf(stderr, "Unsupported btsnoop datalink %u\n", datalink);
+		goto EXIT;
+	}
+
+	while (fread(header, 1, BTSNOOP_RECORD_HEADER_SIZE, file) == BTSNOOP_RECORD_HEADER_SIZE) {
+		uint32_t length = get_be32(&header[4]);
+		uint32_t flags = get_be32(&header[8]);
+
+		if ((length > sizeof(data)) || (fread(data, 1, length, file) != length)) {
+			break;
+		}
+
+		if ((datalink == BTSNOOP_DATALINK_H4) && (length > 0) && (data[0] == BTSNOOP_H4_EVENT)) {
+			ret = add_event(&data[1], length - 1);
+		} else if ((datalink == BTSNOOP_DATALINK_HCI) && (flags & BTSNOOP_HCI_FLAG_EVENT) && (flags & 0x1)) {
+			ret = add_event(data, length);
+		} else if ((datalink == BTSNOOP_DATALINK_MONITOR) && ((flags & 0xFFFF) == BTSNOOP_MONITOR_OPCODE_EVENT)) {
+			ret = add_event(data, length);
+		} else {
+			ret = 0;
+		}
+
+		if (ret != 0) {
+			goto EXIT;
+		}
+	}
+
+	ret = 0;
+
+EXIT:
+	fclose(file);
+	return ret;
+}
+
+// Append an AD structure. Return the new offset.
+static size_t put_ad(uint8_t* p, size_t offset, uint8_t type, const uint8_t* data, uint8_t length) {
+	p[offset] = length + 1;
+	p[offset + 1] = type;
+	memcpy(&p[offset + 2], data, length);
+	return offset + 2 + length;
+}
+
+static size_t put_beacon_data(uint8_t* p, size_t offset, unsigned int index) {
+	static const uint8_t flags[] = { 0x06 };
+	uint8_t manufacturer_data[] = { 0x4C, 0x00, 0x02, 0x15, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x00, 0x01, 0x00, 0x02, 0xC5 };
+
+	manufacturer_data[4] = index & 0xFF;
+	manufacturer_data[5] = (index >> 8) & 0xFF;
+
+	offset = put_ad(p, offset, 0x01, flags, sizeof(flags));
+	offset = put_ad(p, offset, 0xFF, manufacturer_data, sizeof(manufacturer_data));
+	return offset;
+}
+
+// LE Advertising Report event with 'report_count' ADV_IND and SCAN_RSP reports
+static void generate_advertising_report_event(unsigned int index, unsigned int report_count) {
+	uint8_t event[HCI_EVENT_MAX_LENGTH];
+	size_t offset = 4;
+	unsigned int i;
+
+	event[0] = 0x3E;
+	event[2] = 0x02;
+	event[3] = report_count;
+
+	for (i = 0; i < report_count; i++) {
+		uint8_t* report = &event[offset];
+		size_t data_length;
+
+		report[0] = (i % 2) ? 0x04 : 0x00;
+		report[1] = 0x01;
+		report[2] = i;
+		report[3] = index & 0xFF;
+		report[4] = (index >> 8) & 0xFF;
+		report[5] = 0x42; report[6] = 0xC0; report[7] = 0xDE;
+
+		if (i % 2) {
+			char name[16];
+			snprintf(name, sizeof(name), "Tag%u", index % 1000);
+			data_length = put_ad(&report[9], 0, 0x09, (const uint8_t*)name, strlen(name));
+		} else {
+			data_length = put_beacon_data(&report[9], 0, index);
+		}
+		report[8] = data_length;
+		report[9 + data_length] = (uint8_t)(-40 - (int)(index % 50));
+
+		offset += 9 + data_length + 1;
+	}
+
+	event[1] = offset - 2;
+	add_event(event, offset);
+}
+
+// LE Extended Advertising Report event. With 'fragments' set, the data is split in two events.
+static void generate_extended_advertising_report_event(unsigned int index, int fragments) {
+	uint8_t event[HCI_EVENT_MAX_LENGTH];
+	uint8_t data[128];
+	size_t data_length = 0;
+	int fragment;
+
+	while (data_length < (fragments ? 100 : 40)) {
+		data_length = put_beacon_data(data, data_length, index);
+	}
+
+	for (fragment = 0; fragment <= fragments; fragment++) {
+		size_t fragment_length = fragments ? data_length / 2 : data_length;
+		const uint8_t* fragment_data = &data[fragment ? data_length / 2 : 0];
+		uint8_t* report = &event[4];
+
+		if (fragment == fragments) {
+			fragment_length = data_length - (fragment ? data_length / 2 : 0);
+		}
+
+		event[0] = 0x3E;
+		event[2] = 0x0D;
+		event[3] = 1;
+
+		memset(report, 0, 24);
+		// Connectable, data incomplete for all the fragments but the last one
+		report[0] = 0x01 | ((fragment < fragments) ? (1 << 5) : 0);
+		report[2] = 0x01;
+		report[3] = 0x80;
+		report[4] = index & 0xFF;
+		report[5] = (index >> 8) & 0xFF;
+		report[6] = 0x42; report[7] = 0xC0; report[8] = 0xDE;
+		report[9] = 0x01;
+		report[10] = 0x02;
+		report[11] = index % 16;
+		report[12] = 0x7F;
+		report[13] = (uint8_t)(-60 - (int)(index % 30));
+		report[23] = fragment_length;
+		memcpy(&report[24], fragment_data, fragment_length);
+
+		event[1] = 2 + 24 + fragment_length;
+		add_event(event, 4 + 24 + fragment_length);
+	}
+}
+
+static void generate_events(void) {
+	unsigned int i;
+
+	for (i = 0; i < BENCHMARK_GENERATED_EVENTS; i++) {
+		switch (i % 4) {
+		case 0:
+			generate_advertising_report_event(i, 1);
+			break;
+		case 1:
+			generate_advertising_report_event(i, 4);
+			break;
+		case 2:
+			generate_extended_advertising_report_event(i, 0);
+			break;
+		default:
+			generate_extended_advertising_report_event(i, 1);
+			break;
+		}
+	}
+}
+
+static void on_report(gattlib_adapter_t* adapter, const gattlib_advertising_report_t* report, void *user_data) {
+	m_report_count++;
+	m_ad_count += report->ad_count;
+}
+
+static uint64_t get_time_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int main(int argc, const char *argv[]) {
+	gattlib_advertising_parser_t* parser;
+	unsigned long iterations = BENCHMARK_DEFAULT_ITERATIONS;
+	uint64_t start_ns, duration_ns, event_total;
+	unsigned long i;
+	size_t j;
+	int ret;
+
+	if (argc > 3) {
+		printf("%s [<btsnoop-file> [<iterations>]]\n", argv[0]);
+		return 1;
+	}
+
+	if (argc >= 2) {
+		if (load_btsnoop(argv[1]) != 0) {
+			return 1;
+		}
+	} else {
+		generate_events();
+	}
+	if (argc == 3) {
+		iterations = strtoul(argv[2], NULL, 0);
+	}
+
+	if (m_event_count == 0) {
+		fprintf(stderr, "No HCI event to parse\n");
+		return 1;
+	}
+
+	ret = gattlib_advertising_parser_new(&parser);
+	if (ret != GATTLIB_SUCCESS) {
+		fprintf(stderr, "Failed to create the parser: %d\n", ret);
+		return 1;
+	}
+
+	start_ns = get_time_ns();
+	for (i = 0; i < iterations; i++) {
+		for (j = 0; j < m_event_count; j++) {
+			gattlib_advertising_parser_parse_hci_event(parser, NULL, m_events[j].data, m_events[j].length, on_report, NULL);
+		}
+	}
+	duration_ns = get_time_ns() - start_ns;
+	if (duration_ns == 0) {
+		duration_ns = 1;
+	}
+
+	event_total = (uint64_t)m_event_count * iterations;
+
+	printf("Events:        %llu (%zu per iteration, %lu iterations)\n", (unsigned long long)event_total, m_event_count, iterations);
+	printf("Reports:       %llu\n", (unsigned long long)m_report_count);
+	printf("AD structures: %llu\n", (unsigned long long)m_ad_count);
+	printf("Duration:      %.3f ms\n", duration_ns / 1e6);
+	printf("Events/s:      %.0f\n", event_total * 1e9 / duration_ns);
+	printf("Reports/s:     %.0f\n", m_report_count * 1e9 / duration_ns);
+	printf("ns/event:      %.1f\n", (double)duration_ns / event_total);
+
+	gattlib_advertising_parser_free(parser);
+	free(m_events);
+	return 0;
+}
@@ -21,7 +21,6 @@
  */
 
 #include <assert.h>
-#include <ctype.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -49,14 +48,21 @@ static struct {
 	bool value;
 } m_connection_terminated;
 
-static void on_device_connect(gattlib_adapter_t* adapter, const char *dst, gattlib_connection_t* connection, int error, void* user_data) {
+static void on_device_connect(gattlib_adapter_t* adapter, const char *dst, gattlib_connection_t* connection, int error,
+		const gattlib_connect_report_t* report, void* user_data) {
 	int ret;
 
 	if (error != 0) {
-		GATTLIB_LOG(GATTLIB_ERROR, "Failed to connect to device '%s': Error %d", reference_mac_address, error);
+		GATTLIB_LOG(GATTLIB_ERROR, "Failed to connect to device '%s' after %u attempts: Error %d",
+			reference_mac_address, report->attempts, error);
 		goto EXIT;
 	}
 
+	GATTLIB_LOG(GATTLIB_INFO, "Connected to '%s' after %u attempts (queueing:%llu us, connect:%llu us)",
+		reference_mac_address, report->attempts,
+		(unsigned long long)(report->queueing_latency_ns / 1000),
+		(unsigned long long)(report->connect_latency_ns / 1000));
+
 	ret = gattlib_disconnect(connection, true /* wait_disconnection */);
 	assert(ret == 0);
 
@@ -69,21 +75,10 @@ EXIT:
 	pthread_mutex_unlock(&m_connection_terminated.lock);
 }
 
-static int stricmp(char const *a, char const *b) {
-    for (;; a++, b++) {
-        int d = tolower((unsigned char)*a) - tolower((unsigned char)*b);
-        if (d != 0 || !*a)
-            return d;
-    }
-}
-
+// Only the reference device is reported as it is the only address of the allowlist of the adapter
 static void ble_discovered_device(gattlib_adapter_t* adapter, const char* addr, const char* name, void *user_data) {
 	int ret;
 
-	if (stricmp(addr, reference_mac_address) != 0) {
-		return;
-	}
-
 	GATTLIB_LOG(GATTLIB_INFO, "Found bluetooth device '%s'", reference_mac_address);
 
 	for (uintptr_t i = 0; i < BLE_CONNECT_LOOP_COUNT; i++) {
@@ -91,17 +86,9 @@ static void ble_discovered_device(gattlib_adapter_t* adapter, const char* addr,
 
 		memset(&m_connection_terminated, 0, sizeof(m_connection_terminated));
 
-		// Try to connect while the connection is busy.
-		while (true) {
-			ret = gattlib_connect(adapter, addr, GATTLIB_CONNECTION_OPTIONS_NONE, on_device_connect, adapter);
-			if (ret != GATTLIB_BUSY) {
-				break;
-			}
-
-			GATTLIB_LOG(GATTLIB_DEBUG, "Failed to connect to the bluetooth device '%s' because busy. Try again", addr);
-			g_usleep(100);
-		}
-
+		// The connection scheduler retries while the device is still busy disconnecting
+		ret = gattlib_adapter_connect_enqueue(adapter, addr, GATTLIB_CONNECTION_OPTIONS_NONE,
+			0 /* priority */, 0 /* no deadline */, on_device_connect, adapter);
 		if (ret != GATTLIB_SUCCESS) {
 			GATTLIB_LOG(GATTLIB_ERROR, "Failed to connect to the bluetooth device '%s': %d", addr, ret);
 			continue;
@@ -118,14 +105,32 @@ static void ble_discovered_device(gattlib_adapter_t* adapter, const char* addr,
 
 static void* ble_task(void* arg) {
 	gattlib_adapter_t* adapter;
+	gattlib_address_set_t* allowlist;
+	uint64_t reference_address;
 	int ret;
 
+	ret = gattlib_string_to_address48(reference_mac_address, &reference_address);
+	if (ret) {
+		GATTLIB_LOG(GATTLIB_ERROR, "Invalid bluetooth address '%s'.", reference_mac_address);
+		return NULL;
+	}
+
 	ret = gattlib_adapter_open(adapter_name, &adapter);
 	if (ret) {
 		GATTLIB_LOG(GATTLIB_ERROR, "Failed to open adapter.");
 		return NULL;
 	}
 
+	// Let gattlib drop the other devices before they are registered
+	ret = gattlib_address_set_new(&allowlist);
+	if (ret) {
+		GATTLIB_LOG(GATTLIB_ERROR, "Failed to create the allowlist.");
+		goto EXIT;
+	}
+	gattlib_address_set_add(allowlist, reference_address);
+	gattlib_adapter_set_address_allowlist(adapter, allowlist);
+	gattlib_address_set_unref(allowlist);
+
 	ret = gattlib_adapter_scan_enable(adapter, ble_discovered_device, BLE_SCAN_TIMEOUT, NULL /* user_data */);
 	if (ret) {
 		GATTLIB_LOG(GATTLIB_ERROR, "Failed to scan.");